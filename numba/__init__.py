@@ -42,6 +42,9 @@ from numba.core.decorators import (cfunc, generated_jit, jit, njit, stencil,
 from numba.np.ufunc import (vectorize, guvectorize, threading_layer,
                             get_num_threads, set_num_threads,
                             set_parallel_chunksize, get_parallel_chunksize,
+                            set_parallel_schedule, get_parallel_schedule,
+                            set_parallel_split_alignment,
+                            get_parallel_split_alignment,
                             get_thread_id)
 
 # Re-export Numpy helpers
@@ -90,6 +93,10 @@ __all__ = """
     set_parallel_chunksize
     get_parallel_chunksize
     parallel_chunksize
+    set_parallel_schedule
+    get_parallel_schedule
+    set_parallel_split_alignment
+    get_parallel_split_alignment
     """.split() + types.__all__ + errors.__all__
 
 
@@ -1,11 +1,16 @@
 #include "_pymodule.h"
 
+#include <chrono>
+#include <cstddef>
 #include <cstring>
 #include <ctime>
 #include <cassert>
 #include <vector>
 
 #include "_typeof.h"
+extern "C" {
+#include "_hashtable.h"
+}
 #include "frameobject.h"
 #include "core/typeconv/typeconv.hpp"
 #include "_devicearray.h"
@@ -276,9 +281,76 @@ else                                                            \
 
 #endif
 
+/* The PEP 590 vectorcall protocol is public from Python 3.9 */
+#if PY_VERSION_HEX >= 0x03090000
+#define NUMBA_DISPATCHER_VECTORCALL 1
+#else
+#define NUMBA_DISPATCHER_VECTORCALL 0
+#endif
+
 typedef std::vector<Type> TypeTable;
 typedef std::vector<PyObject*> Functions;
 
+/* Opt-in call statistics of a Dispatcher, see Dispatcher_enable_stats().
+   Every call is counted, while the latency is only measured for one call in
+   every `interval` to keep the cost of reading the clock off most calls.
+   Dispatchers aren't thread-safe so neither are the counters. */
+struct DispatcherStats {
+    typedef unsigned long long counter;
+
+    explicit DispatcherStats(counter interval)
+        : calls(0), misses(0), cache_misses(0), compiles(0), fallbacks(0),
+          samples(0), dispatch_ns(0), dispatch_max_ns(0), call_ns(0),
+          interval(interval) { }
+
+    /* Whether the call about to be counted is timed */
+    bool due() const {
+        return interval && (calls + 1) % interval == 0;
+    }
+
+    void countOverload(int index) {
+        if ((size_t) index >= overload_calls.size())
+            overload_calls.resize(index + 1, 0);
+        ++overload_calls[index];
+    }
+
+    /* Record a sample, from the start of the call to the call of the
+       overload (the dispatch latency) and to its return. */
+    void addSample(counter start, counter dispatched, counter end) {
+        counter dispatch = dispatched - start;
+        ++samples;
+        dispatch_ns += dispatch;
+        if (dispatch > dispatch_max_ns)
+            dispatch_max_ns = dispatch;
+        call_ns += end - dispatched;
+    }
+
+    static counter now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /* Number of calls */
+    counter calls;
+    /* Number of calls that didn't resolve to a single overload */
+    counter misses;
+    /* Number of resolutions that missed the resolution cache */
+    counter cache_misses;
+    /* Number of calls that triggered a compilation */
+    counter compiles;
+    /* Number of calls to the object mode fallback */
+    counter fallbacks;
+    /* Number of timed calls and their accumulated latencies */
+    counter samples;
+    counter dispatch_ns;
+    counter dispatch_max_ns;
+    counter call_ns;
+    /* One call in `interval` is timed, none if 0 */
+    counter interval;
+    /* Number of calls per overload, by index of the overload */
+    std::vector<counter> overload_calls;
+};
+
 /* The Dispatcher class is the base class of all dispatchers in the CPU and
    CUDA targets. Its main responsibilities are:
 
@@ -320,12 +392,28 @@ public:
     /* A flattened array of argument types to all overloads
      * (invariant: sizeof(overloads) == argct * sizeof(functions)) */
     TypeTable overloads;
+    /* A cache of the overloads selected by resolve(), as an open addressing
+     * hash table. The key of a slot is its argct argument types followed by
+     * the resolution flags, the value is the index of the overload plus one,
+     * or 0 for an empty slot. */
+    TypeTable cache_keys;
+    std::vector<int> cache_values;
+    size_t cache_count;
+    /* The version of the TypeManager the cache was filled with */
+    unsigned long cache_version;
+    /* Call statistics, NULL unless enabled with _enable_stats() */
+    DispatcherStats *stats;
+#if NUMBA_DISPATCHER_VECTORCALL
+    /* The vectorcall entry point, see Dispatcher_vectorcall() */
+    vectorcallfunc vectorcall;
+#endif
 
     /* Add a new overload. Parameters:
 
        - args: An array of Type objects, one for each parameter
        - callable: The callable implementing this overload. */
     void addDefinition(Type args[], PyObject *callable) {
+        clearCache();
         overloads.reserve(argct + overloads.size());
         for (int i=0; i<argct; ++i) {
             overloads.push_back(args[i]);
@@ -345,12 +433,18 @@ public:
        - exact_match_required: Whether all arguments types must match the
                                overload's types exactly. When false,
                                overloads that would require a type conversion
-                               can also be matched. */
+                               can also be matched.
+       - index: if not NULL, receives the index of the match.
+       - missed: if not NULL, receives whether the lookup missed the cache,
+                 which is then left to the caller to count in the stats. */
     PyObject* resolve(Type sig[], int &matches, bool allow_unsafe,
-                      bool exact_match_required) const {
+                      bool exact_match_required, int *index = NULL,
+                      bool *missed = NULL) {
         const int ovct = functions.size();
-        int selected;
+        int selected = 0;
         matches = 0;
+        if (missed)
+            *missed = false;
         if (0 == ovct) {
             // No overloads registered
             return NULL;
@@ -361,11 +455,34 @@ public:
             selected = 0;
         }
         else {
-            matches = tm->selectOverload(sig, &overloads[0], selected, argct,
-                                         ovct, allow_unsafe,
-                                         exact_match_required);
+            Type flags = (allow_unsafe ? 1 : 0) |
+                         (exact_match_required ? 2 : 0);
+            size_t hash = hashSignature(sig, flags);
+            if (cache_version != tm->getVersion()) {
+                // New conversions may change the outcome
+                clearCache();
+                cache_version = tm->getVersion();
+            }
+            selected = lookupCache(sig, flags, hash);
+            if (selected >= 0) {
+                matches = 1;
+            }
+            else {
+                if (missed)
+                    *missed = true;
+                else if (stats)
+                    ++stats->cache_misses;
+                matches = tm->selectOverload(sig, &overloads[0], selected,
+                                             argct, ovct, allow_unsafe,
+                                             exact_match_required);
+                if (matches == 1) {
+                    insertCache(sig, flags, hash, selected);
+                }
+            }
         }
         if (matches == 1) {
+            if (index)
+                *index = selected;
             return functions[selected];
         }
         return NULL;
@@ -375,11 +492,110 @@ public:
     void clear() {
         functions.clear();
         overloads.clear();
+        clearCache();
+        if (stats) {
+            // The overload indices are reused
+            stats->overload_calls.clear();
+        }
+    }
+
+private:
+    /* The initial number of slots of the cache, a power of two */
+    static const size_t CACHE_MIN_SIZE = 16;
+    /* The cache is emptied rather than grown past this number of slots, to
+       bound its size for dispatchers called with many distinct signatures */
+    static const size_t CACHE_MAX_SIZE = 4096;
+
+    size_t hashSignature(const Type sig[], Type flags) const {
+        size_t hash = (size_t) flags;
+        for (int i = 0; i < argct; ++i) {
+            hash = (hash ^ (size_t) sig[i]) * 1099511628211ULL;
+        }
+        return hash ^ (hash >> 17);
+    }
+
+    bool matchSlot(size_t slot, const Type sig[], Type flags) const {
+        const Type *key = &cache_keys[slot * (argct + 1)];
+        return key[argct] == flags &&
+               0 == std::memcmp(key, sig, argct * sizeof(Type));
+    }
+
+    /* Returns the index of the cached overload, or -1 if there is none */
+    int lookupCache(const Type sig[], Type flags, size_t hash) const {
+        const size_t mask = cache_values.size() - 1;
+        if (cache_values.empty())
+            return -1;
+        for (size_t slot = hash & mask; cache_values[slot];
+             slot = (slot + 1) & mask) {
+            if (matchSlot(slot, sig, flags))
+                return cache_values[slot] - 1;
+        }
+        return -1;
+    }
+
+    void storeSlot(const Type sig[], Type flags, size_t hash, int value) {
+        const size_t mask = cache_values.size() - 1;
+        size_t slot = hash & mask;
+        Type *key;
+        while (cache_values[slot])
+            slot = (slot + 1) & mask;
+        key = &cache_keys[slot * (argct + 1)];
+        std::memcpy(key, sig, argct * sizeof(Type));
+        key[argct] = flags;
+        cache_values[slot] = value;
+        ++cache_count;
+    }
+
+    void insertCache(const Type sig[], Type flags, size_t hash, int index) {
+        const size_t stride = argct + 1;
+        // Keep the load factor at most 1/2
+        if (2 * (cache_count + 1) > cache_values.size()) {
+            TypeTable old_keys;
+            std::vector<int> old_values;
+            size_t size = CACHE_MIN_SIZE;
+            if (!cache_values.empty()) {
+                size = 2 * cache_values.size();
+                if (size > CACHE_MAX_SIZE) {
+                    // Start over rather than grow
+                    size = cache_values.size();
+                }
+                else {
+                    old_keys.swap(cache_keys);
+                    old_values.swap(cache_values);
+                }
+            }
+            cache_keys.assign(size * stride, 0);
+            cache_values.assign(size, 0);
+            cache_count = 0;
+            for (size_t i = 0; i < old_values.size(); ++i) {
+                if (old_values[i]) {
+                    const Type *key = &old_keys[i * stride];
+                    storeSlot(key, key[argct], hashSignature(key, key[argct]),
+                              old_values[i]);
+                }
+            }
+        }
+        storeSlot(sig, flags, hash, index + 1);
+    }
+
+    void clearCache() {
+        // Release the storage too, as the destructor is never run
+        TypeTable().swap(cache_keys);
+        std::vector<int>().swap(cache_values);
+        cache_count = 0;
     }
 
 };
 
 
+static PyObject*
+Dispatcher_call(Dispatcher *self, PyObject *args, PyObject *kws);
+#if NUMBA_DISPATCHER_VECTORCALL
+static PyObject*
+Dispatcher_vectorcall(PyObject *callable, PyObject *const *args,
+                      size_t nargsf, PyObject *kwnames);
+#endif
+
 static int
 Dispatcher_traverse(Dispatcher *self, visitproc visit, void *arg)
 {
@@ -393,6 +609,7 @@ Dispatcher_dealloc(Dispatcher *self)
     Py_XDECREF(self->argnames);
     Py_XDECREF(self->defargs);
     self->clear();
+    delete self->stats;
     Py_TYPE(self)->tp_free((PyObject*)self);
 }
 
@@ -427,6 +644,13 @@ Dispatcher_init(Dispatcher *self, PyObject *args, PyObject *kwds)
     self->fallbackdef = NULL;
     self->has_stararg = has_stararg;
     self->exact_match_required = exact_match_required;
+#if NUMBA_DISPATCHER_VECTORCALL
+    self->vectorcall = Dispatcher_vectorcall;
+    /* Prior to Python 3.12 the vectorcall flag isn't inherited by subclasses
+       defined in Python, set it unless they override __call__ */
+    if (Py_TYPE(self)->tp_call == (ternaryfunc) Dispatcher_call)
+        Py_TYPE(self)->tp_flags |= Py_TPFLAGS_HAVE_VECTORCALL;
+#endif
     return 0;
 }
 
@@ -841,9 +1065,12 @@ Dispatcher_call(Dispatcher *self, PyObject *args, PyObject *kws)
     int i;
     int prealloc[24];
     int matches;
+    int selected;
     PyObject *cfunc;
     PyThreadState *ts = PyThreadState_Get();
     PyObject *locals = NULL;
+    DispatcherStats *stats = self->stats;
+    DispatcherStats::counter start = 0;
 
     // Check TLS target stack
     if (use_tls_target_stack) {
@@ -862,6 +1089,12 @@ Dispatcher_call(Dispatcher *self, PyObject *args, PyObject *kws)
      * not compile one */
     int exact_match_required = self->can_compile ? 1 : self->exact_match_required;
 
+    if (stats) {
+        if (stats->due())
+            start = DispatcherStats::now();
+        ++stats->calls;
+    }
+
 #if (PY_MAJOR_VERSION >= 3) && (PY_MINOR_VERSION >= 10)
     if (ts->tracing && ts->c_profilefunc) {
 #else
@@ -906,7 +1139,7 @@ Dispatcher_call(Dispatcher *self, PyObject *args, PyObject *kws)
        Note that the number of matches is returned in matches by resolve, which
        accepts it as a reference. */
     cfunc = self->resolve(tys, matches, !self->can_compile,
-                          exact_match_required);
+                          exact_match_required, &selected);
 
     if (matches == 0 && !self->can_compile) {
         /*
@@ -922,18 +1155,34 @@ Dispatcher_call(Dispatcher *self, PyObject *args, PyObject *kws)
         if (res > 0) {
             /* Retry with the newly registered conversions */
             cfunc = self->resolve(tys, matches, !self->can_compile,
-                                  exact_match_required);
+                                  exact_match_required, &selected);
         }
     }
+    if (stats) {
+        if (matches == 1)
+            stats->countOverload(selected);
+        else
+            ++stats->misses;
+    }
     if (matches == 1) {
         /* Definition is found */
-        retval = call_cfunc(self, cfunc, args, kws, locals);
+        if (start) {
+            DispatcherStats::counter dispatched = DispatcherStats::now();
+            retval = call_cfunc(self, cfunc, args, kws, locals);
+            stats->addSample(start, dispatched, DispatcherStats::now());
+        }
+        else
+            retval = call_cfunc(self, cfunc, args, kws, locals);
     } else if (matches == 0) {
         /* No matching definition */
         if (self->can_compile) {
+            if (stats)
+                ++stats->compiles;
             retval = compile_and_invoke(self, args, kws, locals);
         } else if (self->fallbackdef) {
             /* Have object fallback */
+            if (stats)
+                ++stats->fallbacks;
             retval = call_cfunc(self, self->fallbackdef, args, kws, locals);
         } else {
             /* Raise TypeError */
@@ -942,6 +1191,8 @@ Dispatcher_call(Dispatcher *self, PyObject *args, PyObject *kws)
         }
     } else if (self->can_compile) {
         /* Ambiguous, but are allowed to compile */
+        if (stats)
+            ++stats->compiles;
         retval = compile_and_invoke(self, args, kws, locals);
     } else {
         /* Ambiguous */
@@ -957,6 +1208,258 @@ CLEANUP:
     return retval;
 }
 
+#if NUMBA_DISPATCHER_VECTORCALL
+/* Call through the tp_call protocol, packing the positional arguments into a
+   tuple and the named arguments into a dict */
+static PyObject*
+Dispatcher_vectorcall_slow(Dispatcher *self, PyObject *const *args,
+                           Py_ssize_t nargs, PyObject *kwnames)
+{
+    PyObject *argtup, *kws = NULL, *retval;
+    Py_ssize_t i;
+
+    argtup = PyTuple_New(nargs);
+    if (argtup == NULL)
+        return NULL;
+    for (i = 0; i < nargs; ++i) {
+        Py_INCREF(args[i]);
+        PyTuple_SET_ITEM(argtup, i, args[i]);
+    }
+    if (kwnames != NULL && PyTuple_GET_SIZE(kwnames) > 0) {
+        kws = PyDict_New();
+        if (kws == NULL) {
+            Py_DECREF(argtup);
+            return NULL;
+        }
+        for (i = 0; i < PyTuple_GET_SIZE(kwnames); ++i) {
+            if (PyDict_SetItem(kws, PyTuple_GET_ITEM(kwnames, i),
+                               args[nargs + i])) {
+                Py_DECREF(kws);
+                Py_DECREF(argtup);
+                return NULL;
+            }
+        }
+    }
+    retval = Dispatcher_call(self, argtup, kws);
+    Py_DECREF(argtup);
+    Py_XDECREF(kws);
+    return retval;
+}
+
+/* The PEP 590 vectorcall entry point. Calls passing exactly the declared
+   positional arguments, which are resolved to an existing overload, go
+   straight to it without building the named arguments dict, folding the
+   arguments or converting them to a sequence. Everything else (named or
+   default arguments, compilation, tracing...) goes through Dispatcher_call. */
+static PyObject*
+Dispatcher_vectorcall(PyObject *callable, PyObject *const *args,
+                      size_t nargsf, PyObject *kwnames)
+{
+    Dispatcher *self = (Dispatcher *) callable;
+    Py_ssize_t nargs = PyVectorcall_NARGS(nargsf);
+    PyThreadState *ts = PyThreadState_Get();
+    PyObject *argtup, *cfunc, *retval;
+    int tys[24];
+    int matches;
+    int selected;
+    bool missed;
+    Py_ssize_t i;
+    int exact_match_required;
+    DispatcherStats *stats = self->stats;
+    DispatcherStats::counter start = 0;
+
+    if ((kwnames != NULL && PyTuple_GET_SIZE(kwnames) > 0) ||
+        use_tls_target_stack ||
+        nargs >= (Py_ssize_t) (sizeof(tys) / sizeof(int)) ||
+        (self->fold_args &&
+         (self->has_stararg || nargs != PyTuple_GET_SIZE(self->argnames))) ||
+        ts->c_profilefunc) {
+        return Dispatcher_vectorcall_slow(self, args, nargs, kwnames);
+    }
+    /* The call is only counted here if it takes the fast path */
+    if (stats && stats->due())
+        start = DispatcherStats::now();
+
+    for (i = 0; i < nargs; ++i) {
+        tys[i] = typeof_typecode((PyObject *) self, args[i]);
+        if (tys[i] == -1) {
+            if (!self->can_fallback)
+                return NULL;
+            PyErr_Clear();
+        }
+    }
+
+    exact_match_required = self->can_compile ? 1 : self->exact_match_required;
+    /* A cache miss is only counted once the slow path isn't needed, as it
+       resolves the call again */
+    cfunc = self->resolve(tys, matches, !self->can_compile,
+                          exact_match_required, &selected, &missed);
+    if (matches != 1) {
+        /* Compilation, conversions or errors are needed */
+        return Dispatcher_vectorcall_slow(self, args, nargs, kwnames);
+    }
+    if (stats) {
+        ++stats->calls;
+        if (missed)
+            ++stats->cache_misses;
+        stats->countOverload(selected);
+    }
+
+    /* The compiled wrappers take their arguments as a tuple */
+    argtup = PyTuple_New(nargs);
+    if (argtup == NULL)
+        return NULL;
+    for (i = 0; i < nargs; ++i) {
+        Py_INCREF(args[i]);
+        PyTuple_SET_ITEM(argtup, i, args[i]);
+    }
+    if (start) {
+        DispatcherStats::counter dispatched = DispatcherStats::now();
+        retval = call_cfunc(self, cfunc, argtup, NULL, NULL);
+        stats->addSample(start, dispatched, DispatcherStats::now());
+    }
+    else
+        retval = call_cfunc(self, cfunc, argtup, NULL, NULL);
+    Py_DECREF(argtup);
+    return retval;
+}
+#endif  /* NUMBA_DISPATCHER_VECTORCALL */
+
+/* Call the dispatcher once for each tuple of positional arguments in a
+   sequence. The overload is resolved once per run of arguments of the same
+   types, the other calls go straight to it. Arguments needing named or
+   default arguments to be folded, or a compilation, go through
+   Dispatcher_call. The results are returned as a list, or stored in `out`
+   (e.g. a preallocated array) if given, which is then returned. */
+static PyObject*
+Dispatcher_call_batch(Dispatcher *self, PyObject *args)
+{
+    PyObject *argseq, *out = Py_None;
+    PyObject *seq, *results;
+    PyObject *cfunc = NULL;
+    PyThreadState *ts = PyThreadState_Get();
+    DispatcherStats *stats = self->stats;
+    std::vector<int> tys, last_tys;
+    Py_ssize_t i, j, n;
+    int exact_match_required;
+    int selected = 0;
+
+    if (!PyArg_ParseTuple(args, "O|O", &argseq, &out))
+        return NULL;
+    seq = PySequence_Fast(argseq, "expected a sequence of argument tuples");
+    if (seq == NULL)
+        return NULL;
+    n = PySequence_Fast_GET_SIZE(seq);
+    if (out == Py_None) {
+        results = PyList_New(n);
+    }
+    else {
+        Py_ssize_t size = PyObject_Size(out);
+        results = NULL;
+        if (size == n) {
+            results = out;
+            Py_INCREF(results);
+        }
+        else if (size >= 0) {
+            PyErr_Format(PyExc_ValueError,
+                         "output has length %zd, expected %zd", size, n);
+        }
+    }
+    if (results == NULL) {
+        Py_DECREF(seq);
+        return NULL;
+    }
+
+    for (i = 0; i < n; ++i) {
+        PyObject *item = PySequence_Fast_GET_ITEM(seq, i);
+        PyObject *retval;
+        Py_ssize_t nargs;
+        int matches;
+        bool missed;
+
+        if (!PyTuple_Check(item)) {
+            PyErr_Format(PyExc_TypeError,
+                         "expected a tuple of arguments, got %.200s",
+                         Py_TYPE(item)->tp_name);
+            goto error;
+        }
+        nargs = PyTuple_GET_SIZE(item);
+        if (use_tls_target_stack || ts->c_profilefunc ||
+            (self->fold_args &&
+             (self->has_stararg ||
+              nargs != PyTuple_GET_SIZE(self->argnames)))) {
+            retval = Dispatcher_call(self, item, NULL);
+            goto store;
+        }
+
+        tys.resize(nargs);
+        for (j = 0; j < nargs; ++j) {
+            tys[j] = typeof_typecode((PyObject *) self,
+                                     PyTuple_GET_ITEM(item, j));
+            if (tys[j] == -1) {
+                if (!self->can_fallback)
+                    goto error;
+                PyErr_Clear();
+            }
+        }
+        if (cfunc == NULL || tys != last_tys) {
+            /* A reference is kept in case the overloads change during a
+               call */
+            Py_CLEAR(cfunc);
+            exact_match_required =
+                self->can_compile ? 1 : self->exact_match_required;
+            /* tys is empty for nullary calls, and as in the vectorcall
+               fast path a miss is only counted if Dispatcher_call doesn't
+               resolve the call again */
+            cfunc = self->resolve(tys.data(), matches, !self->can_compile,
+                                  exact_match_required, &selected, &missed);
+            if (matches != 1) {
+                /* Compilation, conversions or errors are needed */
+                retval = Dispatcher_call(self, item, NULL);
+                goto store;
+            }
+            Py_INCREF(cfunc);
+            last_tys.swap(tys);
+            if (stats) {
+                ++stats->calls;
+                if (missed)
+                    ++stats->cache_misses;
+                stats->countOverload(selected);
+            }
+        }
+        else if (stats) {
+            /* The stats may have been reset since the overload was
+               resolved */
+            ++stats->calls;
+            stats->countOverload(selected);
+        }
+        retval = call_cfunc(self, cfunc, item, NULL, NULL);
+
+    store:
+        if (retval == NULL)
+            goto error;
+        if (out == Py_None) {
+            PyList_SET_ITEM(results, i, retval);
+        }
+        else {
+            int err = PySequence_SetItem(results, i, retval);
+            Py_DECREF(retval);
+            if (err)
+                goto error;
+        }
+    }
+
+    Py_XDECREF(cfunc);
+    Py_DECREF(seq);
+    return results;
+
+error:
+    Py_XDECREF(cfunc);
+    Py_DECREF(seq);
+    Py_DECREF(results);
+    return NULL;
+}
+
 /* Based on Dispatcher_call above, with the following differences:
    1. It does not invoke the definition of the function.
    2. It returns the definition, instead of a value returned by the function.
@@ -1091,12 +1594,92 @@ import_devicearray(void)
     return 0;
 }
 
+/* Enable, or disable and discard, the call statistics. A sample interval of
+   N times one call in every N, 0 disables the timing. */
+static PyObject *
+Dispatcher_enable_stats(Dispatcher *self, PyObject *args)
+{
+    int enable;
+    unsigned long long interval = 64;
+    if (!PyArg_ParseTuple(args, "p|K", &enable, &interval))
+        return NULL;
+    if (!enable) {
+        delete self->stats;
+        self->stats = NULL;
+    }
+    else if (self->stats) {
+        self->stats->interval = interval;
+    }
+    else {
+        self->stats = new DispatcherStats(interval);
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+Dispatcher_reset_stats(Dispatcher *self, PyObject *args)
+{
+    if (self->stats) {
+        *self->stats = DispatcherStats(self->stats->interval);
+    }
+    Py_RETURN_NONE;
+}
+
+/* Return the call statistics as a dict, or None if they aren't enabled. The
+   per overload counts are a list of (callable, count) pairs. */
+static PyObject *
+Dispatcher_get_stats(Dispatcher *self, PyObject *args)
+{
+    DispatcherStats *stats = self->stats;
+    PyObject *overloads;
+    size_t i;
+
+    if (!stats)
+        Py_RETURN_NONE;
+    overloads = PyList_New(0);
+    if (overloads == NULL)
+        return NULL;
+    for (i = 0; i < stats->overload_calls.size(); ++i) {
+        PyObject *item;
+        if (i >= self->functions.size() || !stats->overload_calls[i])
+            continue;
+        item = Py_BuildValue("(OK)", self->functions[i],
+                             stats->overload_calls[i]);
+        if (item == NULL || PyList_Append(overloads, item)) {
+            Py_XDECREF(item);
+            Py_DECREF(overloads);
+            return NULL;
+        }
+        Py_DECREF(item);
+    }
+    return Py_BuildValue("{sKsKsKsKsKsKsKsKsKsKsN}",
+                         "calls", stats->calls,
+                         "misses", stats->misses,
+                         "cache_misses", stats->cache_misses,
+                         "compiles", stats->compiles,
+                         "fallbacks", stats->fallbacks,
+                         "samples", stats->samples,
+                         "dispatch_ns", stats->dispatch_ns,
+                         "dispatch_max_ns", stats->dispatch_max_ns,
+                         "call_ns", stats->call_ns,
+                         "sample_interval", stats->interval,
+                         "overloads", overloads);
+}
+
 static PyMethodDef Dispatcher_methods[] = {
     { "_clear", (PyCFunction)Dispatcher_clear, METH_NOARGS, NULL },
     { "_insert", (PyCFunction)Dispatcher_Insert, METH_VARARGS | METH_KEYWORDS,
       "insert new definition"},
     { "_cuda_call", (PyCFunction)Dispatcher_cuda_call,
       METH_VARARGS | METH_KEYWORDS, "CUDA call resolution" },
+    { "_call_batch", (PyCFunction)Dispatcher_call_batch, METH_VARARGS,
+      "call once for each tuple of arguments in a sequence" },
+    { "_enable_stats", (PyCFunction)Dispatcher_enable_stats, METH_VARARGS,
+      "enable or disable the call statistics" },
+    { "_get_stats", (PyCFunction)Dispatcher_get_stats, METH_NOARGS,
+      "return the call statistics" },
+    { "_reset_stats", (PyCFunction)Dispatcher_reset_stats, METH_NOARGS,
+      "reset the call statistics" },
     { NULL },
 };
 
@@ -1190,11 +1773,20 @@ static PyObject *set_use_tls_target_stack(PyObject *self, PyObject *args)
     }
 }
 
+/* Run the self test of the hash table of _typeof.c, returns 0 on success */
+static PyObject *
+hashtable_test(PyObject *self, PyObject *args)
+{
+    return PyLong_FromLong(_Numba_hashtable_test());
+}
+
 static PyMethodDef ext_methods[] = {
 #define declmethod(func) { #func , ( PyCFunction )func , METH_VARARGS , NULL }
     declmethod(typeof_init),
+    declmethod(typeof_register_type),
     declmethod(compute_fingerprint),
     declmethod(set_use_tls_target_stack),
+    declmethod(hashtable_test),
     { NULL },
 #undef declmethod
 };
@@ -1213,6 +1805,10 @@ MOD_INIT(_dispatcher) {
         return MOD_ERROR_VAL;
 
     DispatcherType.tp_new = PyType_GenericNew;
+#if NUMBA_DISPATCHER_VECTORCALL
+    DispatcherType.tp_vectorcall_offset = offsetof(Dispatcher, vectorcall);
+    DispatcherType.tp_flags |= Py_TPFLAGS_HAVE_VECTORCALL;
+#endif
     if (PyType_Ready(&DispatcherType) < 0) {
         return MOD_ERROR_VAL;
     }
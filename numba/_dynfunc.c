@@ -278,7 +278,8 @@ dup_string(PyObject *strobj)
     return str;
 }
 
-/* Create and initialize a new Closure object */
+/* Create and initialize a new Closure object, *env* may be NULL if the
+   environment is set later (see pycc's modulemixin.c) */
 static ClosureObject *
 closure_new(PyObject *name, PyObject *doc, PyCFunction fnaddr,
             EnvironmentObject *env, PyObject *keepalive)
@@ -299,7 +300,7 @@ closure_new(PyObject *name, PyObject *doc, PyCFunction fnaddr,
         Py_DECREF(clo);
         return NULL;
     }
-    Py_INCREF(env);
+    Py_XINCREF(env);
     clo->env = env;
     Py_XINCREF(keepalive);
     clo->keepalive = keepalive;
@@ -342,10 +343,21 @@ FAIL:
 
 typedef void (*gen_finalizer_t)(void *);
 
+/* Run the native generator until *count* values are stored every *stride*
+   bytes from *data* or until it is exhausted, returns the number of values
+   stored or -1 with an exception set. */
+typedef Py_ssize_t (*gen_fillfunc_t)(PyObject *, char *, Py_ssize_t,
+                                     Py_ssize_t);
+
 typedef struct {
     CLOSURE_HEAD
     PyCFunctionWithKeywords nextfunc;
     gen_finalizer_t finalizer;
+    /* The bulk filling function, if the yielded values are scalars, with
+       the kind (as in NumPy's dtype.kind) and itemsize of these values */
+    gen_fillfunc_t fillfunc;
+    char fill_kind;
+    Py_ssize_t fill_itemsize;
     PyObject *weakreflist;
     union {
         double dummy;   /* Force alignment */
@@ -412,6 +424,135 @@ generator_iternext(GeneratorObject *gen)
     return res;
 }
 
+/* The kind of the values of a buffer with struct format *fmt*, or 0 if they
+   are not scalars in native byte order */
+static char
+buffer_format_kind(const char *fmt)
+{
+    if (fmt == NULL)
+        return 'u';
+    switch (*fmt) {
+    case '@': case '=':
+        fmt++;
+        break;
+#if PY_LITTLE_ENDIAN
+    case '<':
+#else
+    case '>': case '!':
+#endif
+        fmt++;
+        break;
+    }
+    if (fmt[0] == '\0' || (fmt[0] != 'Z' && fmt[1] != '\0'))
+        return 0;
+    switch (fmt[0]) {
+    case 'b': case 'h': case 'i': case 'l': case 'q': case 'n':
+        return 'i';
+    case 'B': case 'H': case 'I': case 'L': case 'Q': case 'N':
+        return 'u';
+    case 'e': case 'f': case 'd':
+        return 'f';
+    case '?':
+        return 'b';
+    case 'Z':
+        if ((fmt[1] == 'f' || fmt[1] == 'd') && fmt[2] == '\0')
+            return 'c';
+        return 0;
+    }
+    return 0;
+}
+
+/* Fill the items of *out* by calling next() on the generator */
+static Py_ssize_t
+generator_fill_sequence(GeneratorObject *gen, PyObject *out)
+{
+    PyObject *args, *item;
+    Py_ssize_t i, n;
+
+    n = PySequence_Size(out);
+    if (n < 0)
+        return -1;
+    /* The argument tuple is shared by all the calls */
+    args = PyTuple_Pack(1, (PyObject *) gen);
+    if (args == NULL)
+        return -1;
+    for (i = 0; i < n; i++) {
+        item = (*gen->nextfunc)((PyObject *) gen, args, NULL);
+        if (item == NULL) {
+            if (PyErr_ExceptionMatches(PyExc_StopIteration)) {
+                PyErr_Clear();
+                break;
+            }
+            goto error;
+        }
+        if (PyList_CheckExact(out)) {
+            PyObject *old = PyList_GET_ITEM(out, i);
+            PyList_SET_ITEM(out, i, item);
+            Py_DECREF(old);
+        }
+        else {
+            int err = PySequence_SetItem(out, i, item);
+            Py_DECREF(item);
+            if (err)
+                goto error;
+        }
+    }
+    Py_DECREF(args);
+    return i;
+
+error:
+    Py_DECREF(args);
+    return -1;
+}
+
+static PyObject *
+generator_fill(GeneratorObject *gen, PyObject *out)
+{
+    Py_ssize_t filled = -1;
+
+    if (gen->nextfunc == NULL) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "cannot call fill() on finalized generator");
+        return NULL;
+    }
+    if (gen->fillfunc != NULL && PyObject_CheckBuffer(out)) {
+        Py_buffer view;
+        if (PyObject_GetBuffer(out, &view, PyBUF_WRITABLE | PyBUF_STRIDES |
+                                           PyBUF_FORMAT) == 0) {
+            if (view.ndim == 1 && view.itemsize == gen->fill_itemsize &&
+                buffer_format_kind(view.format) == gen->fill_kind) {
+                Py_ssize_t stride = view.strides ? view.strides[0]
+                                                 : view.itemsize;
+                filled = gen->fillfunc((PyObject *) gen, (char *) view.buf,
+                                       stride, view.shape[0]);
+                PyBuffer_Release(&view);
+                if (filled < 0)
+                    return NULL;
+                return PyLong_FromSsize_t(filled);
+            }
+            PyBuffer_Release(&view);
+        }
+        else {
+            /* e.g. a read-only buffer, let the generic path report it */
+            PyErr_Clear();
+        }
+    }
+    filled = generator_fill_sequence(gen, out);
+    if (filled < 0)
+        return NULL;
+    return PyLong_FromSsize_t(filled);
+}
+
+static PyMethodDef generator_methods[] = {
+    {"fill", (PyCFunction) generator_fill, METH_O,
+     "fill(out) -> int\n\n"
+     "Store the next values of the generator in the items of the sequence\n"
+     "or 1-dimensional array `out`, until it is full or the generator is\n"
+     "exhausted, and return the number of values stored.  Arrays of the\n"
+     "yielded scalar type are filled without leaving native code."},
+    {NULL}  /* Sentinel */
+};
+
 static PyTypeObject GeneratorType = {
     PyVarObject_HEAD_INIT(NULL, 0)
     "_dynfunc._Generator",                    /* tp_name*/
@@ -441,7 +582,7 @@ static PyTypeObject GeneratorType = {
     offsetof(GeneratorObject, weakreflist),   /* tp_weaklistoffset */
     PyObject_SelfIter,                        /* tp_iter */
     (iternextfunc) generator_iternext,        /* tp_iternext */
-    0,                                        /* tp_methods */
+    generator_methods,                        /* tp_methods */
     0,                                        /* tp_members */
     0,                                        /* tp_getset */
     0,                                        /* tp_base */
@@ -479,6 +620,9 @@ Numba_make_generator(Py_ssize_t gen_state_size,
                      void *initial_state,
                      PyCFunctionWithKeywords nextfunc,
                      gen_finalizer_t finalizer,
+                     gen_fillfunc_t fillfunc,
+                     int fill_kind,
+                     Py_ssize_t fill_itemsize,
                      EnvironmentObject *env)
 {
     GeneratorObject *gen;
@@ -490,6 +634,9 @@ Numba_make_generator(Py_ssize_t gen_state_size,
     Py_XINCREF(env);
     gen->env = env;
     gen->finalizer = finalizer;
+    gen->fillfunc = fillfunc;
+    gen->fill_kind = (char) fill_kind;
+    gen->fill_itemsize = fill_itemsize;
     return (PyObject *) gen;
 }
 
@@ -9,7 +9,14 @@
  * $ sed -i -r 's/\b_Py_(has[h]table)/_Numba_\1/ig' numba/_hashtable.h numba/_hashtable.c
  */
 
-/* The implementation of the hash table (_Numba_hashtable_t) is based on the cfuhash
+/* The hash table (_Numba_hashtable_t) has since been rewritten to use open
+   addressing with linear probing: the entries are stored inline in a single
+   array of slots, next to an array of control bytes holding a tag of their
+   hash, and deletions shift the following entries back rather than leaving
+   tombstones.  Lookups therefore don't chase a pointer per entry and
+   insertions don't allocate.
+
+   The original implementation (_Numba_hashtable_t) was based on the cfuhash
    project:
    http://sourceforge.net/projects/libcfu/
 
@@ -59,44 +66,24 @@
 #include "_hashtable.h"
 
 #define HASHTABLE_MIN_SIZE 16
-#define HASHTABLE_HIGH 0.50
+#define HASHTABLE_HIGH 0.75
 #define HASHTABLE_LOW 0.10
 #define HASHTABLE_REHASH_FACTOR 2.0 / (HASHTABLE_LOW + HASHTABLE_HIGH)
 
-#define BUCKETS_HEAD(SLIST) \
-        ((_Numba_hashtable_entry_t *)_Py_SLIST_HEAD(&(SLIST)))
-#define TABLE_HEAD(HT, BUCKET) \
-        ((_Numba_hashtable_entry_t *)_Py_SLIST_HEAD(&(HT)->buckets[BUCKET]))
-#define ENTRY_NEXT(ENTRY) \
-        ((_Numba_hashtable_entry_t *)_Py_SLIST_ITEM_NEXT(ENTRY))
-#define HASHTABLE_ITEM_SIZE(HT) \
-        (sizeof(_Numba_hashtable_entry_t) + (HT)->data_size)
+/* Slots are aligned for the data that follows the entry header */
+#define HASHTABLE_ALIGN 8
 
-/* Forward declaration */
-static void hashtable_rehash(_Numba_hashtable_t *ht);
+#define CTRL_EMPTY 0
+/* The tag of an occupied slot: the high bit set and the top 7 bits of the
+   hash, as the low bits already select the home slot */
+#define CTRL_TAG(HASH) \
+        ((unsigned char)(0x80 | ((HASH) >> (8 * sizeof(Py_uhash_t) - 7))))
 
-static void
-_Py_slist_init(_Py_slist_t *list)
-{
-    list->head = NULL;
-}
+#define TABLE_SLOT(HT, INDEX) \
+        ((_Numba_hashtable_entry_t *)((HT)->slots + (INDEX) * (HT)->entry_size))
 
-static void
-_Py_slist_prepend(_Py_slist_t *list, _Py_slist_item_t *item)
-{
-    item->next = list->head;
-    list->head = item;
-}
-
-static void
-_Py_slist_remove(_Py_slist_t *list, _Py_slist_item_t *previous,
-                 _Py_slist_item_t *item)
-{
-    if (previous != NULL)
-        previous->next = item->next;
-    else
-        list->head = item->next;
-}
+/* Forward declaration */
+static int hashtable_rehash(_Numba_hashtable_t *ht, size_t new_size);
 
 Py_uhash_t
 _Numba_hashtable_hash_int(const void *key)
@@ -116,7 +103,7 @@ _Numba_hashtable_compare_direct(const void *key, const _Numba_hashtable_entry_t
     return entry->key == key;
 }
 
-/* makes sure the real size of the buckets array is a power of 2 */
+/* makes sure the real size of the slots array is a power of 2 */
 static size_t
 round_size(size_t s)
 {
@@ -129,6 +116,26 @@ round_size(size_t s)
     return i;
 }
 
+/* Allocate the control bytes and slots of *ht* for *num_buckets* slots,
+   return -1 on memory error. */
+static int
+hashtable_alloc_slots(_Numba_hashtable_t *ht, size_t num_buckets,
+                      unsigned char **ctrl, char **slots)
+{
+    if (num_buckets > ((size_t)-1) / (ht->entry_size + 1))
+        return -1;
+    *ctrl = ht->alloc.malloc(num_buckets);
+    if (*ctrl == NULL)
+        return -1;
+    *slots = ht->alloc.malloc(num_buckets * ht->entry_size);
+    if (*slots == NULL) {
+        ht->alloc.free(*ctrl);
+        return -1;
+    }
+    memset(*ctrl, CTRL_EMPTY, num_buckets);
+    return 0;
+}
+
 _Numba_hashtable_t *
 _Numba_hashtable_new_full(size_t data_size, size_t init_size,
                        _Numba_hashtable_hash_func hash_func,
@@ -139,7 +146,6 @@ _Numba_hashtable_new_full(size_t data_size, size_t init_size,
                        _Numba_hashtable_allocator_t *allocator)
 {
     _Numba_hashtable_t *ht;
-    size_t buckets_size;
     _Numba_hashtable_allocator_t alloc;
 
     if (allocator == NULL) {
@@ -156,21 +162,20 @@ _Numba_hashtable_new_full(size_t data_size, size_t init_size,
     ht->num_buckets = round_size(init_size);
     ht->entries = 0;
     ht->data_size = data_size;
+    ht->entry_size = (sizeof(_Numba_hashtable_entry_t) + data_size
+                      + HASHTABLE_ALIGN - 1) & ~(size_t)(HASHTABLE_ALIGN - 1);
+    ht->alloc = alloc;
 
-    buckets_size = ht->num_buckets * sizeof(ht->buckets[0]);
-    ht->buckets = alloc.malloc(buckets_size);
-    if (ht->buckets == NULL) {
+    if (hashtable_alloc_slots(ht, ht->num_buckets, &ht->ctrl, &ht->slots)) {
         alloc.free(ht);
         return NULL;
     }
-    memset(ht->buckets, 0, buckets_size);
 
     ht->hash_func = hash_func;
     ht->compare_func = compare_func;
     ht->copy_data_func = copy_data_func;
     ht->free_data_func = free_data_func;
     ht->get_data_size_func = get_data_size_func;
-    ht->alloc = alloc;
     return ht;
 }
 
@@ -192,23 +197,18 @@ _Numba_hashtable_size(_Numba_hashtable_t *ht)
 
     size = sizeof(_Numba_hashtable_t);
 
-    /* buckets */
-    size += ht->num_buckets * sizeof(_Numba_hashtable_entry_t *);
-
-    /* entries */
-    size += ht->entries * HASHTABLE_ITEM_SIZE(ht);
+    /* control bytes and slots, the entries are stored inline */
+    size += ht->num_buckets * (1 + ht->entry_size);
 
     /* data linked from entries */
     if (ht->get_data_size_func) {
         for (hv = 0; hv < ht->num_buckets; hv++) {
-            _Numba_hashtable_entry_t *entry;
+            void *data;
 
-            for (entry = TABLE_HEAD(ht, hv); entry; entry = ENTRY_NEXT(entry)) {
-                void *data;
-
-                data = _Numba_HASHTABLE_ENTRY_DATA_AS_VOID_P(entry);
-                size += ht->get_data_size_func(data);
-            }
+            if (ht->ctrl[hv] == CTRL_EMPTY)
+                continue;
+            data = _Numba_HASHTABLE_ENTRY_DATA_AS_VOID_P(TABLE_SLOT(ht, hv));
+            size += ht->get_data_size_func(data);
         }
     }
     return size;
@@ -219,8 +219,8 @@ void
 _Numba_hashtable_print_stats(_Numba_hashtable_t *ht)
 {
     size_t size;
-    size_t chain_len, max_chain_len, total_chain_len, nchains;
-    _Numba_hashtable_entry_t *entry;
+    size_t probe_len, max_probe_len, total_probe_len;
+    size_t mask = ht->num_buckets - 1;
     size_t hv;
     double load;
 
@@ -228,81 +228,111 @@ _Numba_hashtable_print_stats(_Numba_hashtable_t *ht)
 
     load = (double)ht->entries / ht->num_buckets;
 
-    max_chain_len = 0;
-    total_chain_len = 0;
-    nchains = 0;
+    /* the distance of the entries from their home slot */
+    max_probe_len = 0;
+    total_probe_len = 0;
     for (hv = 0; hv < ht->num_buckets; hv++) {
-        entry = TABLE_HEAD(ht, hv);
-        if (entry != NULL) {
-            chain_len = 0;
-            for (; entry; entry = ENTRY_NEXT(entry)) {
-                chain_len++;
-            }
-            if (chain_len > max_chain_len)
-                max_chain_len = chain_len;
-            total_chain_len += chain_len;
-            nchains++;
-        }
+        if (ht->ctrl[hv] == CTRL_EMPTY)
+            continue;
+        probe_len = (hv - TABLE_SLOT(ht, hv)->key_hash) & mask;
+        if (probe_len > max_probe_len)
+            max_probe_len = probe_len;
+        total_probe_len += probe_len;
     }
     printf("hash table %p: entries=%"
            PY_FORMAT_SIZE_T "u/%" PY_FORMAT_SIZE_T "u (%.0f%%), ",
            ht, ht->entries, ht->num_buckets, load * 100.0);
-    if (nchains)
-        printf("avg_chain_len=%.1f, ", (double)total_chain_len / nchains);
-    printf("max_chain_len=%" PY_FORMAT_SIZE_T "u, %" PY_FORMAT_SIZE_T "u kB\n",
-           max_chain_len, size / 1024);
+    if (ht->entries)
+        printf("avg_probe_len=%.1f, ",
+               (double)total_probe_len / ht->entries);
+    printf("max_probe_len=%" PY_FORMAT_SIZE_T "u, %" PY_FORMAT_SIZE_T "u kB\n",
+           max_probe_len, size / 1024);
 }
 #endif
 
-/* Get an entry. Return NULL if the key does not exist. */
-_Numba_hashtable_entry_t *
-_Numba_hashtable_get_entry(_Numba_hashtable_t *ht, const void *key)
+/* Return the index of the slot holding *key*, or num_buckets if the key does
+   not exist.  The table always has an empty slot, which ends the probing. */
+static size_t
+hashtable_find(_Numba_hashtable_t *ht, const void *key, Py_uhash_t key_hash)
 {
-    Py_uhash_t key_hash;
-    size_t index;
-    _Numba_hashtable_entry_t *entry;
+    size_t mask = ht->num_buckets - 1;
+    size_t index = key_hash & mask;
+    unsigned char tag = CTRL_TAG(key_hash);
+    unsigned char ctrl;
+
+    while ((ctrl = ht->ctrl[index]) != CTRL_EMPTY) {
+        if (ctrl == tag) {
+            _Numba_hashtable_entry_t *entry = TABLE_SLOT(ht, index);
+            if (entry->key_hash == key_hash && ht->compare_func(key, entry))
+                return index;
+        }
+        index = (index + 1) & mask;
+    }
+    return ht->num_buckets;
+}
 
-    key_hash = ht->hash_func(key);
-    index = key_hash & (ht->num_buckets - 1);
+/* Store an entry, whose key must not be present, in the first free slot of
+   its probe sequence and return it.  The table must have a free slot. */
+static _Numba_hashtable_entry_t *
+hashtable_insert(_Numba_hashtable_t *ht, const void *key, Py_uhash_t key_hash)
+{
+    size_t mask = ht->num_buckets - 1;
+    size_t index = key_hash & mask;
+    _Numba_hashtable_entry_t *entry;
 
-    for (entry = TABLE_HEAD(ht, index); entry != NULL; entry = ENTRY_NEXT(entry)) {
-        if (entry->key_hash == key_hash && ht->compare_func(key, entry))
-            break;
-    }
+    while (ht->ctrl[index] != CTRL_EMPTY)
+        index = (index + 1) & mask;
 
+    ht->ctrl[index] = CTRL_TAG(key_hash);
+    entry = TABLE_SLOT(ht, index);
+    entry->key = key;
+    entry->key_hash = key_hash;
     return entry;
 }
 
+/* Get an entry. Return NULL if the key does not exist. */
+_Numba_hashtable_entry_t *
+_Numba_hashtable_get_entry(_Numba_hashtable_t *ht, const void *key)
+{
+    size_t index = hashtable_find(ht, key, ht->hash_func(key));
+
+    if (index == ht->num_buckets)
+        return NULL;
+    return TABLE_SLOT(ht, index);
+}
+
 static int
 _hashtable_pop_entry(_Numba_hashtable_t *ht, const void *key, void *data, size_t data_size)
 {
-    Py_uhash_t key_hash;
-    size_t index;
-    _Numba_hashtable_entry_t *entry, *previous;
-
-    key_hash = ht->hash_func(key);
-    index = key_hash & (ht->num_buckets - 1);
-
-    previous = NULL;
-    for (entry = TABLE_HEAD(ht, index); entry != NULL; entry = ENTRY_NEXT(entry)) {
-        if (entry->key_hash == key_hash && ht->compare_func(key, entry))
-            break;
-        previous = entry;
-    }
+    size_t mask = ht->num_buckets - 1;
+    size_t hole, index;
 
-    if (entry == NULL)
+    hole = hashtable_find(ht, key, ht->hash_func(key));
+    if (hole == ht->num_buckets)
         return 0;
 
-    _Py_slist_remove(&ht->buckets[index], (_Py_slist_item_t *)previous,
-                     (_Py_slist_item_t *)entry);
-    ht->entries--;
-
     if (data != NULL)
-        _Numba_HASHTABLE_ENTRY_READ_DATA(ht, data, data_size, entry);
-    ht->alloc.free(entry);
+        _Numba_HASHTABLE_ENTRY_READ_DATA(ht, data, data_size,
+                                         TABLE_SLOT(ht, hole));
+
+    /* Shift back the following entries of the cluster that the hole lies on
+       the probe sequence of, so that no lookup stops early at the hole. */
+    for (index = (hole + 1) & mask; ht->ctrl[index] != CTRL_EMPTY;
+         index = (index + 1) & mask) {
+        size_t home = TABLE_SLOT(ht, index)->key_hash & mask;
+        if (((index - home) & mask) >= ((index - hole) & mask)) {
+            ht->ctrl[hole] = ht->ctrl[index];
+            memcpy(TABLE_SLOT(ht, hole), TABLE_SLOT(ht, index),
+                   ht->entry_size);
+            hole = index;
+        }
+    }
+    ht->ctrl[hole] = CTRL_EMPTY;
+    ht->entries--;
 
     if ((float)ht->entries / (float)ht->num_buckets < HASHTABLE_LOW)
-        hashtable_rehash(ht);
+        (void)hashtable_rehash(ht, round_size(
+            (size_t)(ht->entries * HASHTABLE_REHASH_FACTOR)));
     return 1;
 }
 
@@ -312,8 +342,6 @@ int
 _Numba_hashtable_set(_Numba_hashtable_t *ht, const void *key,
                   void *data, size_t data_size)
 {
-    Py_uhash_t key_hash;
-    size_t index;
     _Numba_hashtable_entry_t *entry;
 
     assert(data != NULL || data_size == 0);
@@ -325,26 +353,22 @@ _Numba_hashtable_set(_Numba_hashtable_t *ht, const void *key,
     assert(entry == NULL);
 #endif
 
-    key_hash = ht->hash_func(key);
-    index = key_hash & (ht->num_buckets - 1);
-
-    entry = ht->alloc.malloc(HASHTABLE_ITEM_SIZE(ht));
-    if (entry == NULL) {
-        /* memory allocation failed */
-        return -1;
+    if ((float)(ht->entries + 1) / (float)ht->num_buckets > HASHTABLE_HIGH) {
+        /* growing may fail, the entry still fits as long as a slot is
+           left empty to end the probing */
+        if (hashtable_rehash(ht, round_size(
+                (size_t)((ht->entries + 1) * HASHTABLE_REHASH_FACTOR)))
+            && ht->entries + 1 >= ht->num_buckets) {
+            /* memory allocation failed */
+            return -1;
+        }
     }
 
-    entry->key = (void *)key;
-    entry->key_hash = key_hash;
+    entry = hashtable_insert(ht, key, ht->hash_func(key));
 
     assert(data_size == ht->data_size);
     memcpy(_Numba_HASHTABLE_ENTRY_DATA(entry), data, data_size);
-
-    _Py_slist_prepend(&ht->buckets[index], (_Py_slist_item_t*)entry);
     ht->entries++;
-
-    if ((float)ht->entries / (float)ht->num_buckets > HASHTABLE_HIGH)
-        hashtable_rehash(ht);
     return 0;
 }
 
@@ -386,18 +410,18 @@ _Numba_hashtable_delete(_Numba_hashtable_t *ht, const void *key)
 
 /* Prototype for a pointer to a function to be called foreach
    key/value pair in the hash by hashtable_foreach().  Iteration
-   stops if a non-zero value is returned. */
+   stops if a non-zero value is returned.  The function must not
+   modify the table. */
 int
 _Numba_hashtable_foreach(_Numba_hashtable_t *ht,
                       int (*func) (_Numba_hashtable_entry_t *entry, void *arg),
                       void *arg)
 {
-    _Numba_hashtable_entry_t *entry;
     size_t hv;
 
     for (hv = 0; hv < ht->num_buckets; hv++) {
-        for (entry = TABLE_HEAD(ht, hv); entry; entry = ENTRY_NEXT(entry)) {
-            int res = func(entry, arg);
+        if (ht->ctrl[hv] != CTRL_EMPTY) {
+            int res = func(TABLE_SLOT(ht, hv), arg);
             if (res)
                 return res;
         }
@@ -405,65 +429,63 @@ _Numba_hashtable_foreach(_Numba_hashtable_t *ht,
     return 0;
 }
 
-static void
-hashtable_rehash(_Numba_hashtable_t *ht)
+/* Move the entries to a table of *new_size* slots, return -1 and leave the
+   table unchanged on memory error. */
+static int
+hashtable_rehash(_Numba_hashtable_t *ht, size_t new_size)
 {
-    size_t buckets_size, new_size, bucket;
-    _Py_slist_t *old_buckets = NULL;
-    size_t old_num_buckets;
+    unsigned char *old_ctrl;
+    char *old_slots;
+    size_t old_num_buckets, hv;
 
-    new_size = round_size((size_t)(ht->entries * HASHTABLE_REHASH_FACTOR));
     if (new_size == ht->num_buckets)
-        return;
+        return 0;
+    assert(new_size > ht->entries);
 
+    old_ctrl = ht->ctrl;
+    old_slots = ht->slots;
     old_num_buckets = ht->num_buckets;
 
-    buckets_size = new_size * sizeof(ht->buckets[0]);
-    old_buckets = ht->buckets;
-    ht->buckets = ht->alloc.malloc(buckets_size);
-    if (ht->buckets == NULL) {
+    if (hashtable_alloc_slots(ht, new_size, &ht->ctrl, &ht->slots)) {
         /* cancel rehash on memory allocation failure */
-        ht->buckets = old_buckets ;
-        /* memory allocation failed */
-        return;
+        ht->ctrl = old_ctrl;
+        ht->slots = old_slots;
+        return -1;
     }
-    memset(ht->buckets, 0, buckets_size);
-
     ht->num_buckets = new_size;
 
-    for (bucket = 0; bucket < old_num_buckets; bucket++) {
-        _Numba_hashtable_entry_t *entry, *next;
-        for (entry = BUCKETS_HEAD(old_buckets[bucket]); entry != NULL; entry = next) {
-            size_t entry_index;
-
-            assert(ht->hash_func(entry->key) == entry->key_hash);
-            next = ENTRY_NEXT(entry);
-            entry_index = entry->key_hash & (new_size - 1);
+    for (hv = 0; hv < old_num_buckets; hv++) {
+        _Numba_hashtable_entry_t *entry, *new_entry;
 
-            _Py_slist_prepend(&ht->buckets[entry_index], (_Py_slist_item_t*)entry);
-        }
+        if (old_ctrl[hv] == CTRL_EMPTY)
+            continue;
+        entry = (_Numba_hashtable_entry_t *)(old_slots + hv * ht->entry_size);
+        assert(ht->hash_func(entry->key) == entry->key_hash);
+        new_entry = hashtable_insert(ht, entry->key, entry->key_hash);
+        memcpy(_Numba_HASHTABLE_ENTRY_DATA(new_entry),
+               _Numba_HASHTABLE_ENTRY_DATA(entry), ht->data_size);
     }
 
-    ht->alloc.free(old_buckets);
+    ht->alloc.free(old_ctrl);
+    ht->alloc.free(old_slots);
+    return 0;
 }
 
 void
 _Numba_hashtable_clear(_Numba_hashtable_t *ht)
 {
-    _Numba_hashtable_entry_t *entry, *next;
     size_t i;
 
-    for (i=0; i < ht->num_buckets; i++) {
-        for (entry = TABLE_HEAD(ht, i); entry != NULL; entry = next) {
-            next = ENTRY_NEXT(entry);
-            if (ht->free_data_func)
-                ht->free_data_func(_Numba_HASHTABLE_ENTRY_DATA_AS_VOID_P(entry));
-            ht->alloc.free(entry);
+    if (ht->free_data_func) {
+        for (i = 0; i < ht->num_buckets; i++) {
+            if (ht->ctrl[i] != CTRL_EMPTY)
+                ht->free_data_func(
+                    _Numba_HASHTABLE_ENTRY_DATA_AS_VOID_P(TABLE_SLOT(ht, i)));
         }
-        _Py_slist_init(&ht->buckets[i]);
     }
+    memset(ht->ctrl, CTRL_EMPTY, ht->num_buckets);
     ht->entries = 0;
-    hashtable_rehash(ht);
+    (void)hashtable_rehash(ht, HASHTABLE_MIN_SIZE);
 }
 
 void
@@ -471,18 +493,16 @@ _Numba_hashtable_destroy(_Numba_hashtable_t *ht)
 {
     size_t i;
 
-    for (i = 0; i < ht->num_buckets; i++) {
-        _Py_slist_item_t *entry = ht->buckets[i].head;
-        while (entry) {
-            _Py_slist_item_t *entry_next = entry->next;
-            if (ht->free_data_func)
-                ht->free_data_func(_Numba_HASHTABLE_ENTRY_DATA_AS_VOID_P(entry));
-            ht->alloc.free(entry);
-            entry = entry_next;
+    if (ht->free_data_func) {
+        for (i = 0; i < ht->num_buckets; i++) {
+            if (ht->ctrl[i] != CTRL_EMPTY)
+                ht->free_data_func(
+                    _Numba_HASHTABLE_ENTRY_DATA_AS_VOID_P(TABLE_SLOT(ht, i)));
         }
     }
 
-    ht->alloc.free(ht->buckets);
+    ht->alloc.free(ht->ctrl);
+    ht->alloc.free(ht->slots);
     ht->alloc.free(ht);
 }
 
@@ -492,7 +512,7 @@ _Numba_hashtable_copy(_Numba_hashtable_t *src)
 {
     _Numba_hashtable_t *dst;
     _Numba_hashtable_entry_t *entry;
-    size_t bucket;
+    size_t hv;
     int err;
     void *data, *new_data;
 
@@ -503,28 +523,204 @@ _Numba_hashtable_copy(_Numba_hashtable_t *src)
     if (dst == NULL)
         return NULL;
 
-    for (bucket=0; bucket < src->num_buckets; bucket++) {
-        entry = TABLE_HEAD(src, bucket);
-        for (; entry; entry = ENTRY_NEXT(entry)) {
-            if (src->copy_data_func) {
-                data = _Numba_HASHTABLE_ENTRY_DATA_AS_VOID_P(entry);
-                new_data = src->copy_data_func(data);
-                if (new_data != NULL)
-                    err = _Numba_hashtable_set(dst, entry->key,
-                                        &new_data, src->data_size);
-                else
-                    err = 1;
-            }
-            else {
-                data = _Numba_HASHTABLE_ENTRY_DATA(entry);
-                err = _Numba_hashtable_set(dst, entry->key, data, src->data_size);
-            }
-            if (err) {
-                _Numba_hashtable_destroy(dst);
-                return NULL;
-            }
+    if (src->copy_data_func == NULL) {
+        /* same layout, the slots can be copied as is */
+        memcpy(dst->ctrl, src->ctrl, src->num_buckets);
+        memcpy(dst->slots, src->slots, src->num_buckets * src->entry_size);
+        dst->entries = src->entries;
+        return dst;
+    }
+
+    for (hv = 0; hv < src->num_buckets; hv++) {
+        if (src->ctrl[hv] == CTRL_EMPTY)
+            continue;
+        entry = TABLE_SLOT(src, hv);
+        data = _Numba_HASHTABLE_ENTRY_DATA_AS_VOID_P(entry);
+        new_data = src->copy_data_func(data);
+        if (new_data != NULL)
+            err = _Numba_hashtable_set(dst, entry->key,
+                                &new_data, src->data_size);
+        else
+            err = 1;
+        if (err) {
+            _Numba_hashtable_destroy(dst);
+            return NULL;
         }
     }
     return dst;
 }
 
+/* Self test of the table, run from the test suite.  Return 0 on success, or
+   print the failing check and return 1. */
+
+#define CHECK(CASE) {                                                   \
+    if ( !(CASE) ) {                                                    \
+        printf("'%s' failed file %s:%d\n", #CASE, __FILE__, __LINE__);   \
+        goto fail;                                                      \
+    }                                                                   \
+}
+
+#define KEY(I) ((const void *)(size_t)(I))
+
+/* The number of occupied slots, which must equal the number of entries as
+   deletions don't leave tombstones behind. */
+static size_t
+hashtable_test_occupied(_Numba_hashtable_t *ht)
+{
+    size_t i, n = 0;
+    for (i = 0; i < ht->num_buckets; i++)
+        n += ht->ctrl[i] != CTRL_EMPTY;
+    return n;
+}
+
+static int
+hashtable_test_count(_Numba_hashtable_entry_t *entry, void *arg)
+{
+    (*(size_t *)arg)++;
+    return 0;
+}
+
+int
+_Numba_hashtable_test(void)
+{
+    _Numba_hashtable_t *ht, *copy = NULL;
+    int data, i;
+    size_t count;
+
+    /* identity hashes, so that the home slots are chosen by the keys */
+    ht = _Numba_hashtable_new(sizeof(int), _Numba_hashtable_hash_int,
+                              _Numba_hashtable_compare_direct);
+    if (ht == NULL)
+        return 1;
+    CHECK(_Numba_hashtable_size(ht) > 0);
+    CHECK(ht->num_buckets == HASHTABLE_MIN_SIZE);
+    CHECK(ht->entries == 0);
+
+    /* insert and lookup, with keys 1, 17 and 33 colliding in slot 1 and key
+       2 placed after them */
+    for (i = 0; i < 3; i++) {
+        data = 100 + i;
+        CHECK(_Numba_HASHTABLE_SET(ht, KEY(1 + 16 * i), data) == 0);
+    }
+    data = 200;
+    CHECK(_Numba_HASHTABLE_SET(ht, KEY(2), data) == 0);
+    CHECK(ht->entries == 4);
+    CHECK(TABLE_SLOT(ht, 1)->key == KEY(1));
+    CHECK(TABLE_SLOT(ht, 3)->key == KEY(33));
+    CHECK(TABLE_SLOT(ht, 4)->key == KEY(2));
+    for (i = 0; i < 3; i++) {
+        CHECK(_Numba_HASHTABLE_GET(ht, KEY(1 + 16 * i), data) == 1);
+        CHECK(data == 100 + i);
+    }
+    CHECK(_Numba_HASHTABLE_GET(ht, KEY(2), data) == 1);
+    CHECK(data == 200);
+    /* missing keys, one probing the whole cluster */
+    CHECK(_Numba_HASHTABLE_GET(ht, KEY(49), data) == 0);
+    CHECK(_Numba_HASHTABLE_GET(ht, KEY(3), data) == 0);
+    CHECK(_Numba_hashtable_get_entry(ht, KEY(0)) == NULL);
+
+    /* delete from the middle of the cluster, the following entries must be
+       shifted back rather than the slot being left as a tombstone */
+    _Numba_hashtable_delete(ht, KEY(17));
+    CHECK(ht->entries == 3);
+    CHECK(_Numba_hashtable_get_entry(ht, KEY(17)) == NULL);
+    CHECK(_Numba_HASHTABLE_GET(ht, KEY(33), data) == 1);
+    CHECK(data == 102);
+    CHECK(_Numba_HASHTABLE_GET(ht, KEY(2), data) == 1);
+    CHECK(data == 200);
+    CHECK(TABLE_SLOT(ht, 2)->key == KEY(33));
+    CHECK(TABLE_SLOT(ht, 3)->key == KEY(2));
+    CHECK(ht->ctrl[4] == CTRL_EMPTY);
+    CHECK(hashtable_test_occupied(ht) == ht->entries);
+
+    /* a cluster wrapping around the end of the slots */
+    for (i = 0; i < 3; i++) {
+        data = 300 + i;
+        CHECK(_Numba_HASHTABLE_SET(ht, KEY(15 + 16 * i), data) == 0);
+    }
+    CHECK(TABLE_SLOT(ht, 0)->key == KEY(31));
+    _Numba_hashtable_delete(ht, KEY(15));
+    CHECK(TABLE_SLOT(ht, 15)->key == KEY(31));
+    for (i = 1; i < 3; i++) {
+        CHECK(_Numba_HASHTABLE_GET(ht, KEY(15 + 16 * i), data) == 1);
+        CHECK(data == 300 + i);
+    }
+    CHECK(_Numba_HASHTABLE_GET(ht, KEY(1), data) == 1);
+    CHECK(_Numba_HASHTABLE_GET(ht, KEY(33), data) == 1);
+    CHECK(_Numba_HASHTABLE_GET(ht, KEY(2), data) == 1);
+    CHECK(hashtable_test_occupied(ht) == ht->entries);
+
+    /* the deleted key can be inserted again */
+    data = 400;
+    CHECK(_Numba_HASHTABLE_SET(ht, KEY(17), data) == 0);
+    CHECK(_Numba_HASHTABLE_GET(ht, KEY(17), data) == 1);
+    CHECK(data == 400);
+
+    /* pop */
+    data = 0;
+    CHECK(_Numba_hashtable_pop(ht, KEY(17), &data, sizeof(data)) == 1);
+    CHECK(data == 400);
+    CHECK(_Numba_hashtable_pop(ht, KEY(17), &data, sizeof(data)) == 0);
+    CHECK(ht->entries == 5);
+
+    /* growing keeps the table a power of 2 under the maximum load */
+    for (i = 1000; i < 3000; i++) {
+        data = -i;
+        CHECK(_Numba_HASHTABLE_SET(ht, KEY(i * 7), data) == 0);
+        CHECK((ht->num_buckets & (ht->num_buckets - 1)) == 0);
+        CHECK(ht->entries <= ht->num_buckets * HASHTABLE_HIGH);
+    }
+    CHECK(ht->entries == 2005);
+    CHECK(ht->num_buckets >= 4096);
+    for (i = 1000; i < 3000; i++) {
+        CHECK(_Numba_HASHTABLE_GET(ht, KEY(i * 7), data) == 1);
+        CHECK(data == -i);
+    }
+    CHECK(_Numba_HASHTABLE_GET(ht, KEY(33), data) == 1);
+    CHECK(data == 102);
+    count = 0;
+    CHECK(_Numba_hashtable_foreach(ht, hashtable_test_count, &count) == 0);
+    CHECK(count == ht->entries);
+
+    /* copy */
+    copy = _Numba_hashtable_copy(ht);
+    CHECK(copy != NULL);
+    CHECK(copy->entries == ht->entries);
+    CHECK(_Numba_HASHTABLE_GET(copy, KEY(2999 * 7), data) == 1);
+    CHECK(data == -2999);
+
+    /* shrinking as entries are deleted */
+    for (i = 1000; i < 2990; i++)
+        _Numba_hashtable_delete(ht, KEY(i * 7));
+    CHECK(ht->entries == 15);
+    CHECK(ht->num_buckets < 4096);
+    CHECK(hashtable_test_occupied(ht) == ht->entries);
+    for (i = 2990; i < 3000; i++) {
+        CHECK(_Numba_HASHTABLE_GET(ht, KEY(i * 7), data) == 1);
+        CHECK(data == -i);
+    }
+    CHECK(_Numba_HASHTABLE_GET(ht, KEY(1000 * 7), data) == 0);
+    /* the copy is independent */
+    CHECK(_Numba_HASHTABLE_GET(copy, KEY(1000 * 7), data) == 1);
+    CHECK(data == -1000);
+
+    /* clear */
+    _Numba_hashtable_clear(ht);
+    CHECK(ht->entries == 0);
+    CHECK(ht->num_buckets == HASHTABLE_MIN_SIZE);
+    CHECK(hashtable_test_occupied(ht) == 0);
+    CHECK(_Numba_HASHTABLE_GET(ht, KEY(2), data) == 0);
+
+    _Numba_hashtable_destroy(copy);
+    _Numba_hashtable_destroy(ht);
+    return 0;
+
+fail:
+    if (copy != NULL)
+        _Numba_hashtable_destroy(copy);
+    _Numba_hashtable_destroy(ht);
+    return 1;
+}
+
+#undef CHECK
+#undef KEY
@@ -8,22 +8,7 @@
 /* The whole API is private */
 #ifndef Py_LIMITED_API
 
-typedef struct _Py_slist_item_s {
-    struct _Py_slist_item_s *next;
-} _Py_slist_item_t;
-
 typedef struct {
-    _Py_slist_item_t *head;
-} _Py_slist_t;
-
-#define _Py_SLIST_ITEM_NEXT(ITEM) (((_Py_slist_item_t *)ITEM)->next)
-
-#define _Py_SLIST_HEAD(SLIST) (((_Py_slist_t *)SLIST)->head)
-
-typedef struct {
-    /* used by _Numba_hashtable_t.buckets to link entries */
-    _Py_slist_item_t _Py_slist_item;
-
     const void *key;
     Py_uhash_t key_hash;
 
@@ -56,10 +41,15 @@ typedef struct {
     void (*free) (void *ptr);
 } _Numba_hashtable_allocator_t;
 
+/* An open addressing table with linear probing. The entries, with their data,
+   are stored inline in `slots` and a 7-bit tag of their hash in `ctrl`,
+   such that most mismatches are rejected from `ctrl` alone. */
 typedef struct {
-    size_t num_buckets;
+    size_t num_buckets; /* Number of slots, a power of 2. */
     size_t entries; /* Total number of entries in the table. */
-    _Py_slist_t *buckets;
+    unsigned char *ctrl; /* num_buckets control bytes, 0 for an empty slot */
+    char *slots; /* num_buckets slots of entry_size bytes */
+    size_t entry_size;
     size_t data_size;
 
     _Numba_hashtable_hash_func hash_func;
@@ -99,6 +89,7 @@ PyAPI_FUNC(int) _Numba_hashtable_foreach(
     _Numba_hashtable_foreach_func func, void *arg);
 PyAPI_FUNC(size_t) _Numba_hashtable_size(_Numba_hashtable_t *ht);
 
+/* The entry returned is only valid until the table is next modified */
 PyAPI_FUNC(_Numba_hashtable_entry_t*) _Numba_hashtable_get_entry(
     _Numba_hashtable_t *ht,
     const void *key);
@@ -121,6 +112,9 @@ PyAPI_FUNC(void) _Numba_hashtable_delete(
     _Numba_hashtable_t *ht,
     const void *key);
 
+/* Self test of the table, returns 0 on success */
+PyAPI_FUNC(int) _Numba_hashtable_test(void);
+
 #define _Numba_HASHTABLE_SET(TABLE, KEY, DATA) \
     _Numba_hashtable_set(TABLE, KEY, &(DATA), sizeof(DATA))
 
@@ -977,10 +977,104 @@ numba_do_raise(PyObject *exc_packed)
     return status;
 }
 
+/*
+ * Native cache of the objects returned by numba_unpickle(), keyed by the
+ * address of the pickled data and its SHA1 hash, so that the constants
+ * unpickled over and over again (e.g. the payloads of the exceptions raised
+ * in a loop) cost a lookup and an incref instead of a call to Python.
+ * The cached objects are kept alive forever, as by the memo of
+ * numba.core.serialize._numba_unpickle().  The GIL is held by all callers.
+ */
+
+/* SHA1 produces 160 bit or 20 bytes */
+#define UNPICKLE_HASH_SIZE 20
+#define UNPICKLE_CACHE_MINSIZE 64
+
+typedef struct {
+    const char *data;
+    char hashed[UNPICKLE_HASH_SIZE];
+    PyObject *obj;
+} unpickle_entry_t;
+
+static unpickle_entry_t *unpickle_cache = NULL;
+static size_t unpickle_cache_size = 0;   /* a power of 2 */
+static size_t unpickle_cache_used = 0;
+
+static size_t
+unpickle_cache_hash(const char *data, const char *hashed)
+{
+    size_t h;
+    /* The SHA1 bytes are well mixed already */
+    memcpy(&h, hashed, sizeof(h));
+    return h ^ ((size_t) data >> 4);
+}
+
+/* Return the slot of the key, or the empty slot where it would be inserted */
+static unpickle_entry_t *
+unpickle_cache_slot(unpickle_entry_t *table, size_t size,
+                    const char *data, const char *hashed)
+{
+    size_t mask = size - 1;
+    size_t i = unpickle_cache_hash(data, hashed) & mask;
+    while (table[i].obj != NULL) {
+        if (table[i].data == data
+            && memcmp(table[i].hashed, hashed, UNPICKLE_HASH_SIZE) == 0)
+            break;
+        i = (i + 1) & mask;
+    }
+    return &table[i];
+}
+
+/* Return a borrowed reference to the cached object, or NULL */
+static PyObject *
+unpickle_cache_lookup(const char *data, const char *hashed)
+{
+    if (unpickle_cache == NULL)
+        return NULL;
+    return unpickle_cache_slot(unpickle_cache, unpickle_cache_size,
+                               data, hashed)->obj;
+}
+
+/* Cache a new reference to obj.  Failing to grow the table only disables
+ * the caching of the object, no error is raised. */
+static void
+unpickle_cache_insert(const char *data, const char *hashed, PyObject *obj)
+{
+    unpickle_entry_t *entry;
+
+    if (4 * (unpickle_cache_used + 1) > 3 * unpickle_cache_size) {
+        size_t i, newsize;
+        unpickle_entry_t *newtable;
+
+        newsize = unpickle_cache_size ?
+                  2 * unpickle_cache_size : UNPICKLE_CACHE_MINSIZE;
+        newtable = (unpickle_entry_t *) PyMem_RawCalloc(
+                        newsize, sizeof(unpickle_entry_t));
+        if (newtable == NULL)
+            return;
+        for (i = 0; i < unpickle_cache_size; i++) {
+            unpickle_entry_t *old = &unpickle_cache[i];
+            if (old->obj != NULL)
+                *unpickle_cache_slot(newtable, newsize,
+                                     old->data, old->hashed) = *old;
+        }
+        PyMem_RawFree(unpickle_cache);
+        unpickle_cache = newtable;
+        unpickle_cache_size = newsize;
+    }
+    entry = unpickle_cache_slot(unpickle_cache, unpickle_cache_size,
+                                data, hashed);
+    entry->data = data;
+    memcpy(entry->hashed, hashed, UNPICKLE_HASH_SIZE);
+    Py_INCREF(obj);
+    entry->obj = obj;
+    unpickle_cache_used++;
+}
+
 #ifdef PYCC_COMPILING
 /* AOT avoid the use of `numba.core.serialize` */
-NUMBA_EXPORT_FUNC(PyObject *)
-numba_unpickle(const char *data, int n, const char *hashed)
+static PyObject *
+unpickle_uncached(const char *data, int n, const char *hashed)
 {
     PyObject *buf, *obj;
     static PyObject *loads;
@@ -1007,8 +1101,8 @@ numba_unpickle(const char *data, int n, const char *hashed)
 
 #else
 
-NUMBA_EXPORT_FUNC(PyObject *)
-numba_unpickle(const char *data, int n, const char *hashed)
+static PyObject *
+unpickle_uncached(const char *data, int n, const char *hashed)
 {
     PyObject *buf=NULL, *obj=NULL, *addr=NULL, *hashedbuf=NULL;
     static PyObject *loads=NULL;
@@ -1028,8 +1122,7 @@ numba_unpickle(const char *data, int n, const char *hashed)
     buf = PyBytes_FromStringAndSize(data, n);
     if (buf == NULL)
         return NULL;
-    /* SHA1 produces 160 bit or 20 bytes */
-    hashedbuf = PyBytes_FromStringAndSize(hashed, 20);
+    hashedbuf = PyBytes_FromStringAndSize(hashed, UNPICKLE_HASH_SIZE);
     if (hashedbuf == NULL)
         goto error;
     addr = PyLong_FromVoidPtr((void*)data);
@@ -1044,6 +1137,22 @@ error:
 }
 #endif
 
+NUMBA_EXPORT_FUNC(PyObject *)
+numba_unpickle(const char *data, int n, const char *hashed)
+{
+    PyObject *obj;
+
+    obj = unpickle_cache_lookup(data, hashed);
+    if (obj != NULL) {
+        Py_INCREF(obj);
+        return obj;
+    }
+    obj = unpickle_uncached(data, n, hashed);
+    if (obj != NULL)
+        unpickle_cache_insert(data, hashed, obj);
+    return obj;
+}
+
 /*
  * Unicode helpers
  */
@@ -1151,6 +1260,82 @@ numba_get_PyUnicode_ExtendedCase(int code)
 /* from _unicodetype_db.h */
 #undef SHIFT
 
+/*
+ * Bulk routines over the buffer of an ASCII string (1 byte per character),
+ * for use by the string methods when the ASCII flag extracted by
+ * numba_extract_unicode() is set.  For these strings the case and class of
+ * a character only depend on its range, so no table lookup is needed.
+ */
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NUMBA_ASCII_SSE2
+#endif
+
+/* Flip the case of the letters in [first, first + 26) */
+static void
+ascii_flip_case(const unsigned char *src, unsigned char *dst, Py_ssize_t n,
+                unsigned char first)
+{
+    Py_ssize_t i = 0;
+#ifdef NUMBA_ASCII_SSE2
+    const __m128i below = _mm_set1_epi8((char) (first - 1));
+    const __m128i above = _mm_set1_epi8((char) (first + 26));
+    const __m128i bit = _mm_set1_epi8(0x20);
+    /* ASCII bytes are non-negative, so the signed comparisons hold */
+    for (; i + 16 <= n; i += 16) {
+        __m128i c = _mm_loadu_si128((const __m128i *) (src + i));
+        __m128i in = _mm_and_si128(_mm_cmpgt_epi8(c, below),
+                                   _mm_cmplt_epi8(c, above));
+        _mm_storeu_si128((__m128i *) (dst + i),
+                         _mm_xor_si128(c, _mm_and_si128(in, bit)));
+    }
+#endif
+    for (; i < n; i++) {
+        unsigned char c = src[i];
+        dst[i] = c ^ ((unsigned char) (c - first) < 26 ? 0x20 : 0);
+    }
+}
+
+NUMBA_EXPORT_FUNC(void)
+numba_ascii_upper(const unsigned char *src, unsigned char *dst, Py_ssize_t n)
+{
+    ascii_flip_case(src, dst, n, 'a');
+}
+
+NUMBA_EXPORT_FUNC(void)
+numba_ascii_lower(const unsigned char *src, unsigned char *dst, Py_ssize_t n)
+{
+    ascii_flip_case(src, dst, n, 'A');
+}
+
+/* Whether all the n characters are letters */
+NUMBA_EXPORT_FUNC(int)
+numba_ascii_isalpha(const unsigned char *src, Py_ssize_t n)
+{
+    Py_ssize_t i = 0;
+#ifdef NUMBA_ASCII_SSE2
+    const __m128i below = _mm_set1_epi8('a' - 1);
+    const __m128i above = _mm_set1_epi8('z' + 1);
+    const __m128i bit = _mm_set1_epi8(0x20);
+    for (; i + 16 <= n; i += 16) {
+        /* fold the upper case letters onto the lower case ones */
+        __m128i c = _mm_or_si128(
+            _mm_loadu_si128((const __m128i *) (src + i)), bit);
+        __m128i in = _mm_and_si128(_mm_cmpgt_epi8(c, below),
+                                   _mm_cmplt_epi8(c, above));
+        if (_mm_movemask_epi8(in) != 0xffff)
+            return 0;
+    }
+#endif
+    for (; i < n; i++) {
+        if ((unsigned char) ((src[i] | 0x20) - 'a') >= 26)
+            return 0;
+    }
+    return 1;
+}
+
 /*
  * defined break point for gdb
  */
@@ -1173,6 +1358,12 @@ numba_gdb_breakpoint(void) {
 #undef MATH_UNARY
 #undef MATH_BINARY
 
+/*
+ * Vector-width variants of the math functions
+ */
+
+#include "_vectormath.c"
+
 /*
  * BLAS and LAPACK wrappers
  */
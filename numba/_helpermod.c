@@ -99,6 +99,9 @@ build_c_helpers_dict(void)
     /* BLAS / LAPACK */
     declmethod(xxgemm);
     declmethod(xxgemv);
+    declmethod(xxgemm_batched);
+    declmethod(xxgemv_batched);
+    declmethod(lapack_release_workspace);
     declmethod(xxdot);
     declmethod(xxgetrf);
     declmethod(ez_xxgetri);
@@ -120,11 +123,18 @@ build_c_helpers_dict(void)
     declmethod(rnd_shuffle);
     declmethod(rnd_init);
     declmethod(poisson_ptrs);
+    declmethod(rnd_fill_int32);
+    declmethod(rnd_fill_double);
+    declmethod(rnd_fill_gauss);
+    declmethod(rnd_fill_randint64);
 
     /* Unicode string support */
     declmethod(extract_unicode);
     declmethod(gettyperecord);
     declmethod(get_PyUnicode_ExtendedCase);
+    declmethod(ascii_upper);
+    declmethod(ascii_lower);
+    declmethod(ascii_isalpha);
 
     /* for gdb breakpoint */
     declmethod(gdb_breakpoint);
@@ -132,18 +142,41 @@ build_c_helpers_dict(void)
     /* for dictionary support */
     declmethod(test_dict);
     declmethod(dict_new_minsize);
+    declmethod(dict_new_sized);
+    declmethod(dict_reserve);
+    declmethod(dict_compact);
+    declmethod(dict_new_layout);
+    declmethod(dict_set_default_layout);
+    declmethod(dict_layout);
     declmethod(dict_set_method_table);
     declmethod(dict_free);
     declmethod(dict_length);
     declmethod(dict_lookup);
     declmethod(dict_insert);
     declmethod(dict_insert_ez);
+    declmethod(dict_insert_many);
+    declmethod(dict_lookup_many);
     declmethod(dict_delitem);
     declmethod(dict_popitem);
     declmethod(dict_iter_sizeof);
     declmethod(dict_iter);
     declmethod(dict_iter_next);
     declmethod(dict_dump);
+    declmethod(dict_update);
+    declmethod(dict_merge);
+    declmethod(dict_update_add_int64);
+    declmethod(dict_update_add_float64);
+    declmethod(cdict_new);
+    declmethod(cdict_free);
+    declmethod(cdict_set_method_table);
+    declmethod(cdict_length);
+    declmethod(cdict_nshards);
+    declmethod(cdict_shard);
+    declmethod(cdict_shard_of);
+    declmethod(cdict_lookup);
+    declmethod(cdict_insert);
+    declmethod(cdict_update);
+    declmethod(cdict_merge_shard);
 
     /* for list support */
     declmethod(test_list);
@@ -159,6 +192,10 @@ build_c_helpers_dict(void)
     declmethod(list_setitem);
     declmethod(list_getitem);
     declmethod(list_append);
+    declmethod(list_reserve);
+    declmethod(list_extend);
+    declmethod(list_extend_list);
+    declmethod(list_assign_slice);
     declmethod(list_delitem);
     declmethod(list_delete_slice);
     declmethod(list_iter_sizeof);
@@ -171,6 +208,14 @@ build_c_helpers_dict(void)
 #undef MATH_UNARY
 #undef MATH_BINARY
 
+#ifdef NUMBA_HAVE_VECTOR_MATH
+#define VECTOR_MATH_UNARY(F, FF) \
+    declmethod(F##_v4); declmethod(F##_v8); \
+    declmethod(FF##_v8); declmethod(FF##_v16);
+    #include "vectormathnames.h"
+#undef VECTOR_MATH_UNARY
+#endif
+
 #undef declmethod
     return dct;
 error:
@@ -228,6 +273,9 @@ static PyMethodDef ext_methods[] = {
     { "rnd_seed", (PyCFunction) _numba_rnd_seed, METH_VARARGS, NULL },
     { "rnd_set_state", (PyCFunction) _numba_rnd_set_state, METH_VARARGS, NULL },
     { "rnd_shuffle", (PyCFunction) _numba_rnd_shuffle, METH_O, NULL },
+    { "lapack_release_workspace", (PyCFunction) _numba_lapack_release_workspace, METH_NOARGS, NULL },
+    { "lapack_workspace_size", (PyCFunction) _numba_lapack_workspace_size, METH_NOARGS, NULL },
+    { "lapack_workspace_total_size", (PyCFunction) _numba_lapack_workspace_total_size, METH_NOARGS, NULL },
     { "_import_cython_function", (PyCFunction) _numba_import_cython_function, METH_VARARGS, NULL },
     { NULL },
 };
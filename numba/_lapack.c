@@ -99,6 +99,237 @@ static int checked_PyMem_RawMalloc(void** var, size_t bytes)
     return 0;
 }
 
+/*
+ * Per-thread cache of the work arrays of the LAPACK wrappers.
+ *
+ * Each buffer of each wrapper has a slot holding the largest array it was
+ * given so far, which is reused by the following calls from the same
+ * thread instead of being allocated and freed around every LAPACK call.
+ * The sizes are in bytes so that the kinds of a routine share its slots.
+ * Arrays larger than WORKSPACE_MAX_CACHED are not kept, their allocation
+ * cost being small relative to the computation.  The cached arrays of the
+ * calling thread are released by numba_lapack_release_workspace(), and
+ * those of every thread when it exits by a destructor registered with the
+ * first array the thread caches: a pthread key destructor on POSIX and a
+ * fiber local storage callback, which Windows runs at thread exit.
+ */
+
+#ifdef _MSC_VER
+#include <windows.h>
+#define THREAD_LOCAL(ty) __declspec(thread) ty
+#define WS_FETCH_ADD(ptr, val) \
+    InterlockedExchangeAdd64((volatile LONG64 *)(ptr), (LONG64)(val))
+#define WS_LOAD(ptr) InterlockedOr64((volatile LONG64 *)(ptr), 0)
+#else
+#include <pthread.h>
+/* Non-standard C99 extension that's understood by gcc and clang */
+#define THREAD_LOCAL(ty) __thread ty
+#define WS_FETCH_ADD(ptr, val) __atomic_fetch_add((ptr), (val), __ATOMIC_RELAXED)
+#define WS_LOAD(ptr) __atomic_load_n((ptr), __ATOMIC_RELAXED)
+#endif
+
+#define WORKSPACE_MAX_CACHED (1 << 20)
+
+typedef enum {
+    WS_XXGETRI_WORK,
+    WS_RGEEV_WORK,
+    WS_CGEEV_WORK,
+    WS_CGEEV_RWORK,
+    WS_RSYEVD_WORK,
+    WS_RSYEVD_IWORK,
+    WS_CHEEVD_WORK,
+    WS_CHEEVD_RWORK,
+    WS_CHEEVD_IWORK,
+    WS_RGESDD_WORK,
+    WS_RGESDD_IWORK,
+    WS_CGESDD_WORK,
+    WS_CGESDD_RWORK,
+    WS_CGESDD_IWORK,
+    WS_GEQRF_WORK,
+    WS_XXGQR_WORK,
+    WS_RGELSD_WORK,
+    WS_RGELSD_IWORK,
+    WS_CGELSD_WORK,
+    WS_CGELSD_RWORK,
+    WS_CGELSD_IWORK,
+    WS_COUNT
+} workspace_slot;
+
+typedef struct {
+    void *data;
+    size_t size;
+} workspace_t;
+
+static THREAD_LOCAL(workspace_t) lapack_workspaces[WS_COUNT];
+static THREAD_LOCAL(int) lapack_workspaces_registered;
+
+/* The size in bytes of the arrays cached by all the threads */
+static long long lapack_workspaces_total;
+
+/*
+ * Free the cached arrays *ws* of a thread.
+ */
+static void free_workspaces(workspace_t *ws)
+{
+    int i;
+    for (i = 0; i < WS_COUNT; i++)
+    {
+        PyMem_RawFree(ws[i].data);
+        WS_FETCH_ADD(&lapack_workspaces_total, -(long long)ws[i].size);
+        ws[i].data = NULL;
+        ws[i].size = 0;
+    }
+}
+
+#ifdef _MSC_VER
+
+static INIT_ONCE workspace_key_once = INIT_ONCE_STATIC_INIT;
+static DWORD workspace_key = FLS_OUT_OF_INDEXES;
+
+static void NTAPI workspace_thread_exit(void *ws)
+{
+    if (ws)
+        free_workspaces((workspace_t *)ws);
+}
+
+static BOOL CALLBACK workspace_key_init(PINIT_ONCE once, void *param,
+                                        void **context)
+{
+    workspace_key = FlsAlloc(workspace_thread_exit);
+    return TRUE;
+}
+
+/*
+ * Arrange for the calling thread's cache to be freed when it exits.
+ */
+static void register_workspaces(void)
+{
+    InitOnceExecuteOnce(&workspace_key_once, workspace_key_init, NULL, NULL);
+    if (workspace_key != FLS_OUT_OF_INDEXES)
+        FlsSetValue(workspace_key, lapack_workspaces);
+}
+
+#else
+
+static pthread_once_t workspace_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t workspace_key;
+static int workspace_key_created;
+
+static void workspace_thread_exit(void *ws)
+{
+    free_workspaces((workspace_t *)ws);
+}
+
+static void workspace_key_init(void)
+{
+    workspace_key_created =
+        pthread_key_create(&workspace_key, workspace_thread_exit) == 0;
+}
+
+/*
+ * Arrange for the calling thread's cache to be freed when it exits.
+ */
+static void register_workspaces(void)
+{
+    pthread_once(&workspace_key_once, workspace_key_init);
+    if (workspace_key_created)
+        pthread_setspecific(workspace_key, lapack_workspaces);
+}
+
+#endif
+
+/*
+ * As checked_PyMem_RawMalloc() but takes the array from the given slot of
+ * the calling thread's cache, growing it if needed.  The array must be
+ * given back with release_workspace().
+ * Returns zero on success for status checking.
+ */
+static int checked_workspace(workspace_slot slot, void** var, size_t bytes)
+{
+    workspace_t *ws = &lapack_workspaces[slot];
+    if (bytes == 0)
+        bytes = 1;
+    if (bytes <= ws->size)
+    {
+        *var = ws->data;
+        return 0;
+    }
+    if (bytes > WORKSPACE_MAX_CACHED)
+        return checked_PyMem_RawMalloc(var, bytes);
+    if (checked_PyMem_RawMalloc(var, bytes))
+        return 1;
+    if (!lapack_workspaces_registered)
+    {
+        register_workspaces();
+        lapack_workspaces_registered = 1;
+    }
+    PyMem_RawFree(ws->data);
+    WS_FETCH_ADD(&lapack_workspaces_total, (long long)(bytes - ws->size));
+    ws->data = *var;
+    ws->size = bytes;
+    return 0;
+}
+
+/*
+ * Give back an array obtained from checked_workspace(), it is only freed
+ * if it is not cached.
+ */
+static void release_workspace(workspace_slot slot, void *data)
+{
+    if (data != lapack_workspaces[slot].data)
+        PyMem_RawFree(data);
+}
+
+/*
+ * Free the work arrays cached for the calling thread.
+ */
+NUMBA_EXPORT_FUNC(void)
+numba_lapack_release_workspace(void)
+{
+    free_workspaces(lapack_workspaces);
+}
+
+/*
+ * The size in bytes of the work arrays cached for the calling thread.
+ */
+NUMBA_EXPORT_FUNC(size_t)
+numba_lapack_workspace_size(void)
+{
+    size_t total = 0;
+    int i;
+    for (i = 0; i < WS_COUNT; i++)
+        total += lapack_workspaces[i].size;
+    return total;
+}
+
+/*
+ * The size in bytes of the work arrays cached for all the threads.
+ */
+NUMBA_EXPORT_FUNC(size_t)
+numba_lapack_workspace_total_size(void)
+{
+    return (size_t)WS_LOAD(&lapack_workspaces_total);
+}
+
+NUMBA_EXPORT_FUNC(PyObject *)
+_numba_lapack_release_workspace(PyObject *self)
+{
+    numba_lapack_release_workspace();
+    Py_RETURN_NONE;
+}
+
+NUMBA_EXPORT_FUNC(PyObject *)
+_numba_lapack_workspace_size(PyObject *self)
+{
+    return PyLong_FromSize_t(numba_lapack_workspace_size());
+}
+
+NUMBA_EXPORT_FUNC(PyObject *)
+_numba_lapack_workspace_total_size(PyObject *self)
+{
+    return PyLong_FromSize_t(numba_lapack_workspace_total_size());
+}
+
 /*
  * Checks that the char kind is valid (one of [s,d,c,z]) for use in blas/lapack.
  * Returns zero on success for status checking.
@@ -402,6 +633,249 @@ numba_xxgemm(char kind, char transa, char transb,
 }
 
 
+/*
+ * Batched matrix products over stacks of matrices held at a constant stride
+ * (in elements, 0 to reuse the same operand for every product) from each
+ * other.  The kind and the BLAS function are checked once for the whole
+ * batch.  None of the BLAS libraries available through SciPy exports a
+ * batched routine, so small real products are computed by an in-house
+ * kernel, saving the per call overhead of BLAS which dominates for such
+ * sizes, and larger or complex ones by a loop of BLAS calls.
+ */
+
+/* Largest dimension handled by the small matrix kernels */
+#define SMALL_MATRIX_MAX 32
+
+/* Column-major c = alpha * a * b + beta * c, with m, n, k at most
+ * SMALL_MATRIX_MAX.  As in BLAS, c is not read if beta is zero. */
+#define EMIT_SMALL_GEMM(T)                                                  \
+static void                                                                 \
+small_gemm_##T(Py_ssize_t m, Py_ssize_t n, Py_ssize_t k, T alpha,           \
+               const T *a, Py_ssize_t lda, const T *b, Py_ssize_t ldb,      \
+               T beta, T *c, Py_ssize_t ldc)                                \
+{                                                                           \
+    T acc[SMALL_MATRIX_MAX];                                                \
+    Py_ssize_t i, j, p;                                                     \
+    for (j = 0; j < n; j++) {                                               \
+        for (i = 0; i < m; i++)                                             \
+            acc[i] = 0;                                                     \
+        for (p = 0; p < k; p++) {                                           \
+            const T *ap = a + p * lda;                                      \
+            T bpj = b[p + j * ldb];                                         \
+            for (i = 0; i < m; i++)                                         \
+                acc[i] += ap[i] * bpj;                                      \
+        }                                                                   \
+        if (beta == 0) {                                                    \
+            for (i = 0; i < m; i++)                                         \
+                c[i + j * ldc] = alpha * acc[i];                            \
+        }                                                                   \
+        else {                                                              \
+            for (i = 0; i < m; i++)                                         \
+                c[i + j * ldc] = alpha * acc[i] + beta * c[i + j * ldc];    \
+        }                                                                   \
+    }                                                                       \
+}
+
+/* Column-major y = alpha * op(a) * x + beta * y, a being m x n with m and n
+ * at most SMALL_MATRIX_MAX.  As in BLAS, y is not read if beta is zero. */
+#define EMIT_SMALL_GEMV(T)                                                  \
+static void                                                                 \
+small_gemv_##T(int trans, Py_ssize_t m, Py_ssize_t n, T alpha,              \
+               const T *a, Py_ssize_t lda, const T *x, T beta, T *y)        \
+{                                                                           \
+    T acc[SMALL_MATRIX_MAX];                                                \
+    Py_ssize_t i, j, leny = trans ? n : m;                                  \
+    if (trans) {                                                            \
+        for (j = 0; j < n; j++) {                                           \
+            T s = 0;                                                        \
+            for (i = 0; i < m; i++)                                         \
+                s += a[i + j * lda] * x[i];                                 \
+            acc[j] = s;                                                     \
+        }                                                                   \
+    }                                                                       \
+    else {                                                                  \
+        for (i = 0; i < m; i++)                                             \
+            acc[i] = 0;                                                     \
+        for (j = 0; j < n; j++) {                                           \
+            T xj = x[j];                                                    \
+            for (i = 0; i < m; i++)                                         \
+                acc[i] += a[i + j * lda] * xj;                              \
+        }                                                                   \
+    }                                                                       \
+    for (i = 0; i < leny; i++)                                              \
+        y[i] = (beta == 0) ? alpha * acc[i] : alpha * acc[i] + beta * y[i]; \
+}
+
+EMIT_SMALL_GEMM(float)
+EMIT_SMALL_GEMM(double)
+EMIT_SMALL_GEMV(float)
+EMIT_SMALL_GEMV(double)
+
+#undef EMIT_SMALL_GEMM
+#undef EMIT_SMALL_GEMV
+
+/* Defined with the LAPACK helpers below */
+static size_t kind_size(char kind);
+
+/* Batched matrix * matrix: c[i] = alpha * a[i] * b[i] + beta * c[i]
+ * for i in [0, batch), with a[i] = a + i * stride_a and so on. */
+NUMBA_EXPORT_FUNC(int)
+numba_xxgemm_batched(char kind, char transa, char transb,
+                     Py_ssize_t m, Py_ssize_t n, Py_ssize_t k,
+                     void *alpha, void *a, Py_ssize_t lda,
+                     Py_ssize_t stride_a,
+                     void *b, Py_ssize_t ldb, Py_ssize_t stride_b,
+                     void *beta, void *c, Py_ssize_t ldc,
+                     Py_ssize_t stride_c, Py_ssize_t batch)
+{
+    void *raw_func = NULL;
+    F_INT _m, _n, _k;
+    F_INT _lda, _ldb, _ldc;
+    size_t itemsize;
+    Py_ssize_t i;
+
+    ENSURE_VALID_KIND(kind)
+
+    if ((kind == 's' || kind == 'd')
+        && (transa == 'N' || transa == 'n')
+        && (transb == 'N' || transb == 'n')
+        && m <= SMALL_MATRIX_MAX && n <= SMALL_MATRIX_MAX
+        && k <= SMALL_MATRIX_MAX)
+    {
+        if (kind == 's')
+        {
+            float *_a = (float *) a, *_b = (float *) b, *_c = (float *) c;
+            float _alpha = *(float *) alpha, _beta = *(float *) beta;
+            for (i = 0; i < batch; i++)
+                small_gemm_float(m, n, k, _alpha, _a + i * stride_a, lda,
+                                 _b + i * stride_b, ldb, _beta,
+                                 _c + i * stride_c, ldc);
+        }
+        else
+        {
+            double *_a = (double *) a, *_b = (double *) b, *_c = (double *) c;
+            double _alpha = *(double *) alpha, _beta = *(double *) beta;
+            for (i = 0; i < batch; i++)
+                small_gemm_double(m, n, k, _alpha, _a + i * stride_a, lda,
+                                  _b + i * stride_b, ldb, _beta,
+                                  _c + i * stride_c, ldc);
+        }
+        return 0;
+    }
+
+    switch (kind)
+    {
+        case 's':
+            raw_func = get_cblas_sgemm();
+            break;
+        case 'd':
+            raw_func = get_cblas_dgemm();
+            break;
+        case 'c':
+            raw_func = get_cblas_cgemm();
+            break;
+        case 'z':
+            raw_func = get_cblas_zgemm();
+            break;
+    }
+    ENSURE_VALID_FUNC(raw_func)
+
+    _m = (F_INT) m;
+    _n = (F_INT) n;
+    _k = (F_INT) k;
+    _lda = (F_INT) lda;
+    _ldb = (F_INT) ldb;
+    _ldc = (F_INT) ldc;
+    itemsize = kind_size(kind);
+
+    for (i = 0; i < batch; i++)
+    {
+        (*(xxgemm_t) raw_func)(&transa, &transb, &_m, &_n, &_k, alpha,
+                               (char *) a + i * stride_a * itemsize, &_lda,
+                               (char *) b + i * stride_b * itemsize, &_ldb,
+                               beta,
+                               (char *) c + i * stride_c * itemsize, &_ldc);
+    }
+    return 0;
+}
+
+/* Batched matrix * vector: y[i] = alpha * a[i] * x[i] + beta * y[i]
+ * for i in [0, batch), with a[i] = a + i * stride_a and so on. */
+NUMBA_EXPORT_FUNC(int)
+numba_xxgemv_batched(char kind, char trans, Py_ssize_t m, Py_ssize_t n,
+                     void *alpha, void *a, Py_ssize_t lda,
+                     Py_ssize_t stride_a, void *x, Py_ssize_t stride_x,
+                     void *beta, void *y, Py_ssize_t stride_y,
+                     Py_ssize_t batch)
+{
+    void *raw_func = NULL;
+    F_INT _m, _n;
+    F_INT _lda;
+    F_INT inc = 1;
+    size_t itemsize;
+    Py_ssize_t i;
+
+    ENSURE_VALID_KIND(kind)
+
+    if ((kind == 's' || kind == 'd')
+        && m <= SMALL_MATRIX_MAX && n <= SMALL_MATRIX_MAX)
+    {
+        int _trans = !(trans == 'N' || trans == 'n');
+        if (kind == 's')
+        {
+            float *_a = (float *) a, *_x = (float *) x, *_y = (float *) y;
+            float _alpha = *(float *) alpha, _beta = *(float *) beta;
+            for (i = 0; i < batch; i++)
+                small_gemv_float(_trans, m, n, _alpha, _a + i * stride_a,
+                                 lda, _x + i * stride_x, _beta,
+                                 _y + i * stride_y);
+        }
+        else
+        {
+            double *_a = (double *) a, *_x = (double *) x, *_y = (double *) y;
+            double _alpha = *(double *) alpha, _beta = *(double *) beta;
+            for (i = 0; i < batch; i++)
+                small_gemv_double(_trans, m, n, _alpha, _a + i * stride_a,
+                                  lda, _x + i * stride_x, _beta,
+                                  _y + i * stride_y);
+        }
+        return 0;
+    }
+
+    switch (kind)
+    {
+        case 's':
+            raw_func = get_cblas_sgemv();
+            break;
+        case 'd':
+            raw_func = get_cblas_dgemv();
+            break;
+        case 'c':
+            raw_func = get_cblas_cgemv();
+            break;
+        case 'z':
+            raw_func = get_cblas_zgemv();
+            break;
+    }
+    ENSURE_VALID_FUNC(raw_func)
+
+    _m = (F_INT) m;
+    _n = (F_INT) n;
+    _lda = (F_INT) lda;
+    itemsize = kind_size(kind);
+
+    for (i = 0; i < batch; i++)
+    {
+        (*(xxgemv_t) raw_func)(&trans, &_m, &_n, alpha,
+                               (char *) a + i * stride_a * itemsize, &_lda,
+                               (char *) x + i * stride_x * itemsize, &inc,
+                               beta,
+                               (char *) y + i * stride_y * itemsize, &inc);
+    }
+    return 0;
+}
+
+
 /* L2-norms */
 NUMBA_EXPORT_FUNC(F_INT)
 numba_xxnrm2(char kind, Py_ssize_t n, void * x, Py_ssize_t incx, void * result)
@@ -833,13 +1307,13 @@ numba_ez_xxgetri(char kind, Py_ssize_t n, void *a, Py_ssize_t lda,
 
     lwork = cast_from_X(kind, work);
 
-    if (checked_PyMem_RawMalloc(&work, base_size * lwork))
+    if (checked_workspace(WS_XXGETRI_WORK, &work, base_size * lwork))
     {
         return STATUS_ERROR;
     }
 
     numba_raw_xxgetri(kind, _n, a, _lda, ipiv, work, &lwork, &info);
-    PyMem_RawFree(work);
+    release_workspace(WS_XXGETRI_WORK, work);
     CATCH_LAPACK_INVALID_ARG("xxgetri", info);
 
     return (int)info;
@@ -945,13 +1419,13 @@ numba_ez_rgeev(char kind, char jobvl, char jobvr, Py_ssize_t n, void *a,
     CATCH_LAPACK_INVALID_ARG("numba_raw_rgeev", info);
 
     lwork = cast_from_X(kind, work);
-    if (checked_PyMem_RawMalloc(&work, base_size * lwork))
+    if (checked_workspace(WS_RGEEV_WORK, &work, base_size * lwork))
     {
         return STATUS_ERROR;
     }
     numba_raw_rgeev(kind, jobvl, jobvr, _n, a, _lda, wr, wi, vl, _ldvl,
                     vr, _ldvr, work, lwork, &info);
-    PyMem_RawFree(work);
+    release_workspace(WS_RGEEV_WORK, work);
 
     CATCH_LAPACK_INVALID_ARG("numba_raw_rgeev", info);
 
@@ -1027,19 +1501,19 @@ numba_ez_cgeev(char kind, char jobvl, char jobvr,  Py_ssize_t n, void *a,
     CATCH_LAPACK_INVALID_ARG("numba_raw_cgeev", info);
 
     lwork = cast_from_X(kind, work);
-    if (checked_PyMem_RawMalloc((void**)&rwork, 2*n*base_size))
+    if (checked_workspace(WS_CGEEV_RWORK, (void**)&rwork, 2*n*base_size))
     {
         return STATUS_ERROR;
     }
-    if (checked_PyMem_RawMalloc(&work, base_size * lwork))
+    if (checked_workspace(WS_CGEEV_WORK, &work, base_size * lwork))
     {
-        PyMem_RawFree(rwork);
+        release_workspace(WS_CGEEV_RWORK, rwork);
         return STATUS_ERROR;
     }
     numba_raw_cgeev(kind, jobvl, jobvr, _n, a, _lda, w, vl, _ldvl,
                     vr, _ldvr, work, lwork, rwork, &info);
-    PyMem_RawFree(work);
-    PyMem_RawFree(rwork);
+    release_workspace(WS_CGEEV_WORK, work);
+    release_workspace(WS_CGEEV_RWORK, rwork);
     CATCH_LAPACK_INVALID_ARG("numba_raw_cgeev", info);
 
     return (int)info;
@@ -1105,19 +1579,19 @@ numba_ez_rsyevd(char kind, char jobz, char uplo, Py_ssize_t n, void *a, Py_ssize
     CATCH_LAPACK_INVALID_ARG("numba_raw_rsyevd", info);
 
     lwork = cast_from_X(kind, work);
-    if (checked_PyMem_RawMalloc(&work, base_size * lwork))
+    if (checked_workspace(WS_RSYEVD_WORK, &work, base_size * lwork))
     {
         return STATUS_ERROR;
     }
     liwork = *iwork;
-    if (checked_PyMem_RawMalloc((void**)&iwork, base_size * liwork))
+    if (checked_workspace(WS_RSYEVD_IWORK, (void**)&iwork, base_size * liwork))
     {
-        PyMem_RawFree(work);
+        release_workspace(WS_RSYEVD_WORK, work);
         return STATUS_ERROR;
     }
     numba_raw_rsyevd(kind, jobz, uplo, _n, a, _lda, w, work, lwork, iwork, liwork, &info);
-    PyMem_RawFree(work);
-    PyMem_RawFree(iwork);
+    release_workspace(WS_RSYEVD_WORK, work);
+    release_workspace(WS_RSYEVD_IWORK, iwork);
 
     CATCH_LAPACK_INVALID_ARG("numba_raw_rsyevd", info);
 
@@ -1191,29 +1665,29 @@ numba_ez_cheevd(char kind, char jobz, char uplo, Py_ssize_t n, void *a, Py_ssize
     CATCH_LAPACK_INVALID_ARG("numba_raw_cheevd", info);
 
     lwork = cast_from_X(uf_kind, work);
-    if (checked_PyMem_RawMalloc(&work, base_size * lwork))
+    if (checked_workspace(WS_CHEEVD_WORK, &work, base_size * lwork))
     {
         return STATUS_ERROR;
     }
 
     lrwork = cast_from_X(uf_kind, rwork);
-    if (checked_PyMem_RawMalloc(&rwork, underlying_float_size * lrwork))
+    if (checked_workspace(WS_CHEEVD_RWORK, &rwork, underlying_float_size * lrwork))
     {
-        PyMem_RawFree(work);
+        release_workspace(WS_CHEEVD_WORK, work);
         return STATUS_ERROR;
     }
 
     liwork = *iwork;
-    if (checked_PyMem_RawMalloc((void**)&iwork, base_size * liwork))
+    if (checked_workspace(WS_CHEEVD_IWORK, (void**)&iwork, base_size * liwork))
     {
-        PyMem_RawFree(work);
-        PyMem_RawFree(rwork);
+        release_workspace(WS_CHEEVD_WORK, work);
+        release_workspace(WS_CHEEVD_RWORK, rwork);
         return STATUS_ERROR;
     }
     numba_raw_cheevd(kind, jobz, uplo, _n, a, _lda, w, work, lwork, rwork, lrwork, iwork, liwork, &info);
-    PyMem_RawFree(work);
-    PyMem_RawFree(rwork);
-    PyMem_RawFree(iwork);
+    release_workspace(WS_CHEEVD_WORK, work);
+    release_workspace(WS_CHEEVD_RWORK, rwork);
+    release_workspace(WS_CHEEVD_IWORK, iwork);
 
     CATCH_LAPACK_INVALID_ARG("numba_raw_cheevd", info);
 
@@ -1310,18 +1784,18 @@ numba_ez_rgesdd(char kind, char jobz, Py_ssize_t m, Py_ssize_t n, void *a,
 
     /* Allocate work array */
     lwork = cast_from_X(kind, work);
-    if (checked_PyMem_RawMalloc(&work, base_size * lwork))
+    if (checked_workspace(WS_RGESDD_WORK, &work, base_size * lwork))
         return -1;
     minmn = m > n ? n : m;
-    if (checked_PyMem_RawMalloc((void**) &iwork, 8 * minmn * sizeof(F_INT)))
+    if (checked_workspace(WS_RGESDD_IWORK, (void**) &iwork, 8 * minmn * sizeof(F_INT)))
     {
-        PyMem_RawFree(work);
+        release_workspace(WS_RGESDD_WORK, work);
         return STATUS_ERROR;
     }
     numba_raw_rgesdd(kind, jobz, m, n, a, lda, s, u ,ldu, vt, ldvt, work, lwork,
                      iwork, &info);
-    PyMem_RawFree(work);
-    PyMem_RawFree(iwork);
+    release_workspace(WS_RGESDD_WORK, work);
+    release_workspace(WS_RGESDD_IWORK, iwork);
     CATCH_LAPACK_INVALID_ARG("numba_raw_rgesdd", info);
 
     return (int)info;
@@ -1418,7 +1892,7 @@ numba_ez_cgesdd(char kind, char jobz, Py_ssize_t m, Py_ssize_t n, void *a,
 
     /* Allocate work array */
     lwork = cast_from_X(kind, work);
-    if (checked_PyMem_RawMalloc(&work, complex_base_size * lwork))
+    if (checked_workspace(WS_CGESDD_WORK, &work, complex_base_size * lwork))
         return STATUS_ERROR;
 
     minmn = m > n ? n : m;
@@ -1434,24 +1908,24 @@ numba_ez_cgesdd(char kind, char jobz, Py_ssize_t m, Py_ssize_t n, void *a,
         lrwork = minmn * (tmp1 > tmp2 ? tmp1: tmp2);
     }
 
-    if (checked_PyMem_RawMalloc(&rwork,
+    if (checked_workspace(WS_CGESDD_RWORK, &rwork,
                                 real_base_size * (lrwork > 1 ? lrwork : 1)))
     {
-        PyMem_RawFree(work);
+        release_workspace(WS_CGESDD_WORK, work);
         return STATUS_ERROR;
     }
-    if (checked_PyMem_RawMalloc((void **) &iwork,
+    if (checked_workspace(WS_CGESDD_IWORK, (void **) &iwork,
                                 8 * minmn * sizeof(F_INT)))
     {
-        PyMem_RawFree(work);
-        PyMem_RawFree(rwork);
+        release_workspace(WS_CGESDD_WORK, work);
+        release_workspace(WS_CGESDD_RWORK, rwork);
         return STATUS_ERROR;
     }
     numba_raw_cgesdd(kind, jobz, m, n, a, lda, s, u ,ldu, vt, ldvt, work, lwork,
                      rwork, iwork, &info);
-    PyMem_RawFree(work);
-    PyMem_RawFree(rwork);
-    PyMem_RawFree(iwork);
+    release_workspace(WS_CGESDD_WORK, work);
+    release_workspace(WS_CGESDD_RWORK, rwork);
+    release_workspace(WS_CGESDD_IWORK, iwork);
     CATCH_LAPACK_INVALID_ARG("numba_raw_cgesdd", info);
 
     return (int)info;
@@ -1550,11 +2024,11 @@ numba_ez_geqrf(char kind, Py_ssize_t m, Py_ssize_t n, void *a, Py_ssize_t
 
     /* Allocate work array */
     lwork = cast_from_X(kind, work);
-    if (checked_PyMem_RawMalloc(&work, base_size * lwork))
+    if (checked_workspace(WS_GEQRF_WORK, &work, base_size * lwork))
         return STATUS_ERROR;
 
     numba_raw_xgeqrf(kind, m, n, a, lda, tau, work, lwork, &info);
-    PyMem_RawFree(work);
+    release_workspace(WS_GEQRF_WORK, work);
     CATCH_LAPACK_INVALID_ARG("numba_raw_xgeqrf", info);
 
     return 0; /* info cannot be >0 */
@@ -1628,11 +2102,11 @@ numba_ez_xxgqr(char kind, Py_ssize_t m, Py_ssize_t n, Py_ssize_t k, void *a,
 
     /* Allocate work array */
     lwork = cast_from_X(kind, work);
-    if (checked_PyMem_RawMalloc(&work, base_size * lwork))
+    if (checked_workspace(WS_XXGQR_WORK, &work, base_size * lwork))
         return STATUS_ERROR;
 
     numba_raw_xxxgqr(kind, m, n, k, a, lda, tau, work, lwork, &info);
-    PyMem_RawFree(work);
+    release_workspace(WS_XXGQR_WORK, work);
     CATCH_LAPACK_INVALID_ARG("numba_raw_xxxgqr", info);
 
     return 0;  /* info cannot be >0 */
@@ -1712,13 +2186,13 @@ numba_ez_rgelsd(char kind, Py_ssize_t m, Py_ssize_t n, Py_ssize_t nrhs,
 
     /* Allocate work array */
     lwork = cast_from_X(kind, work);
-    if (checked_PyMem_RawMalloc(&work, base_size * lwork))
+    if (checked_workspace(WS_RGELSD_WORK, &work, base_size * lwork))
         return STATUS_ERROR;
 
     /* Allocate iwork array */
-    if (checked_PyMem_RawMalloc((void **)&iwork, sizeof(F_INT) * iwork_tmp))
+    if (checked_workspace(WS_RGELSD_IWORK, (void **)&iwork, sizeof(F_INT) * iwork_tmp))
     {
-        PyMem_RawFree(work);
+        release_workspace(WS_RGELSD_WORK, work);
         return STATUS_ERROR;
     }
 
@@ -1736,8 +2210,8 @@ numba_ez_rgelsd(char kind, Py_ssize_t m, Py_ssize_t n, Py_ssize_t nrhs,
 
     numba_raw_rgelsd(kind, m, n, nrhs, a, lda, b, ldb, S, rcond_cast, rank,
                      work, lwork, iwork, &info);
-    PyMem_RawFree(work);
-    PyMem_RawFree(iwork);
+    release_workspace(WS_RGELSD_WORK, work);
+    release_workspace(WS_RGELSD_IWORK, iwork);
     CATCH_LAPACK_INVALID_ARG("numba_raw_rgelsd", info);
 
     return (int)info;
@@ -1821,13 +2295,13 @@ numba_ez_cgelsd(char kind, Py_ssize_t m, Py_ssize_t n, Py_ssize_t nrhs,
 
     /* Allocate work array */
     lwork = cast_from_X(kind, work);
-    if (checked_PyMem_RawMalloc(&work, base_size * lwork))
+    if (checked_workspace(WS_CGELSD_WORK, &work, base_size * lwork))
         return STATUS_ERROR;
 
     /* Allocate iwork array */
-    if (checked_PyMem_RawMalloc((void **)&iwork, sizeof(F_INT) * iwork_tmp))
+    if (checked_workspace(WS_CGELSD_IWORK, (void **)&iwork, sizeof(F_INT) * iwork_tmp))
     {
-        PyMem_RawFree(work);
+        release_workspace(WS_CGELSD_WORK, work);
         return STATUS_ERROR;
     }
 
@@ -1847,18 +2321,18 @@ numba_ez_cgelsd(char kind, Py_ssize_t m, Py_ssize_t n, Py_ssize_t nrhs,
     real_base_size = kind_size(real_kind);
 
     lrwork = cast_from_X(real_kind, rwork);
-    if (checked_PyMem_RawMalloc((void **)&rwork, real_base_size * lrwork))
+    if (checked_workspace(WS_CGELSD_RWORK, (void **)&rwork, real_base_size * lrwork))
     {
-        PyMem_RawFree(work);
-        PyMem_RawFree(iwork);
+        release_workspace(WS_CGELSD_WORK, work);
+        release_workspace(WS_CGELSD_IWORK, iwork);
         return STATUS_ERROR;
     }
 
     numba_raw_cgelsd(kind, m, n, nrhs, a, lda, b, ldb, S, rcond_cast, rank,
                      work, lwork, rwork, iwork, &info);
-    PyMem_RawFree(work);
-    PyMem_RawFree(rwork);
-    PyMem_RawFree(iwork);
+    release_workspace(WS_CGELSD_WORK, work);
+    release_workspace(WS_CGELSD_RWORK, rwork);
+    release_workspace(WS_CGELSD_IWORK, iwork);
     CATCH_LAPACK_INVALID_ARG("numba_raw_cgelsd", info);
 
     return (int)info;
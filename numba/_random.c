@@ -406,6 +406,144 @@ get_next_double(rnd_state_t *state)
     return (a * 67108864.0 + b) / 9007199254740992.0;
 }
 
+/*
+ * Bulk generation into a buffer, producing the same stream as repeated
+ * calls to the scalar functions.  The tempering and conversion loops run
+ * over whole runs of the state vector, which lets the compiler vectorize them.
+ */
+
+/* Fill out[0:n] with the next n tempered 32-bit outputs */
+NUMBA_EXPORT_FUNC(void)
+numba_rnd_fill_int32(rnd_state_t *state, unsigned int *out, Py_ssize_t n)
+{
+    while (n > 0) {
+        Py_ssize_t i, run;
+        const unsigned int *mt;
+
+        if (state->index == MT_N) {
+            numba_rnd_shuffle(state);
+            state->index = 0;
+        }
+        run = MT_N - state->index;
+        if (run > n)
+            run = n;
+        mt = state->mt + state->index;
+        for (i = 0; i < run; i++) {
+            unsigned int y = mt[i];
+            y ^= (y >> 11);
+            y ^= (y << 7) & 0x9d2c5680U;
+            y ^= (y << 15) & 0xefc60000U;
+            y ^= (y >> 18);
+            out[i] = y;
+        }
+        state->index += (int) run;
+        out += run;
+        n -= run;
+    }
+}
+
+/* The number of doubles converted at once by numba_rnd_fill_double() */
+#define RND_FILL_CHUNK 256
+
+/* Fill out[0:n] with the doubles of get_next_double() */
+NUMBA_EXPORT_FUNC(void)
+numba_rnd_fill_double(rnd_state_t *state, double *out, Py_ssize_t n)
+{
+    unsigned int buf[2 * RND_FILL_CHUNK];
+
+    while (n > 0) {
+        Py_ssize_t i, chunk = n < RND_FILL_CHUNK ? n : RND_FILL_CHUNK;
+
+        numba_rnd_fill_int32(state, buf, 2 * chunk);
+        for (i = 0; i < chunk; i++) {
+            /* these fit in an int, whose conversion is cheaper */
+            double a = (int) (buf[2 * i] >> 5);
+            double b = (int) (buf[2 * i + 1] >> 6);
+            out[i] = (a * 67108864.0 + b) / 9007199254740992.0;
+        }
+        out += chunk;
+        n -= chunk;
+    }
+}
+
+/* Fill out[0:n] with standard normal variates, computed by pairs with the
+   polar Box-Muller transform like np.random.standard_normal(), including
+   the variate cached in the state. */
+NUMBA_EXPORT_FUNC(void)
+numba_rnd_fill_gauss(rnd_state_t *state, double *out, Py_ssize_t n)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < n; i++) {
+        if (state->has_gauss) {
+            out[i] = state->gauss;
+            state->has_gauss = 0;
+        }
+        else {
+            double x1, x2, r2, f;
+            do {
+                x1 = 2.0 * get_next_double(state) - 1.0;
+                x2 = 2.0 * get_next_double(state) - 1.0;
+                r2 = x1 * x1 + x2 * x2;
+            } while (r2 >= 1.0 || r2 == 0.0);
+            f = sqrt(-2.0 * log(r2) / r2);
+            state->gauss = f * x1;
+            state->has_gauss = 1;
+            out[i] = f * x2;
+        }
+    }
+}
+
+/* Fill out[0:n] with integers drawn uniformly from [low, high) like
+   np.random.randint(), by rejection of the draws of as many bits as
+   high - low - 1 has.  Returns -1 if the range is empty, leaving the
+   state unchanged, otherwise 0. */
+NUMBA_EXPORT_FUNC(int)
+numba_rnd_fill_randint64(rnd_state_t *state, int64_t *out, Py_ssize_t n,
+                         int64_t low, int64_t high)
+{
+    Py_ssize_t i;
+    uint64_t range, rmax, mask;
+
+    if (n <= 0)
+        return 0;
+    if (high <= low)
+        return -1;
+    range = (uint64_t) high - (uint64_t) low;
+    if (range > (uint64_t) INT64_MAX)
+        return -1;  /* high - low overflows like in the scalar version */
+    rmax = range - 1;
+    if (rmax == 0) {
+        for (i = 0; i < n; i++)
+            out[i] = low;
+        return 0;
+    }
+    /* the smallest all-ones mask covering rmax */
+    mask = rmax;
+    mask |= mask >> 1;
+    mask |= mask >> 2;
+    mask |= mask >> 4;
+    mask |= mask >> 8;
+    mask |= mask >> 16;
+    mask |= mask >> 32;
+
+    for (i = 0; i < n; i++) {
+        uint64_t r;
+        do {
+            if (mask <= 0xffffffffU) {
+                r = get_next_int32(state) & mask;
+            }
+            else {
+                /* the high bits first, to match np.random */
+                r = (uint64_t) (get_next_int32(state) & (mask >> 32)) << 32;
+                r |= get_next_int32(state);
+            }
+        } while (r > rmax);
+        out[i] = (int64_t) ((uint64_t) low + r);
+    }
+    return 0;
+}
+
 NUMBA_EXPORT_FUNC(double)
 loggam(double x)
 {
@@ -646,17 +646,99 @@ typecode_using_fingerprint(PyObject *dispatcher, PyObject *val)
 }
 
 
+/*
+ * Direct lookup tables for the typecodes of bools and of small tuples of
+ * scalars, so that they don't need a fingerprint to be computed. The entries
+ * are filled from typecode_using_fingerprint() on first use, the typecodes
+ * it returns are kept alive forever.
+ */
+
+#define N_SCALAR_KINDS 4
+#define N_TUPLE 4       /* Fast path for tuples of up to 4 scalars */
+#define N_UNITUPLE 16   /* and for homogeneous ones of up to 16 */
+/* The tuples of up to N_TUPLE items, with N_SCALAR_KINDS ** n entries for
+   the tuples of n items */
+#define N_TUPLE_CODES ((1 << (2 * (N_TUPLE + 1))) / 3)
+static int cached_boolcode;
+static int cached_tuplecode[N_TUPLE_CODES];
+static int cached_unituplecode[N_SCALAR_KINDS][N_UNITUPLE + 1];
+
+/* The index of the kind of a scalar in the tables above, or -1 if it isn't
+   one of the supported scalars. This must agree with compute_fingerprint()
+   and only matches the exact types. */
+static int scalar_kind(PyObject *val) {
+    PyTypeObject *tyobj = Py_TYPE(val);
+    if (tyobj == &PyBool_Type)
+        return 0;
+    if (tyobj == &PyLong_Type)
+        return 1;
+    if (tyobj == &PyFloat_Type)
+        return 2;
+    if (tyobj == &PyComplex_Type)
+        return 3;
+    return -1;
+}
+
+static
+int typecode_bool(PyObject *dispatcher, PyObject *val) {
+    if (cached_boolcode == -1)
+        cached_boolcode = typecode_using_fingerprint(dispatcher, val);
+    return cached_boolcode;
+}
+
+static
+int typecode_tuple(PyObject *dispatcher, PyObject *tup) {
+    Py_ssize_t i, n = PyTuple_GET_SIZE(tup);
+    int *slot = NULL;
+    int kind = 0, key = 0, homogeneous = 1;
+
+    if (n <= N_UNITUPLE) {
+        for (i = 0; i < n; ++i) {
+            int k = scalar_kind(PyTuple_GET_ITEM(tup, i));
+            if (k < 0)
+                break;
+            if (i == 0)
+                kind = k;
+            else if (k != kind)
+                homogeneous = 0;
+            key = key * N_SCALAR_KINDS + k;
+        }
+        if (i < n)
+            slot = NULL;
+        else if (n <= N_TUPLE)
+            /* Skip the entries of the shorter tuples */
+            slot = &cached_tuplecode[((1 << (2 * n)) - 1) / 3 + key];
+        else if (homogeneous)
+            slot = &cached_unituplecode[kind][n];
+    }
+    if (slot == NULL)
+        return typecode_using_fingerprint(dispatcher, tup);
+    if (*slot == -1)
+        *slot = typecode_using_fingerprint(dispatcher, tup);
+    return *slot;
+}
+
+
 /*
  * Direct lookup table for extra-fast typecode resolution of simple array types.
  */
 
-#define N_DTYPES 12
-#define N_NDIM 5    /* Fast path for up to 5D array */
+#define N_DTYPES NPY_NTYPES
+#define N_NDIM 8    /* Fast path for up to 8D array */
 #define N_LAYOUT 3
-static int cached_arycode[N_NDIM][N_LAYOUT][N_DTYPES];
+static int cached_arycode[N_NDIM + 1][N_LAYOUT][N_DTYPES];
+
+/* Convert a Numpy dtype number to an internal index into cached_arycode, or
+   -1 for the dtypes which aren't determined by their number alone (flexible,
+   datetime and object types). */
+static int dtype_num_to_arycode(int type_num) {
+    if (type_num < 0 || type_num >= N_DTYPES || type_num == NPY_OBJECT ||
+        PyTypeNum_ISFLEXIBLE(type_num) || PyTypeNum_ISDATETIME(type_num))
+        return -1;
+    return type_num;
+}
 
-/* Convert a Numpy dtype number to an internal index into cached_arycode.
-   The returned value must also be a valid index into BASIC_TYPECODES. */
+/* Convert a Numpy dtype number to an index into BASIC_TYPECODES. */
 static int dtype_num_to_typecode(int type_num) {
     int dtype;
     switch(type_num) {
@@ -733,10 +815,10 @@ static
 int get_cached_ndarray_typecode(int ndim, int layout, PyArray_Descr* descr) {
     PyObject* key = ndarray_key(ndim, layout, descr);
     PyObject *tmpobject = PyDict_GetItem(ndarray_typecache, key);
+    Py_DECREF(key);
     if (tmpobject == NULL)
         return -1;
 
-    Py_DECREF(key);
     return PyLong_AsLong(tmpobject);
 }
 
@@ -750,12 +832,197 @@ void cache_ndarray_typecode(int ndim, int layout, PyArray_Descr* descr,
     Py_DECREF(value);
 }
 
+/*
+ * A fixed size cache of typecodes keyed on the identity of an object along
+ * with two integers, looked up without creating any Python object. It
+ * holds the typecodes of the arrays and structured scalars that can't use
+ * cached_arycode, keyed on their dtype, number of dimensions and flags,
+ * before the dict based caches above which compare dtypes by value. It also
+ * holds those of the registered types below. Entries hold a reference to
+ * their key so that its address can't be reused, and are evicted when their
+ * probe sequence is full.
+ */
+
+#define IDENT_CACHE_SIZE 1024   /* a power of two */
+#define IDENT_CACHE_PROBES 8
+/* The ndim of structured scalars, which are distinct from 0d arrays */
+#define IDENT_CACHE_SCALAR -1
+/* The ndim of the entries of classes and of Numba types */
+#define IDENT_CACHE_CLASS -2
+#define IDENT_CACHE_NUMBA_TYPE -3
+
+typedef struct {
+    PyObject *key;      /* NULL for an empty entry */
+    int ndim;
+    int flags;
+    int typecode;
+} ident_cache_entry_t;
+
+static ident_cache_entry_t ident_typecache[IDENT_CACHE_SIZE];
+
+static size_t
+ident_cache_index(PyObject *key, int ndim, int flags)
+{
+    size_t h = (size_t) key >> 4;
+    h ^= ((size_t) (ndim + 3) * 0x9E3779B1u) ^ ((size_t) flags << 11);
+    return h ^ (h >> 10);
+}
+
+/* The flags of an array that typeof() depends on beyond its dtype and
+   ndim */
+static int
+array_cache_flags(PyArrayObject *ary, int layout)
+{
+    return layout | (PyArray_ISALIGNED(ary) ? 4 : 0) |
+           (PyArray_ISWRITEABLE(ary) ? 8 : 0);
+}
+
+static int
+get_ident_cached_typecode(PyObject *key, int ndim, int flags)
+{
+    size_t i, h = ident_cache_index(key, ndim, flags);
+    for (i = 0; i < IDENT_CACHE_PROBES; ++i) {
+        ident_cache_entry_t *e = &ident_typecache[(h + i) % IDENT_CACHE_SIZE];
+        if (e->key == key && e->ndim == ndim && e->flags == flags)
+            return e->typecode;
+        if (e->key == NULL)
+            break;
+    }
+    return -1;
+}
+
+static void
+cache_ident_typecode(PyObject *key, int ndim, int flags, int typecode)
+{
+    size_t i, h = ident_cache_index(key, ndim, flags);
+    ident_cache_entry_t *e = &ident_typecache[h % IDENT_CACHE_SIZE];
+    if (typecode < 0)
+        return;
+    for (i = 0; i < IDENT_CACHE_PROBES; ++i) {
+        ident_cache_entry_t *cand = &ident_typecache[(h + i) % IDENT_CACHE_SIZE];
+        if (cand->key == NULL) {
+            e = cand;
+            break;
+        }
+    }
+    /* Evict the first entry of the probe sequence if it's full */
+    Py_INCREF(key);
+    Py_XDECREF(e->key);
+    e->key = key;
+    e->ndim = ndim;
+    e->flags = flags;
+    e->typecode = typecode;
+}
+
+/*
+ * Types registered with typeof_register_type() whose instances carry their
+ * Numba type, so that it doesn't have to be looked up through typeof():
+ *
+ * - instances of exactly a class registered with an attribute name hold
+ *   their Numba type in that attribute, as typed containers do. Their
+ *   typecode is cached on the Numba type.
+ * - instances of subclasses of a class registered without one get their
+ *   Numba type from the `_numba_type_` attribute of their class, as jitclass
+ *   boxes do. Their typecode is cached on their class.
+ */
+
+#define N_REGISTERED_TYPES 8
+static PyTypeObject *attr_typed_classes[N_REGISTERED_TYPES];
+static PyObject *attr_typed_names[N_REGISTERED_TYPES];
+static int n_attr_typed_classes = 0;
+static PyTypeObject *class_typed_bases[N_REGISTERED_TYPES];
+static int n_class_typed_bases = 0;
+
+/*
+ * typeof_register_type(cls, attr)
+ * (called from numba.typed and jitclass to register their types)
+ */
+PyObject *
+typeof_register_type(PyObject *self, PyObject *args)
+{
+    PyTypeObject *cls;
+    PyObject *attr;
+
+    if (!PyArg_ParseTuple(args, "O!O:typeof_register_type",
+                          &PyType_Type, &cls, &attr))
+        return NULL;
+    if (attr != Py_None && !PyUnicode_Check(attr)) {
+        PyErr_SetString(PyExc_TypeError, "attr must be a str or None");
+        return NULL;
+    }
+    if (n_attr_typed_classes == N_REGISTERED_TYPES ||
+        n_class_typed_bases == N_REGISTERED_TYPES) {
+        PyErr_SetString(PyExc_RuntimeError, "too many registered types");
+        return NULL;
+    }
+    Py_INCREF(cls);
+    if (attr == Py_None) {
+        class_typed_bases[n_class_typed_bases++] = cls;
+    }
+    else {
+        Py_INCREF(attr);
+        PyUnicode_InternInPlace(&attr);
+        attr_typed_classes[n_attr_typed_classes] = cls;
+        attr_typed_names[n_attr_typed_classes++] = attr;
+    }
+    Py_RETURN_NONE;
+}
+
+/* Compute the typecode of *val* if its type is registered. Returns 0 if it
+ * isn't, otherwise 1 with the typecode (or -1 on error) in *typecode*.
+ */
+static int
+typecode_registered(PyObject *dispatcher, PyObject *val, int *typecode)
+{
+    PyTypeObject *tyobj = Py_TYPE(val);
+    PyObject *numba_type;
+    int i;
+
+    for (i = 0; i < n_attr_typed_classes; ++i) {
+        if (tyobj != attr_typed_classes[i])
+            continue;
+        numba_type = PyObject_GenericGetAttr(val, attr_typed_names[i]);
+        if (numba_type == NULL || numba_type == Py_None) {
+            /* Let typeof() raise the appropriate error */
+            Py_XDECREF(numba_type);
+            PyErr_Clear();
+            *typecode = typecode_fallback(dispatcher, val);
+            return 1;
+        }
+        *typecode = get_ident_cached_typecode(numba_type,
+                                              IDENT_CACHE_NUMBA_TYPE, 0);
+        if (*typecode == -1) {
+            /* The cache keeps the Numba type alive, as required by the
+               fingerprint cache above */
+            *typecode = _typecode_from_type_object(numba_type);
+            cache_ident_typecode(numba_type, IDENT_CACHE_NUMBA_TYPE, 0,
+                                 *typecode);
+        }
+        Py_DECREF(numba_type);
+        return 1;
+    }
+    for (i = 0; i < n_class_typed_bases; ++i) {
+        if (!PyType_IsSubtype(tyobj, class_typed_bases[i]))
+            continue;
+        *typecode = get_ident_cached_typecode((PyObject *) tyobj,
+                                              IDENT_CACHE_CLASS, 0);
+        if (*typecode == -1) {
+            *typecode = typecode_fallback_keep_ref(dispatcher, val);
+            cache_ident_typecode((PyObject *) tyobj, IDENT_CACHE_CLASS, 0,
+                                 *typecode);
+        }
+        return 1;
+    }
+    return 0;
+}
+
 static
 int typecode_ndarray(PyObject *dispatcher, PyArrayObject *ary) {
     int typecode;
     int dtype;
     int ndim = PyArray_NDIM(ary);
     int layout = 0;
+    int flags;
 
     /* The order in which we check for the right contiguous-ness is important.
        The order must match the order by numba.numpy_support.map_layout.
@@ -772,9 +1039,9 @@ int typecode_ndarray(PyObject *dispatcher, PyArrayObject *ary) {
      * writeable), all others must be forced to the fall back */
     if (!PyArray_ISBEHAVED(ary)) goto FALLBACK;
 
-    if (ndim <= 0 || ndim > N_NDIM) goto FALLBACK;
+    if (ndim > N_NDIM) goto FALLBACK;
 
-    dtype = dtype_num_to_typecode(PyArray_TYPE(ary));
+    dtype = dtype_num_to_arycode(PyArray_TYPE(ary));
     if (dtype == -1) goto FALLBACK;
 
     /* Fast path, using direct table lookup */
@@ -782,28 +1049,40 @@ int typecode_ndarray(PyObject *dispatcher, PyArrayObject *ary) {
     assert(ndim <= N_NDIM);
     assert(dtype < N_DTYPES);
 
-    typecode = cached_arycode[ndim - 1][layout][dtype];
+    typecode = cached_arycode[ndim][layout][dtype];
     if (typecode == -1) {
         /* First use of this table entry, so it requires populating */
         typecode = typecode_fallback_keep_ref(dispatcher, (PyObject*)ary);
-        cached_arycode[ndim - 1][layout][dtype] = typecode;
+        cached_arycode[ndim][layout][dtype] = typecode;
     }
     return typecode;
 
 FALLBACK:
     /* Slower path, for non-trivial array types */
+    flags = array_cache_flags(ary, layout);
+    typecode = get_ident_cached_typecode((PyObject *) PyArray_DESCR(ary),
+                                         ndim, flags);
+    if (typecode != -1)
+        return typecode;
 
-    /* If this isn't a structured array then we can't use the cache */
-    if (PyArray_TYPE(ary) != NPY_VOID)
-        return typecode_using_fingerprint(dispatcher, (PyObject *) ary);
-
-    /* Check type cache */
-    typecode = get_cached_ndarray_typecode(ndim, layout, PyArray_DESCR(ary));
-    if (typecode == -1) {
-        /* First use of this type, use fallback and populate the cache */
-        typecode = typecode_fallback_keep_ref(dispatcher, (PyObject*)ary);
-        cache_ndarray_typecode(ndim, layout, PyArray_DESCR(ary), typecode);
+    /* If this isn't a behaved structured array then we can't use the dict
+       cache, which doesn't account for the flags */
+    if (PyArray_TYPE(ary) != NPY_VOID || !PyArray_ISBEHAVED(ary)) {
+        typecode = typecode_using_fingerprint(dispatcher, (PyObject *) ary);
+    }
+    else {
+        typecode = get_cached_ndarray_typecode(ndim, layout,
+                                               PyArray_DESCR(ary));
+        if (typecode == -1) {
+            /* First use of this type, use fallback and populate the cache */
+            typecode = typecode_fallback_keep_ref(dispatcher,
+                                                  (PyObject*)ary);
+            cache_ndarray_typecode(ndim, layout, PyArray_DESCR(ary),
+                                   typecode);
+        }
     }
+    cache_ident_typecode((PyObject *) PyArray_DESCR(ary), ndim, flags,
+                         typecode);
     return typecode;
 }
 
@@ -817,11 +1096,17 @@ int typecode_arrayscalar(PyObject *dispatcher, PyObject* aryscalar) {
 
     /* Is it a structured scalar? */
     if (descr->type_num == NPY_VOID) {
-        typecode = get_cached_typecode(descr);
+        typecode = get_ident_cached_typecode((PyObject *) descr,
+                                             IDENT_CACHE_SCALAR, 0);
         if (typecode == -1) {
-            /* Resolve through fallback then populate cache */
-            typecode = typecode_fallback_keep_ref(dispatcher, aryscalar);
-            cache_typecode(descr, typecode);
+            typecode = get_cached_typecode(descr);
+            if (typecode == -1) {
+                /* Resolve through fallback then populate cache */
+                typecode = typecode_fallback_keep_ref(dispatcher, aryscalar);
+                cache_typecode(descr, typecode);
+            }
+            cache_ident_typecode((PyObject *) descr, IDENT_CACHE_SCALAR, 0,
+                                 typecode);
         }
         Py_DECREF(descr);
         return typecode;
@@ -876,7 +1161,7 @@ int typecode_devicendarray(PyObject *dispatcher, PyObject *ary)
         goto FALLBACK;
     }
 
-    if (ndim <= 0 || ndim > N_NDIM)
+    if (ndim < 0 || ndim > N_NDIM)
         goto FALLBACK;
 
     PyObject* dtype_obj = PyObject_GetAttrString(ary, "dtype");
@@ -905,7 +1190,7 @@ int typecode_devicendarray(PyObject *dispatcher, PyObject *ary)
         goto FALLBACK;
     }
 
-    dtype = dtype_num_to_typecode(dtype_num);
+    dtype = dtype_num_to_arycode(dtype_num);
     if (dtype == -1) {
         /* Not a dtype we have in the global lookup table. */
         goto FALLBACK;
@@ -915,12 +1200,12 @@ int typecode_devicendarray(PyObject *dispatcher, PyObject *ary)
     assert(layout < N_LAYOUT);
     assert(ndim <= N_NDIM);
     assert(dtype < N_DTYPES);
-    typecode = cached_arycode[ndim - 1][layout][dtype];
+    typecode = cached_arycode[ndim][layout][dtype];
 
     if (typecode == -1) {
         /* First use of this table entry, so it requires populating */
         typecode = typecode_fallback_keep_ref(dispatcher, (PyObject*)ary);
-        cached_arycode[ndim - 1][layout][dtype] = typecode;
+        cached_arycode[ndim][layout][dtype] = typecode;
     }
 
     return typecode;
@@ -939,6 +1224,7 @@ typeof_typecode(PyObject *dispatcher, PyObject *val)
 {
     PyTypeObject *tyobj = Py_TYPE(val);
     int subtype_attr;
+    int typecode;
     /* This needs to be kept in sync with Dispatcher.typeof_pyval(),
      * otherwise funny things may happen.
      */
@@ -960,6 +1246,10 @@ typeof_typecode(PyObject *dispatcher, PyObject *val)
         return tc_float64;
     else if (tyobj == &PyComplex_Type)
         return tc_complex128;
+    else if (tyobj == &PyBool_Type)
+        return typecode_bool(dispatcher, val);
+    else if (tyobj == &PyTuple_Type)
+        return typecode_tuple(dispatcher, val);
     /* Array scalar handling */
     else if (PyArray_CheckScalar(val)) {
         return typecode_arrayscalar(dispatcher, val);
@@ -1029,6 +1319,10 @@ typeof_typecode(PyObject *dispatcher, PyObject *val)
             return typecode_ndarray(dispatcher, (PyArrayObject*)val);
         }
     }
+    /* Typed containers and jitclass instances */
+    else if (typecode_registered(dispatcher, val, &typecode)) {
+        return typecode;
+    }
 
     return typecode_using_fingerprint(dispatcher, val);
 }
@@ -1122,6 +1416,9 @@ typeof_init(PyObject *self, PyObject *args)
 
     /* initialize cached_arycode to all ones (in bits) */
     memset(cached_arycode, 0xFF, sizeof(cached_arycode));
+    cached_boolcode = -1;
+    memset(cached_tuplecode, 0xFF, sizeof(cached_tuplecode));
+    memset(cached_unituplecode, 0xFF, sizeof(cached_unituplecode));
 
     str_typeof_pyval = PyString_InternFromString("typeof_pyval");
     str_value = PyString_InternFromString("value");
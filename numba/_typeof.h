@@ -6,6 +6,7 @@
 #endif
 
 extern PyObject *typeof_init(PyObject *self, PyObject *args);
+extern PyObject *typeof_register_type(PyObject *self, PyObject *args);
 extern int typeof_typecode(PyObject *dispatcher, PyObject *val);
 extern PyObject *typeof_compute_fingerprint(PyObject *val);
 
@@ -0,0 +1,208 @@
+/*
+ * Vector-width variants of the math functions, which the LLVM loop
+ * vectorizer may call in place of the scalar functions (see
+ * numba/cpython/mathimpl.py): numba_<F>_v<W> computes F for the W lanes
+ * of its vector argument.  The 256-bit variants need AVX2 and FMA and the
+ * 512-bit ones AVX-512F, the JIT only uses them when the CPU has these
+ * features.
+ *
+ * The kernels evaluate polynomial approximations with vector operations.
+ * They are accurate to a few units in the last place, but their results
+ * may differ from those of the scalar functions.  The float variants are
+ * computed in double precision.  The coefficients are the Chebyshev
+ * interpolants of the functions, computed with 60 significant digits.
+ */
+
+#if defined(__x86_64__) && !defined(_WIN32) \
+    && (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 9))
+
+#include <immintrin.h>
+
+#define NUMBA_HAVE_VECTOR_MATH 1
+
+#define VM_ARRAY_SIZE(a) ((int) (sizeof(a) / sizeof((a)[0])))
+
+#define VM_MAGIC 0x1.8p52
+#define VM_LOG2E 0x1.71547652b82fep+0
+#define VM_LN2_HI 0x1.62e42fee00000p-1
+#define VM_LN2_LO 0x1.a39ef35793c76p-33
+#define VM_HALF_LOG_2PI_M_HALF 0x1.acfe390c97d69p-2
+
+/* exp(r) = sum(r**k / k!) */
+static const double vm_exp_poly[14] = {
+    0x1.0000000000000p+0, 0x1.0000000000000p+0, 0x1.0000000000000p-1,
+    0x1.5555555555555p-3, 0x1.5555555555555p-5, 0x1.1111111111111p-7,
+    0x1.6c16c16c16c17p-10, 0x1.a01a01a01a01ap-13, 0x1.a01a01a01a01ap-16,
+    0x1.71de3a556c734p-19, 0x1.27e4fb7789f5cp-22, 0x1.ae64567f544e4p-26,
+    0x1.1eed8eff8d898p-29, 0x1.6124613a86d09p-33
+};
+
+/* R(z) = sum(2 z**k / (2 k + 1)) */
+static const double vm_log_poly[10] = {
+    0x1.5555555555555p-1, 0x1.999999999999ap-2, 0x1.2492492492492p-2,
+    0x1.c71c71c71c71cp-3, 0x1.745d1745d1746p-3, 0x1.3b13b13b13b14p-3,
+    0x1.1111111111111p-3, 0x1.e1e1e1e1e1e1ep-4, 0x1.af286bca1af28p-4,
+    0x1.8618618618618p-4
+};
+
+/* erf(x) / x for |x| < 0.5, in s = 8 x**2 - 1 */
+static const double vm_erf_small[11] = {
+    0x1.15446b34ed348p+0, -0x1.658407f4c04c0p-5, 0x1.a6db683de1276p-10,
+    -0x1.8f7e682c96cd8p-15, 0x1.35219bf04bdf6p-20, -0x1.93403af733005p-26,
+    0x1.c5c5703cf6dd2p-32, -0x1.c08f4c11bbea1p-38, 0x1.8b2b73c6a8ddap-44,
+    -0x1.39fdacc3f61efp-50, 0x1.c60ae6747e9bcp-57
+};
+
+/* erfcx(x) = exp(x**2) erfc(x) on [0.5, 1.5), [1.5, 4) and [4, 27.5),
+   in s = k (xc - x) / (x + 4) */
+static const double vm_erfcx_bounds[3] = {0.5, 1.5, 4.0};
+static const double vm_erfcx_k[3] = {
+    0x1.4000000000000p+3, 0x1.599999999999ap+2, 0x1.ae4c415c9882bp+0
+};
+static const double vm_erfcx_xc[3] = {
+    0x1.e666666666666p-1, 0x1.425ed097b425fp+1, 0x1.184dc5abbf30ap+3
+};
+static const double vm_erfcx_poly[3][17] = {
+    {
+        0x1.c43d576d9c122p-2, 0x1.253e31d811cb8p-3, 0x1.b32f9470ad336p-6,
+        0x1.f5e5be0396612p-9, 0x1.c68a25aa22911p-12, 0x1.3fff99f415dd3p-15,
+        0x1.50cedb41bf178p-19, 0x1.da5d3a45e45d8p-24, 0x1.0a11415324fa1p-29,
+        -0x1.df0b4eb711667p-34, -0x1.06757905bbf0cp-37, 0x1.2b98bc495d540p-46,
+        0x1.22b8e08aa03b4p-46, 0x1.acac701302cf0p-53, -0x1.4aa03b748b9f5p-55,
+        -0x1.43278f4061861p-61, 0x1.a49057a58fe51p-64
+    },
+    {
+        0x1.aceddcf6f7011p-3, 0x1.6b13ef64a0587p-4, 0x1.3beff26b0afcdp-6,
+        0x1.d4b262672ff98p-9, 0x1.272e154af5501p-11, 0x1.37eee437ace26p-14,
+        0x1.0dd8f97c95317p-17, 0x1.6b3da2269eb82p-21, 0x1.4e1dd6fde8f9dp-25,
+        0x1.a5ee5bac0b26dp-31, -0x1.c72d13bb880eep-34, -0x1.5fc6209b92fd6p-37,
+        -0x1.b686c864d3ee6p-45, 0x1.b3047543b9619p-45, 0x1.296f450a9c2bap-49,
+        -0x1.d6789cce099cbp-53, -0x1.2ceb71d797419p-56
+    },
+    {
+        0x1.0621e2226e5c3p-4, 0x1.c098f42b08343p-5, 0x1.ca65b035f2c8fp-7,
+        0x1.b4ffad70996fap-9, 0x1.821dfff270d1dp-11, 0x1.396b3979d383fp-13,
+        0x1.cdab5821efa44p-16, 0x1.2eccc97900109p-18, 0x1.56e1322b8e006p-21,
+        0x1.3b410cdd5fa79p-24, 0x1.8e236f10b23cdp-28, 0x1.122703c30f398p-34,
+        -0x1.2c005ac2ad341p-34, -0x1.866dc64f9c1c7p-37, -0x1.113a4c46e8a27p-41,
+        0x1.17da462587126p-43, 0x1.93bc07b7ae14fp-46
+    }
+};
+
+/* R(y) = lgamma(y) / ((y - 1) (y - 2)) on [1, 1.5), [1.5, 2) and [2, 3),
+   in s = (y - c) / h, with the rows {low, high, c, 1 / h} of the bounds */
+static const double vm_lgamma_bounds[3][4] = {
+    {1.0, 1.5, 1.25, 4.0}, {1.5, 2.0, 1.75, 4.0}, {2.0, 3.0, 2.5, 2.0}
+};
+static const double vm_lgamma_poly[3][17] = {
+    {
+        0x1.0c58fe25dca2cp-1, -0x1.79f9bf0adea8dp-5, 0x1.83575d02c83bep-8,
+        -0x1.ccfde37c04686p-11, 0x1.28367ed88c3a9p-13, -0x1.8e4684a8434f1p-16,
+        0x1.13b466d35a91ap-18, -0x1.858dc67c49c09p-21, 0x1.1759df544285ep-23,
+        -0x1.954521c43b61ap-26, 0x1.28abf8639f74cp-28, -0x1.b5c21815c59eep-31,
+        0x1.44e1d6520afcdp-33, -0x1.df7b7c8dcb08ap-36, 0x1.6755695536c14p-38,
+        -0x1.3eeef4eadb456p-40, 0x1.e22b68bcae7cbp-43
+    },
+    {
+        0x1.ccf151e09cde8p-2, -0x1.e96586307946ep-6, 0x1.6cb6251711902p-9,
+        -0x1.382e176f60b21p-12, 0x1.1f9587fa1dab7p-15, -0x1.14f7c58ea8137p-18,
+        0x1.12aa72f79a449p-21, -0x1.16056279b24e8p-24, 0x1.1daed5bb4d2a9p-27,
+        -0x1.28f25f46cebb8p-30, 0x1.37765f53056e9p-33, -0x1.491b660598863p-36,
+        0x1.5ddb2852886f8p-39, -0x1.74d4c371fa690p-42, 0x1.901e99a0086c8p-45,
+        -0x1.d37773f875e6ep-48, 0x1.f98b9e72b500cp-51
+    },
+    {
+        0x1.84afe00cddfdfp-2, -0x1.31d26e932300fp-5, 0x1.462044b0af66fp-8,
+        -0x1.8a722dfc5e8b7p-11, 0x1.feef08b133995p-14, -0x1.59511fff10c94p-16,
+        0x1.e05c3c3939309p-19, -0x1.5501ac6d32794p-21, 0x1.eb8f7679dae04p-24,
+        -0x1.666fe83c397adp-26, 0x1.07c6f47198790p-28, -0x1.87425c30165f5p-31,
+        0x1.23d8f42f9b7aap-33, -0x1.b0bcc001dae26p-36, 0x1.45cd99744a0f0p-38,
+        -0x1.22d6fdd22620ep-40, 0x1.b9756a3c95d9ap-43
+    }
+};
+
+/* Stirling's series: B(2 k) / (2 k (2 k - 1)) */
+static const double vm_stirling[9] = {
+    0x1.5555555555555p-4, -0x1.6c16c16c16c17p-9, 0x1.a01a01a01a01ap-11,
+    -0x1.3813813813814p-11, 0x1.b951e2b18ff23p-11, -0x1.f6ab0d9993c7dp-10,
+    0x1.a41a41a41a41ap-8, -0x1.e4286cb0f5398p-6, 0x1.6fe96381e0680p-3
+};
+
+typedef double vm_v4df __attribute__((vector_size(32)));
+typedef long long vm_v4di __attribute__((vector_size(32)));
+typedef double vm_v8df __attribute__((vector_size(64)));
+typedef long long vm_v8di __attribute__((vector_size(64)));
+
+#define VM_W 4
+#define VM_V vm_v4df
+#define VM_I vm_v4di
+#define VM_TARGET "avx2,fma"
+#define VM_FMS(a, b, c) \
+    ((VM_V) _mm256_fmsub_pd((__m256d) (a), (__m256d) (b), (__m256d) (c)))
+#define VM_NAME(F) vm_##F##_avx2
+#include "_vectormath_kernels.h"
+#undef VM_W
+#undef VM_V
+#undef VM_I
+#undef VM_TARGET
+#undef VM_FMS
+#undef VM_NAME
+
+#define VM_W 8
+#define VM_V vm_v8df
+#define VM_I vm_v8di
+#define VM_TARGET "avx512f"
+#define VM_FMS(a, b, c) \
+    ((VM_V) _mm512_fmsub_pd((__m512d) (a), (__m512d) (b), (__m512d) (c)))
+#define VM_NAME(F) vm_##F##_avx512
+#include "_vectormath_kernels.h"
+#undef VM_W
+#undef VM_V
+#undef VM_I
+#undef VM_TARGET
+#undef VM_FMS
+#undef VM_NAME
+
+/* 4 x double and 8 x float for AVX2, 8 x double and 16 x float for
+   AVX-512F.  The float variants compute each half of their argument
+   with the double kernel. */
+#define VECTOR_MATH_UNARY(F, FF)                                          \
+    NUMBA_EXPORT_FUNC(__m256d) __attribute__((target("avx2,fma")))        \
+    numba_##F##_v4(__m256d a)                                             \
+    {                                                                     \
+        return (__m256d) vm_##F##_avx2((vm_v4df) a);                      \
+    }                                                                     \
+    NUMBA_EXPORT_FUNC(__m512d) __attribute__((target("avx512f")))         \
+    numba_##F##_v8(__m512d a)                                             \
+    {                                                                     \
+        return (__m512d) vm_##F##_avx512((vm_v8df) a);                    \
+    }                                                                     \
+    NUMBA_EXPORT_FUNC(__m256) __attribute__((target("avx2,fma")))         \
+    numba_##FF##_v8(__m256 a)                                             \
+    {                                                                     \
+        __m256d lo = _mm256_cvtps_pd(_mm256_castps256_ps128(a));          \
+        __m256d hi = _mm256_cvtps_pd(_mm256_extractf128_ps(a, 1));        \
+        lo = (__m256d) vm_##F##_avx2((vm_v4df) lo);                       \
+        hi = (__m256d) vm_##F##_avx2((vm_v4df) hi);                       \
+        return _mm256_insertf128_ps(                                      \
+            _mm256_castps128_ps256(_mm256_cvtpd_ps(lo)),                  \
+            _mm256_cvtpd_ps(hi), 1);                                      \
+    }                                                                     \
+    NUMBA_EXPORT_FUNC(__m512) __attribute__((target("avx512f")))          \
+    numba_##FF##_v16(__m512 a)                                            \
+    {                                                                     \
+        __m512d lo = _mm512_cvtps_pd(_mm512_castps512_ps256(a));          \
+        __m512d hi = _mm512_cvtps_pd((__m256) _mm512_extractf64x4_pd(     \
+            _mm512_castps_pd(a), 1));                                     \
+        lo = (__m512d) vm_##F##_avx512((vm_v8df) lo);                     \
+        hi = (__m512d) vm_##F##_avx512((vm_v8df) hi);                     \
+        return _mm512_castpd_ps(_mm512_insertf64x4(                       \
+            _mm512_castpd256_pd512((__m256d) _mm512_cvtpd_ps(lo)),        \
+            (__m256d) _mm512_cvtpd_ps(hi), 1));                           \
+    }
+
+#include "vectormathnames.h"
+
+#undef VECTOR_MATH_UNARY
+
+#endif
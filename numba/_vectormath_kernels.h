@@ -0,0 +1,221 @@
+/*
+ * Vector math kernels, included by _vectormath.c once for each vector
+ * type.  The includer defines:
+ *  - VM_W, VM_V and VM_I: the width, and the vector types of VM_W doubles
+ *    and of VM_W 64-bit integers;
+ *  - VM_TARGET: the target features the kernels are compiled for;
+ *  - VM_FMS(a, b, c): a * b - c, computed with a single rounding;
+ *  - VM_NAME(F): the name of the kernel F for these types.
+ *
+ * The kernels compute all the lanes with vector operations, except for
+ * lgamma() of the arguments that aren't positive, normal and finite, which
+ * are passed to the scalar function as glibc's libmvec does for the special
+ * cases.
+ */
+
+#define VM_FUNC static inline __attribute__((always_inline, target(VM_TARGET)))
+
+VM_FUNC VM_V
+VM_NAME(splat)(double v)
+{
+    VM_V r = {0};
+    return r + v;
+}
+
+VM_FUNC VM_V
+VM_NAME(select)(VM_I mask, VM_V a, VM_V b)
+{
+    return (VM_V) (((VM_I) a & mask) | ((VM_I) b & ~mask));
+}
+
+VM_FUNC int
+VM_NAME(any)(VM_I mask)
+{
+    long long acc = 0;
+    int i;
+    for (i = 0; i < VM_W; i++)
+        acc |= mask[i];
+    return acc != 0;
+}
+
+VM_FUNC VM_V
+VM_NAME(poly)(VM_V s, const double *coefs, int n)
+{
+    VM_V r = VM_NAME(splat)(coefs[n - 1]);
+    int i;
+    for (i = n - 2; i >= 0; i--)
+        r = r * s + coefs[i];
+    return r;
+}
+
+/* exp(a) for a <= 0 */
+VM_FUNC VM_V
+VM_NAME(exp_neg)(VM_V a)
+{
+    VM_V n, r, p;
+    VM_I k, k1;
+    a = VM_NAME(select)((VM_I) (a < -746.0), VM_NAME(splat)(-746.0), a);
+    /* a = n log(2) + r, |r| <= log(2) / 2 */
+    n = (a * VM_LOG2E + VM_MAGIC) - VM_MAGIC;
+    r = (a - n * VM_LN2_HI) - n * VM_LN2_LO;
+    p = VM_NAME(poly)(r, vm_exp_poly, VM_ARRAY_SIZE(vm_exp_poly));
+    /* scale by 2**n in two steps, as 2**n may be subnormal */
+    k = (VM_I) (n + VM_MAGIC) - (VM_I) VM_NAME(splat)(VM_MAGIC);
+    k1 = k >> 1;
+    k = k - k1;
+    p = p * (VM_V) ((k1 + 1023) << 52);
+    return p * (VM_V) ((k + 1023) << 52);
+}
+
+/* log(x) for normal, positive and finite x */
+VM_FUNC VM_V
+VM_NAME(log)(VM_V x)
+{
+    VM_I bits = (VM_I) x;
+    VM_I mant = bits & 0x000fffffffffffffLL;
+    VM_I e = (bits >> 52) - 1023;
+    /* x = 2**e m with sqrt(2) / 2 <= m < sqrt(2) */
+    VM_I half = (VM_I) (mant > 0x6a09e667f3bcdLL);
+    VM_V f, s, z, hfsq, R, de;
+    e = e - half;
+    mant |= 0x3ff0000000000000LL ^ (half & 0x0010000000000000LL);
+    f = (VM_V) mant - 1.0;
+    /* log(1 + f) = f - f**2 / 2 + s (f**2 / 2 + R(s**2)) with
+       s = f / (2 + f) */
+    s = f / (2.0 + f);
+    z = s * s;
+    R = z * VM_NAME(poly)(z, vm_log_poly, VM_ARRAY_SIZE(vm_log_poly));
+    hfsq = 0.5 * f * f;
+    de = (VM_V) (e + (VM_I) VM_NAME(splat)(VM_MAGIC)) - VM_MAGIC;
+    return de * VM_LN2_HI - ((hfsq - (s * (hfsq + R) + de * VM_LN2_LO)) - f);
+}
+
+/* erfc(x) for x >= 0.5 */
+VM_FUNC VM_V
+VM_NAME(erfc_pos)(VM_V x)
+{
+    VM_V xe, p, s, q, hi, lo;
+    int i;
+    xe = VM_NAME(select)((VM_I) (x < 27.5), x, VM_NAME(splat)(27.5));
+    /* erfc(x) = exp(-x**2) erfcx(x), with erfcx(x) approximated on each
+       piece in s = k (xc - x) / (x + 4) */
+    p = VM_NAME(splat)(0.0);
+    for (i = 0; i < VM_ARRAY_SIZE(vm_erfcx_bounds); i++) {
+        VM_I mask = (VM_I) (xe >= vm_erfcx_bounds[i]);
+        if (i + 1 < VM_ARRAY_SIZE(vm_erfcx_bounds))
+            mask &= (VM_I) (xe < vm_erfcx_bounds[i + 1]);
+        if (!VM_NAME(any)(mask))
+            continue;
+        s = vm_erfcx_k[i] * (vm_erfcx_xc[i] - xe) / (xe + 4.0);
+        q = VM_NAME(poly)(s, vm_erfcx_poly[i],
+                          VM_ARRAY_SIZE(vm_erfcx_poly[i]));
+        p = VM_NAME(select)(mask, q, p);
+    }
+    /* exp(-x**2) = exp(-hi) exp(-lo) */
+    hi = xe * xe;
+    lo = VM_FMS(xe, xe, hi);
+    return p * (VM_NAME(exp_neg)(-hi) * (1.0 - lo));
+}
+
+/* erf(x) / x for |x| < 0.5 */
+VM_FUNC VM_V
+VM_NAME(erf_small)(VM_V x)
+{
+    return VM_NAME(poly)(8.0 * x * x - 1.0, vm_erf_small,
+                         VM_ARRAY_SIZE(vm_erf_small));
+}
+
+VM_FUNC VM_V
+VM_NAME(erf)(VM_V x)
+{
+    VM_I sign = (VM_I) x & (long long) 0x8000000000000000ULL;
+    VM_V ax = (VM_V) ((VM_I) x ^ sign);
+    VM_I small = (VM_I) (ax < 0.5);
+    VM_V r = VM_NAME(splat)(0.0);
+    if (VM_NAME(any)(~small)) {
+        r = 1.0 - VM_NAME(erfc_pos)(VM_NAME(select)(small,
+                                                    VM_NAME(splat)(0.5), ax));
+        r = (VM_V) ((VM_I) r | sign);
+    }
+    if (VM_NAME(any)(small))
+        r = VM_NAME(select)(small, x * VM_NAME(erf_small)(x), r);
+    return VM_NAME(select)((VM_I) (x != x), x, r);
+}
+
+VM_FUNC VM_V
+VM_NAME(erfc)(VM_V x)
+{
+    VM_I sign = (VM_I) x & (long long) 0x8000000000000000ULL;
+    VM_V ax = (VM_V) ((VM_I) x ^ sign);
+    VM_I small = (VM_I) (ax < 0.5);
+    VM_V r = VM_NAME(splat)(0.0);
+    if (VM_NAME(any)(~small)) {
+        VM_V e = VM_NAME(erfc_pos)(VM_NAME(select)(small,
+                                                   VM_NAME(splat)(0.5), ax));
+        r = VM_NAME(select)((VM_I) (x < 0.0), 2.0 - e, e);
+    }
+    if (VM_NAME(any)(small))
+        r = VM_NAME(select)(small, 1.0 - x * VM_NAME(erf_small)(x), r);
+    return VM_NAME(select)((VM_I) (x != x), x, r);
+}
+
+VM_FUNC VM_V
+VM_NAME(lgamma)(VM_V x)
+{
+    VM_I fast = (VM_I) (x >= 0x1p-1022) & (VM_I) (x < INFINITY);
+    VM_I big;
+    VM_V xf, r;
+    int i;
+    xf = VM_NAME(select)(fast, x, VM_NAME(splat)(1.0));
+    r = VM_NAME(splat)(0.0);
+    big = (VM_I) (xf >= 8.0);
+    if (VM_NAME(any)(~big)) {
+        /* lgamma(x) = (y - 1) (y - 2) R(y) + log(prod) with 1 <= y < 3:
+           y = x + 1 and prod = 1 / x for x < 1, and y = x - k and
+           prod = (x - 1) ... (x - k) for x >= 3 */
+        VM_I lt1 = (VM_I) (xf < 1.0);
+        VM_V y = VM_NAME(select)(lt1, xf + 1.0, xf);
+        VM_V prod = VM_NAME(select)(lt1, xf, VM_NAME(splat)(1.0));
+        VM_V a, b, p, corr;
+        for (i = 0; i < 5; i++) {
+            VM_I mask = (VM_I) (y >= 3.0);
+            y = VM_NAME(select)(mask, y - 1.0, y);
+            prod = VM_NAME(select)(mask, prod * y, prod);
+        }
+        /* y - 1 and y - 2, computed exactly from x */
+        a = VM_NAME(select)(lt1, xf, y - 1.0);
+        b = VM_NAME(select)(lt1, xf - 1.0, y - 2.0);
+        p = VM_NAME(splat)(0.0);
+        for (i = 0; i < VM_ARRAY_SIZE(vm_lgamma_bounds); i++) {
+            VM_I mask = (VM_I) (y >= vm_lgamma_bounds[i][0])
+                        & (VM_I) (y < vm_lgamma_bounds[i][1]);
+            VM_V s, q;
+            if (!VM_NAME(any)(mask))
+                continue;
+            s = (y - vm_lgamma_bounds[i][2]) * vm_lgamma_bounds[i][3];
+            q = VM_NAME(poly)(s, vm_lgamma_poly[i],
+                              VM_ARRAY_SIZE(vm_lgamma_poly[i]));
+            p = VM_NAME(select)(mask, q, p);
+        }
+        corr = VM_NAME(log)(prod);
+        r = a * b * p + VM_NAME(select)(lt1, -corr, corr);
+    }
+    if (VM_NAME(any)(big)) {
+        /* Stirling's series */
+        VM_V z = 1.0 / xf;
+        VM_V w = z * VM_NAME(poly)(z * z, vm_stirling,
+                                   VM_ARRAY_SIZE(vm_stirling));
+        VM_V st = (xf - 0.5) * (VM_NAME(log)(xf) - 1.0)
+                  + (VM_HALF_LOG_2PI_M_HALF + w);
+        r = VM_NAME(select)(big, st, r);
+    }
+    if (VM_NAME(any)(~fast)) {
+        for (i = 0; i < VM_W; i++) {
+            if (!fast[i])
+                r[i] = lgamma(x[i]);
+        }
+    }
+    return r;
+}
+
+#undef VM_FUNC
@@ -277,6 +277,7 @@ int mem_cmp_zeros(void *obj, size_t n){
 
 #define D_MASK(dk) ((dk)->size-1)
 #define D_GROWTH_RATE(d) ((d)->used*3)
+#define SWISS_GROWTH_RATE(d) ((d)->used*2)
 
 static int
 ix_size(Py_ssize_t size) {
@@ -357,6 +358,242 @@ set_index(NB_DictKeys *dk, Py_ssize_t i, Py_ssize_t ix)
 }
 
 
+/*
+Swiss layout
+
+Each slot has a control byte alongside its index, which is either
+D_CTRL_EMPTY, D_CTRL_DELETED or, for a slot in use, 7 bits of the hash of the
+entry it indexes. The slots are probed by groups of D_GROUP_WIDTH slots, laid
+out as their control bytes followed by their indices: all the control bytes
+of a group are compared to that of the hash at once, so that only the slots
+likely to hold the key load their entry, and a group with an empty slot ends
+the probing.
+
+The groups are visited in the same order as the slots of the compact layout
+(see above), which keeps the locality of integer keys, whose hashes are the
+integers, while the control byte is taken from bits independent of those
+picking the group.
+
+D_CTRL_EMPTY being 0xff, the tables are allocated with all slots empty.
+*/
+#define D_GROUP_WIDTH 16
+#define D_SWISS_MINSIZE D_GROUP_WIDTH
+#define D_CTRL_EMPTY ((unsigned char)0xff)
+#define D_CTRL_DELETED ((unsigned char)0x80)
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define D_USE_SSE2
+#   include <emmintrin.h>
+#endif
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#endif
+
+/* Hint the processor to move the cache line at *ptr* in the cache */
+#if defined(_MSC_VER)
+#   if defined(_M_X64) || defined(_M_IX86)
+#       define D_PREFETCH(ptr) _mm_prefetch((const char*)(ptr), _MM_HINT_T0)
+#   else
+#       define D_PREFETCH(ptr) ((void)(ptr))
+#   endif
+#else
+#   define D_PREFETCH(ptr) __builtin_prefetch(ptr)
+#endif
+
+/* Force the inlining of the probing kernels into their callers, which call
+   them with a constant key size so that they get specialized for it */
+#if defined(_MSC_VER)
+#   define D_INLINE static __forceinline
+#elif defined(__GNUC__)
+#   define D_INLINE static inline __attribute__((always_inline))
+#else
+#   define D_INLINE static inline
+#endif
+
+/* A bitmask of the slots of a group */
+typedef unsigned int group_mask_t;
+
+static int dict_default_layout = D_LAYOUT_COMPACT;
+
+/* The slots of the group at *ctrl* whose control byte is *c* */
+static group_mask_t
+group_match(const unsigned char *ctrl, unsigned char c) {
+#ifdef D_USE_SSE2
+    __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+    return (group_mask_t)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(group, _mm_set1_epi8((char)c)));
+#else
+    group_mask_t mask = 0;
+    int i;
+    for (i = 0; i < D_GROUP_WIDTH; ++i) {
+        mask |= (group_mask_t)(ctrl[i] == c) << i;
+    }
+    return mask;
+#endif
+}
+
+/* The slots of the group at *ctrl* that are empty or deleted, which are the
+ * ones whose control byte has the high bit set */
+static group_mask_t
+group_match_free(const unsigned char *ctrl) {
+#ifdef D_USE_SSE2
+    return (group_mask_t)_mm_movemask_epi8(
+        _mm_loadu_si128((const __m128i *)ctrl));
+#else
+    group_mask_t mask = 0;
+    int i;
+    for (i = 0; i < D_GROUP_WIDTH; ++i) {
+        mask |= (group_mask_t)(ctrl[i] >> 7) << i;
+    }
+    return mask;
+#endif
+}
+
+/* The position of the lowest slot of a non-empty mask */
+static Py_ssize_t
+group_mask_lowest(group_mask_t mask) {
+#if defined(_MSC_VER)
+    unsigned long pos;
+    _BitScanForward(&pos, mask);
+    return (Py_ssize_t)pos;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+/* The control byte of a hash, the high bits of its product with an odd
+ * constant */
+static unsigned char
+swiss_ctrl(Py_hash_t hash) {
+    return (unsigned char)(((uint64_t)hash * 0x9E3779B97F4A7C15ULL) >> 57);
+}
+
+/* The control bytes of group *g*, which are followed by its indices */
+static unsigned char *
+swiss_group(NB_DictKeys *dk, size_t g) {
+    return (unsigned char*)dk->indices + g * dk->group_size;
+}
+
+/* Lookup the index of the *j*-th slot of a group */
+static Py_ssize_t
+group_get_index(NB_DictKeys *dk, const unsigned char *group, Py_ssize_t j) {
+    const char *indices = (const char*)group + D_GROUP_WIDTH;
+    switch (dk->group_size / D_GROUP_WIDTH) {
+    case 2:
+        return ((const int8_t*)indices)[j];
+    case 3:
+        return ((const int16_t*)indices)[j];
+    case 5:
+        return ((const int32_t*)indices)[j];
+    default:
+        return (Py_ssize_t)((const int64_t*)indices)[j];
+    }
+}
+
+/* Write the index of the *j*-th slot of a group */
+static void
+group_set_index(NB_DictKeys *dk, unsigned char *group, Py_ssize_t j, Py_ssize_t ix) {
+    char *indices = (char*)group + D_GROUP_WIDTH;
+    switch (dk->group_size / D_GROUP_WIDTH) {
+    case 2:
+        assert(ix <= 0x7f);
+        ((int8_t*)indices)[j] = (int8_t)ix;
+        break;
+    case 3:
+        assert(ix <= 0x7fff);
+        ((int16_t*)indices)[j] = (int16_t)ix;
+        break;
+    case 5:
+        assert(ix <= 0x7fffffff);
+        ((int32_t*)indices)[j] = (int32_t)ix;
+        break;
+    default:
+        ((int64_t*)indices)[j] = ix;
+    }
+}
+
+static size_t
+swiss_group_mask(NB_DictKeys *dk) {
+    return (size_t)dk->size / D_GROUP_WIDTH - 1;
+}
+
+/* Swiss layout version of find_empty_slot() */
+static Py_ssize_t
+swiss_find_free_slot(NB_DictKeys *dk, Py_hash_t hash) {
+    size_t gmask = swiss_group_mask(dk);
+    size_t perturb = (size_t)hash;
+    size_t g = (size_t)hash & gmask;
+    for (;;) {
+        group_mask_t avail = group_match_free(swiss_group(dk, g));
+        if (avail) {
+            return g * D_GROUP_WIDTH + group_mask_lowest(avail);
+        }
+        perturb >>= PERTURB_SHIFT;
+        g = (g*5 + perturb + 1) & gmask;
+    }
+}
+
+/* Swiss layout version of lookdict_index() */
+static Py_ssize_t
+swiss_lookup_index(NB_DictKeys *dk, Py_hash_t hash, Py_ssize_t index) {
+    unsigned char ctrl = swiss_ctrl(hash);
+    size_t gmask = swiss_group_mask(dk);
+    size_t perturb = (size_t)hash;
+    size_t g = (size_t)hash & gmask;
+    for (;;) {
+        const unsigned char *group = swiss_group(dk, g);
+        group_mask_t match = group_match(group, ctrl);
+        for (; match; match &= match - 1) {
+            Py_ssize_t j = group_mask_lowest(match);
+            if (group_get_index(dk, group, j) == index) {
+                return g * D_GROUP_WIDTH + j;
+            }
+        }
+        if (group_match(group, D_CTRL_EMPTY)) {
+            return DKIX_EMPTY;
+        }
+        perturb >>= PERTURB_SHIFT;
+        g = (g*5 + perturb + 1) & gmask;
+    }
+}
+
+#ifndef NDEBUG
+/* NOTE: This function is only used in assert()s */
+/* Lookup the index of slot *i* in either layout */
+static Py_ssize_t
+dk_get_index(NB_DictKeys *dk, Py_ssize_t i) {
+    if (dk->layout == D_LAYOUT_SWISS) {
+        return group_get_index(dk, swiss_group(dk, i / D_GROUP_WIDTH),
+                               i % D_GROUP_WIDTH);
+    }
+    return get_index(dk, i);
+}
+#endif
+
+/* Point slot *i* of the hash table at the entry *ix* of hash *hash* */
+static void
+set_slot(NB_DictKeys *dk, Py_ssize_t i, Py_ssize_t ix, Py_hash_t hash) {
+    if (dk->layout == D_LAYOUT_SWISS) {
+        unsigned char *group = swiss_group(dk, i / D_GROUP_WIDTH);
+        group[i % D_GROUP_WIDTH] = swiss_ctrl(hash);
+        group_set_index(dk, group, i % D_GROUP_WIDTH, ix);
+    } else {
+        set_index(dk, i, ix);
+    }
+}
+
+/* Mark slot *i* of the hash table as deleted */
+static void
+clear_slot(NB_DictKeys *dk, Py_ssize_t i) {
+    if (dk->layout == D_LAYOUT_SWISS) {
+        swiss_group(dk, i / D_GROUP_WIDTH)[i % D_GROUP_WIDTH] = D_CTRL_DELETED;
+    } else {
+        set_index(dk, i, DKIX_DUMMY);
+    }
+}
+
+
 /* USABLE_FRACTION is the maximum dictionary load.
  * Increasing this ratio makes dictionaries more dense resulting in more
  * collisions.  Decreasing it improves sparseness at the expense of spreading
@@ -370,6 +607,12 @@ set_index(NB_DictKeys *dk, Py_ssize_t i, Py_ssize_t ix)
  */
 #define USABLE_FRACTION(n) (((n) << 1)/3)
 
+/* The maximum load of the swiss layout, which degrades much more gracefully
+ * than the compact one as it gets fuller. It leaves at least 2 free slots in
+ * the smallest table of D_SWISS_MINSIZE slots.
+ */
+#define SWISS_USABLE_FRACTION(n) ((n) - ((n) >> 3))
+
 /* Alternative fraction that is otherwise close enough to 2n/3 to make
  * little difference. 8 * 2/3 == 8 * 5/8 == 5. 16 * 2/3 == 16 * 5/8 == 10.
  * 32 * 2/3 = 21, 32 * 5/8 = 20.
@@ -426,11 +669,65 @@ static int
 key_equal(NB_DictKeys *dk, const char *lhs, const char *rhs) {
     if ( dk->methods.key_equal ) {
         return dk->methods.key_equal(lhs, rhs);
-    } else {
-        return memcmp(lhs, rhs, dk->key_size) == 0;
+    }
+    /* The common word sized keys are compared inline */
+    if ( dk->key_size == sizeof(int64_t) ) {
+        int64_t a, b;
+        memcpy(&a, lhs, sizeof(a));
+        memcpy(&b, rhs, sizeof(b));
+        return a == b;
+    }
+    return memcmp(lhs, rhs, dk->key_size) == 0;
+}
+
+/* Bitwise comparison of plain data keys of *size* bytes, one of the sizes
+   of NB_DictKeys.pod_key_size */
+D_INLINE int
+pod_key_equal(const char *lhs, const char *rhs, Py_ssize_t size) {
+    if ( size == 4 ) {
+        uint32_t a, b;
+        memcpy(&a, lhs, sizeof(a));
+        memcpy(&b, rhs, sizeof(b));
+        return a == b;
+    }
+    if ( size == 8 ) {
+        uint64_t a, b;
+        memcpy(&a, lhs, sizeof(a));
+        memcpy(&b, rhs, sizeof(b));
+        return a == b;
+    }
+    {
+        uint64_t a[2], b[2];
+        assert ( size == 16 );
+        memcpy(a, lhs, sizeof(a));
+        memcpy(b, rhs, sizeof(b));
+        return ((a[0] ^ b[0]) | (a[1] ^ b[1])) == 0;
+    }
+}
+
+/* The key size selecting the specialized kernels, see
+   NB_DictKeys.pod_key_size */
+static Py_ssize_t
+dk_pod_key_size(NB_DictKeys *dk) {
+    type_based_methods_table *m = &dk->methods;
+    if ( m->key_equal || m->key_incref || m->key_decref ||
+         m->value_incref || m->value_decref ) {
+        return 0;
+    }
+    switch ( dk->key_size ) {
+    case 4: case 8: case 16:
+        return dk->key_size;
+    default:
+        return 0;
     }
 }
 
+static void
+dk_set_methods(NB_DictKeys *dk, const type_based_methods_table *methods) {
+    memcpy(&dk->methods, methods, sizeof(type_based_methods_table));
+    dk->pod_key_size = dk_pod_key_size(dk);
+}
+
 static char *
 entry_get_key(NB_DictKeys *dk, NB_DictEntry* entry) {
     char * out = entry->keyvalue;
@@ -507,14 +804,28 @@ numba_dict_length(NB_Dict *d) {
 Adapted from CPython's new_keys_object().
 */
 int
-numba_dictkeys_new(NB_DictKeys **out, Py_ssize_t size, Py_ssize_t key_size, Py_ssize_t val_size) {
-    Py_ssize_t usable = USABLE_FRACTION(size);
-    Py_ssize_t index_size = ix_size(size);
-    Py_ssize_t entry_size = aligned_size(sizeof(NB_DictEntry) + aligned_size(key_size) + aligned_size(val_size));
-    Py_ssize_t entry_offset = aligned_size(index_size * size);
-    Py_ssize_t alloc_size = sizeof(NB_DictKeys) + entry_offset + entry_size * usable;
-
-    NB_DictKeys *dk = malloc(aligned_size(alloc_size));
+numba_dictkeys_new(NB_DictKeys **out, Py_ssize_t size, Py_ssize_t key_size, Py_ssize_t val_size, int layout) {
+    Py_ssize_t usable, index_size, entry_size, group_size, entry_offset;
+    Py_ssize_t alloc_size;
+    NB_DictKeys *dk;
+
+    assert ( layout == D_LAYOUT_COMPACT || layout == D_LAYOUT_SWISS );
+    if ( layout == D_LAYOUT_SWISS && size < D_SWISS_MINSIZE ) {
+        size = D_SWISS_MINSIZE;
+    }
+    usable = (layout == D_LAYOUT_SWISS ? SWISS_USABLE_FRACTION(size)
+                                       : USABLE_FRACTION(size));
+    index_size = ix_size(size);
+    entry_size = aligned_size(sizeof(NB_DictEntry) + aligned_size(key_size) + aligned_size(val_size));
+    /* The swiss layout interleaves the control bytes and the indices by
+       groups, so that a probe finds both in the same cache line */
+    group_size = D_GROUP_WIDTH * (1 + index_size);
+    entry_offset = aligned_size(layout == D_LAYOUT_SWISS
+                                ? group_size * (size / D_GROUP_WIDTH)
+                                : index_size * size);
+    alloc_size = sizeof(NB_DictKeys) + entry_offset + entry_size * usable;
+
+    dk = malloc(aligned_size(alloc_size));
     if (!dk) return ERR_NO_MEMORY;
 
     assert ( size >= D_MINSIZE );
@@ -526,10 +837,13 @@ numba_dictkeys_new(NB_DictKeys **out, Py_ssize_t size, Py_ssize_t key_size, Py_s
     dk->val_size = val_size;
     dk->entry_offset = entry_offset;
     dk->entry_size = entry_size;
+    dk->layout = layout;
+    dk->group_size = group_size;
 
     assert (aligned_pointer(dk->indices) == dk->indices );
     /* Ensure that the method table is all nulls */
     memset(&dk->methods, 0x00, sizeof(type_based_methods_table));
+    dk->pod_key_size = dk_pod_key_size(dk);
     /* Ensure hash is (-1) for empty entry */
     memset(dk->indices, 0xff, entry_offset + entry_size * usable);
 
@@ -540,10 +854,10 @@ numba_dictkeys_new(NB_DictKeys **out, Py_ssize_t size, Py_ssize_t key_size, Py_s
 
 /* Allocate new dictionary */
 int
-numba_dict_new(NB_Dict **out, Py_ssize_t size, Py_ssize_t key_size, Py_ssize_t val_size) {
+numba_dict_new_layout(NB_Dict **out, Py_ssize_t size, Py_ssize_t key_size, Py_ssize_t val_size, int layout) {
     NB_DictKeys* dk;
     NB_Dict *d;
-    int status = numba_dictkeys_new(&dk, size, key_size, val_size);
+    int status = numba_dictkeys_new(&dk, size, key_size, val_size, layout);
     if (status != OK) return status;
 
     d = malloc(sizeof(NB_Dict));
@@ -558,6 +872,26 @@ numba_dict_new(NB_Dict **out, Py_ssize_t size, Py_ssize_t key_size, Py_ssize_t v
     return OK;
 }
 
+int
+numba_dict_new(NB_Dict **out, Py_ssize_t size, Py_ssize_t key_size, Py_ssize_t val_size) {
+    return numba_dict_new_layout(out, size, key_size, val_size, dict_default_layout);
+}
+
+int
+numba_dict_set_default_layout(int layout) {
+    int previous = dict_default_layout;
+    if (layout != D_LAYOUT_COMPACT && layout != D_LAYOUT_SWISS) {
+        return -1;
+    }
+    dict_default_layout = layout;
+    return previous;
+}
+
+int
+numba_dict_layout(NB_Dict *d) {
+    return (int)d->keys->layout;
+}
+
 /*
 Adapted from CPython lookdict_index().
 
@@ -570,6 +904,9 @@ lookdict_index(NB_DictKeys *dk, Py_hash_t hash, Py_ssize_t index)
     size_t perturb = (size_t)hash;
     size_t i = (size_t)hash & mask;
 
+    if (dk->layout == D_LAYOUT_SWISS) {
+        return swiss_lookup_index(dk, hash, index);
+    }
     for (;;) {
         Py_ssize_t ix = get_index(dk, i);
         if (ix == index) {
@@ -611,10 +948,54 @@ lookdict_unicode_nodummy is further specialized for string keys that cannot be
 the <dummy> value.
 For both, when the key isn't found a DKIX_EMPTY is returned.
 */
-Py_ssize_t
-numba_dict_lookup(NB_Dict *d, const char *key_bytes, Py_hash_t hash, char *oldval_bytes)
+
+/* Swiss layout version of numba_dict_lookup(). A nonzero *pod_key_size*,
+   which must be a constant, compares the keys inline as plain data. */
+D_INLINE Py_ssize_t
+swiss_lookup(NB_DictKeys *dk, const char *key_bytes, Py_hash_t hash, char *oldval_bytes,
+             Py_ssize_t pod_key_size)
+{
+    unsigned char ctrl = swiss_ctrl(hash);
+    size_t gmask = swiss_group_mask(dk);
+    size_t perturb = (size_t)hash;
+    size_t g = (size_t)hash & gmask;
+
+    for (;;) {
+        const unsigned char *group = swiss_group(dk, g);
+        group_mask_t match = group_match(group, ctrl);
+        for (; match; match &= match - 1) {
+            Py_ssize_t ix = group_get_index(dk, group, group_mask_lowest(match));
+            NB_DictEntry *ep = get_entry(dk, ix);
+            if (ep->hash == hash) {
+                int cmp = (pod_key_size
+                           ? pod_key_equal(entry_get_key(dk, ep), key_bytes, pod_key_size)
+                           : key_equal(dk, entry_get_key(dk, ep), key_bytes));
+                if (cmp < 0) {
+                    // error'ed in comparison
+                    memset(oldval_bytes, 0, dk->val_size);
+                    return DKIX_ERROR;
+                }
+                if (cmp > 0) {
+                    // key is equal; retrieve the value.
+                    copy_val(dk, oldval_bytes, entry_get_val(dk, ep));
+                    return ix;
+                }
+            }
+        }
+        if (group_match(group, D_CTRL_EMPTY)) {
+            zero_val(dk, oldval_bytes);
+            return DKIX_EMPTY;
+        }
+        perturb >>= PERTURB_SHIFT;
+        g = (g*5 + perturb + 1) & gmask;
+    }
+}
+
+/* Compact layout version of numba_dict_lookup(), see swiss_lookup() */
+D_INLINE Py_ssize_t
+compact_lookup(NB_DictKeys *dk, const char *key_bytes, Py_hash_t hash, char *oldval_bytes,
+               Py_ssize_t pod_key_size)
 {
-    NB_DictKeys *dk = d->keys;
     size_t mask = D_MASK(dk);
     size_t perturb = hash;
     size_t i = (size_t)hash & mask;
@@ -632,7 +1013,9 @@ numba_dict_lookup(NB_Dict *d, const char *key_bytes, Py_hash_t hash, char *oldva
                 int cmp;
 
                 startkey = entry_get_key(dk, ep);
-                cmp = key_equal(dk, startkey, key_bytes);
+                cmp = (pod_key_size
+                       ? pod_key_equal(startkey, key_bytes, pod_key_size)
+                       : key_equal(dk, startkey, key_bytes));
                 if (cmp < 0) {
                     // error'ed in comparison
                     memset(oldval_bytes, 0, dk->val_size);
@@ -651,6 +1034,36 @@ numba_dict_lookup(NB_Dict *d, const char *key_bytes, Py_hash_t hash, char *oldva
     assert(0 && "unreachable");
 }
 
+Py_ssize_t
+numba_dict_lookup(NB_Dict *d, const char *key_bytes, Py_hash_t hash, char *oldval_bytes)
+{
+    NB_DictKeys *dk = d->keys;
+
+    /* The kernels are inlined for each of the constant key sizes */
+    if (dk->layout == D_LAYOUT_SWISS) {
+        switch (dk->pod_key_size) {
+        case 4:
+            return swiss_lookup(dk, key_bytes, hash, oldval_bytes, 4);
+        case 8:
+            return swiss_lookup(dk, key_bytes, hash, oldval_bytes, 8);
+        case 16:
+            return swiss_lookup(dk, key_bytes, hash, oldval_bytes, 16);
+        default:
+            return swiss_lookup(dk, key_bytes, hash, oldval_bytes, 0);
+        }
+    }
+    switch (dk->pod_key_size) {
+    case 4:
+        return compact_lookup(dk, key_bytes, hash, oldval_bytes, 4);
+    case 8:
+        return compact_lookup(dk, key_bytes, hash, oldval_bytes, 8);
+    case 16:
+        return compact_lookup(dk, key_bytes, hash, oldval_bytes, 16);
+    default:
+        return compact_lookup(dk, key_bytes, hash, oldval_bytes, 0);
+    }
+}
+
 
 /* Internal function to find slot for an item from its hash
    when it is known that the key is not present in the dict.
@@ -665,6 +1078,9 @@ find_empty_slot(NB_DictKeys *dk, Py_hash_t hash){
 
     assert(dk != NULL);
 
+    if (dk->layout == D_LAYOUT_SWISS) {
+        return swiss_find_free_slot(dk, hash);
+    }
     mask = D_MASK(dk);
     i = hash & mask;
     ix = get_index(dk, i);
@@ -676,12 +1092,75 @@ find_empty_slot(NB_DictKeys *dk, Py_hash_t hash){
     return i;
 }
 
+/* The smallest size whose usable fraction holds *n* entries, to be rounded
+   up to a power of two */
+static Py_ssize_t
+usable_size_for(Py_ssize_t layout, Py_ssize_t n) {
+    if (layout == D_LAYOUT_SWISS) {
+        return (n * 8 + 6) / 7;
+    }
+    return (n * 3 + 1) / 2 + 1;
+}
+
+/* The size of the smallest table of the layout holding *n* entries, or 0 on
+   overflow */
+static Py_ssize_t
+table_size_for(Py_ssize_t layout, Py_ssize_t n) {
+    Py_ssize_t minsize = usable_size_for(layout, n);
+    Py_ssize_t size = (layout == D_LAYOUT_SWISS ? D_SWISS_MINSIZE : D_MINSIZE);
+    while (size < minsize && size > 0) {
+        size <<= 1;
+    }
+    return size > 0 ? size : 0;
+}
+
 static int
 insertion_resize(NB_Dict *d)
 {
+    /* The swiss layout is fuller when it is resized, doubling it keeps
+       about the same range of loads */
+    if (d->keys->layout == D_LAYOUT_SWISS) {
+        return numba_dict_resize(d, SWISS_GROWTH_RATE(d));
+    }
     return numba_dict_resize(d, D_GROWTH_RATE(d));
 }
 
+/* Insert a key that isn't in the dict */
+static int
+insert_new(NB_Dict *d, const char *key_bytes, Py_hash_t hash, const char *val_bytes)
+{
+    NB_DictKeys *dk = d->keys;
+    Py_ssize_t hashpos;
+    NB_DictEntry *ep;
+
+    if (dk->usable <= 0) {
+        /* Need to resize */
+        if (insertion_resize(d) != OK)
+            return ERR_NO_MEMORY;
+        else
+            dk = d->keys;     // reload
+    }
+    hashpos = find_empty_slot(dk, hash);
+    ep = get_entry(dk, dk->nentries);
+    set_slot(dk, hashpos, dk->nentries, hash);
+    copy_key(dk, entry_get_key(dk, ep), key_bytes);
+    assert ( hash != -1 );
+    ep->hash = hash;
+    copy_val(dk, entry_get_val(dk, ep), val_bytes);
+
+    /* incref, plain data needs none */
+    if (!dk->pod_key_size) {
+        dk_incref_key(dk, key_bytes);
+        dk_incref_val(dk, val_bytes);
+    }
+
+    d->used += 1;
+    dk->usable -= 1;
+    dk->nentries += 1;
+    assert (dk->usable >= 0);
+    return OK;
+}
+
 int
 numba_dict_insert(
     NB_Dict    *d,
@@ -702,42 +1181,17 @@ numba_dict_insert(
 
     if (ix == DKIX_EMPTY) {
         /* Insert into new slot */
-        Py_ssize_t hashpos;
-        NB_DictEntry *ep;
-
-        if (dk->usable <= 0) {
-            /* Need to resize */
-            if (insertion_resize(d) != OK)
-                return ERR_NO_MEMORY;
-            else
-                dk = d->keys;     // reload
-        }
-        hashpos = find_empty_slot(dk, hash);
-        ep = get_entry(dk, dk->nentries);
-        set_index(dk, hashpos, dk->nentries);
-        copy_key(dk, entry_get_key(dk, ep), key_bytes);
-        assert ( hash != -1 );
-        ep->hash = hash;
-        copy_val(dk, entry_get_val(dk, ep), val_bytes);
-
-        /* incref */
-        dk_incref_key(dk, key_bytes);
-        dk_incref_val(dk, val_bytes);
-
-        d->used += 1;
-        dk->usable -= 1;
-        dk->nentries += 1;
-        assert (dk->usable >= 0);
-        return OK;
+        return insert_new(d, key_bytes, hash, val_bytes);
     } else {
         /* Replace existing value in the slot at ix */
-        /* decref old value */
-        dk_decref_val(dk, oldval_bytes);
         // Replace the previous value
         copy_val(dk, entry_get_val(dk, get_entry(dk, ix)), val_bytes);
 
-        /* incref */
-        dk_incref_val(dk, val_bytes);
+        if (!dk->pod_key_size) {
+            /* decref old value and incref the new one */
+            dk_decref_val(dk, oldval_bytes);
+            dk_incref_val(dk, val_bytes);
+        }
         return OK_REPLACED;
     }
 }
@@ -750,6 +1204,13 @@ void
 build_indices(NB_DictKeys *keys, Py_ssize_t n) {
     size_t mask = (size_t)D_MASK(keys);
     Py_ssize_t ix;
+    if (keys->layout == D_LAYOUT_SWISS) {
+        for (ix = 0; ix != n; ix++) {
+            Py_hash_t hash = get_entry(keys, ix)->hash;
+            set_slot(keys, swiss_find_free_slot(keys, hash), ix, hash);
+        }
+        return;
+    }
     for (ix = 0; ix != n; ix++) {
         size_t perturb;
         Py_hash_t hash = get_entry(keys, ix)->hash;
@@ -798,7 +1259,8 @@ numba_dict_resize(NB_Dict *d, Py_ssize_t minsize) {
 
     /* Allocate a new table. */
     status = numba_dictkeys_new(
-        &d->keys, newsize, oldkeys->key_size, oldkeys->val_size
+        &d->keys, newsize, oldkeys->key_size, oldkeys->val_size,
+        (int)oldkeys->layout
     );
     if (status != OK) {
         d->keys = oldkeys;
@@ -807,7 +1269,7 @@ numba_dict_resize(NB_Dict *d, Py_ssize_t minsize) {
     // New table must be large enough.
     assert(d->keys->usable >= d->used);
     // Copy method table
-    memcpy(&d->keys->methods, &oldkeys->methods, sizeof(type_based_methods_table));
+    dk_set_methods(d->keys, &oldkeys->methods);
 
     numentries = d->used;
 
@@ -867,11 +1329,13 @@ numba_dict_delitem(NB_Dict *d, Py_hash_t hash, Py_ssize_t ix)
 
     d->used -= 1;
     ep = get_entry(dk, ix);
-    set_index(dk, hashpos, DKIX_DUMMY);
+    clear_slot(dk, hashpos);
 
     /* decref */
-    dk_decref_key(dk, entry_get_key(dk, ep));
-    dk_decref_val(dk, entry_get_val(dk, ep));
+    if (!dk->pod_key_size) {
+        dk_decref_key(dk, entry_get_key(dk, ep));
+        dk_decref_val(dk, entry_get_val(dk, ep));
+    }
 
     /* zero the entries */
     zero_key(dk, entry_get_key(dk, ep));
@@ -906,8 +1370,8 @@ numba_dict_popitem(NB_Dict *d, char *key_bytes, char *val_bytes)
 
     j = lookdict_index(d->keys, ep->hash, i);
     assert(j >= 0);
-    assert(get_index(d->keys, j) == i);
-    set_index(d->keys, j, DKIX_DUMMY);
+    assert(dk_get_index(d->keys, j) == i);
+    clear_slot(d->keys, j);
 
     key_ptr = entry_get_key(d->keys, ep);
     val_ptr = entry_get_val(d->keys, ep);
@@ -993,6 +1457,135 @@ numba_dict_iter_next(NB_DictIter *it, const char **key_ptr, const char **val_ptr
     return ERR_ITER_EXHAUSTED;
 }
 
+/* The *_many() functions look up the keys in a pipeline: the slots probed
+   first for a key are prefetched 2 * D_PREFETCH_DISTANCE keys ahead, and
+   the entry they likely index D_PREFETCH_DISTANCE keys ahead, such that the
+   two dependent cache misses of a lookup overlap those of the next keys. */
+#define D_PREFETCH_DISTANCE 8
+
+/* Prefetch the slots probed first for *hash* */
+static void
+prefetch_home(NB_DictKeys *dk, Py_hash_t hash) {
+    if (dk->layout == D_LAYOUT_SWISS) {
+        D_PREFETCH(swiss_group(dk, (size_t)hash & swiss_group_mask(dk)));
+    } else {
+        D_PREFETCH(dk->indices + ((size_t)hash & D_MASK(dk)) * ix_size(dk->size));
+    }
+}
+
+/* Prefetch the entry indexed by the first slot probed for *hash* that may
+   hold it */
+static void
+prefetch_entry(NB_DictKeys *dk, Py_hash_t hash) {
+    Py_ssize_t ix;
+    if (dk->layout == D_LAYOUT_SWISS) {
+        const unsigned char *group = swiss_group(dk, (size_t)hash & swiss_group_mask(dk));
+        group_mask_t match = group_match(group, swiss_ctrl(hash));
+        if (!match) {
+            return;
+        }
+        ix = group_get_index(dk, group, group_mask_lowest(match));
+    } else {
+        ix = get_index(dk, (size_t)hash & D_MASK(dk));
+    }
+    if (ix >= 0) {
+        D_PREFETCH(get_entry(dk, ix));
+    }
+}
+
+/* Issue the prefetches for the *i*-th of *n* keys */
+static void
+prefetch_many(NB_DictKeys *dk, const Py_hash_t *hashes, Py_ssize_t i, Py_ssize_t n) {
+    if (i + 2 * D_PREFETCH_DISTANCE < n) {
+        prefetch_home(dk, hashes[i + 2 * D_PREFETCH_DISTANCE]);
+    }
+    if (i + D_PREFETCH_DISTANCE < n) {
+        prefetch_entry(dk, hashes[i + D_PREFETCH_DISTANCE]);
+    }
+}
+
+/* Start the pipeline of prefetches of *n* keys */
+static void
+prefetch_many_start(NB_DictKeys *dk, const Py_hash_t *hashes, Py_ssize_t n) {
+    Py_ssize_t i;
+    for (i = 0; i < n && i < 2 * D_PREFETCH_DISTANCE; ++i) {
+        prefetch_home(dk, hashes[i]);
+    }
+}
+
+/* Resize the dict such that *n* more entries can be inserted without
+   resizing */
+static int
+reserve_entries(NB_Dict *d, Py_ssize_t n) {
+    if (d->keys->usable >= n) {
+        return OK;
+    }
+    return numba_dict_resize(d, usable_size_for(d->keys->layout, d->used + n));
+}
+
+int
+numba_dict_insert_many(
+    NB_Dict         *d,
+    const char      *keys,
+    const Py_hash_t *hashes,
+    const char      *vals,
+    Py_ssize_t       n
+    )
+{
+    Py_ssize_t i;
+    Py_ssize_t key_size = d->keys->key_size, val_size = d->keys->val_size;
+    int status;
+    STACK_ALLOC(char, old, val_size);
+
+    if (n <= 0) {
+        return OK;
+    }
+    /* Grow once up front. Duplicated keys make this reserve more than
+       needed, which is harmless. */
+    status = reserve_entries(d, n);
+    if (status != OK) {
+        return status;
+    }
+    prefetch_many_start(d->keys, hashes, n);
+    for (i = 0; i < n; ++i) {
+        prefetch_many(d->keys, hashes, i, n);
+        status = numba_dict_insert(d, keys + i * key_size, hashes[i],
+                                   vals + i * val_size, old);
+        if (status < 0) {
+            return status;
+        }
+    }
+    return OK;
+}
+
+Py_ssize_t
+numba_dict_lookup_many(
+    NB_Dict         *d,
+    const char      *keys,
+    const Py_hash_t *hashes,
+    Py_ssize_t       n,
+    Py_ssize_t      *ixs,
+    char            *vals
+    )
+{
+    NB_DictKeys *dk = d->keys;
+    Py_ssize_t i, found = 0;
+
+    prefetch_many_start(dk, hashes, n);
+    for (i = 0; i < n; ++i) {
+        Py_ssize_t ix;
+        prefetch_many(dk, hashes, i, n);
+        ix = numba_dict_lookup(d, keys + i * dk->key_size, hashes[i],
+                               vals + i * dk->val_size);
+        if (ix == DKIX_ERROR) {
+            return DKIX_ERROR;
+        }
+        ixs[i] = ix;
+        found += (ix >= 0);
+    }
+    return found;
+}
+
 int
 numba_dict_insert_ez(
     NB_Dict    *d,
@@ -1011,10 +1604,292 @@ numba_dict_new_minsize(NB_Dict **out, Py_ssize_t key_size, Py_ssize_t val_size)
     return numba_dict_new(out, D_MINSIZE, key_size, val_size);
 }
 
+int
+numba_dict_new_sized(NB_Dict **out, Py_ssize_t n_keys, Py_ssize_t key_size, Py_ssize_t val_size)
+{
+    Py_ssize_t size = table_size_for(dict_default_layout, n_keys);
+    if (n_keys < 0 || size == 0) {
+        return ERR_NO_MEMORY;
+    }
+    return numba_dict_new(out, size, key_size, val_size);
+}
+
+int
+numba_dict_reserve(NB_Dict *d, Py_ssize_t n_keys)
+{
+    if (n_keys <= d->used) {
+        return OK;
+    }
+    return reserve_entries(d, n_keys - d->used);
+}
+
+int
+numba_dict_compact(NB_Dict *d)
+{
+    NB_DictKeys *dk = d->keys;
+    Py_ssize_t size = table_size_for(dk->layout, d->used);
+
+    /* Nothing to do without deleted entries and spare capacity */
+    if (dk->nentries == d->used && dk->size <= size) {
+        return OK;
+    }
+    return numba_dict_resize(d, size);
+}
+
 void
 numba_dict_set_method_table(NB_Dict *d, type_based_methods_table *methods)
 {
-    memcpy(&d->keys->methods, methods, sizeof(type_based_methods_table));
+    dk_set_methods(d->keys, methods);
+}
+
+int
+numba_dict_update(NB_Dict *d, const char *key_bytes, Py_hash_t hash, const char *val_bytes, dict_value_update_t op)
+{
+    char stackbuf[64];
+    char *oldval_bytes = stackbuf;
+    NB_DictKeys *dk = d->keys;
+    Py_ssize_t ix;
+    int status;
+
+    if ((size_t)dk->val_size > sizeof(stackbuf)) {
+        oldval_bytes = malloc(dk->val_size);
+        if (!oldval_bytes) return ERR_NO_MEMORY;
+    }
+    if (!op) {
+        status = numba_dict_insert(d, key_bytes, hash, val_bytes, oldval_bytes);
+    } else {
+        ix = numba_dict_lookup(d, key_bytes, hash, oldval_bytes);
+        if (ix == DKIX_ERROR) {
+            status = ERR_CMP_FAILED;
+        } else if (ix == DKIX_EMPTY) {
+            status = insert_new(d, key_bytes, hash, val_bytes);
+        } else {
+            op(entry_get_val(dk, get_entry(dk, ix)), val_bytes);
+            status = OK_REPLACED;
+        }
+    }
+    if (oldval_bytes != stackbuf) free(oldval_bytes);
+    return status;
+}
+
+/* Merge the entries of *src*, only those of shard *i* of *cd* if *cd* is not
+   NULL */
+static int
+merge_entries(NB_Dict *dst, NB_Dict *src, dict_value_update_t op,
+              NB_ConcurrentDict *cd, Py_ssize_t i)
+{
+    NB_DictKeys *dk = src->keys;
+    Py_ssize_t j;
+    int status;
+
+    assert(dk->key_size == dst->keys->key_size);
+    assert(dk->val_size == dst->keys->val_size);
+    for (j = 0; j < dk->nentries; j++) {
+        NB_DictEntry *ep = get_entry(dk, j);
+        if (ep->hash == DKIX_EMPTY) continue;
+        if (cd && numba_cdict_shard_of(cd, ep->hash) != i) continue;
+        status = numba_dict_update(dst, entry_get_key(dk, ep), ep->hash,
+                                   entry_get_val(dk, ep), op);
+        if (status < 0) return status;
+    }
+    return OK;
+}
+
+int
+numba_dict_merge(NB_Dict *dst, NB_Dict *src, dict_value_update_t op)
+{
+    return merge_entries(dst, src, op, NULL, 0);
+}
+
+void
+numba_dict_update_add_int64(char *val, const char *update)
+{
+    int64_t a, b;
+    memcpy(&a, val, sizeof(a));
+    memcpy(&b, update, sizeof(b));
+    /* wrap around on overflow as integer arithmetic does in Numba */
+    a = (int64_t)((uint64_t)a + (uint64_t)b);
+    memcpy(val, &a, sizeof(a));
+}
+
+void
+numba_dict_update_add_float64(char *val, const char *update)
+{
+    double a, b;
+    memcpy(&a, val, sizeof(a));
+    memcpy(&b, update, sizeof(b));
+    a += b;
+    memcpy(val, &a, sizeof(a));
+}
+
+
+/* The concurrent dict
+
+The shards are guarded by spinlocks, as the critical sections are short:
+a single probe of the shard, or occasionally its resize. A waiting thread
+yields the processor after D_LOCK_SPINS turns so that the holder of the lock
+can make progress when the threads outnumber the processors.
+*/
+#if defined(_MSC_VER)
+#   include <windows.h>
+#   define D_LOCK_TRY(lock) (_InterlockedExchange((volatile long *)(lock), 1) == 0)
+#   define D_LOCK_RELEASE(lock) _InterlockedExchange((volatile long *)(lock), 0)
+#   define D_LOCK_PEEK(lock) (*(volatile long *)(lock))
+#   define D_YIELD() SwitchToThread()
+#else
+#   include <sched.h>
+#   define D_LOCK_TRY(lock) (__atomic_exchange_n((lock), 1, __ATOMIC_ACQUIRE) == 0)
+#   define D_LOCK_RELEASE(lock) __atomic_store_n((lock), 0, __ATOMIC_RELEASE)
+#   define D_LOCK_PEEK(lock) __atomic_load_n((lock), __ATOMIC_RELAXED)
+#   define D_YIELD() sched_yield()
+#endif
+
+#define D_LOCK_SPINS 128
+/* Keeps the shard bits clear of the control bits of the swiss layout */
+#define D_MAX_SHARDS (1 << 16)
+
+static void
+shard_lock(NB_DictShard *shard) {
+    int spins = 0;
+    while (!D_LOCK_TRY(&shard->lock)) {
+        while (D_LOCK_PEEK(&shard->lock)) {
+            if (++spins >= D_LOCK_SPINS) {
+                D_YIELD();
+                spins = 0;
+            }
+        }
+    }
+}
+
+static void
+shard_unlock(NB_DictShard *shard) {
+    D_LOCK_RELEASE(&shard->lock);
+}
+
+int
+numba_cdict_new(NB_ConcurrentDict **out, Py_ssize_t nshards, Py_ssize_t key_size, Py_ssize_t val_size)
+{
+    NB_ConcurrentDict *cd;
+    Py_ssize_t n, i;
+    int status;
+
+    for (n = 1; n < nshards && n < D_MAX_SHARDS; n <<= 1)
+        ;
+    cd = calloc(1, sizeof(NB_ConcurrentDict) + n * sizeof(NB_DictShard));
+    if (!cd) return ERR_NO_MEMORY;
+    cd->nshards = n;
+    for (i = 0; i < n; i++) {
+        status = numba_dict_new_minsize(&cd->shards[i].dict, key_size, val_size);
+        if (status != OK) {
+            numba_cdict_free(cd);
+            return status;
+        }
+    }
+    *out = cd;
+    return OK;
+}
+
+void
+numba_cdict_free(NB_ConcurrentDict *cd)
+{
+    Py_ssize_t i;
+    for (i = 0; i < cd->nshards; i++) {
+        if (cd->shards[i].dict) {
+            numba_dict_free(cd->shards[i].dict);
+        }
+    }
+    free(cd);
+}
+
+void
+numba_cdict_set_method_table(NB_ConcurrentDict *cd, type_based_methods_table *methods)
+{
+    Py_ssize_t i;
+    for (i = 0; i < cd->nshards; i++) {
+        numba_dict_set_method_table(cd->shards[i].dict, methods);
+    }
+}
+
+Py_ssize_t
+numba_cdict_length(NB_ConcurrentDict *cd)
+{
+    Py_ssize_t i, n = 0;
+    for (i = 0; i < cd->nshards; i++) {
+        n += numba_dict_length(cd->shards[i].dict);
+    }
+    return n;
+}
+
+Py_ssize_t
+numba_cdict_nshards(NB_ConcurrentDict *cd)
+{
+    return cd->nshards;
+}
+
+NB_Dict *
+numba_cdict_shard(NB_ConcurrentDict *cd, Py_ssize_t i)
+{
+    assert(i >= 0 && i < cd->nshards);
+    return cd->shards[i].dict;
+}
+
+Py_ssize_t
+numba_cdict_shard_of(NB_ConcurrentDict *cd, Py_hash_t hash)
+{
+    /* The shards probe with the low bits of the hash, and the swiss layout
+       takes its control bytes from the top 7 bits of the same product */
+    uint64_t mixed = (uint64_t)hash * 0x9E3779B97F4A7C15ULL;
+    return (Py_ssize_t)((mixed >> 32) & (uint64_t)(cd->nshards - 1));
+}
+
+Py_ssize_t
+numba_cdict_lookup(NB_ConcurrentDict *cd, const char *key_bytes, Py_hash_t hash, char *oldval_bytes)
+{
+    NB_DictShard *shard = &cd->shards[numba_cdict_shard_of(cd, hash)];
+    Py_ssize_t ix;
+
+    shard_lock(shard);
+    ix = numba_dict_lookup(shard->dict, key_bytes, hash, oldval_bytes);
+    shard_unlock(shard);
+    return ix;
+}
+
+int
+numba_cdict_insert(NB_ConcurrentDict *cd, const char *key_bytes, Py_hash_t hash, const char *val_bytes, char *oldval_bytes)
+{
+    NB_DictShard *shard = &cd->shards[numba_cdict_shard_of(cd, hash)];
+    int status;
+
+    shard_lock(shard);
+    status = numba_dict_insert(shard->dict, key_bytes, hash, val_bytes, oldval_bytes);
+    shard_unlock(shard);
+    return status;
+}
+
+int
+numba_cdict_update(NB_ConcurrentDict *cd, const char *key_bytes, Py_hash_t hash, const char *val_bytes, dict_value_update_t op)
+{
+    NB_DictShard *shard = &cd->shards[numba_cdict_shard_of(cd, hash)];
+    int status;
+
+    shard_lock(shard);
+    status = numba_dict_update(shard->dict, key_bytes, hash, val_bytes, op);
+    shard_unlock(shard);
+    return status;
+}
+
+int
+numba_cdict_merge_shard(NB_ConcurrentDict *cd, Py_ssize_t i, NB_Dict *src, dict_value_update_t op)
+{
+    NB_DictShard *shard;
+    int status;
+
+    assert(i >= 0 && i < cd->nshards);
+    shard = &cd->shards[i];
+    shard_lock(shard);
+    status = merge_entries(shard->dict, src, op, cd, i);
+    shard_unlock(shard);
+    return status;
 }
 
 
@@ -1046,7 +1921,7 @@ numba_test_dict(void) {
 #endif
     puts("test_dict");
 
-    status = numba_dict_new(&d, D_MINSIZE, 4, 8);
+    status = numba_dict_new_layout(&d, D_MINSIZE, 4, 8, D_LAYOUT_COMPACT);
     CHECK(status == OK);
     CHECK(d->keys->size == D_MINSIZE);
     CHECK(d->keys->key_size == 4);
@@ -26,6 +26,17 @@ typedef struct {
 } type_based_methods_table;
 
 
+/* The layouts of the hash table.
+- D_LAYOUT_COMPACT
+    The CPython layout, probing the indices one at a time.
+- D_LAYOUT_SWISS
+    A control byte holding 7 bits of the hash of each slot, alongside the
+    indices, such that the slots are probed in groups of 16 at a time.
+Both keep the entries in insertion order.
+*/
+#define D_LAYOUT_COMPACT 0
+#define D_LAYOUT_SWISS 1
+
 typedef struct {
    /* hash table size */
     Py_ssize_t      size;
@@ -42,6 +53,15 @@ typedef struct {
     Py_ssize_t      key_size, val_size, entry_size;
     /* Byte offset from indices to the first entry. */
     Py_ssize_t      entry_offset;
+    /* Hash table layout, one of the D_LAYOUT_* values. */
+    Py_ssize_t      layout;
+    /* Byte size of a group of slots (its control bytes and indices) in the
+       swiss layout. */
+    Py_ssize_t      group_size;
+    /* Size of the keys if they are plain data compared bitwise, and neither
+       the keys nor the values are refcounted: 4, 8 or 16, otherwise 0.
+       Selects the probing kernels specialized for this key size. */
+    Py_ssize_t      pod_key_size;
 
     /* Method table for type-dependent operations. */
     type_based_methods_table methods;
@@ -70,6 +90,31 @@ typedef struct {
 } NB_DictIter;
 
 
+/* Combine the value *update* into the value *val* of a dict, in place */
+typedef void (*dict_value_update_t)(char *val, const char *update);
+
+/* The size of a shard of a NB_ConcurrentDict, a cache line */
+#define D_SHARD_SIZE 64
+
+typedef struct {
+    NB_Dict         *dict;
+    /* spinlock guarding the dict, 0 when unlocked */
+    int              lock;
+    char             padding[D_SHARD_SIZE - sizeof(NB_Dict *) - sizeof(int)];
+} NB_DictShard;
+
+/* A dict safe to use from many threads at once. The keys are spread over
+   independently locked shards, each a NB_Dict, by bits of their hash that
+   the shards don't use for probing. The entries of a shard are kept in
+   insertion order, but not the entries of the whole dict.
+*/
+typedef struct {
+    /* number of shards, a power of two */
+    Py_ssize_t       nshards;
+    NB_DictShard     shards[];
+} NB_ConcurrentDict;
+
+
 
 /* A test function for the dict
 Returns 0 for OK; 1 for failure.
@@ -91,6 +136,21 @@ Parameters
 NUMBA_EXPORT_FUNC(int)
 numba_dict_new(NB_Dict **out, Py_ssize_t size, Py_ssize_t key_size, Py_ssize_t val_size);
 
+/* Same as numba_dict_new() with a hash table of the given layout */
+NUMBA_EXPORT_FUNC(int)
+numba_dict_new_layout(NB_Dict **out, Py_ssize_t size, Py_ssize_t key_size, Py_ssize_t val_size, int layout);
+
+/* Set the layout of the dicts allocated by numba_dict_new() and
+numba_dict_new_minsize(). Returns the previous layout, or -1 if the layout
+is unknown.
+*/
+NUMBA_EXPORT_FUNC(int)
+numba_dict_set_default_layout(int layout);
+
+/* Returns the layout of a dict */
+NUMBA_EXPORT_FUNC(int)
+numba_dict_layout(NB_Dict *d);
+
 /* Free a dict */
 NUMBA_EXPORT_FUNC(void)
 numba_dict_free(NB_Dict *d);
@@ -105,6 +165,23 @@ See numba_dict_new().
 NUMBA_EXPORT_FUNC(int)
 numba_dict_new_minsize(NB_Dict **out, Py_ssize_t key_size, Py_ssize_t val_size);
 
+/* Same as numba_dict_new_minsize() with room for *n_keys* keys, that can be
+inserted without resizing the dict */
+NUMBA_EXPORT_FUNC(int)
+numba_dict_new_sized(NB_Dict **out, Py_ssize_t n_keys, Py_ssize_t key_size, Py_ssize_t val_size);
+
+/* Resize the dict, if needed, such that it holds *n_keys* keys in total
+without resizing */
+NUMBA_EXPORT_FUNC(int)
+numba_dict_reserve(NB_Dict *d, Py_ssize_t n_keys);
+
+/* Drop the deleted entries and shrink the hash table to the smallest size
+holding the entries. The insertion order is unchanged but, like any resize,
+this invalidates the entry indices and the iterators of the dict.
+*/
+NUMBA_EXPORT_FUNC(int)
+numba_dict_compact(NB_Dict *d);
+
 /* Set the method table for type specific operations
 */
 NUMBA_EXPORT_FUNC(void)
@@ -158,6 +235,54 @@ numba_dict_insert(NB_Dict *d, const char *key_bytes, Py_hash_t hash, const char
 NUMBA_EXPORT_FUNC(int)
 numba_dict_insert_ez(NB_Dict *d, const char *key_bytes, Py_hash_t hash, const char *val_bytes);
 
+/* Insert many keys to the dict, as numba_dict_insert_ez() does for each of
+them in turn. The probes of the next keys are prefetched while a key is
+inserted, and the dict is grown at most once.
+
+Parameters
+- NB_Dict *d
+    The dictionary object.
+- const char *keys
+    The *n* keys, packed as key_size-d byte buffers.
+- const Py_hash_t *hashes
+    The precomputed hashes of the keys.
+- const char *vals
+    The *n* values, packed as val_size-d byte buffers.
+- Py_ssize_t n
+    The number of keys.
+
+Returns
+- < 0 for error, in which case the keys before the failing one are inserted
+- 0 for ok
+*/
+NUMBA_EXPORT_FUNC(int)
+numba_dict_insert_many(NB_Dict *d, const char *keys, const Py_hash_t *hashes, const char *vals, Py_ssize_t n);
+
+/* Lookup many keys, as numba_dict_lookup() does for each of them in turn.
+The probes of the next keys are prefetched while a key is looked up.
+
+Parameters
+- NB_Dict *d
+    The dictionary object.
+- const char *keys
+    The *n* keys, packed as key_size-d byte buffers.
+- const Py_hash_t *hashes
+    The precomputed hashes of the keys.
+- Py_ssize_t n
+    The number of keys.
+- Py_ssize_t *ixs
+    Output for the *n* results of numba_dict_lookup().
+- char *vals
+    Output for the *n* values, packed as val_size-d byte buffers. The values
+    of the missing keys are zeroed.
+
+Returns
+- the number of keys found
+- DKIX_ERROR if a key comparison failed
+*/
+NUMBA_EXPORT_FUNC(Py_ssize_t)
+numba_dict_lookup_many(NB_Dict *d, const char *keys, const Py_hash_t *hashes, Py_ssize_t n, Py_ssize_t *ixs, char *vals);
+
 /* Delete an entry from the dict
 Parameters
 - NB_Dict *d
@@ -219,4 +344,93 @@ numba_dict_iter_next(NB_DictIter *it, const char **key_ptr, const char **val_ptr
 NUMBA_EXPORT_FUNC(void)
 numba_dict_dump(NB_Dict *);
 
+/* Update or insert a key: if the key is in the dict, *op* combines *val_bytes*
+into its value in place, otherwise the key is inserted with *val_bytes* as its
+value. A NULL *op* replaces the value as numba_dict_insert() does. *op* must
+take care of the refcounts of the values it combines.
+
+Returns
+- OK if the key was inserted
+- OK_REPLACED if the value was updated
+- a negative error code otherwise
+*/
+NUMBA_EXPORT_FUNC(int)
+numba_dict_update(NB_Dict *d, const char *key_bytes, Py_hash_t hash, const char *val_bytes, dict_value_update_t op);
+
+/* Update or insert each of the entries of *src* in *dst*, as if by
+numba_dict_update(). The dicts must have the same key and value types.
+*/
+NUMBA_EXPORT_FUNC(int)
+numba_dict_merge(NB_Dict *dst, NB_Dict *src, dict_value_update_t op);
+
+/* Update operations adding the values, for dicts of int64 or float64 values
+*/
+NUMBA_EXPORT_FUNC(void)
+numba_dict_update_add_int64(char *val, const char *update);
+
+NUMBA_EXPORT_FUNC(void)
+numba_dict_update_add_float64(char *val, const char *update);
+
+/* Allocate a new concurrent dict
+Parameters
+- NB_ConcurrentDict **out
+    Output for the new dictionary.
+- Py_ssize_t nshards
+    Minimum number of shards, rounded up to a power of two.
+- Py_ssize_t key_size
+    Size of a key entry.
+- Py_ssize_t val_size
+    Size of a value entry.
+*/
+NUMBA_EXPORT_FUNC(int)
+numba_cdict_new(NB_ConcurrentDict **out, Py_ssize_t nshards, Py_ssize_t key_size, Py_ssize_t val_size);
+
+/* Free a concurrent dict, no thread may be using it */
+NUMBA_EXPORT_FUNC(void)
+numba_cdict_free(NB_ConcurrentDict *cd);
+
+/* Set the method table of all the shards, before the dict is used */
+NUMBA_EXPORT_FUNC(void)
+numba_cdict_set_method_table(NB_ConcurrentDict *cd, type_based_methods_table *methods);
+
+/* Returns the number of entries, which is only exact when no other thread is
+modifying the dict */
+NUMBA_EXPORT_FUNC(Py_ssize_t)
+numba_cdict_length(NB_ConcurrentDict *cd);
+
+/* Returns the number of shards */
+NUMBA_EXPORT_FUNC(Py_ssize_t)
+numba_cdict_nshards(NB_ConcurrentDict *cd);
+
+/* Returns the dict of shard *i*, for use when no other thread is using the
+concurrent dict (e.g. to iterate over it) */
+NUMBA_EXPORT_FUNC(NB_Dict *)
+numba_cdict_shard(NB_ConcurrentDict *cd, Py_ssize_t i);
+
+/* Returns the shard a key of the given hash belongs to */
+NUMBA_EXPORT_FUNC(Py_ssize_t)
+numba_cdict_shard_of(NB_ConcurrentDict *cd, Py_hash_t hash);
+
+/* The thread-safe counterparts of numba_dict_lookup(), numba_dict_insert()
+and numba_dict_update(), locking the shard of the key. The index returned by
+the lookup is an index into the shard, only meaningful to tell whether the key
+was found.
+*/
+NUMBA_EXPORT_FUNC(Py_ssize_t)
+numba_cdict_lookup(NB_ConcurrentDict *cd, const char *key_bytes, Py_hash_t hash, char *oldval_bytes);
+
+NUMBA_EXPORT_FUNC(int)
+numba_cdict_insert(NB_ConcurrentDict *cd, const char *key_bytes, Py_hash_t hash, const char *val_bytes, char *oldval_bytes);
+
+NUMBA_EXPORT_FUNC(int)
+numba_cdict_update(NB_ConcurrentDict *cd, const char *key_bytes, Py_hash_t hash, const char *val_bytes, dict_value_update_t op);
+
+/* Update or insert the entries of *src* that belong to shard *i*, as if by
+numba_dict_update(). Merging many dicts into a concurrent dict is parallel
+over the shards: each thread merges all the dicts into its own shards, with
+no contention for the locks.
+*/
+NUMBA_EXPORT_FUNC(int)
+numba_cdict_merge_shard(NB_ConcurrentDict *cd, Py_ssize_t i, NB_Dict *src, dict_value_update_t op);
+
 #endif
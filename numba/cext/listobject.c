@@ -42,6 +42,14 @@
  * delete operations over multiple items, we can simply implement those using
  * the basic functions above.
  *
+ * The following bulk functions copy many items at once, with a single resize
+ * and a single memcpy, for the common cases of the compiler level:
+ *
+ * - Reserving space          numba_list_reserve
+ * - Extending from a buffer  numba_list_extend
+ * - Extending from a list    numba_list_extend_list
+ * - Assigning a simple slice numba_list_assign_slice
+ *
  * The following additional functions are implemented for the list, these are
  * needed to make the list work within Numba.
  *
@@ -382,8 +390,10 @@ numba_list_resize(NB_List *lp, Py_ssize_t newsize) {
     /* Bypass realloc() when a previous overallocation is large enough
        to accommodate the newsize.  If the newsize falls lower than half
        the allocated size, then proceed with the realloc() to shrink the list.
+       A list growing into space it reserved is never shrunk.
     */
-    if (lp->allocated >= newsize && newsize >= (lp->allocated >> 1)) {
+    if (lp->allocated >= newsize &&
+            (newsize >= (lp->allocated >> 1) || newsize >= lp->size)) {
         assert(lp->items != NULL || newsize == 0);
         lp->size = newsize;
         return LIST_OK;
@@ -416,6 +426,180 @@ numba_list_resize(NB_List *lp, Py_ssize_t newsize) {
     return LIST_OK;
 }
 
+/* Return whether *ptr* points into the items of a list.
+ */
+static int
+points_into_items(NB_List *lp, const char *ptr) {
+    uintptr_t p = (uintptr_t)ptr, base = (uintptr_t)lp->items;
+    return lp->items != NULL && p >= base &&
+           p < base + (uintptr_t)(lp->item_size * lp->size);
+}
+
+/* Reserve space for items in a list.
+ *
+ * lp: a list
+ * allocated: the number of items to make room for
+ *
+ * The size of the list is unchanged, appending to it does not reallocate
+ * until it holds *allocated* items.
+ */
+int
+numba_list_reserve(NB_List *lp, Py_ssize_t allocated) {
+    char *items;
+    size_t num_allocated_bytes;
+    // check for mutability
+    if (!lp->is_mutable) {
+        return LIST_ERR_IMMUTABLE;
+    }
+    if (allocated <= lp->allocated) {
+        return LIST_OK;
+    }
+    if ((size_t)allocated > (size_t)PY_SSIZE_T_MAX / lp->item_size) {
+        return LIST_ERR_NO_MEMORY;
+    }
+    num_allocated_bytes = (size_t)allocated * lp->item_size;
+    items = realloc(lp->items, aligned_size(num_allocated_bytes));
+    if (items == NULL) {
+        return LIST_ERR_NO_MEMORY;
+    }
+    lp->items = items;
+    lp->allocated = allocated;
+    return LIST_OK;
+}
+
+/* Append many items to the end of a list.
+ *
+ * lp: a list
+ * items: a buffer holding the items contiguously, may point into the list
+ * n: the number of items
+ *
+ * The list is resized once and the items are copied at once, the references
+ * to the items, if any, are then incremented in a single pass.
+ */
+int
+numba_list_extend(NB_List *lp, const char *items, Py_ssize_t n) {
+    Py_ssize_t size = lp->size, offset = -1, i;
+    char *loc;
+    int result;
+    // check for mutability
+    if (!lp->is_mutable) {
+        return LIST_ERR_IMMUTABLE;
+    }
+    if (n < 0) {
+        return LIST_ERR_INDEX;
+    }
+    if (n == 0) {
+        return LIST_OK;
+    }
+    if (n > PY_SSIZE_T_MAX - size) {
+        return LIST_ERR_NO_MEMORY;
+    }
+    // the resize may move the items of the list
+    if (points_into_items(lp, items)) {
+        offset = items - lp->items;
+    }
+    result = numba_list_resize(lp, size + n);
+    if (result < LIST_OK) {
+        return result;
+    }
+    if (offset >= 0) {
+        items = lp->items + offset;
+    }
+    loc = lp->items + lp->item_size * size;
+    memmove(loc, items, lp->item_size * n);
+    if (lp->methods.item_incref) {
+        for (i = 0; i < n; i++) {
+            lp->methods.item_incref(loc + lp->item_size * i);
+        }
+    }
+    return LIST_OK;
+}
+
+/* Append all the items of another list, of the same item type.
+ *
+ * lp: a list
+ * other: the list to append the items of, may be lp itself
+ */
+int
+numba_list_extend_list(NB_List *lp, NB_List *other) {
+    assert(lp->item_size == other->item_size);
+    return numba_list_extend(lp, other->items, other->size);
+}
+
+/* Assign to a simple slice
+ *
+ * lp: a list
+ * start: the start index of the slice
+ * stop: the stop index of the slice (not included)
+ * items: a buffer holding the new items contiguously, may point into the list
+ * n: the number of new items
+ *
+ * The items in [start, stop) are replaced by the *n* new items, the list
+ * growing or shrinking as needed. This function assumes that the slice has a
+ * step of 1 and that 0 <= start <= stop <= len(l).
+ */
+int
+numba_list_assign_slice(NB_List *lp, Py_ssize_t start, Py_ssize_t stop,
+                        const char *items, Py_ssize_t n) {
+    Py_ssize_t size = lp->size, item_size = lp->item_size, i;
+    char *copied = NULL;
+    int result;
+    // check for mutability
+    if (!lp->is_mutable) {
+        return LIST_ERR_IMMUTABLE;
+    }
+    if (start < 0 || stop < start || stop > size || n < 0) {
+        return LIST_ERR_INDEX;
+    }
+    if (n > PY_SSIZE_T_MAX - size) {
+        return LIST_ERR_NO_MEMORY;
+    }
+    // the items of the list are moved below, copy the new items out first
+    if (n > 0 && points_into_items(lp, items)) {
+        copied = malloc(item_size * n);
+        if (copied == NULL) {
+            return LIST_ERR_NO_MEMORY;
+        }
+        memcpy(copied, items, item_size * n);
+        items = copied;
+    }
+    // grow first, such that a failure leaves the list unchanged
+    if (n > stop - start) {
+        result = numba_list_resize(lp, size - (stop - start) + n);
+        if (result < LIST_OK) {
+            free(copied);
+            return result;
+        }
+    }
+    // incref the new items before the old ones are decref'ed, as they may be
+    // the same
+    if (lp->methods.item_incref) {
+        for (i = 0; i < n; i++) {
+            lp->methods.item_incref(items + item_size * i);
+        }
+    }
+    if (lp->methods.item_decref) {
+        for (i = start; i < stop; i++) {
+            lp->methods.item_decref(lp->items + item_size * i);
+        }
+    }
+    // move the tail of the list into place and copy in the new items
+    if (n != stop - start) {
+        memmove(lp->items + item_size * (start + n),
+                lp->items + item_size * stop,
+                item_size * (size - stop));
+    }
+    if (n > 0) {
+        memcpy(lp->items + item_size * start, items, item_size * n);
+    }
+    free(copied);
+    if (n < stop - start) {
+        // Since we are decreasing the size, this should never fail
+        return numba_list_resize(lp, size - (stop - start) + n);
+    }
+    return LIST_OK;
+}
+
 /* Delete a single item.
  *
  * lp: a list
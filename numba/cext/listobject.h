@@ -113,6 +113,19 @@ numba_list_append(NB_List *lp, const char *item);
 NUMBA_EXPORT_FUNC(int)
 numba_list_resize(NB_List *lp, Py_ssize_t newsize);
 
+NUMBA_EXPORT_FUNC(int)
+numba_list_reserve(NB_List *lp, Py_ssize_t allocated);
+
+NUMBA_EXPORT_FUNC(int)
+numba_list_extend(NB_List *lp, const char *items, Py_ssize_t n);
+
+NUMBA_EXPORT_FUNC(int)
+numba_list_extend_list(NB_List *lp, NB_List *other);
+
+NUMBA_EXPORT_FUNC(int)
+numba_list_assign_slice(NB_List *lp, Py_ssize_t start, Py_ssize_t stop,
+                        const char *items, Py_ssize_t n);
+
 NUMBA_EXPORT_FUNC(int)
 numba_list_delitem(NB_List *lp, Py_ssize_t index);
 
@@ -517,6 +517,16 @@ def box_tuple(typ, val, c):
     """
     Convert native array or structure *val* to a tuple object.
     """
+    if (isinstance(typ, types.UniTuple) and type(typ.dtype) is types.Array
+            and c.context.enable_nrt and typ.count > 1):
+        # Box all the arrays in a single call
+        np_dtype = numpy_support.as_dtype(typ.dtype.dtype)
+        dtypeptr = c.env_manager.read_const(c.env_manager.add_const(np_dtype))
+        tuple_val = c.pyapi.nrt_adapt_ndarrays_to_python(typ, val, dtypeptr)
+        # Steals NRT refs
+        c.context.nrt.decref(c.builder, typ, val)
+        return tuple_val
+
     tuple_val = c.pyapi.tuple_new(typ.count)
 
     for i, dtype in enumerate(typ):
@@ -224,3 +224,74 @@ class PyCallWrapper(object):
     def debug_print(self, builder, msg):
         if config.DEBUG_JIT:
             self.context.debug_print(builder, "DEBUGJIT: {0}".format(msg))
+
+
+class GeneratorFillWrapper(PyCallWrapper):
+    """
+    Build the bulk filling function of a generator, which calls its native
+    next function to store the yielded scalars in a buffer (see
+    generator_fill() in _dynfunc.c).
+    """
+    def build(self):
+        fillname = self.fndesc.llvm_fill_name
+
+        # Py_ssize_t fill(PyObject *gen, char *data, Py_ssize_t stride,
+        #                 Py_ssize_t count)
+        pyobj = self.context.get_argument_type(types.pyobject)
+        intp = self.context.get_value_type(types.intp)
+        fillty = llvmlite.ir.FunctionType(intp, [pyobj, cgutils.voidptr_t,
+                                                 intp, intp])
+        fill = llvmlite.ir.Function(self.module, fillty, name=fillname)
+
+        builder = IRBuilder(fill.append_basic_block('entry'))
+        gen, data, stride, count = fill.args
+        gen.name = 'py_gen'
+        data.name = 'data'
+        stride.name = 'stride'
+        count.name = 'count'
+
+        api = self.context.get_python_api(builder)
+        self.build_fill(api, builder, gen, data, stride, count)
+
+        return fill, api
+
+    def build_fill(self, api, builder, gen, data, stride, count):
+        intp = count.type
+        gentype, = self.fndesc.argtypes
+        yield_type = self.fndesc.restype
+
+        # Checks that the environment is alive, as the Python wrapper does.
+        # emit_environment_sentry() can't be used as it returns a NULL
+        # object, while this function returns -1 on error.
+        envname = self.context.get_env_name(self.fndesc)
+        gvptr = self.context.declare_env_global(builder.module, envname)
+        envptr = builder.load(gvptr)
+        with cgutils.if_unlikely(builder, cgutils.is_null(builder, envptr)):
+            api.err_set_string(
+                "PyExc_RuntimeError",
+                f"missing Environment: {self.fndesc.env_name}",
+            )
+            builder.ret(Constant(intp, -1))
+        genptr = api.to_native_generator(gen, gentype).value
+
+        with cgutils.for_range(builder, count, intp=intp) as loop:
+            status, retval = self.context.call_conv.call_function(
+                builder, self.func, yield_type, self.fndesc.argtypes,
+                [genptr], attrs=('noinline',))
+
+            with builder.if_then(builder.not_(status.is_ok), likely=False):
+                # Exhausted => report the number of values stored
+                with builder.if_then(status.is_stop_iteration):
+                    builder.ret(loop.index)
+                # Error out
+                self.context.call_conv.raise_error(builder, api, status)
+                builder.ret(Constant(intp, -1))
+
+            offset = builder.mul(loop.index, stride)
+            ptr = builder.bitcast(
+                builder.gep(data, [offset]),
+                self.context.get_data_type(yield_type).as_pointer())
+            self.context.pack_value(builder, yield_type, retval, ptr)
+
+        builder.ret(count)
+
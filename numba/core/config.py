@@ -223,6 +223,26 @@ class _EnvReloader(object):
         # Enable debug prints in nrtdynmod and use of "safe" API functions
         DEBUG_NRT = _readenv("NUMBA_DEBUG_NRT", int, 0)
 
+        # serve NRT allocations from per-thread size-class pools
+        NRT_POOL_ALLOCATOR = _readenv("NUMBA_NRT_POOL_ALLOCATOR", int, 0)
+
+        # trace NRT MemInfo creation and destruction from startup
+        NRT_TRACE = _readenv("NUMBA_NRT_TRACE", int, 0)
+
+        # map NRT allocations of at least this many bytes directly, 0 disables
+        NRT_LARGE_ALLOC_THRESHOLD = _readenv(
+            "NUMBA_NRT_LARGE_ALLOC_THRESHOLD", int, 0)
+
+        # huge page and NUMA placement options for the mapped allocations
+        NRT_LARGE_ALLOC_FLAGS = _readenv(
+            "NUMBA_NRT_LARGE_ALLOC_FLAGS", str, "thp")
+
+        # bias the reference count of MemInfos to their allocating thread
+        NRT_BIASED_REFCOUNT = _readenv("NUMBA_NRT_BIASED_REFCOUNT", int, 0)
+
+        # Hash table layout of the typed dicts, 'compact' or 'swiss'
+        DICT_LAYOUT = _readenv("NUMBA_DICT_LAYOUT", str, "compact")
+
         # How many recently deserialized functions to retain regardless
         # of external references
         FUNCTION_CACHE_SIZE = _readenv("NUMBA_FUNCTION_CACHE_SIZE", int, 128)
@@ -239,6 +259,9 @@ class _EnvReloader(object):
         # Contains path to the directory
         CACHE_DIR = _readenv("NUMBA_CACHE_DIR", str, "")
 
+        # Path of a file caching the default type casting rules
+        TYPECONV_SNAPSHOT = _readenv("NUMBA_TYPECONV_SNAPSHOT", str, "")
+
         # Enable tracing support
         TRACE = _readenv("NUMBA_TRACE", int, 0)
 
@@ -344,6 +367,11 @@ class _EnvReloader(object):
         DISABLE_INTEL_SVML = _readenv(
             "NUMBA_DISABLE_INTEL_SVML", int, IS_32BITS)
 
+        # if set, the calls of the C math functions are not mapped to their
+        # vector-width variants for the loop vectorizer
+        DISABLE_VECTOR_MATH_VARIANTS = _readenv(
+            "NUMBA_DISABLE_VECTOR_MATH_VARIANTS", int, 0)
+
         # Disable jit for debugging
         DISABLE_JIT = _readenv("NUMBA_DISABLE_JIT", int, 0)
 
@@ -355,6 +383,13 @@ class _EnvReloader(object):
         )
         THREADING_LAYER = _readenv("NUMBA_THREADING_LAYER", str, 'default')
 
+        # number of iterations the workqueue threading layer spins for before
+        # parking a waiting thread, 0 means park immediately
+        WORKQUEUE_SPIN = _readenv("NUMBA_WORKQUEUE_SPIN", int, 0)
+
+        # CPU placement policy for the threading layer worker threads
+        THREAD_AFFINITY = _readenv("NUMBA_THREAD_AFFINITY", str, "")
+
         CAPTURED_ERRORS = _readenv("NUMBA_CAPTURED_ERRORS",
                                    _validate_captured_errors_style,
                                    'old_style')
@@ -402,6 +437,9 @@ class _EnvReloader(object):
         CUDA_ARRAY_INTERFACE_SYNC = _readenv("NUMBA_CUDA_ARRAY_INTERFACE_SYNC",
                                              int, 1)
 
+        # Number of closed CUDA IPC handles kept open for reuse (default: 0)
+        CUDA_IPC_CACHE_SIZE = _readenv("NUMBA_CUDA_IPC_CACHE_SIZE", int, 0)
+
         # Path of the directory that the CUDA driver libraries are located
         CUDA_DRIVER = _readenv("NUMBA_CUDA_DRIVER", str, '')
 
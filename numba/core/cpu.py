@@ -5,7 +5,7 @@ import llvmlite.binding as ll
 from llvmlite import ir
 
 from numba import _dynfunc
-from numba.core.callwrapper import PyCallWrapper
+from numba.core.callwrapper import PyCallWrapper, GeneratorFillWrapper
 from numba.core.base import BaseContext, PYOBJECT
 from numba.core import utils, types, config, cgutils, callconv, codegen, externals, fastmathpass, intrinsics
 from numba.core.utils import cached_property
@@ -74,7 +74,7 @@ class CPUContext(BaseContext):
         from numba.misc import gdb_hook, literal
         from numba.np import linalg, polynomial, arraymath, arrayobj
         from numba.np.random import generator_core, generator_methods
-        from numba.typed import typeddict, dictimpl
+        from numba.typed import typeddict, dictimpl, concurrentdict
         from numba.typed import typedlist, listobject
         from numba.experimental import jitclass, function_type
         from numba.np import npdatetime
@@ -183,6 +183,19 @@ class CPUContext(BaseContext):
         builder.build()
         library.add_ir_module(wrapper_module)
 
+    def create_generator_fill_wrapper(self, library, gendesc, env,
+                                      call_helper):
+        wrapper_module = self.create_module("fill_wrapper")
+        fnty = self.call_conv.get_function_type(gendesc.restype,
+                                                gendesc.argtypes)
+        wrapper_callee = ir.Function(wrapper_module, fnty,
+                                     gendesc.llvm_func_name)
+        builder = GeneratorFillWrapper(self, wrapper_module, wrapper_callee,
+                                       gendesc, env, call_helper=call_helper,
+                                       release_gil=False)
+        builder.build()
+        library.add_ir_module(wrapper_module)
+
     def create_cfunc_wrapper(self, library, fndesc, env, call_helper):
         wrapper_module = self.create_module("cfunc_wrapper")
         fnty = self.call_conv.get_function_type(fndesc.restype, fndesc.argtypes)
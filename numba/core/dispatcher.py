@@ -336,6 +336,60 @@ class _DispatcherBase(_dispatcher.Dispatcher):
         assert (not val) or len(self.signatures) > 0
         self._can_compile = not val
 
+    def call_batch(self, arg_tuples, out=None):
+        """Call the function once for each tuple of positional arguments in
+        the sequence `arg_tuples`. This is equivalent to
+        ``[self(*args) for args in arg_tuples]`` but the overload is only
+        resolved when the argument types change, and the calls don't go
+        through the interpreter.
+
+        The results are returned as a list, or stored in `out`, a mutable
+        sequence such as an array of the same length, which is then returned.
+        """
+        return self._call_batch(arg_tuples, out)
+
+    def enable_stats(self, enable=True, sample_interval=64):
+        """Enable, or disable and discard, the collection of call statistics
+        for this dispatcher, see get_stats(). The dispatch latency is
+        measured for one call in every `sample_interval`, or never if it is
+        0.
+        """
+        self._enable_stats(enable, sample_interval)
+
+    def reset_stats(self):
+        """Reset the call statistics to zero.
+        """
+        self._reset_stats()
+
+    def get_stats(self):
+        """Return the call statistics collected since they were enabled or
+        last reset, or None if they aren't enabled. This is a dict of:
+
+        - calls: the number of calls
+        - misses: the calls that didn't resolve to a single compiled
+          overload
+        - cache_misses: the overload resolutions that missed the resolution
+          cache
+        - compiles: the calls that triggered a compilation
+        - fallbacks: the calls to the object mode fallback
+        - overloads: a dict of the number of calls per signature
+        - samples: the number of calls whose latency was measured
+        - dispatch_ns: their total time, in nanoseconds, from entering the
+          dispatcher to calling the compiled overload, which excludes the
+          time spent in the compiled wrapper
+        - dispatch_max_ns: the maximum of that time
+        - call_ns: their total time in the compiled wrapper
+        - sample_interval: the sampling interval of the latency
+        """
+        stats = self._get_stats()
+        if stats is None:
+            return None
+        sigs = {id(cres.entry_point): sig
+                for sig, cres in self.overloads.items()}
+        stats['overloads'] = {sigs.get(id(func), func): count
+                              for func, count in stats['overloads']}
+        return stats
+
     def add_overload(self, cres):
         args = tuple(cres.signature.args)
         sig = [a._code for a in args]
@@ -44,6 +44,29 @@ class GeneratorDescriptor(FunctionDescriptor):
         """
         return 'finalize_' + self.mangled_name
 
+    @property
+    def llvm_fill_name(self):
+        """
+        The LLVM name of the generator's bulk filling function
+        (if get_fill_dtype() of the generator type is not None).
+        """
+        return 'fill_' + self.mangled_name
+
+
+def get_fill_dtype(gentype):
+    """
+    Return the NumPy dtype of the values yielded by a generator of type
+    *gentype* if they can be stored in an array without boxing them, which
+    the generator's bulk filling function does, otherwise None.
+    """
+    yield_type = gentype.yield_type
+    if (not isinstance(yield_type, (types.Integer, types.Float,
+                                    types.Complex, types.Boolean))
+            or isinstance(yield_type, types.Literal)):
+        return None
+    from numba.np import numpy_support
+    return numpy_support.as_dtype(yield_type)
+
 
 class BaseGeneratorLower(object):
     """
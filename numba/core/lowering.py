@@ -274,6 +274,10 @@ class BaseLower(object):
                                                 self.genlower.gendesc,
                                                 self.env, self.call_helper,
                                                 release_gil=release_gil)
+            if generators.get_fill_dtype(self.genlower.gentype) is not None:
+                self.context.create_generator_fill_wrapper(
+                    self.library, self.genlower.gendesc, self.env,
+                    self.call_helper)
         self.context.create_cpython_wrapper(self.library, self.fndesc,
                                             self.env, self.call_helper,
                                             release_gil=release_gil)
@@ -1213,6 +1213,36 @@ class PythonAPI(object):
                                       serial_aryty_pytype,
                                       ndim, writable, dtypeptr])
 
+    def nrt_adapt_ndarrays_to_python(self, tupty, tup, dtypeptr):
+        """
+        Box the homogeneous tuple of arrays *tup* into a new tuple object,
+        converting all the arrays in a single call.
+        """
+        assert self.context.enable_nrt, "NRT required"
+
+        aryty = tupty.dtype
+        intty = ir.IntType(32)
+        serial_aryty_pytype = self.unserialize(self.serialize_object(aryty.box_type))
+
+        fnty = ir.FunctionType(self.pyobj,
+                               [self.voidptr, self.py_ssize_t, self.py_ssize_t,
+                                self.pyobj, intty, intty, self.pyobj])
+        fn = self._get_function(fnty, name="NRT_adapt_ndarrays_to_python_acqref")
+        fn.args[0].add_attribute('nocapture')
+
+        count = self.py_ssize_t(tupty.count)
+        arystruct_size = self.py_ssize_t(
+            self.context.get_abi_sizeof(self.context.get_value_type(aryty)))
+        ndim = self.context.get_constant(types.int32, aryty.ndim)
+        writable = self.context.get_constant(types.int32, int(aryty.mutable))
+
+        tupptr = cgutils.alloca_once_value(self.builder, tup)
+        return self.builder.call(fn, [self.builder.bitcast(tupptr,
+                                                           self.voidptr),
+                                      count, arystruct_size,
+                                      serial_aryty_pytype,
+                                      ndim, writable, dtypeptr])
+
     def nrt_meminfo_new_from_pyobject(self, data, pyobj):
         """
         Allocate a new MemInfo with data payload borrowed from a python
@@ -1467,11 +1497,30 @@ class PythonAPI(object):
         else:
             finalizer = Constant(ir.PointerType(finalizerty), None)
 
-        # PyObject *numba_make_generator(state_size, initial_state, nextfunc, finalizer, env)
+        # This is the bulk filling function generated by GeneratorFillWrapper
+        from numba.core.generators import get_fill_dtype
+        fillty = ir.FunctionType(self.py_ssize_t, [self.pyobj, self.voidptr,
+                                                   self.py_ssize_t,
+                                                   self.py_ssize_t])
+        fill_dtype = get_fill_dtype(typ)
+        if fill_dtype is not None:
+            fill = self._get_function(fillty, name=gendesc.llvm_fill_name)
+            fill_kind = ord(fill_dtype.kind)
+            fill_itemsize = fill_dtype.itemsize
+        else:
+            fill = Constant(ir.PointerType(fillty), None)
+            fill_kind = fill_itemsize = 0
+
+        # PyObject *numba_make_generator(state_size, initial_state, nextfunc,
+        #                                finalizer, fillfunc, fill_kind,
+        #                                fill_itemsize, env)
         fnty = ir.FunctionType(self.pyobj, [self.py_ssize_t,
                                             self.voidptr,
                                             ir.PointerType(genfnty),
                                             ir.PointerType(finalizerty),
+                                            ir.PointerType(fillty),
+                                            ir.IntType(32),
+                                            self.py_ssize_t,
                                             self.voidptr])
         fn = self._get_function(fnty, name="numba_make_generator")
 
@@ -1482,7 +1531,10 @@ class PythonAPI(object):
         env = self.builder.bitcast(env, self.voidptr)
 
         return self.builder.call(fn,
-                                 (state_size, initial_state, genfn, finalizer, env))
+                                 (state_size, initial_state, genfn, finalizer,
+                                  fill, Constant(ir.IntType(32), fill_kind),
+                                  Constant(self.py_ssize_t, fill_itemsize),
+                                  env))
 
     def numba_array_adaptor(self, ary, ptr):
         assert not self.context.enable_nrt
@@ -45,6 +45,8 @@ typedef struct {
     NRT_MemInfo *meminfo;
 } MemInfoObject;
 
+static PyTypeObject MemInfoType;
+
 
 static
 int MemInfo_init(MemInfoObject *self, PyObject *args, PyObject *kwds) {
@@ -131,13 +133,47 @@ MemInfo_get_parent(MemInfoObject *self, void *closure) {
     }
 }
 
+/*
+ * Free list of MemInfoObjects, as every array returned from a jitted function
+ * is based on one.  Only the exact MemInfoType is kept, and the list is
+ * protected by the GIL.
+ */
+#define MEMINFO_MAXFREELIST 64
+static MemInfoObject *meminfo_freelist[MEMINFO_MAXFREELIST];
+static int meminfo_numfree = 0;
+
 static void
 MemInfo_dealloc(MemInfoObject *self)
 {
     NRT_MemInfo_release(self->meminfo);
+    if (Py_TYPE(self) == &MemInfoType &&
+        meminfo_numfree < MEMINFO_MAXFREELIST) {
+        meminfo_freelist[meminfo_numfree++] = self;
+        return;
+    }
     Py_TYPE(self)->tp_free((PyObject*)self);
 }
 
+/*
+ * Create a MemInfoObject for *meminfo*, stealing the NRT reference.
+ */
+static MemInfoObject *
+MemInfo_new_from_meminfo(NRT_MemInfo *meminfo)
+{
+    MemInfoObject *miobj;
+    if (meminfo_numfree > 0) {
+        miobj = meminfo_freelist[--meminfo_numfree];
+        (void) PyObject_INIT(miobj, &MemInfoType);
+    }
+    else {
+        miobj = PyObject_New(MemInfoObject, &MemInfoType);
+        if (miobj == NULL)
+            return NULL;
+    }
+    miobj->meminfo = meminfo;
+    return miobj;
+}
+
 static PyMethodDef MemInfo_methods[] = {
     {"acquire", (PyCFunction)MemInfo_acquire, METH_NOARGS,
      "Increment the reference count"
@@ -294,7 +330,10 @@ PyObject* try_to_return_parent(arystruct_t *arystruct, int ndim,
     if (PyArray_NDIM(array) != ndim)
         goto RETURN_ARRAY_COPY;
 
-    if (PyObject_RichCompareBool((PyObject *) PyArray_DESCR(array),
+    /* The descr is a constant of the environment, usually the very object
+       of the parent array for the builtin dtypes */
+    if (PyArray_DESCR(array) != descr &&
+        PyObject_RichCompareBool((PyObject *) PyArray_DESCR(array),
                                  (PyObject *) descr, Py_EQ) <= 0)
         goto RETURN_ARRAY_COPY;
 
@@ -314,42 +353,35 @@ RETURN_ARRAY_COPY:
     return NULL;
 }
 
-/**
- * This function is used during the boxing of ndarray type.
- * `arystruct` is a structure containing essential information from the
- *             unboxed array.
- * `retty` is the subtype of the NumPy PyArray_Type this function should return.
- *         This is related to `numba.core.types.Array.box_type`.
- * `ndim` is the number of dimension of the array.
- * `writeable` corresponds to the "writable" flag in NumPy ndarray.
- * `descr` is the NumPy data type description.
- *
- * This function was renamed in 0.52.0 to specify that it acquires references.
- * It used to steal the reference of the arystruct.
- * Refer to https://github.com/numba/numba/pull/6446
- */
-NUMBA_EXPORT_FUNC(PyObject *)
-NRT_adapt_ndarray_to_python_acqref(arystruct_t* arystruct, PyTypeObject *retty,
-                            int ndim, int writeable, PyArray_Descr *descr)
+static int
+check_ndarray_descr(PyArray_Descr *descr)
 {
-    PyArrayObject *array;
-    MemInfoObject *miobj = NULL;
-    PyObject *args;
-    npy_intp *shape, *strides;
-    int flags = 0;
-
     if (descr == NULL) {
         PyErr_Format(PyExc_RuntimeError,
                      "In 'NRT_adapt_ndarray_to_python', 'descr' is NULL");
-        return NULL;
+        return -1;
     }
 
     if (!NUMBA_PyArray_DescrCheck(descr)) {
         PyErr_Format(PyExc_TypeError,
                      "expected dtype object, got '%.200s'",
                      Py_TYPE(descr)->tp_name);
-        return NULL;
+        return -1;
     }
+    return 0;
+}
+
+/*
+ * Box *arystruct* once *descr* has been checked.
+ */
+static PyObject *
+adapt_ndarray_to_python(arystruct_t* arystruct, PyTypeObject *retty,
+                        int ndim, int writeable, PyArray_Descr *descr)
+{
+    PyArrayObject *array;
+    MemInfoObject *miobj = NULL;
+    npy_intp *shape, *strides;
+    int flags = 0;
 
     if (arystruct->parent) {
         PyObject *obj = try_to_return_parent(arystruct, ndim, descr);
@@ -359,22 +391,14 @@ NRT_adapt_ndarray_to_python_acqref(arystruct_t* arystruct, PyTypeObject *retty,
     }
 
     if (arystruct->meminfo) {
-        /* wrap into MemInfoObject */
-        miobj = PyObject_New(MemInfoObject, &MemInfoType);
-        args = PyTuple_New(1);
-        /* SETITEM steals reference */
-        PyTuple_SET_ITEM(args, 0, PyLong_FromVoidPtr(arystruct->meminfo));
-        NRT_Debug(nrt_debug_print("NRT_adapt_ndarray_to_python arystruct->meminfo=%p\n", arystruct->meminfo));
-        /*  Note: MemInfo_init() does not incref.  This function steals the
-         *        NRT reference, which we need to acquire.
-         */
-        NRT_Debug(nrt_debug_print("NRT_adapt_ndarray_to_python_acqref created MemInfo=%p\n", miobj));
-        NRT_MemInfo_acquire(arystruct->meminfo);
-        if (MemInfo_init(miobj, args, NULL)) {
-            NRT_Debug(nrt_debug_print("MemInfo_init failed.\n"));
+        /* wrap into MemInfoObject, which steals the NRT reference that
+           we need to acquire */
+        miobj = MemInfo_new_from_meminfo(arystruct->meminfo);
+        if (miobj == NULL)
             return NULL;
-        }
-        Py_DECREF(args);
+        NRT_MemInfo_acquire(arystruct->meminfo);
+        NRT_Debug(nrt_debug_print("NRT_adapt_ndarray_to_python_acqref created MemInfo=%p for meminfo=%p\n",
+                                  miobj, arystruct->meminfo));
     }
 
     shape = arystruct->shape_and_strides;
@@ -384,8 +408,10 @@ NRT_adapt_ndarray_to_python_acqref(arystruct_t* arystruct, PyTypeObject *retty,
                                                    shape, strides, arystruct->data,
                                                    flags, (PyObject *) miobj);
 
-    if (array == NULL)
+    if (array == NULL) {
+        Py_XDECREF(miobj);
         return NULL;
+    }
 
     /* Set writable */
 #if NPY_API_VERSION >= 0x00000007
@@ -422,6 +448,64 @@ NRT_adapt_ndarray_to_python_acqref(arystruct_t* arystruct, PyTypeObject *retty,
     return (PyObject *) array;
 }
 
+/**
+ * This function is used during the boxing of ndarray type.
+ * `arystruct` is a structure containing essential information from the
+ *             unboxed array.
+ * `retty` is the subtype of the NumPy PyArray_Type this function should return.
+ *         This is related to `numba.core.types.Array.box_type`.
+ * `ndim` is the number of dimension of the array.
+ * `writeable` corresponds to the "writable" flag in NumPy ndarray.
+ * `descr` is the NumPy data type description.
+ *
+ * This function was renamed in 0.52.0 to specify that it acquires references.
+ * It used to steal the reference of the arystruct.
+ * Refer to https://github.com/numba/numba/pull/6446
+ */
+NUMBA_EXPORT_FUNC(PyObject *)
+NRT_adapt_ndarray_to_python_acqref(arystruct_t* arystruct, PyTypeObject *retty,
+                            int ndim, int writeable, PyArray_Descr *descr)
+{
+    if (check_ndarray_descr(descr))
+        return NULL;
+    return adapt_ndarray_to_python(arystruct, retty, ndim, writeable, descr);
+}
+
+/**
+ * Box the `count` arrays of a homogeneous tuple into a new tuple object.
+ * `arystructs` points to the `count` array structures, laid out every
+ *              `arystruct_size` bytes.
+ * The other arguments are those of NRT_adapt_ndarray_to_python_acqref(),
+ * shared by all the arrays.  The references of the arystructs are acquired.
+ */
+NUMBA_EXPORT_FUNC(PyObject *)
+NRT_adapt_ndarrays_to_python_acqref(void *arystructs, Py_ssize_t count,
+                                    Py_ssize_t arystruct_size,
+                                    PyTypeObject *retty, int ndim,
+                                    int writeable, PyArray_Descr *descr)
+{
+    PyObject *tuple;
+    Py_ssize_t i;
+
+    if (check_ndarray_descr(descr))
+        return NULL;
+    tuple = PyTuple_New(count);
+    if (tuple == NULL)
+        return NULL;
+    for (i = 0; i < count; i++) {
+        arystruct_t *arystruct = (arystruct_t *)
+            ((char *) arystructs + i * arystruct_size);
+        PyObject *array = adapt_ndarray_to_python(arystruct, retty, ndim,
+                                                  writeable, descr);
+        if (array == NULL) {
+            Py_DECREF(tuple);
+            return NULL;
+        }
+        PyTuple_SET_ITEM(tuple, i, array);
+    }
+    return tuple;
+}
+
 NUMBA_EXPORT_FUNC(void)
 NRT_adapt_buffer_from_python(Py_buffer *buf, arystruct_t *arystruct)
 {
@@ -447,6 +531,229 @@ NRT_adapt_buffer_from_python(Py_buffer *buf, arystruct_t *arystruct)
 }
 
 
+/*
+ * DLPack import
+ *
+ * The structures below are those of the DLPack ABI (dlpack.h), which is
+ * stable across its versions.
+ */
+
+typedef struct {
+    int device_type;
+    int32_t device_id;
+} NRT_DLDevice;
+
+typedef struct {
+    uint8_t code;
+    uint8_t bits;
+    uint16_t lanes;
+} NRT_DLDataType;
+
+typedef struct {
+    void *data;
+    NRT_DLDevice device;
+    int32_t ndim;
+    NRT_DLDataType dtype;
+    int64_t *shape;
+    int64_t *strides;
+    uint64_t byte_offset;
+} NRT_DLTensor;
+
+typedef struct NRT_DLManagedTensor {
+    NRT_DLTensor dl_tensor;
+    void *manager_ctx;
+    void (*deleter)(struct NRT_DLManagedTensor *self);
+} NRT_DLManagedTensor;
+
+/* Device types whose memory is accessible from the host */
+#define NRT_DL_CPU 1
+#define NRT_DL_CUDA_HOST 3
+#define NRT_DL_ROCM_HOST 11
+
+/* Type codes */
+#define NRT_DL_INT 0
+#define NRT_DL_UINT 1
+#define NRT_DL_FLOAT 2
+#define NRT_DL_COMPLEX 5
+#define NRT_DL_BOOL 6
+
+static void
+dlpack_dtor(void *ptr, size_t size, void *info) {
+    PyGILState_STATE gstate;
+    NRT_DLManagedTensor *managed = info;
+
+    /* the deleters of the Python frameworks may need the GIL */
+    gstate = PyGILState_Ensure();
+    if (managed->deleter)
+        managed->deleter(managed);
+    PyGILState_Release(gstate);
+}
+
+static int
+dlpack_typenum(NRT_DLDataType dtype)
+{
+    if (dtype.lanes != 1)
+        return -1;
+    switch (dtype.code) {
+    case NRT_DL_INT:
+        switch (dtype.bits) {
+        case 8: return NPY_INT8;
+        case 16: return NPY_INT16;
+        case 32: return NPY_INT32;
+        case 64: return NPY_INT64;
+        }
+        break;
+    case NRT_DL_UINT:
+        switch (dtype.bits) {
+        case 8: return NPY_UINT8;
+        case 16: return NPY_UINT16;
+        case 32: return NPY_UINT32;
+        case 64: return NPY_UINT64;
+        }
+        break;
+    case NRT_DL_FLOAT:
+        switch (dtype.bits) {
+        case 16: return NPY_FLOAT16;
+        case 32: return NPY_FLOAT32;
+        case 64: return NPY_FLOAT64;
+        }
+        break;
+    case NRT_DL_COMPLEX:
+        switch (dtype.bits) {
+        case 64: return NPY_COMPLEX64;
+        case 128: return NPY_COMPLEX128;
+        }
+        break;
+    case NRT_DL_BOOL:
+        if (dtype.bits == 8)
+            return NPY_BOOL;
+        break;
+    }
+    return -1;
+}
+
+/*
+ * Wrap a DLPack tensor as a NumPy array without copying it.  *obj* is either
+ * a "dltensor" capsule or an object with a __dlpack__() method.  The array
+ * is based on a MemInfo owning the tensor, whose deleter is called when the
+ * MemInfo is released, so the array can be passed to and returned from
+ * jitted code like any NRT-allocated array.
+ */
+NUMBA_EXPORT_FUNC(PyObject *)
+NRT_adapt_dlpack_to_ndarray(PyObject *obj)
+{
+    PyObject *capsule;
+    NRT_DLManagedTensor *managed;
+    NRT_DLTensor *tensor;
+    NRT_MemInfo *mi;
+    MemInfoObject *miobj;
+    PyArray_Descr *descr;
+    PyArrayObject *array;
+    npy_intp shape[NPY_MAXDIMS], strides[NPY_MAXDIMS];
+    npy_intp nitems = 1, stride;
+    void *data;
+    int typenum, i;
+
+    if (PyCapsule_CheckExact(obj)) {
+        Py_INCREF(obj);
+        capsule = obj;
+    }
+    else {
+        capsule = PyObject_CallMethod(obj, "__dlpack__", NULL);
+        if (capsule == NULL)
+            return NULL;
+    }
+    managed = PyCapsule_GetPointer(capsule, "dltensor");
+    if (managed == NULL) {
+        if (PyErr_ExceptionMatches(PyExc_ValueError)) {
+            PyErr_Clear();
+            PyErr_SetString(PyExc_ValueError,
+                            "expected an unconsumed DLPack capsule");
+        }
+        goto error;
+    }
+    tensor = &managed->dl_tensor;
+
+    if (tensor->device.device_type != NRT_DL_CPU &&
+        tensor->device.device_type != NRT_DL_CUDA_HOST &&
+        tensor->device.device_type != NRT_DL_ROCM_HOST) {
+        PyErr_Format(PyExc_BufferError,
+                     "DLPack tensor on device type %d is not accessible "
+                     "from the host", tensor->device.device_type);
+        goto error;
+    }
+    if (tensor->ndim < 0 || tensor->ndim > NPY_MAXDIMS) {
+        PyErr_Format(PyExc_ValueError,
+                     "unsupported DLPack tensor dimension %d",
+                     (int) tensor->ndim);
+        goto error;
+    }
+    typenum = dlpack_typenum(tensor->dtype);
+    if (typenum < 0) {
+        PyErr_Format(PyExc_TypeError,
+                     "unsupported DLPack dtype (code=%d, bits=%d, lanes=%d)",
+                     (int) tensor->dtype.code, (int) tensor->dtype.bits,
+                     (int) tensor->dtype.lanes);
+        goto error;
+    }
+    descr = PyArray_DescrFromType(typenum);
+    if (descr == NULL)
+        goto error;
+
+    /* DLPack strides are in elements, NULL meaning C-contiguous */
+    stride = descr->elsize;
+    for (i = tensor->ndim - 1; i >= 0; i--) {
+        shape[i] = (npy_intp) tensor->shape[i];
+        if (tensor->strides) {
+            strides[i] = (npy_intp) tensor->strides[i] * descr->elsize;
+        }
+        else {
+            strides[i] = stride;
+            stride *= shape[i];
+        }
+        nitems *= shape[i];
+    }
+    data = (char *) tensor->data + tensor->byte_offset;
+
+    /* The capsule is consumed: the MemInfo now owns the tensor */
+    if (PyCapsule_SetName(capsule, "used_dltensor")) {
+        Py_DECREF(descr);
+        goto error;
+    }
+    Py_DECREF(capsule);
+    mi = NRT_MemInfo_new(data, nitems * descr->elsize, dlpack_dtor, managed);
+    if (mi == NULL) {
+        Py_DECREF(descr);
+        dlpack_dtor(data, 0, managed);
+        return PyErr_NoMemory();
+    }
+    miobj = MemInfo_new_from_meminfo(mi);
+    if (miobj == NULL) {
+        Py_DECREF(descr);
+        NRT_MemInfo_release(mi);
+        return NULL;
+    }
+
+    array = (PyArrayObject *) PyArray_NewFromDescr(&PyArray_Type, descr,
+                                                   tensor->ndim, shape,
+                                                   strides, data,
+                                                   NPY_ARRAY_WRITEABLE, NULL);
+    if (array == NULL) {
+        Py_DECREF(miobj);
+        return NULL;
+    }
+    if (-1 == PyArray_SetBaseObject(array, (PyObject *) miobj)) {
+        Py_DECREF(array);
+        Py_DECREF(miobj);
+        return NULL;
+    }
+    return (PyObject *) array;
+
+error:
+    Py_DECREF(capsule);
+    return NULL;
+}
+
 /* Initialization subroutines for modules including this source file */
 
 static int
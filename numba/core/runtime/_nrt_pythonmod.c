@@ -17,6 +17,26 @@ memsys_use_cpython_allocator(PyObject *self, PyObject *args) {
     Py_RETURN_NONE;
 }
 
+static PyObject *
+memsys_set_pool_allocator(PyObject *self, PyObject *args) {
+    int enable;
+    if (!PyArg_ParseTuple(args, "p", &enable)) {
+        return NULL;
+    }
+    if (NRT_MemSys_set_pool_allocator(enable)) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "cannot change the NRT allocation mode while blocks "
+                        "are allocated");
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+memsys_stats_enabled(PyObject *self, PyObject *args) {
+    return PyBool_FromLong(NRT_MemSys_stats_enabled());
+}
+
 static PyObject *
 memsys_get_stats_alloc(PyObject *self, PyObject *args) {
     return PyLong_FromSize_t(NRT_MemSys_get_stats_alloc());
@@ -38,6 +58,185 @@ memsys_get_stats_mi_free(PyObject *self, PyObject *args) {
 }
 
 
+static PyObject *
+memsys_set_biased_refcount(PyObject *self, PyObject *args) {
+    int enable;
+    if (!PyArg_ParseTuple(args, "p", &enable)) {
+        return NULL;
+    }
+    NRT_MemSys_set_biased_refcount(enable);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+memsys_set_large_allocation(PyObject *self, PyObject *args) {
+    Py_ssize_t threshold;
+    int flags;
+    if (!PyArg_ParseTuple(args, "ni", &threshold, &flags)) {
+        return NULL;
+    }
+    if (threshold < 0) {
+        PyErr_SetString(PyExc_ValueError, "threshold must be non-negative");
+        return NULL;
+    }
+    if (NRT_MemSys_set_large_allocation((size_t)threshold, flags)) {
+        PyErr_SetString(PyExc_NotImplementedError,
+                        "large allocation mapping is not supported on this "
+                        "platform");
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+/*
+ * Allocation tracing
+ */
+
+static PyObject *
+memsys_set_tracing(PyObject *self, PyObject *args) {
+    int enable;
+    if (!PyArg_ParseTuple(args, "p", &enable)) {
+        return NULL;
+    }
+    if (NRT_MemSys_set_tracing(enable)) {
+        return PyErr_NoMemory();
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+memsys_trace_set_tag(PyObject *self, PyObject *args) {
+    const char *tag, *prev;
+    if (!PyArg_ParseTuple(args, "z", &tag)) {
+        return NULL;
+    }
+    prev = NRT_MemSys_trace_set_tag(tag);
+    if (prev == NULL) {
+        Py_RETURN_NONE;
+    }
+    return PyUnicode_FromString(prev);
+}
+
+static PyObject *
+memsys_trace_checkpoint(PyObject *self, PyObject *args) {
+    return PyLong_FromSize_t(NRT_MemSys_trace_checkpoint());
+}
+
+static PyObject *
+trace_histogram(const size_t *counts) {
+    Py_ssize_t i;
+    PyObject *hist = PyList_New(NRT_TRACE_BUCKETS);
+    if (hist == NULL)
+        return NULL;
+    for (i = 0; i < NRT_TRACE_BUCKETS; i++) {
+        PyObject *count = PyLong_FromSize_t(counts[i]);
+        if (count == NULL) {
+            Py_DECREF(hist);
+            return NULL;
+        }
+        PyList_SET_ITEM(hist, i, count);
+    }
+    return hist;
+}
+
+static PyObject *
+memsys_get_trace_summary(PyObject *self, PyObject *args) {
+    NRT_TraceSummary summary;
+    PyObject *size_hist, *lifetime_hist;
+    NRT_MemSys_trace_summary(&summary);
+    size_hist = trace_histogram(summary.size_histogram);
+    if (size_hist == NULL)
+        return NULL;
+    lifetime_hist = trace_histogram(summary.lifetime_histogram);
+    if (lifetime_hist == NULL) {
+        Py_DECREF(size_hist);
+        return NULL;
+    }
+    return Py_BuildValue("{s:n,s:n,s:n,s:n,s:n,s:N,s:N}",
+                         "live_count", (Py_ssize_t)summary.live_count,
+                         "live_bytes", (Py_ssize_t)summary.live_bytes,
+                         "peak_live_bytes",
+                         (Py_ssize_t)summary.peak_live_bytes,
+                         "total_count", (Py_ssize_t)summary.total_count,
+                         "total_bytes", (Py_ssize_t)summary.total_bytes,
+                         "size_histogram", size_hist,
+                         "lifetime_histogram", lifetime_hist);
+}
+
+static PyObject *
+memsys_get_trace_live(PyObject *self, PyObject *args) {
+    Py_ssize_t since;
+    size_t count, max = 0, i;
+    NRT_TraceLiveEntry *entries = NULL;
+    PyObject *result;
+    if (!PyArg_ParseTuple(args, "n", &since)) {
+        return NULL;
+    }
+    /* MemInfos may be created between the calls, retry until they fit */
+    while ((count = NRT_MemSys_trace_live(since, entries, max)) > max) {
+        max = count + count / 4 + 16;
+        PyMem_Free(entries);
+        entries = PyMem_New(NRT_TraceLiveEntry, max);
+        if (entries == NULL)
+            return PyErr_NoMemory();
+    }
+    result = PyList_New(count);
+    if (result == NULL)
+        goto done;
+    for (i = 0; i < count; i++) {
+        NRT_TraceLiveEntry *e = &entries[i];
+        PyObject *item = Py_BuildValue("(NnnznK)",
+                                       PyLong_FromVoidPtr(e->mi),
+                                       (Py_ssize_t)e->size,
+                                       (Py_ssize_t)e->refct,
+                                       e->tag,
+                                       (Py_ssize_t)e->seq,
+                                       e->age_ns);
+        if (item == NULL) {
+            Py_CLEAR(result);
+            goto done;
+        }
+        PyList_SET_ITEM(result, i, item);
+    }
+done:
+    PyMem_Free(entries);
+    return result;
+}
+
+static PyObject *
+memsys_get_trace_tags(PyObject *self, PyObject *args) {
+    size_t count, max = 0, i;
+    NRT_TraceTagEntry *entries = NULL;
+    PyObject *result;
+    while ((count = NRT_MemSys_trace_tags(entries, max)) > max) {
+        max = count + 16;
+        PyMem_Free(entries);
+        entries = PyMem_New(NRT_TraceTagEntry, max);
+        if (entries == NULL)
+            return PyErr_NoMemory();
+    }
+    result = PyDict_New();
+    if (result == NULL)
+        goto done;
+    for (i = 0; i < count; i++) {
+        NRT_TraceTagEntry *e = &entries[i];
+        PyObject *item = Py_BuildValue("(nnn)",
+                                       (Py_ssize_t)e->count,
+                                       (Py_ssize_t)e->bytes,
+                                       (Py_ssize_t)e->live_count);
+        if (item == NULL || PyDict_SetItemString(result, e->tag, item)) {
+            Py_XDECREF(item);
+            Py_CLEAR(result);
+            goto done;
+        }
+        Py_DECREF(item);
+    }
+done:
+    PyMem_Free(entries);
+    return result;
+}
+
+
 /*
  * Create a new MemInfo with a owner PyObject
  */
@@ -86,11 +285,33 @@ meminfo_alloc_safe(PyObject *self, PyObject *args) {
     return PyLong_FromVoidPtr(mi);
 }
 
+/*
+ * Wrap a DLPack tensor as a NumPy array based on a new MemInfo
+ */
+static PyObject *
+array_from_dlpack(PyObject *self, PyObject *args) {
+    PyObject *obj;
+    if (!PyArg_ParseTuple(args, "O", &obj)) {
+        return NULL;
+    }
+    return NRT_adapt_dlpack_to_ndarray(obj);
+}
+
 static PyMethodDef ext_methods[] = {
 #define declmethod(func) { #func , ( PyCFunction )func , METH_VARARGS , NULL }
 #define declmethod_noargs(func) { #func , ( PyCFunction )func , METH_NOARGS, NULL }
     declmethod_noargs(memsys_use_cpython_allocator),
     declmethod_noargs(memsys_shutdown),
+    declmethod(memsys_set_pool_allocator),
+    declmethod(memsys_set_large_allocation),
+    declmethod(memsys_set_biased_refcount),
+    declmethod_noargs(memsys_stats_enabled),
+    declmethod(memsys_set_tracing),
+    declmethod(memsys_trace_set_tag),
+    declmethod_noargs(memsys_trace_checkpoint),
+    declmethod_noargs(memsys_get_trace_summary),
+    declmethod(memsys_get_trace_live),
+    declmethod_noargs(memsys_get_trace_tags),
     declmethod_noargs(memsys_get_stats_alloc),
     declmethod_noargs(memsys_get_stats_free),
     declmethod_noargs(memsys_get_stats_mi_alloc),
@@ -98,6 +319,7 @@ static PyMethodDef ext_methods[] = {
     declmethod(meminfo_new),
     declmethod(meminfo_alloc),
     declmethod(meminfo_alloc_safe),
+    declmethod(array_from_dlpack),
     { NULL },
 #undef declmethod
 };
@@ -126,6 +348,7 @@ build_c_helpers_dict(void)
 
 declmethod(adapt_ndarray_from_python);
 declmethod(adapt_ndarray_to_python_acqref);
+declmethod(adapt_ndarrays_to_python_acqref);
 declmethod(adapt_buffer_from_python);
 declmethod(meminfo_new_from_pyobject);
 declmethod(meminfo_as_pyobject);
@@ -145,9 +368,13 @@ declmethod(MemInfo_varsize_alloc);
 declmethod(MemInfo_data);
 declmethod(MemInfo_varsize_free);
 declmethod(MemInfo_varsize_realloc);
+declmethod(MemInfo_varsize_capacity);
+declmethod(MemInfo_acquire);
 declmethod(MemInfo_release);
 declmethod(Allocate);
 declmethod(Free);
+declmethod(Arena_push);
+declmethod(Arena_pop);
 declmethod(get_api);
 
 
@@ -174,5 +401,9 @@ MOD_INIT(_nrt_python) {
 
     PyModule_AddObject(m, "c_helpers", build_c_helpers_dict());
 
+    PyModule_AddIntMacro(m, NRT_LARGE_THP);
+    PyModule_AddIntMacro(m, NRT_LARGE_HUGETLB);
+    PyModule_AddIntMacro(m, NRT_LARGE_NUMA_LOCAL);
+
     return MOD_SUCCESS_VAL(m);
 }
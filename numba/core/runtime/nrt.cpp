@@ -1,6 +1,16 @@
 /* MSVC C99 doesn't have <stdatomic.h>, else this could be written in easily
  * in C */
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <stdint.h>
 
 #ifdef _MSC_VER
 #include <inttypes.h>
@@ -11,8 +21,17 @@
 #include "nrt.h"
 #include "assert.h"
 
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define NRT_HAVE_MMAP 1
+#endif
+
 
-/* NOTE: if changing the layout, please update numba.core.runtime.atomicops */
+struct nrt_refct_thread;
+
+/* NOTE: if changing the layout, please update numba.core.runtime.nrtdynmod */
 extern "C" {
 struct MemInfo {
     std::atomic_size_t     refct;
@@ -21,9 +40,16 @@ struct MemInfo {
     void              *data;
     size_t            size;    /* only used for NRT allocated memory */
     NRT_ExternalAllocator *external_allocator;
+    /* Owning thread of a biased MemInfo, NULL if refct is a plain count,
+     * see nrt_refct_acquire() */
+    nrt_refct_thread  *owner;
+    /* References held by the owning thread, only it writes to this */
+    std::atomic_size_t biased;
 };
 }
 
+static size_t nrt_refct_total(NRT_MemInfo *mi);
+
 
 /*
  * Misc helpers.
@@ -44,11 +70,38 @@ static void nrt_fatal_error(const char *msg)
  * Global resources.
  */
 
+/*
+ * Allocation statistics are sharded over cache-line sized slots to keep
+ * threads allocating concurrently from contending on the same counters.
+ * Each thread increments the slot it was assigned on first use and the
+ * slots are summed when the statistics are read. Building with
+ * NRT_DISABLE_STATS defined compiles the counting out, the statistics then
+ * read as zero and only whether a block was ever allocated is recorded, so
+ * that the allocator can no longer be changed once a block was allocated.
+ */
+
+#define NRT_STATS_SHARDS 64
+#define NRT_CACHE_LINE 64
+
+struct alignas(NRT_CACHE_LINE) nrt_stats_shard {
+    std::atomic_size_t alloc, free, mi_alloc, mi_free;
+};
+
 struct NRT_MemSys {
     /* Shutdown flag */
     int shutting;
+    /* Serve allocations from the thread-local pool, see nrt_pool_malloc() */
+    int pool;
+    /* Record MemInfo creation and destruction, see nrt_trace_alloc() */
+    int tracing;
+    /* Bias MemInfos towards their creating thread, see nrt_refct_acquire() */
+    int biased_refct;
+    /* MemInfo allocations of at least this size are mapped directly, see
+     * nrt_large_malloc(), 0 disables this */
+    size_t large_threshold;
+    int large_flags;
     /* Stats */
-    std::atomic_size_t stats_alloc, stats_free, stats_mi_alloc, stats_mi_free;
+    nrt_stats_shard stats[NRT_STATS_SHARDS];
     /* System allocation functions */
     struct {
         NRT_malloc_func malloc;
@@ -61,13 +114,80 @@ struct NRT_MemSys {
 /* The Memory System object */
 static NRT_MemSys TheMSys;
 
+#ifndef NRT_DISABLE_STATS
+
+static std::atomic<unsigned> nrt_stats_next_shard(0);
+static thread_local int nrt_stats_tls_shard = -1;
+
+static inline nrt_stats_shard *nrt_stats_local(void) {
+    int shard = nrt_stats_tls_shard;
+    if (shard < 0) {
+        shard = (int)(nrt_stats_next_shard.fetch_add(
+            1, std::memory_order_relaxed) % NRT_STATS_SHARDS);
+        nrt_stats_tls_shard = shard;
+    }
+    return &TheMSys.stats[shard];
+}
+
+#define NRT_STATS_INC(counter) \
+    (nrt_stats_local()->counter.fetch_add(1, std::memory_order_relaxed))
+
+#define NRT_STATS_SUM(counter) nrt_stats_sum(&nrt_stats_shard::counter)
+
+static size_t nrt_stats_sum(std::atomic_size_t nrt_stats_shard::*counter) {
+    size_t total = 0;
+    for (int i = 0; i < NRT_STATS_SHARDS; i++)
+        total += (TheMSys.stats[i].*counter).load(std::memory_order_relaxed);
+    return total;
+}
+
+/* Whether any blocks are allocated */
+static bool nrt_blocks_outstanding(void) {
+    return (NRT_STATS_SUM(alloc) != NRT_STATS_SUM(free) ||
+            NRT_STATS_SUM(mi_alloc) != NRT_STATS_SUM(mi_free));
+}
+
+#else
+
+/* Set on the first allocation, written once so it stays in every cache */
+static std::atomic<bool> nrt_blocks_allocated(false);
+
+static inline void nrt_note_allocation(void) {
+    if (!nrt_blocks_allocated.load(std::memory_order_relaxed))
+        nrt_blocks_allocated.store(true, std::memory_order_relaxed);
+}
+
+#define NRT_STATS_INC_alloc() nrt_note_allocation()
+#define NRT_STATS_INC_mi_alloc() nrt_note_allocation()
+#define NRT_STATS_INC_free() ((void)0)
+#define NRT_STATS_INC_mi_free() ((void)0)
+#define NRT_STATS_INC(counter) NRT_STATS_INC_##counter()
+#define NRT_STATS_SUM(counter) ((size_t)0)
+
+/* Without the counts, blocks may be outstanding once any was allocated */
+static bool nrt_blocks_outstanding(void) {
+    return nrt_blocks_allocated.load(std::memory_order_relaxed);
+}
+
+#endif /* NRT_DISABLE_STATS */
+
 
 extern "C" void NRT_MemSys_init(void) {
     TheMSys.shutting = 0;
-    TheMSys.stats_alloc = 0;
-    TheMSys.stats_free = 0;
-    TheMSys.stats_mi_alloc = 0;
-    TheMSys.stats_mi_free = 0;
+    TheMSys.pool = 0;
+    TheMSys.tracing = 0;
+    TheMSys.biased_refct = 0;
+    TheMSys.large_threshold = 0;
+    TheMSys.large_flags = 0;
+#ifdef NRT_DISABLE_STATS
+    nrt_blocks_allocated.store(false);
+#endif
+    for (int i = 0; i < NRT_STATS_SHARDS; i++) {
+        TheMSys.stats[i].alloc = 0;
+        TheMSys.stats[i].free = 0;
+        TheMSys.stats[i].mi_alloc = 0;
+        TheMSys.stats[i].mi_free = 0;
+    }
     /* Bind to libc allocator */
     TheMSys.allocator.malloc = malloc;
     TheMSys.allocator.realloc = realloc;
@@ -85,8 +205,7 @@ extern "C" void NRT_MemSys_set_allocator(NRT_malloc_func malloc_func,
     if ((malloc_func != TheMSys.allocator.malloc ||
          realloc_func != TheMSys.allocator.realloc ||
          free_func != TheMSys.allocator.free) &&
-         (TheMSys.stats_alloc != TheMSys.stats_free ||
-          TheMSys.stats_mi_alloc != TheMSys.stats_mi_free)) {
+         nrt_blocks_outstanding()) {
         nrt_fatal_error("cannot change allocator while blocks are allocated");
     }
     TheMSys.allocator.malloc = malloc_func;
@@ -94,20 +213,1077 @@ extern "C" void NRT_MemSys_set_allocator(NRT_malloc_func malloc_func,
     TheMSys.allocator.free = free_func;
 }
 
+extern "C" int NRT_MemSys_set_pool_allocator(int enable) {
+    enable = enable != 0;
+    if (enable != TheMSys.pool && nrt_blocks_outstanding()) {
+        /* blocks must be freed by the scheme that allocated them */
+        return -1;
+    }
+    TheMSys.pool = enable;
+    return 0;
+}
+
+extern "C" int NRT_MemSys_stats_enabled(void) {
+#ifndef NRT_DISABLE_STATS
+    return 1;
+#else
+    return 0;
+#endif
+}
+
 extern "C" size_t NRT_MemSys_get_stats_alloc() {
-    return TheMSys.stats_alloc;
+    return NRT_STATS_SUM(alloc);
 }
 
 extern "C" size_t NRT_MemSys_get_stats_free() {
-    return TheMSys.stats_free;
+    return NRT_STATS_SUM(free);
 }
 
 extern "C" size_t NRT_MemSys_get_stats_mi_alloc() {
-    return TheMSys.stats_mi_alloc;
+    return NRT_STATS_SUM(mi_alloc);
 }
 
 extern "C" size_t NRT_MemSys_get_stats_mi_free() {
-    return TheMSys.stats_mi_free;
+    return NRT_STATS_SUM(mi_free);
+}
+
+/*
+ * Thread-local size-class pool allocator.
+ *
+ * When enabled with NRT_MemSys_set_pool_allocator() every block from
+ * NRT_Allocate() is preceded by a nrt_pool_header. Requests of up to
+ * NRT_POOL_MAX_SIZE bytes are rounded up to one of NRT_POOL_NUM_CLASSES size
+ * classes and served from a free list in the calling thread's cache, which is
+ * refilled by carving slabs obtained from the system allocator. Larger
+ * requests go straight to the system allocator.
+ *
+ * A block freed by the thread owning its cache goes back on that cache's free
+ * list. A block freed by any other thread is pushed onto a lock-free list of
+ * remote frees for its owner, which the owner takes in one go when its own
+ * free list runs dry. A cache is released when its thread exits and is
+ * adopted, blocks and all, by the next thread to need one. Slabs and caches
+ * are never returned to the system.
+ */
+
+#define NRT_POOL_NUM_CLASSES 40
+#define NRT_POOL_MAX_SIZE 32768
+#define NRT_POOL_LARGE 0xffffffffu
+#define NRT_POOL_MAGIC 0x4e52544cu
+#define NRT_POOL_HEADER_SIZE 16
+#define NRT_POOL_SLAB_SIZE (64 * 1024)
+#define NRT_POOL_SLAB_MIN_BLOCKS 8
+
+struct nrt_thread_cache;
+
+struct nrt_pool_header {
+    union {
+        nrt_thread_cache *owner;  /* small blocks */
+        size_t size;              /* large blocks */
+    };
+    uint32_t size_class;
+    uint32_t magic;
+};
+
+static_assert(sizeof(nrt_pool_header) <= NRT_POOL_HEADER_SIZE,
+              "pool header must preserve the payload alignment");
+
+struct nrt_pool_class {
+    void *free_list;  /* linked through the first word of the payload */
+    char *slab_cursor;
+    char *slab_end;
+};
+
+struct nrt_thread_cache {
+    nrt_pool_class classes[NRT_POOL_NUM_CLASSES];
+    std::atomic<void *> remote[NRT_POOL_NUM_CLASSES];
+    std::atomic<bool> in_use;
+};
+
+static std::mutex nrt_pool_registry_lock;
+/* Allocated on first use and never destroyed so that threads exiting during
+ * process teardown can still release their cache.
+ */
+static std::vector<nrt_thread_cache *> *nrt_pool_registry = NULL;
+
+static thread_local nrt_thread_cache *nrt_pool_tls_cache = NULL;
+static thread_local bool nrt_pool_tls_destroyed = false;
+
+/* Releases the thread's cache for adoption when the thread exits */
+struct nrt_pool_cache_ref {
+    nrt_thread_cache *cache;
+    ~nrt_pool_cache_ref() {
+        nrt_pool_tls_destroyed = true;
+        nrt_pool_tls_cache = NULL;
+        if (cache)
+            cache->in_use.store(false, std::memory_order_release);
+    }
+};
+
+static thread_local nrt_pool_cache_ref nrt_pool_tls_ref = { NULL };
+
+static inline unsigned nrt_pool_log2(unsigned long long v) {
+#if defined(__GNUC__)
+    return (unsigned)(sizeof(unsigned long long) * 8 - 1 -
+                      __builtin_clzll(v));
+#else
+    unsigned r = 0;
+    while (v >>= 1)
+        r++;
+    return r;
+#endif
+}
+
+/* Classes are multiples of 16 up to 128 bytes then four per doubling */
+static inline unsigned nrt_pool_size_class(size_t size) {
+    unsigned b;
+    if (size <= 128)
+        return size ? (unsigned)((size + 15) / 16 - 1) : 0;
+    b = nrt_pool_log2(size - 1);
+    return 8 + (b - 7) * 4 +
+           (unsigned)(((size - ((size_t)1 << b)) + ((size_t)1 << (b - 2)) - 1)
+                      >> (b - 2)) - 1;
+}
+
+static inline size_t nrt_pool_class_size(unsigned cls) {
+    unsigned b;
+    if (cls < 8)
+        return ((size_t)cls + 1) * 16;
+    b = 7 + (cls - 8) / 4;
+    return ((size_t)1 << b) + ((size_t)((cls - 8) % 4 + 1) << (b - 2));
+}
+
+static inline nrt_pool_header *nrt_pool_header_of(void *ptr) {
+    nrt_pool_header *hdr = (nrt_pool_header *)((char *)ptr - NRT_POOL_HEADER_SIZE);
+    if (hdr->magic != NRT_POOL_MAGIC)
+        nrt_fatal_error("NRT pool: freeing a block it did not allocate");
+    return hdr;
+}
+
+/* Get the calling thread's cache, adopting a released one if possible.
+ * Returns NULL if the thread is exiting or no cache could be allocated.
+ */
+static nrt_thread_cache *nrt_pool_get_cache(void) {
+    nrt_thread_cache *cache = nrt_pool_tls_cache;
+    if (cache || nrt_pool_tls_destroyed)
+        return cache;
+    {
+        std::lock_guard<std::mutex> guard(nrt_pool_registry_lock);
+        if (!nrt_pool_registry) {
+            nrt_pool_registry = new (std::nothrow) std::vector<nrt_thread_cache *>();
+            if (!nrt_pool_registry)
+                return NULL;
+        }
+        for (nrt_thread_cache *c : *nrt_pool_registry) {
+            bool expected = false;
+            if (c->in_use.compare_exchange_strong(expected, true,
+                                                  std::memory_order_acquire)) {
+                cache = c;
+                break;
+            }
+        }
+        if (!cache) {
+            cache = new (std::nothrow) nrt_thread_cache();
+            if (!cache)
+                return NULL;
+            try {
+                nrt_pool_registry->push_back(cache);
+            } catch (...) {
+                delete cache;
+                return NULL;
+            }
+            cache->in_use.store(true, std::memory_order_relaxed);
+        }
+    }
+    nrt_pool_tls_ref.cache = cache;
+    nrt_pool_tls_cache = cache;
+    return cache;
+}
+
+static void *nrt_pool_malloc_large(size_t size) {
+    nrt_pool_header *hdr;
+    if (size > (size_t)-1 - NRT_POOL_HEADER_SIZE)
+        return NULL;
+    hdr = (nrt_pool_header *)TheMSys.allocator.malloc(size + NRT_POOL_HEADER_SIZE);
+    if (!hdr)
+        return NULL;
+    hdr->size = size;
+    hdr->size_class = NRT_POOL_LARGE;
+    hdr->magic = NRT_POOL_MAGIC;
+    return (char *)hdr + NRT_POOL_HEADER_SIZE;
+}
+
+static void *nrt_pool_malloc(size_t size) {
+    nrt_thread_cache *cache;
+    nrt_pool_class *pc;
+    nrt_pool_header *hdr;
+    unsigned cls;
+    void *ptr;
+    if (size > NRT_POOL_MAX_SIZE || !(cache = nrt_pool_get_cache()))
+        return nrt_pool_malloc_large(size);
+    cls = nrt_pool_size_class(size);
+    pc = &cache->classes[cls];
+    if (!pc->free_list) {
+        /* take everything other threads have freed back to us */
+        pc->free_list = cache->remote[cls].exchange(NULL, std::memory_order_acquire);
+    }
+    if ((ptr = pc->free_list)) {
+        pc->free_list = *(void **)ptr;
+        return ptr;
+    }
+    /* carve a new block */
+    {
+        size_t stride = NRT_POOL_HEADER_SIZE + nrt_pool_class_size(cls);
+        if ((size_t)(pc->slab_end - pc->slab_cursor) < stride) {
+            size_t slab_size = NRT_POOL_SLAB_SIZE;
+            if (slab_size < stride * NRT_POOL_SLAB_MIN_BLOCKS)
+                slab_size = stride * NRT_POOL_SLAB_MIN_BLOCKS;
+            char *slab = (char *)TheMSys.allocator.malloc(slab_size);
+            if (!slab)
+                return NULL;
+            pc->slab_cursor = slab;
+            pc->slab_end = slab + slab_size;
+        }
+        hdr = (nrt_pool_header *)pc->slab_cursor;
+        pc->slab_cursor += stride;
+    }
+    hdr->owner = cache;
+    hdr->size_class = cls;
+    hdr->magic = NRT_POOL_MAGIC;
+    return (char *)hdr + NRT_POOL_HEADER_SIZE;
+}
+
+static void nrt_pool_free(void *ptr) {
+    nrt_pool_header *hdr;
+    nrt_thread_cache *owner;
+    unsigned cls;
+    if (!ptr)
+        return;
+    hdr = nrt_pool_header_of(ptr);
+    cls = hdr->size_class;
+    if (cls == NRT_POOL_LARGE) {
+        hdr->magic = 0;
+        TheMSys.allocator.free(hdr);
+        return;
+    }
+    owner = hdr->owner;
+    if (owner == nrt_pool_tls_cache) {
+        *(void **)ptr = owner->classes[cls].free_list;
+        owner->classes[cls].free_list = ptr;
+    } else {
+        void *head = owner->remote[cls].load(std::memory_order_relaxed);
+        do {
+            *(void **)ptr = head;
+        } while (!owner->remote[cls].compare_exchange_weak(
+                     head, ptr, std::memory_order_release,
+                     std::memory_order_relaxed));
+    }
+}
+
+static void *nrt_pool_realloc(void *ptr, size_t size) {
+    nrt_pool_header *hdr;
+    size_t old_size;
+    void *new_ptr;
+    if (!ptr)
+        return nrt_pool_malloc(size);
+    hdr = nrt_pool_header_of(ptr);
+    if (hdr->size_class == NRT_POOL_LARGE) {
+        old_size = hdr->size;
+        if (size > NRT_POOL_MAX_SIZE) {
+            if (size > (size_t)-1 - NRT_POOL_HEADER_SIZE)
+                return NULL;
+            hdr = (nrt_pool_header *)TheMSys.allocator.realloc(
+                hdr, size + NRT_POOL_HEADER_SIZE);
+            if (!hdr)
+                return NULL;
+            hdr->size = size;
+            return (char *)hdr + NRT_POOL_HEADER_SIZE;
+        }
+    } else {
+        old_size = nrt_pool_class_size(hdr->size_class);
+        if (size <= old_size)
+            return ptr;
+    }
+    new_ptr = nrt_pool_malloc(size);
+    if (!new_ptr)
+        return NULL;
+    memcpy(new_ptr, ptr, old_size < size ? old_size : size);
+    nrt_pool_free(ptr);
+    return new_ptr;
+}
+
+/*
+ * Allocation tracing.
+ *
+ * The live MemInfos are kept in a map under a lock along with the per-tag
+ * totals. Tags are interned as keys of the tag map, whose entries are never
+ * removed so that the tag pointers handed out stay valid.
+ */
+
+typedef std::chrono::steady_clock nrt_trace_clock;
+
+struct nrt_trace_tag_stats {
+    size_t count;
+    size_t bytes;
+    size_t live_count;
+};
+
+typedef std::map<std::string, nrt_trace_tag_stats> nrt_trace_tag_map;
+
+struct nrt_trace_record {
+    size_t size;
+    size_t seq;
+    nrt_trace_tag_map::value_type *tag;
+    nrt_trace_clock::time_point start;
+};
+
+struct nrt_trace_state {
+    std::unordered_map<NRT_MemInfo *, nrt_trace_record> live;
+    nrt_trace_tag_map tags;
+    NRT_TraceSummary summary;
+    size_t seq;
+};
+
+static std::mutex nrt_trace_lock;
+/* Allocated on first use and never destroyed, see nrt_pool_registry */
+static nrt_trace_state *nrt_trace = NULL;
+
+static thread_local nrt_trace_tag_map::value_type *nrt_trace_tls_tag = NULL;
+
+static inline unsigned nrt_trace_bucket(unsigned long long v) {
+    return v ? nrt_pool_log2(v) + 1 : 0;
+}
+
+extern "C" int NRT_MemSys_set_tracing(int enable) {
+    std::lock_guard<std::mutex> guard(nrt_trace_lock);
+    if (enable && !TheMSys.tracing) {
+        if (!nrt_trace) {
+            nrt_trace = new (std::nothrow) nrt_trace_state();
+            if (!nrt_trace)
+                return -1;
+        }
+        nrt_trace->live.clear();
+        for (auto &tag : nrt_trace->tags)
+            tag.second = nrt_trace_tag_stats();
+        memset(&nrt_trace->summary, 0, sizeof(nrt_trace->summary));
+    }
+    TheMSys.tracing = enable != 0;
+    return 0;
+}
+
+extern "C" const char *NRT_MemSys_trace_set_tag(const char *tag) {
+    nrt_trace_tag_map::value_type *prev = nrt_trace_tls_tag;
+    nrt_trace_tag_map::value_type *entry = NULL;
+    if (tag) {
+        std::lock_guard<std::mutex> guard(nrt_trace_lock);
+        if (!nrt_trace)
+            nrt_trace = new (std::nothrow) nrt_trace_state();
+        if (nrt_trace) {
+            try {
+                entry = &*nrt_trace->tags.emplace(
+                    tag, nrt_trace_tag_stats()).first;
+            } catch (...) {
+                /* leave the allocations untagged */
+            }
+        }
+    }
+    nrt_trace_tls_tag = entry;
+    return prev ? prev->first.c_str() : NULL;
+}
+
+extern "C" size_t NRT_MemSys_trace_checkpoint(void) {
+    std::lock_guard<std::mutex> guard(nrt_trace_lock);
+    return nrt_trace ? nrt_trace->seq : 0;
+}
+
+static void nrt_trace_alloc(NRT_MemInfo *mi, size_t size) {
+    std::lock_guard<std::mutex> guard(nrt_trace_lock);
+    NRT_TraceSummary *summary;
+    nrt_trace_record rec;
+    if (!TheMSys.tracing || !nrt_trace)
+        return;
+    rec.size = size;
+    rec.seq = nrt_trace->seq++;
+    rec.tag = nrt_trace_tls_tag;
+    rec.start = nrt_trace_clock::now();
+    try {
+        nrt_trace->live[mi] = rec;
+    } catch (...) {
+        return;  /* the MemInfo goes untraced */
+    }
+    summary = &nrt_trace->summary;
+    summary->live_count++;
+    summary->live_bytes += size;
+    summary->peak_live_bytes = std::max(summary->peak_live_bytes,
+                                        summary->live_bytes);
+    summary->total_count++;
+    summary->total_bytes += size;
+    summary->size_histogram[nrt_trace_bucket(size)]++;
+    if (rec.tag) {
+        rec.tag->second.count++;
+        rec.tag->second.bytes += size;
+        rec.tag->second.live_count++;
+    }
+}
+
+static void nrt_trace_resize(NRT_MemInfo *mi, size_t size) {
+    std::lock_guard<std::mutex> guard(nrt_trace_lock);
+    if (!TheMSys.tracing || !nrt_trace)
+        return;
+    auto it = nrt_trace->live.find(mi);
+    if (it == nrt_trace->live.end())
+        return;
+    NRT_TraceSummary *summary = &nrt_trace->summary;
+    summary->live_bytes += size - it->second.size;
+    summary->peak_live_bytes = std::max(summary->peak_live_bytes,
+                                        summary->live_bytes);
+    it->second.size = size;
+}
+
+static void nrt_trace_free(NRT_MemInfo *mi) {
+    std::lock_guard<std::mutex> guard(nrt_trace_lock);
+    if (!TheMSys.tracing || !nrt_trace)
+        return;
+    auto it = nrt_trace->live.find(mi);
+    if (it == nrt_trace->live.end())
+        return;  /* created before tracing was enabled */
+    NRT_TraceSummary *summary = &nrt_trace->summary;
+    nrt_trace_record &rec = it->second;
+    long long lifetime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        nrt_trace_clock::now() - rec.start).count();
+    summary->live_count--;
+    summary->live_bytes -= rec.size;
+    summary->lifetime_histogram[
+        nrt_trace_bucket(lifetime > 0 ? (unsigned long long)lifetime : 0)]++;
+    if (rec.tag)
+        rec.tag->second.live_count--;
+    nrt_trace->live.erase(it);
+}
+
+extern "C" void NRT_MemSys_trace_summary(NRT_TraceSummary *out) {
+    std::lock_guard<std::mutex> guard(nrt_trace_lock);
+    if (nrt_trace)
+        *out = nrt_trace->summary;
+    else
+        memset(out, 0, sizeof(*out));
+}
+
+extern "C" size_t NRT_MemSys_trace_live(size_t since, NRT_TraceLiveEntry *out,
+                                        size_t max) {
+    std::vector<NRT_TraceLiveEntry> entries;
+    std::lock_guard<std::mutex> guard(nrt_trace_lock);
+    if (!nrt_trace)
+        return 0;
+    nrt_trace_clock::time_point now = nrt_trace_clock::now();
+    try {
+        for (auto &item : nrt_trace->live) {
+            const nrt_trace_record &rec = item.second;
+            NRT_TraceLiveEntry entry;
+            if (rec.seq < since)
+                continue;
+            entry.mi = item.first;
+            entry.size = rec.size;
+            entry.refct = nrt_refct_total(item.first);
+            entry.tag = rec.tag ? rec.tag->first.c_str() : NULL;
+            entry.seq = rec.seq;
+            entry.age_ns = (unsigned long long)
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    now - rec.start).count();
+            entries.push_back(entry);
+        }
+    } catch (...) {
+        return 0;
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const NRT_TraceLiveEntry &a, const NRT_TraceLiveEntry &b) {
+                  return a.seq < b.seq;
+              });
+    if (out)
+        std::copy_n(entries.begin(), std::min(max, entries.size()), out);
+    return entries.size();
+}
+
+extern "C" size_t NRT_MemSys_trace_tags(NRT_TraceTagEntry *out, size_t max) {
+    std::lock_guard<std::mutex> guard(nrt_trace_lock);
+    size_t n = 0;
+    if (!nrt_trace)
+        return 0;
+    for (auto &tag : nrt_trace->tags) {
+        if (!tag.second.count)
+            continue;  /* not used since tracing was enabled */
+        if (out && n < max) {
+            out[n].tag = tag.first.c_str();
+            out[n].count = tag.second.count;
+            out[n].bytes = tag.second.bytes;
+            out[n].live_count = tag.second.live_count;
+        }
+        n++;
+    }
+    return n;
+}
+
+/*
+ * Large allocations.
+ *
+ * MemInfo allocations at or above the threshold set with
+ * NRT_MemSys_set_large_allocation() are made through nrt_large_allocator,
+ * an internal external allocator that maps them directly, so that they can
+ * be backed by huge pages and bound to the allocating thread's NUMA node.
+ * Recording the allocator in the MemInfo routes the release back to it. A
+ * header before the block records the length of the mapping, or 0 if the
+ * mapping failed and the system allocator was used instead.
+ */
+
+#define NRT_LARGE_HEADER_SIZE 16
+#define NRT_HUGE_PAGE_SIZE ((size_t)2 * 1024 * 1024)
+
+struct nrt_large_header {
+    size_t map_size;
+    /* whether the mapping is made of reserved huge pages, its length is
+       then a multiple of NRT_HUGE_PAGE_SIZE */
+    size_t hugetlb;
+};
+
+static_assert(sizeof(nrt_large_header) <= NRT_LARGE_HEADER_SIZE,
+              "nrt_large_header must fit in NRT_LARGE_HEADER_SIZE");
+
+static inline size_t nrt_round_up(size_t v, size_t multiple) {
+    return (v + multiple - 1) / multiple * multiple;
+}
+
+#if defined(NRT_HAVE_MMAP)
+
+static size_t nrt_page_size(void) {
+    static size_t page_size = 0;
+    if (!page_size) {
+        long sz = sysconf(_SC_PAGESIZE);
+        page_size = sz > 0 ? (size_t)sz : 4096;
+    }
+    return page_size;
+}
+
+static void *nrt_map(size_t len, int extra_flags) {
+    void *addr = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | extra_flags, -1, 0);
+    return addr == MAP_FAILED ? NULL : addr;
+}
+
+/* Prefer the NUMA node of the calling thread for the pages of the mapping */
+static void nrt_bind_local(void *addr, size_t len) {
+#if defined(SYS_getcpu) && defined(SYS_mbind)
+    const int mpol_preferred = 1;
+    const size_t bits = 8 * sizeof(unsigned long);
+    unsigned long nodemask[1024 / (8 * sizeof(unsigned long))] = { 0 };
+    unsigned cpu, node;
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0 ||
+        node >= sizeof(nodemask) * 8)
+        return;
+    nodemask[node / bits] |= 1UL << (node % bits);
+    /* best effort, the default first-touch placement applies on failure */
+    (void)syscall(SYS_mbind, addr, len, mpol_preferred, nodemask,
+                  sizeof(nodemask) * 8, 0);
+#endif
+}
+
+/* Map `len` bytes, returning the mapping and its length in `*map_size`,
+ * `*hugetlb` is set if it is made of reserved huge pages.
+ */
+static void *nrt_large_map(size_t len, size_t *map_size, size_t *hugetlb) {
+    int flags = TheMSys.large_flags;
+    void *addr = NULL;
+    size_t huge_len = nrt_round_up(len, NRT_HUGE_PAGE_SIZE);
+    *hugetlb = 0;
+#if defined(MAP_HUGETLB)
+    if (flags & NRT_LARGE_HUGETLB) {
+        /* fails unless huge pages are reserved, fall through if so */
+        addr = nrt_map(huge_len, MAP_HUGETLB);
+        *map_size = huge_len;
+        *hugetlb = addr != NULL;
+    }
+#endif
+    if (!addr && (flags & NRT_LARGE_THP) && len >= NRT_HUGE_PAGE_SIZE) {
+        /* over-map to align to a huge page boundary, then trim */
+        char *base = (char *)nrt_map(huge_len + NRT_HUGE_PAGE_SIZE, 0);
+        if (base) {
+            char *aligned = (char *)nrt_round_up((size_t)base,
+                                                 NRT_HUGE_PAGE_SIZE);
+            if (aligned != base)
+                munmap(base, aligned - base);
+            if (aligned + huge_len != base + huge_len + NRT_HUGE_PAGE_SIZE)
+                munmap(aligned + huge_len,
+                       (base + huge_len + NRT_HUGE_PAGE_SIZE) -
+                       (aligned + huge_len));
+#if defined(MADV_HUGEPAGE)
+            madvise(aligned, huge_len, MADV_HUGEPAGE);
+#endif
+            addr = aligned;
+            *map_size = huge_len;
+        }
+    }
+    if (!addr) {
+        *map_size = nrt_round_up(len, nrt_page_size());
+        addr = nrt_map(*map_size, 0);
+    }
+    if (addr && (flags & NRT_LARGE_NUMA_LOCAL))
+        nrt_bind_local(addr, *map_size);
+    return addr;
+}
+
+#endif /* NRT_HAVE_MMAP */
+
+static void *nrt_large_malloc(size_t size, void *opaque_data) {
+    nrt_large_header *hdr = NULL;
+    size_t map_size = 0, hugetlb = 0;
+    if (size > (size_t)-1 - NRT_LARGE_HEADER_SIZE - 2 * NRT_HUGE_PAGE_SIZE)
+        return NULL;
+#if defined(NRT_HAVE_MMAP)
+    hdr = (nrt_large_header *)nrt_large_map(size + NRT_LARGE_HEADER_SIZE,
+                                            &map_size, &hugetlb);
+#endif
+    if (!hdr) {
+        hdr = (nrt_large_header *)TheMSys.allocator.malloc(
+            size + NRT_LARGE_HEADER_SIZE);
+        if (!hdr)
+            return NULL;
+        map_size = 0;
+    }
+    hdr->map_size = map_size;
+    hdr->hugetlb = hugetlb;
+    return (char *)hdr + NRT_LARGE_HEADER_SIZE;
+}
+
+static void *nrt_large_realloc(void *ptr, size_t new_size, void *opaque_data) {
+    nrt_large_header *hdr;
+    if (!ptr)
+        return nrt_large_malloc(new_size, opaque_data);
+    if (new_size > (size_t)-1 - NRT_LARGE_HEADER_SIZE - 2 * NRT_HUGE_PAGE_SIZE)
+        return NULL;
+    hdr = (nrt_large_header *)((char *)ptr - NRT_LARGE_HEADER_SIZE);
+    if (!hdr->map_size) {
+        hdr = (nrt_large_header *)TheMSys.allocator.realloc(
+            hdr, new_size + NRT_LARGE_HEADER_SIZE);
+        return hdr ? (char *)hdr + NRT_LARGE_HEADER_SIZE : NULL;
+    }
+#if defined(NRT_HAVE_MMAP) && defined(MREMAP_MAYMOVE)
+    {
+        /* remap the pages rather than copying them, the length of a
+           mapping of huge pages must be a multiple of their size */
+        size_t len = nrt_round_up(new_size + NRT_LARGE_HEADER_SIZE,
+                                  hdr->hugetlb ? NRT_HUGE_PAGE_SIZE
+                                               : nrt_page_size());
+        size_t map_size, hugetlb;
+        nrt_large_header *new_hdr;
+        void *addr;
+        if (len <= hdr->map_size)
+            return ptr;
+        addr = mremap(hdr, hdr->map_size, len, MREMAP_MAYMOVE);
+        if (addr != MAP_FAILED) {
+            hdr = (nrt_large_header *)addr;
+            hdr->map_size = len;
+            return (char *)hdr + NRT_LARGE_HEADER_SIZE;
+        }
+        /* e.g. no reserved huge pages left, map anew and copy */
+        new_hdr = (nrt_large_header *)nrt_large_map(
+            new_size + NRT_LARGE_HEADER_SIZE, &map_size, &hugetlb);
+        if (!new_hdr)
+            return NULL;
+        /* the new mapping holds more than the whole old one */
+        memcpy(new_hdr, hdr, hdr->map_size);
+        munmap(hdr, hdr->map_size);
+        new_hdr->map_size = map_size;
+        new_hdr->hugetlb = hugetlb;
+        return (char *)new_hdr + NRT_LARGE_HEADER_SIZE;
+    }
+#else
+    return NULL;  /* unreachable, map_size is only set if mmap is used */
+#endif
+}
+
+static void nrt_large_free(void *ptr, void *opaque_data) {
+    nrt_large_header *hdr;
+    if (!ptr)
+        return;
+    hdr = (nrt_large_header *)((char *)ptr - NRT_LARGE_HEADER_SIZE);
+#if defined(NRT_HAVE_MMAP)
+    if (hdr->map_size) {
+        munmap(hdr, hdr->map_size);
+        return;
+    }
+#endif
+    TheMSys.allocator.free(hdr);
+}
+
+static NRT_ExternalAllocator nrt_large_allocator = {
+    nrt_large_malloc,
+    nrt_large_realloc,
+    nrt_large_free,
+    NULL
+};
+
+extern "C" int NRT_MemSys_set_large_allocation(size_t threshold, int flags) {
+#if !defined(NRT_HAVE_MMAP)
+    if (threshold)
+        return -1;
+#endif
+    TheMSys.large_flags = flags;
+    TheMSys.large_threshold = threshold;
+    return 0;
+}
+
+/*
+ * Arena allocation.
+ *
+ * Blocks are carved from the chunks of the calling thread's innermost arena
+ * through nrt_arena_allocator, which is recorded in the MemInfo so that its
+ * release comes back here. Each block is preceded by a header pointing to
+ * its chunk, a chunk counts its live blocks plus one for the arena while it
+ * is active and is freed when the count drops to zero.
+ */
+
+#define NRT_ARENA_HEADER_SIZE 16
+#define NRT_ARENA_DEFAULT_CHUNK_SIZE (64 * 1024)
+
+struct nrt_arena_chunk {
+    std::atomic_size_t refs;
+    nrt_arena_chunk *next;
+    char *cursor;
+    char *end;
+};
+
+struct nrt_arena_header {
+    nrt_arena_chunk *chunk;  /* NULL if allocated from the system */
+};
+
+struct NRT_Arena {
+    NRT_Arena *parent;
+    nrt_arena_chunk *chunks;  /* the chunk being carved comes first */
+    size_t chunk_size;
+};
+
+static thread_local NRT_Arena *nrt_arena_tls_current = NULL;
+
+/* Blocks and chunks start on 16 byte boundaries */
+static const size_t nrt_arena_chunk_header_size =
+    (sizeof(nrt_arena_chunk) + 15) & ~(size_t)15;
+
+static void *nrt_arena_malloc(size_t size, void *opaque_data) {
+    NRT_Arena *arena = nrt_arena_tls_current;
+    nrt_arena_chunk *chunk;
+    nrt_arena_header *hdr;
+    size_t stride;
+    if (size > (size_t)-1 - NRT_ARENA_HEADER_SIZE - 15)
+        return NULL;
+    stride = (NRT_ARENA_HEADER_SIZE + size + 15) & ~(size_t)15;
+    if (!arena || stride > arena->chunk_size - nrt_arena_chunk_header_size) {
+        /* no arena to carve from, e.g. a reallocation after the pop */
+        hdr = (nrt_arena_header *)TheMSys.allocator.malloc(
+            NRT_ARENA_HEADER_SIZE + size);
+        if (!hdr)
+            return NULL;
+        hdr->chunk = NULL;
+        return (char *)hdr + NRT_ARENA_HEADER_SIZE;
+    }
+    chunk = arena->chunks;
+    if (!chunk || (size_t)(chunk->end - chunk->cursor) < stride) {
+        chunk = (nrt_arena_chunk *)TheMSys.allocator.malloc(arena->chunk_size);
+        if (!chunk)
+            return NULL;
+        chunk->refs = 1;  /* the arena's */
+        chunk->next = arena->chunks;
+        chunk->cursor = (char *)chunk + nrt_arena_chunk_header_size;
+        chunk->end = (char *)chunk + arena->chunk_size;
+        arena->chunks = chunk;
+    }
+    hdr = (nrt_arena_header *)chunk->cursor;
+    chunk->cursor += stride;
+    chunk->refs.fetch_add(1, std::memory_order_relaxed);
+    hdr->chunk = chunk;
+    return (char *)hdr + NRT_ARENA_HEADER_SIZE;
+}
+
+static void nrt_arena_chunk_decref(nrt_arena_chunk *chunk) {
+    if (chunk->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        TheMSys.allocator.free(chunk);
+}
+
+static void nrt_arena_free(void *ptr, void *opaque_data) {
+    nrt_arena_header *hdr;
+    if (!ptr)
+        return;
+    hdr = (nrt_arena_header *)((char *)ptr - NRT_ARENA_HEADER_SIZE);
+    if (hdr->chunk)
+        nrt_arena_chunk_decref(hdr->chunk);
+    else
+        TheMSys.allocator.free(hdr);
+}
+
+static void *nrt_arena_realloc(void *ptr, size_t new_size, void *opaque_data) {
+    /* blocks don't know their size, MemInfo allocations are never resized */
+    return NULL;
+}
+
+static NRT_ExternalAllocator nrt_arena_allocator = {
+    nrt_arena_malloc,
+    nrt_arena_realloc,
+    nrt_arena_free,
+    NULL
+};
+
+extern "C" NRT_Arena *NRT_Arena_push(size_t chunk_size) {
+    NRT_Arena *arena;
+    if (!chunk_size)
+        chunk_size = NRT_ARENA_DEFAULT_CHUNK_SIZE;
+    if (chunk_size < 4 * nrt_arena_chunk_header_size)
+        chunk_size = 4 * nrt_arena_chunk_header_size;
+    arena = (NRT_Arena *)TheMSys.allocator.malloc(sizeof(NRT_Arena));
+    if (!arena)
+        return NULL;
+    arena->parent = nrt_arena_tls_current;
+    arena->chunks = NULL;
+    arena->chunk_size = chunk_size;
+    nrt_arena_tls_current = arena;
+    NRT_Debug(nrt_debug_print("NRT_Arena_push %p chunk_size=%zu\n",
+                              arena, chunk_size));
+    return arena;
+}
+
+extern "C" size_t NRT_Arena_pop(NRT_Arena *arena) {
+    nrt_arena_chunk *chunk, *next;
+    size_t alive = 0;
+    if (arena != nrt_arena_tls_current)
+        nrt_fatal_error("NRT_Arena_pop called with an arena that is not "
+                        "the innermost arena of the calling thread");
+    nrt_arena_tls_current = arena->parent;
+    for (chunk = arena->chunks; chunk; chunk = next) {
+        next = chunk->next;
+        /* blocks released concurrently by other threads may be counted */
+        alive += chunk->refs.load(std::memory_order_relaxed) - 1;
+        nrt_arena_chunk_decref(chunk);
+    }
+    NRT_Debug(nrt_debug_print("NRT_Arena_pop %p alive=%zu\n", arena, alive));
+    TheMSys.allocator.free(arena);
+    return alive;
+}
+
+/* Pick the allocator for a MemInfo allocation of `size` bytes */
+static inline NRT_ExternalAllocator *
+nrt_meminfo_allocator(size_t size, NRT_ExternalAllocator *allocator) {
+    NRT_Arena *arena;
+    if (allocator)
+        return allocator;
+    if (TheMSys.large_threshold && size >= TheMSys.large_threshold)
+        return &nrt_large_allocator;
+    arena = nrt_arena_tls_current;
+    if (arena && size <= arena->chunk_size / 4)
+        return &nrt_arena_allocator;
+    return NULL;
+}
+
+/*
+ * Biased reference counting.
+ *
+ * When enabled with NRT_MemSys_set_biased_refcount(), a MemInfo is owned by
+ * the thread creating it. The owner counts its references in `biased` with
+ * plain loads and stores, other threads count theirs atomically in `refct`,
+ * which then holds a signed count shifted left by two with the flags below.
+ * The count of `refct` goes negative when other threads release references
+ * the owner handed them, the first thread to take it below zero queues the
+ * MemInfo for the owner.
+ *
+ * The owner merges a MemInfo, adding `biased` into `refct` and setting
+ * NRT_REFCT_MERGED, when it drops its last reference or when it finds the
+ * MemInfo in its queue. A merged MemInfo is counted atomically by every
+ * thread and is destroyed when the count reaches zero. The owner drains its
+ * queue whenever it acquires, releases or creates a MemInfo, and when it
+ * exits. After that, queueing to it merges the MemInfo in place, which is
+ * safe as nothing writes to `biased` anymore.
+ */
+
+#define NRT_REFCT_MERGED ((size_t)1)
+#define NRT_REFCT_QUEUED ((size_t)2)
+#define NRT_REFCT_FLAGS (NRT_REFCT_MERGED | NRT_REFCT_QUEUED)
+#define NRT_REFCT_ONE ((size_t)4)
+#define NRT_REFCT_COUNT(word) ((intptr_t)((word) & ~NRT_REFCT_FLAGS) / 4)
+#define NRT_REFCT_WORD(count) ((size_t)(count) * NRT_REFCT_ONE)
+
+struct nrt_refct_node {
+    NRT_MemInfo *mi;
+    nrt_refct_node *next;
+};
+
+/* Marks the queue of an exited thread */
+#define NRT_REFCT_CLOSED ((nrt_refct_node *)1)
+
+struct nrt_refct_thread {
+    std::atomic<nrt_refct_node *> queue;
+    /* one for the thread while it runs plus one per MemInfo it owns */
+    std::atomic_size_t refs;
+};
+
+static thread_local nrt_refct_thread *nrt_refct_tls_thread = NULL;
+static thread_local bool nrt_refct_tls_destroyed = false;
+
+static void nrt_refct_thread_decref(nrt_refct_thread *thread) {
+    if (thread->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete thread;
+}
+
+/* Merge `mi` into an atomically counted MemInfo, must be called by the
+ * owner or once the owner has exited. Returns whether it must be destroyed.
+ */
+static bool nrt_refct_merge(NRT_MemInfo *mi) {
+    size_t old = mi->refct.load(std::memory_order_relaxed), word;
+    intptr_t biased = (intptr_t)mi->biased.load(std::memory_order_relaxed);
+    intptr_t count;
+    /* before publishing, another thread may destroy `mi` right after */
+    mi->biased.store(0, std::memory_order_relaxed);
+    do {
+        count = NRT_REFCT_COUNT(old) + biased;
+        word = NRT_REFCT_WORD(count) | NRT_REFCT_MERGED;
+    } while (!mi->refct.compare_exchange_weak(old, word,
+                                              std::memory_order_acq_rel));
+    return count == 0;
+}
+
+static void nrt_refct_drain(nrt_refct_node *node) {
+    while (node) {
+        nrt_refct_node *next = node->next;
+        NRT_MemInfo *mi = node->mi;
+        TheMSys.allocator.free(node);
+        if (nrt_refct_merge(mi))
+            NRT_MemInfo_call_dtor(mi);
+        node = next;
+    }
+}
+
+/* Merges the queued MemInfos and releases the thread's state on exit */
+struct nrt_refct_thread_ref {
+    nrt_refct_thread *thread;
+    ~nrt_refct_thread_ref() {
+        nrt_refct_tls_destroyed = true;
+        if (!thread)
+            return;
+        nrt_refct_drain(thread->queue.exchange(NRT_REFCT_CLOSED,
+                                               std::memory_order_acq_rel));
+        nrt_refct_tls_thread = NULL;
+        nrt_refct_thread_decref(thread);
+    }
+};
+
+static thread_local nrt_refct_thread_ref nrt_refct_tls_ref = { NULL };
+
+static nrt_refct_thread *nrt_refct_get_thread(void) {
+    nrt_refct_thread *thread = nrt_refct_tls_thread;
+    if (thread || nrt_refct_tls_destroyed)
+        return thread;
+    thread = new (std::nothrow) nrt_refct_thread();
+    if (!thread)
+        return NULL;
+    thread->refs.store(1, std::memory_order_relaxed);
+    nrt_refct_tls_ref.thread = thread;
+    nrt_refct_tls_thread = thread;
+    return thread;
+}
+
+static inline void nrt_refct_poll(nrt_refct_thread *thread) {
+    if (thread->queue.load(std::memory_order_relaxed))
+        nrt_refct_drain(thread->queue.exchange(NULL, std::memory_order_acquire));
+}
+
+static void nrt_refct_enqueue(NRT_MemInfo *mi) {
+    nrt_refct_thread *owner = mi->owner;
+    nrt_refct_node *node, *head;
+    node = (nrt_refct_node *)TheMSys.allocator.malloc(sizeof(nrt_refct_node));
+    head = owner->queue.load(std::memory_order_acquire);
+    do {
+        if (head == NRT_REFCT_CLOSED || !node) {
+            if (head != NRT_REFCT_CLOSED) {
+                /* out of memory, leave the MemInfo to the owner's exit */
+                return;
+            }
+            TheMSys.allocator.free(node);
+            if (nrt_refct_merge(mi))
+                NRT_MemInfo_call_dtor(mi);
+            return;
+        }
+        node->mi = mi;
+        node->next = head;
+    } while (!owner->queue.compare_exchange_weak(head, node,
+                                                 std::memory_order_release,
+                                                 std::memory_order_acquire));
+}
+
+static void nrt_refct_init(NRT_MemInfo *mi) {
+    nrt_refct_thread *thread = NULL;
+    if (TheMSys.biased_refct)
+        thread = nrt_refct_get_thread();
+    mi->owner = thread;
+    if (thread) {
+        nrt_refct_poll(thread);
+        thread->refs.fetch_add(1, std::memory_order_relaxed);
+        mi->refct = 0;
+        mi->biased = 1;
+    } else {
+        mi->refct = 1;  /* starts with 1 refct */
+        mi->biased = 0;
+    }
+}
+
+static void nrt_refct_acquire(NRT_MemInfo *mi) {
+    nrt_refct_thread *thread = nrt_refct_tls_thread;
+    if (mi->owner == thread &&
+        !(mi->refct.load(std::memory_order_relaxed) & NRT_REFCT_MERGED)) {
+        /* the owner, a plain increment */
+        mi->biased.store(mi->biased.load(std::memory_order_relaxed) + 1,
+                         std::memory_order_relaxed);
+        nrt_refct_poll(thread);
+        return;
+    }
+    mi->refct.fetch_add(NRT_REFCT_ONE, std::memory_order_relaxed);
+}
+
+static void nrt_refct_release(NRT_MemInfo *mi) {
+    nrt_refct_thread *thread = nrt_refct_tls_thread;
+    size_t old = mi->refct.load(std::memory_order_relaxed), word;
+    intptr_t count;
+    bool queue;
+    if (mi->owner == thread && !(old & NRT_REFCT_MERGED)) {
+        size_t biased = mi->biased.load(std::memory_order_relaxed) - 1;
+        mi->biased.store(biased, std::memory_order_relaxed);
+        if (biased == 0) {
+            /* the owner's last reference, other threads take over */
+            old = mi->refct.fetch_or(NRT_REFCT_MERGED,
+                                     std::memory_order_acq_rel);
+            /* a queued MemInfo is left to the drain */
+            if (!(old & NRT_REFCT_QUEUED) && NRT_REFCT_COUNT(old) == 0)
+                NRT_MemInfo_call_dtor(mi);
+        }
+        nrt_refct_poll(thread);
+        return;
+    }
+    do {
+        count = NRT_REFCT_COUNT(old) - 1;
+        word = NRT_REFCT_WORD(count) | (old & NRT_REFCT_FLAGS);
+        queue = !(old & NRT_REFCT_FLAGS) && count < 0;
+        if (queue)
+            word |= NRT_REFCT_QUEUED;
+    } while (!mi->refct.compare_exchange_weak(old, word,
+                                              std::memory_order_acq_rel));
+    if (queue)
+        nrt_refct_enqueue(mi);
+    else if ((old & NRT_REFCT_FLAGS) == NRT_REFCT_MERGED && count == 0)
+        NRT_MemInfo_call_dtor(mi);
+}
+
+static size_t nrt_refct_total(NRT_MemInfo *mi) {
+    size_t word = mi->refct.load();
+    if (!mi->owner)
+        return word;
+    /* exact only on the owning thread */
+    return (size_t)(NRT_REFCT_COUNT(word) + (intptr_t)mi->biased.load());
+}
+
+extern "C" void NRT_MemSys_set_biased_refcount(int enable) {
+    TheMSys.biased_refct = enable != 0;
 }
 
 /*
@@ -118,7 +1294,7 @@ extern "C" void NRT_MemInfo_init(NRT_MemInfo *mi,void *data, size_t size,
                       NRT_dtor_function dtor, void *dtor_info,
                       NRT_ExternalAllocator *external_allocator)
 {
-    mi->refct = 1;  /* starts with 1 refct */
+    nrt_refct_init(mi);
     mi->dtor = dtor;
     mi->dtor_info = dtor_info;
     mi->data = data;
@@ -126,7 +1302,9 @@ extern "C" void NRT_MemInfo_init(NRT_MemInfo *mi,void *data, size_t size,
     mi->external_allocator = external_allocator;
     NRT_Debug(nrt_debug_print("NRT_MemInfo_init mi=%p external_allocator=%p\n", mi, external_allocator));
     /* Update stats */
-    TheMSys.stats_mi_alloc++;
+    NRT_STATS_INC(mi_alloc);
+    if (TheMSys.tracing)
+        nrt_trace_alloc(mi, size);
 }
 
 NRT_MemInfo *NRT_MemInfo_new(void *data, size_t size,
@@ -143,7 +1321,7 @@ NRT_MemInfo *NRT_MemInfo_new(void *data, size_t size,
 size_t NRT_MemInfo_refcount(NRT_MemInfo *mi) {
     /* Should never returns 0 for a valid MemInfo */
     if (mi && mi->data)
-        return mi->refct;
+        return nrt_refct_total(mi);
     else{
         return (size_t)-1;
     }
@@ -158,10 +1336,12 @@ void nrt_internal_dtor_safe(void *ptr, size_t size, void *info) {
 }
 
 static
-void *nrt_allocate_meminfo_and_data(size_t size, NRT_MemInfo **mi_out, NRT_ExternalAllocator *allocator) {
+void *nrt_allocate_meminfo_and_data(size_t size, NRT_MemInfo **mi_out, NRT_ExternalAllocator **allocator) {
     NRT_MemInfo *mi = NULL;
-    NRT_Debug(nrt_debug_print("nrt_allocate_meminfo_and_data %p\n", allocator));
-    char *base = (char *)NRT_Allocate_External(sizeof(NRT_MemInfo) + size, allocator);
+    /* may switch to the large allocation path */
+    *allocator = nrt_meminfo_allocator(size, *allocator);
+    NRT_Debug(nrt_debug_print("nrt_allocate_meminfo_and_data %p\n", *allocator));
+    char *base = (char *)NRT_Allocate_External(sizeof(NRT_MemInfo) + size, *allocator);
     if (base == NULL) {
         *mi_out = NULL; /* set meminfo to NULL as allocation failed */
         return NULL; /* return early as allocation failed */
@@ -196,18 +1376,19 @@ void nrt_internal_custom_dtor(void *ptr, size_t size, void *info) {
 
 NRT_MemInfo *NRT_MemInfo_alloc(size_t size) {
     NRT_MemInfo *mi = NULL;
-    void *data = nrt_allocate_meminfo_and_data(size, &mi, NULL);
+    NRT_ExternalAllocator *allocator = NULL;
+    void *data = nrt_allocate_meminfo_and_data(size, &mi, &allocator);
     if (data == NULL) {
         return NULL; /* return early as allocation failed */
     }
     NRT_Debug(nrt_debug_print("NRT_MemInfo_alloc %p\n", data));
-    NRT_MemInfo_init(mi, data, size, NULL, NULL, NULL);
+    NRT_MemInfo_init(mi, data, size, NULL, NULL, allocator);
     return mi;
 }
 
 extern "C" NRT_MemInfo *NRT_MemInfo_alloc_external(size_t size, NRT_ExternalAllocator *allocator) {
     NRT_MemInfo *mi = NULL;
-    void *data = nrt_allocate_meminfo_and_data(size, &mi, allocator);
+    void *data = nrt_allocate_meminfo_and_data(size, &mi, &allocator);
     if (data == NULL) {
         return NULL; /* return early as allocation failed */
     }
@@ -222,34 +1403,36 @@ extern "C" NRT_MemInfo *NRT_MemInfo_alloc_safe(size_t size) {
 
 extern "C" NRT_MemInfo* NRT_MemInfo_alloc_dtor_safe(size_t size, NRT_dtor_function dtor) {
     NRT_MemInfo *mi = NULL;
-    void *data = nrt_allocate_meminfo_and_data(size, &mi, NULL);
+    NRT_ExternalAllocator *allocator = NULL;
+    void *data = nrt_allocate_meminfo_and_data(size, &mi, &allocator);
     if (data == NULL) {
         return NULL; /* return early as allocation failed */
     }
     /* Fill region with debug markers */
     memset(data, 0xCB, size);
     NRT_Debug(nrt_debug_print("NRT_MemInfo_alloc_dtor_safe %p %zu\n", data, size));
-    NRT_MemInfo_init(mi, data, size, nrt_internal_custom_dtor_safe, (void*)dtor, NULL);
+    NRT_MemInfo_init(mi, data, size, nrt_internal_custom_dtor_safe, (void*)dtor, allocator);
     return mi;
 }
 
 NRT_MemInfo* NRT_MemInfo_alloc_dtor(size_t size, NRT_dtor_function dtor) {
     NRT_MemInfo *mi = NULL;
-    void *data = (void *)nrt_allocate_meminfo_and_data(size, &mi, NULL);
+    NRT_ExternalAllocator *allocator = NULL;
+    void *data = (void *)nrt_allocate_meminfo_and_data(size, &mi, &allocator);
     if (data == NULL) {
         return NULL; /* return early as allocation failed */
     }
     NRT_Debug(nrt_debug_print("NRT_MemInfo_alloc_dtor %p %zu\n", data, size));
-    NRT_MemInfo_init(mi, data, size, nrt_internal_custom_dtor, (void *)dtor, NULL);
+    NRT_MemInfo_init(mi, data, size, nrt_internal_custom_dtor, (void *)dtor, allocator);
     return mi;
 }
 
 static
 void *nrt_allocate_meminfo_and_data_align(size_t size, unsigned align,
-                                          NRT_MemInfo **mi, NRT_ExternalAllocator *allocator)
+                                          NRT_MemInfo **mi, NRT_ExternalAllocator **allocator)
 {
     size_t offset = 0, intptr = 0, remainder = 0;
-    NRT_Debug(nrt_debug_print("nrt_allocate_meminfo_and_data_align %p\n", allocator));
+    NRT_Debug(nrt_debug_print("nrt_allocate_meminfo_and_data_align %p\n", *allocator));
     char *base = (char *)nrt_allocate_meminfo_and_data(size + 2 * align, mi, allocator);
     if (base == NULL) {
         return NULL; /* return early as allocation failed */
@@ -277,18 +1460,20 @@ void *nrt_allocate_meminfo_and_data_align(size_t size, unsigned align,
 
 extern "C" NRT_MemInfo *NRT_MemInfo_alloc_aligned(size_t size, unsigned align) {
     NRT_MemInfo *mi = NULL;
-    void *data = nrt_allocate_meminfo_and_data_align(size, align, &mi, NULL);
+    NRT_ExternalAllocator *allocator = NULL;
+    void *data = nrt_allocate_meminfo_and_data_align(size, align, &mi, &allocator);
     if (data == NULL) {
         return NULL; /* return early as allocation failed */
     }
     NRT_Debug(nrt_debug_print("NRT_MemInfo_alloc_aligned %p\n", data));
-    NRT_MemInfo_init(mi, data, size, NULL, NULL, NULL);
+    NRT_MemInfo_init(mi, data, size, NULL, NULL, allocator);
     return mi;
 }
 
 extern "C" NRT_MemInfo *NRT_MemInfo_alloc_safe_aligned(size_t size, unsigned align) {
     NRT_MemInfo *mi = NULL;
-    void *data = nrt_allocate_meminfo_and_data_align(size, align, &mi, NULL);
+    NRT_ExternalAllocator *allocator = NULL;
+    void *data = nrt_allocate_meminfo_and_data_align(size, align, &mi, &allocator);
     if (data == NULL) {
         return NULL; /* return early as allocation failed */
     }
@@ -296,14 +1481,14 @@ extern "C" NRT_MemInfo *NRT_MemInfo_alloc_safe_aligned(size_t size, unsigned ali
     memset(data, 0xCB, size);
     NRT_Debug(nrt_debug_print("NRT_MemInfo_alloc_safe_aligned %p %zu\n",
                               data, size));
-    NRT_MemInfo_init(mi, data, size, nrt_internal_dtor_safe, (void*)size, NULL);
+    NRT_MemInfo_init(mi, data, size, nrt_internal_dtor_safe, (void*)size, allocator);
     return mi;
 }
 
 extern "C" NRT_MemInfo *NRT_MemInfo_alloc_safe_aligned_external(size_t size, unsigned align, NRT_ExternalAllocator *allocator) {
     NRT_MemInfo *mi = NULL;
     NRT_Debug(nrt_debug_print("NRT_MemInfo_alloc_safe_aligned_external %p\n", allocator));
-    void *data = nrt_allocate_meminfo_and_data_align(size, align, &mi, allocator);
+    void *data = nrt_allocate_meminfo_and_data_align(size, align, &mi, &allocator);
     if (data == NULL) {
         return NULL; /* return early as allocation failed */
     }
@@ -319,20 +1504,30 @@ extern "C" void NRT_dealloc(NRT_MemInfo *mi) {
     NRT_Debug(nrt_debug_print("NRT_dealloc meminfo: %p external_allocator: %p\n", mi, mi->external_allocator));
     if (mi->external_allocator) {
         mi->external_allocator->free(mi, mi->external_allocator->opaque_data);
-        TheMSys.stats_free++;;
+        NRT_STATS_INC(free);
     } else {
         NRT_Free(mi);
     }
 }
 
 extern "C" void NRT_MemInfo_destroy(NRT_MemInfo *mi) {
+    /* before the address can be reused */
+    nrt_refct_thread *owner = mi->owner;
+    if (TheMSys.tracing)
+        nrt_trace_free(mi);
     NRT_dealloc(mi);
-    TheMSys.stats_mi_free++;
+    NRT_STATS_INC(mi_free);
+    if (owner)
+        nrt_refct_thread_decref(owner);
 }
 
 extern "C" void NRT_MemInfo_acquire(NRT_MemInfo *mi) {
     NRT_Debug(nrt_debug_print("NRT_MemInfo_acquire %p refct=%zu\n", mi,
-                                                            mi->refct.load()));
+                                                            nrt_refct_total(mi)));
+    if (mi->owner) {
+        nrt_refct_acquire(mi);
+        return;
+    }
     assert(mi->refct > 0 && "RefCt cannot be zero");
     mi->refct++;
 }
@@ -348,7 +1543,11 @@ extern "C" void NRT_MemInfo_call_dtor(NRT_MemInfo *mi) {
 
 extern "C" void NRT_MemInfo_release(NRT_MemInfo *mi) {
     NRT_Debug(nrt_debug_print("NRT_MemInfo_release %p refct=%zu\n", mi,
-                                                            mi->refct.load()));
+                                                            nrt_refct_total(mi)));
+    if (mi->owner) {
+        nrt_refct_release(mi);
+        return;
+    }
     assert (mi->refct > 0 && "RefCt cannot be 0");
     /* RefCt drop to zero */
     if ((--(mi->refct)) == 0) {
@@ -374,12 +1573,114 @@ extern "C" void *NRT_MemInfo_parent(NRT_MemInfo *mi) {
 }
 
 extern "C" void NRT_MemInfo_dump(NRT_MemInfo *mi, FILE *out) {
-    fprintf(out, "MemInfo %p refcount %zu\n", mi, mi->refct.load());
+    fprintf(out, "MemInfo %p refcount %zu\n", mi, nrt_refct_total(mi));
 }
 
 /*
  * Resizable buffer API.
+ *
+ * A varsize buffer is preceded by a header recording its capacity, which may
+ * exceed the size last requested so that a buffer growing by small steps is
+ * reallocated a logarithmic number of times. Buffers with a capacity of at
+ * least NRT_VARSIZE_MAP_THRESHOLD are mapped with nrt_large_allocator where
+ * mremap() is available, growing them then moves pages instead of copying.
+ */
+
+#define NRT_VARSIZE_HEADER_SIZE 16
+#define NRT_VARSIZE_MAP_THRESHOLD ((size_t)1024 * 1024)
+
+struct nrt_varsize_header {
+    size_t capacity;
+    /* whether the buffer is allocated with nrt_large_allocator */
+    size_t mapped;
+};
+
+static inline nrt_varsize_header *nrt_varsize_get_header(void *data) {
+    return (nrt_varsize_header *)((char *)data - NRT_VARSIZE_HEADER_SIZE);
+}
+
+static inline bool nrt_varsize_use_map(size_t capacity) {
+#if defined(NRT_HAVE_MMAP) && defined(MREMAP_MAYMOVE)
+    return capacity >= NRT_VARSIZE_MAP_THRESHOLD;
+#else
+    return false;
+#endif
+}
+
+static void *nrt_varsize_buffer_alloc(size_t capacity) {
+    nrt_varsize_header *hdr;
+    bool mapped = nrt_varsize_use_map(capacity);
+    if (capacity > (size_t)-1 - NRT_VARSIZE_HEADER_SIZE)
+        return NULL;
+    hdr = (nrt_varsize_header *)NRT_Allocate_External(
+        capacity + NRT_VARSIZE_HEADER_SIZE,
+        mapped ? &nrt_large_allocator : NULL);
+    if (!hdr)
+        return NULL;
+    hdr->capacity = capacity;
+    hdr->mapped = mapped;
+    return (char *)hdr + NRT_VARSIZE_HEADER_SIZE;
+}
+
+static void nrt_varsize_buffer_free(void *data) {
+    nrt_varsize_header *hdr;
+    if (!data)
+        return;
+    hdr = nrt_varsize_get_header(data);
+    if (hdr->mapped) {
+        nrt_large_free(hdr, NULL);
+        NRT_STATS_INC(free);
+    } else {
+        NRT_Free(hdr);
+    }
+}
+
+/* Resize the buffer at `data` holding `used` bytes of content to hold at
+ * least `size` bytes. Returns NULL on failure, leaving `data` untouched.
  */
+static void *nrt_varsize_buffer_realloc(void *data, size_t used, size_t size) {
+    nrt_varsize_header *hdr;
+    size_t capacity;
+    bool mapped;
+    void *new_data;
+    if (!data)
+        return nrt_varsize_buffer_alloc(size);
+    hdr = nrt_varsize_get_header(data);
+    capacity = hdr->capacity;
+    /* keep the buffer unless it would be mostly unused */
+    if (size <= capacity && size >= capacity / 4)
+        return data;
+    if (size > capacity) {
+        /* grow by at least half the capacity */
+        capacity = capacity + capacity / 2;
+        if (capacity < size || capacity > (size_t)-1 / 2)
+            capacity = size;
+    } else {
+        capacity = size;
+    }
+    if (capacity > (size_t)-1 - NRT_VARSIZE_HEADER_SIZE)
+        return NULL;
+    mapped = nrt_varsize_use_map(capacity);
+    if (mapped == (bool)hdr->mapped) {
+        if (mapped)
+            hdr = (nrt_varsize_header *)nrt_large_realloc(
+                hdr, capacity + NRT_VARSIZE_HEADER_SIZE, NULL);
+        else
+            hdr = (nrt_varsize_header *)NRT_Reallocate(
+                hdr, capacity + NRT_VARSIZE_HEADER_SIZE);
+        if (!hdr)
+            return NULL;
+        hdr->capacity = capacity;
+        return (char *)hdr + NRT_VARSIZE_HEADER_SIZE;
+    }
+    /* moving between the system allocator and a mapping */
+    new_data = nrt_varsize_buffer_alloc(capacity);
+    if (!new_data)
+        return NULL;
+    memcpy(new_data, data, used < size ? used : size);
+    nrt_varsize_buffer_free(data);
+    return new_data;
+}
 
 static void
 nrt_varsize_dtor(void *ptr, size_t size, void *info) {
@@ -390,13 +1691,13 @@ nrt_varsize_dtor(void *ptr, size_t size, void *info) {
         dtor_fn_t *dtor = (dtor_fn_t *)info;
         dtor(ptr);
     }
-    NRT_Free(ptr);
+    nrt_varsize_buffer_free(ptr);
 }
 
 NRT_MemInfo *NRT_MemInfo_new_varsize(size_t size)
 {
     NRT_MemInfo *mi = NULL;
-    void *data = NRT_Allocate(size);
+    void *data = nrt_varsize_buffer_alloc(size);
     if (data == NULL) {
         return NULL; /* return early as allocation failed */
     }
@@ -422,10 +1723,12 @@ extern "C" void *NRT_MemInfo_varsize_alloc(NRT_MemInfo *mi, size_t size)
                         "with a non varsize-allocated meminfo");
         return NULL;  /* unreachable */
     }
-    mi->data = NRT_Allocate(size);
+    mi->data = nrt_varsize_buffer_alloc(size);
     if (mi->data == NULL)
         return NULL;
     mi->size = size;
+    if (TheMSys.tracing)
+        nrt_trace_resize(mi, size);
     NRT_Debug(nrt_debug_print("NRT_MemInfo_varsize_alloc %p size=%zu "
                               "-> data=%p\n", mi, size, mi->data));
     return mi->data;
@@ -438,18 +1741,27 @@ extern "C" void *NRT_MemInfo_varsize_realloc(NRT_MemInfo *mi, size_t size)
                         "with a non varsize-allocated meminfo");
         return NULL;  /* unreachable */
     }
-    mi->data = NRT_Reallocate(mi->data, size);
+    mi->data = nrt_varsize_buffer_realloc(mi->data, mi->size, size);
     if (mi->data == NULL)
         return NULL;
     mi->size = size;
+    if (TheMSys.tracing)
+        nrt_trace_resize(mi, size);
     NRT_Debug(nrt_debug_print("NRT_MemInfo_varsize_realloc %p size=%zu "
                               "-> data=%p\n", mi, size, mi->data));
     return mi->data;
 }
 
+extern "C" size_t NRT_MemInfo_varsize_capacity(NRT_MemInfo *mi)
+{
+    if (!mi->data)
+        return 0;
+    return nrt_varsize_get_header(mi->data)->capacity;
+}
+
 extern "C" void NRT_MemInfo_varsize_free(NRT_MemInfo *mi, void *ptr)
 {
-    NRT_Free(ptr);
+    nrt_varsize_buffer_free(ptr);
     if (ptr == mi->data)
         mi->data = NULL;
 }
@@ -467,16 +1779,23 @@ extern "C" void* NRT_Allocate_External(size_t size, NRT_ExternalAllocator *alloc
     if (allocator) {
         ptr = allocator->malloc(size, allocator->opaque_data);
         NRT_Debug(nrt_debug_print("NRT_Allocate_External custom bytes=%zu ptr=%p\n", size, ptr));
+    } else if (TheMSys.pool) {
+        ptr = nrt_pool_malloc(size);
+        NRT_Debug(nrt_debug_print("NRT_Allocate_External pool bytes=%zu ptr=%p\n", size, ptr));
     } else {
         ptr = TheMSys.allocator.malloc(size);
         NRT_Debug(nrt_debug_print("NRT_Allocate_External bytes=%zu ptr=%p\n", size, ptr));
     }
-    TheMSys.stats_alloc++;
+    NRT_STATS_INC(alloc);
     return ptr;
 }
 
 extern "C" void *NRT_Reallocate(void *ptr, size_t size) {
-    void *new_ptr = TheMSys.allocator.realloc(ptr, size);
+    void *new_ptr;
+    if (TheMSys.pool)
+        new_ptr = nrt_pool_realloc(ptr, size);
+    else
+        new_ptr = TheMSys.allocator.realloc(ptr, size);
     NRT_Debug(nrt_debug_print("NRT_Reallocate bytes=%zu ptr=%p -> %p\n",
                               size, ptr, new_ptr));
     return new_ptr;
@@ -484,8 +1803,11 @@ extern "C" void *NRT_Reallocate(void *ptr, size_t size) {
 
 extern "C" void NRT_Free(void *ptr) {
     NRT_Debug(nrt_debug_print("NRT_Free %p\n", ptr));
-    TheMSys.allocator.free(ptr);
-    TheMSys.stats_free++;;
+    if (TheMSys.pool)
+        nrt_pool_free(ptr);
+    else
+        TheMSys.allocator.free(ptr);
+    NRT_STATS_INC(free);
 }
 
 /*
@@ -557,7 +1879,9 @@ NRT_api_functions nrt_functions_table = {
     nrt_manage_memory,
     NRT_MemInfo_acquire,
     NRT_MemInfo_release,
-    NRT_MemInfo_data
+    NRT_MemInfo_data,
+    NRT_Arena_push,
+    NRT_Arena_pop
 };
 
 
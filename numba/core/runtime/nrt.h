@@ -48,10 +48,47 @@ void NRT_MemSys_shutdown(void);
 VISIBILITY_HIDDEN
 void NRT_MemSys_set_allocator(NRT_malloc_func, NRT_realloc_func, NRT_free_func);
 
+/*
+ * Enable or disable serving allocations from per-thread size-class pools
+ * layered over the system allocation functions.
+ * Returns -1 if the mode cannot be changed because blocks are allocated.
+ */
+VISIBILITY_HIDDEN
+int NRT_MemSys_set_pool_allocator(int enable);
+
+/*
+ * Enable or disable biasing the reference count of the MemInfos created from
+ * then on towards their creating thread, which then counts its references
+ * without atomic operations. A MemInfo whose last reference is released by
+ * another thread is destroyed once its creating thread next uses the NRT or
+ * exits.
+ */
+VISIBILITY_HIDDEN
+void NRT_MemSys_set_biased_refcount(int enable);
+
+/* Flags for NRT_MemSys_set_large_allocation() */
+#define NRT_LARGE_THP 1         /* advise transparent huge pages */
+#define NRT_LARGE_HUGETLB 2     /* try reserved huge pages first */
+#define NRT_LARGE_NUMA_LOCAL 4  /* prefer the allocating thread's node */
+
+/*
+ * Map MemInfo allocations of `threshold` bytes or more directly, using the
+ * huge page and NUMA placement `flags`, a threshold of 0 disables this.
+ * Returns -1 if a non-zero threshold is not supported on this platform.
+ */
+VISIBILITY_HIDDEN
+int NRT_MemSys_set_large_allocation(size_t threshold, int flags);
+
 /*
  * The following functions get internal statistics of the memory subsystem.
+ * If the NRT is built with NRT_DISABLE_STATS defined the statistics are not
+ * collected and read as zero, NRT_MemSys_stats_enabled() then returns 0.
+ * Note that the checks for allocated blocks made when changing the
+ * allocator or the allocation mode rely on the statistics.
  */
 VISIBILITY_HIDDEN
+int NRT_MemSys_stats_enabled(void);
+VISIBILITY_HIDDEN
 size_t NRT_MemSys_get_stats_alloc(void);
 VISIBILITY_HIDDEN
 size_t NRT_MemSys_get_stats_free(void);
@@ -60,6 +97,111 @@ size_t NRT_MemSys_get_stats_mi_alloc(void);
 VISIBILITY_HIDDEN
 size_t NRT_MemSys_get_stats_mi_free(void);
 
+/*
+ * Allocation tracing.
+ *
+ * When enabled every MemInfo created is recorded along with its size, the
+ * allocation tag of the creating thread and its creation time, until it is
+ * destroyed. Summaries of the traced allocations and the MemInfos alive
+ * between checkpoints can then be queried. Tracing serialises MemInfo
+ * creation and destruction and is intended for diagnosing memory use.
+ */
+
+/* Bucket 0 counts zeros, bucket i > 0 counts values in [2**(i-1), 2**i) */
+#define NRT_TRACE_BUCKETS 65
+
+typedef struct {
+    size_t live_count;
+    size_t live_bytes;
+    size_t peak_live_bytes;
+    size_t total_count;
+    size_t total_bytes;
+    /* MemInfo sizes at creation */
+    size_t size_histogram[NRT_TRACE_BUCKETS];
+    /* Lifetimes of destroyed MemInfos in nanoseconds */
+    size_t lifetime_histogram[NRT_TRACE_BUCKETS];
+} NRT_TraceSummary;
+
+typedef struct {
+    NRT_MemInfo *mi;
+    size_t size;
+    size_t refct;
+    const char *tag;        /* NULL if untagged */
+    size_t seq;             /* creation sequence number */
+    unsigned long long age_ns;
+} NRT_TraceLiveEntry;
+
+typedef struct {
+    const char *tag;
+    size_t count;
+    size_t bytes;
+    size_t live_count;
+} NRT_TraceTagEntry;
+
+/*
+ * Enable or disable tracing, enabling it discards any earlier trace.
+ * Returns -1 if the trace could not be allocated.
+ */
+VISIBILITY_HIDDEN
+int NRT_MemSys_set_tracing(int enable);
+
+/*
+ * Set the tag recorded for MemInfos subsequently created by the calling
+ * thread, NULL clears it. Returns the previous tag. Tags are interned and
+ * stay valid for the lifetime of the process.
+ */
+VISIBILITY_HIDDEN
+const char *NRT_MemSys_trace_set_tag(const char *tag);
+
+/*
+ * Returns the sequence number the next traced MemInfo will get, MemInfos
+ * created after the call have a seq at least as large.
+ */
+VISIBILITY_HIDDEN
+size_t NRT_MemSys_trace_checkpoint(void);
+
+VISIBILITY_HIDDEN
+void NRT_MemSys_trace_summary(NRT_TraceSummary *out);
+
+/*
+ * Copy out up to `max` entries for the traced MemInfos still alive that were
+ * created at or after checkpoint `since`, oldest first.
+ * Returns the number of such MemInfos, which may exceed `max`.
+ */
+VISIBILITY_HIDDEN
+size_t NRT_MemSys_trace_live(size_t since, NRT_TraceLiveEntry *out, size_t max);
+
+/*
+ * Copy out up to `max` per-tag totals for the tags used since tracing was
+ * enabled. Returns the number of such tags.
+ */
+VISIBILITY_HIDDEN
+size_t NRT_MemSys_trace_tags(NRT_TraceTagEntry *out, size_t max);
+
+/*
+ * Arena allocation.
+ *
+ * While an arena pushed by a thread is active, the MemInfos that thread
+ * allocates with NRT_MemInfo_alloc* (without an external allocator) and of
+ * at most a quarter of the chunk size are bump-allocated from the arena's
+ * chunks. Popping the arena releases its hold on the chunks, each chunk is
+ * freed once the MemInfos carved from it have been released, so MemInfos
+ * escaping the arena stay valid. Arenas nest and must be popped in reverse
+ * order by the thread that pushed them.
+ */
+
+/* Push a new arena for the calling thread, chunk_size 0 picks a default.
+ * Returns NULL if the arena could not be allocated.
+ */
+VISIBILITY_HIDDEN
+NRT_Arena *NRT_Arena_push(size_t chunk_size);
+
+/* Pop the calling thread's innermost arena, returns the number of MemInfos
+ * allocated from it that are still alive.
+ */
+VISIBILITY_HIDDEN
+size_t NRT_Arena_pop(NRT_Arena *arena);
+
 /* Memory Info API */
 
 /* Create a new MemInfo for external memory
@@ -197,6 +339,12 @@ VISIBILITY_HIDDEN
 void *NRT_MemInfo_varsize_alloc(NRT_MemInfo *mi, size_t size);
 VISIBILITY_HIDDEN
 void *NRT_MemInfo_varsize_realloc(NRT_MemInfo *mi, size_t size);
+/*
+ * The capacity of the current buffer of a varsize MemInfo, which may exceed
+ * the size last requested.
+ */
+VISIBILITY_HIDDEN
+size_t NRT_MemInfo_varsize_capacity(NRT_MemInfo *mi);
 VISIBILITY_HIDDEN
 void NRT_MemInfo_varsize_free(NRT_MemInfo *mi, void *ptr);
 
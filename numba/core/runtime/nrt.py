@@ -1,3 +1,5 @@
+import contextlib
+import warnings
 from collections import namedtuple
 from weakref import finalize as _finalize
 
@@ -6,10 +8,15 @@ from llvmlite import binding as ll
 
 from numba.core.compiler_lock import global_compiler_lock
 from numba.core.typing.typeof import typeof_impl
-from numba.core import types
+from numba.core import types, config
+from numba.core.errors import NumbaInvalidConfigWarning
 from numba.core.runtime import _nrt_python as _nrt
 
 _nrt_mstats = namedtuple("nrt_mstats", ["alloc", "free", "mi_alloc", "mi_free"])
+_nrt_live_meminfo = namedtuple("nrt_live_meminfo",
+                               ["meminfo", "size", "refcount", "tag", "seq",
+                                "age_ns"])
+_nrt_tag_stats = namedtuple("nrt_tag_stats", ["count", "bytes", "live_count"])
 
 
 class _Runtime(object):
@@ -95,10 +102,30 @@ class _Runtime(object):
             raise MemoryError(msg)
         return MemInfo(mi)
 
+    def from_dlpack(self, obj):
+        """
+        Returns a NumPy array viewing the DLPack tensor `obj`, either an
+        object with a `__dlpack__()` method or a DLPack capsule, without
+        copying it. The array is based on a MemInfo owning the tensor, whose
+        deleter is called once the array and the jitted code using it release
+        the MemInfo. Only tensors accessible from the host are supported.
+        """
+        return _nrt.array_from_dlpack(obj)
+
+    @property
+    def stats_enabled(self):
+        """
+        Whether the NRT was built with allocation statistics.
+        """
+        return _nrt.memsys_stats_enabled()
+
     def get_allocation_stats(self):
         """
         Returns a namedtuple of (alloc, free, mi_alloc, mi_free) for count of
         each memory operations.
+
+        The counts are all zero if the NRT was built with the statistics
+        disabled, see `stats_enabled`.
         """
         # No init guard needed to access stats members
         return _nrt_mstats(alloc=_nrt.memsys_get_stats_alloc(),
@@ -106,6 +133,85 @@ class _Runtime(object):
                            mi_alloc=_nrt.memsys_get_stats_mi_alloc(),
                            mi_free=_nrt.memsys_get_stats_mi_free())
 
+    def enable_tracing(self, enable=True):
+        """
+        Enable or disable the tracing of MemInfo creation and destruction.
+        Enabling tracing discards the previous trace.
+        """
+        _nrt.memsys_set_tracing(enable)
+
+    @contextlib.contextmanager
+    def trace_tag(self, tag):
+        """
+        A context manager tagging the MemInfos the current thread creates
+        within it with the string `tag`.
+        """
+        prev = _nrt.memsys_trace_set_tag(tag)
+        try:
+            yield
+        finally:
+            _nrt.memsys_trace_set_tag(prev)
+
+    def trace_checkpoint(self):
+        """
+        Returns a checkpoint for `get_live_meminfos()`, only MemInfos created
+        after the checkpoint are reported for it.
+        """
+        return _nrt.memsys_trace_checkpoint()
+
+    def get_trace_summary(self):
+        """
+        Returns a dict summarising the traced MemInfos: the live count and
+        bytes, the peak live bytes, the total count and bytes, and histograms
+        of the MemInfo sizes and lifetimes in nanoseconds. Histogram bucket 0
+        counts zeros and bucket i > 0 counts values in [2**(i-1), 2**i).
+        """
+        return _nrt.memsys_get_trace_summary()
+
+    def get_live_meminfos(self, since=0):
+        """
+        Returns a list of namedtuples of (meminfo, size, refcount, tag, seq,
+        age_ns) for the traced MemInfos still alive that were created after
+        checkpoint `since`, oldest first. `meminfo` is the address of the
+        MemInfo.
+        """
+        return [_nrt_live_meminfo(*entry)
+                for entry in _nrt.memsys_get_trace_live(since)]
+
+    def get_trace_tags(self):
+        """
+        Returns a dict mapping the tags used while tracing to namedtuples of
+        (count, bytes, live_count) for the MemInfos created under them.
+        """
+        return {tag: _nrt_tag_stats(*stats)
+                for tag, stats in _nrt.memsys_get_trace_tags().items()}
+
+
+def _configure_large_allocation():
+    """Set up the large allocation path from the `config`.
+
+    Invalid flags are ignored and warn via a `NumbaInvalidConfigWarning`
+    category.
+    """
+    known = {'thp': _nrt.NRT_LARGE_THP,
+             'hugetlb': _nrt.NRT_LARGE_HUGETLB,
+             'numa': _nrt.NRT_LARGE_NUMA_LOCAL}
+    flags = 0
+    for item in config.NRT_LARGE_ALLOC_FLAGS.split(','):
+        item = item.strip().lower()
+        if not item:
+            continue
+        try:
+            flags |= known[item]
+        except KeyError:
+            warnings.warn(f"invalid NRT large allocation flag {item!r}",
+                          NumbaInvalidConfigWarning)
+    try:
+        _nrt.memsys_set_large_allocation(config.NRT_LARGE_ALLOC_THRESHOLD,
+                                        flags)
+    except NotImplementedError as e:
+        warnings.warn(str(e), NumbaInvalidConfigWarning)
+
 
 # Alias to _nrt_python._MemInfo
 MemInfo = _nrt._MemInfo
@@ -118,6 +224,14 @@ def typeof_meminfo(val, c):
 
 # Create runtime
 _nrt.memsys_use_cpython_allocator()
+if config.NRT_POOL_ALLOCATOR:
+    _nrt.memsys_set_pool_allocator(True)
+if config.NRT_TRACE:
+    _nrt.memsys_set_tracing(True)
+if config.NRT_LARGE_ALLOC_THRESHOLD > 0:
+    _configure_large_allocation()
+if config.NRT_BIASED_REFCOUNT:
+    _nrt.memsys_set_biased_refcount(True)
 rtsys = _Runtime()
 
 # Install finalizer
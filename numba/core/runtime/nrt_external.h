@@ -20,6 +20,8 @@ struct ExternalMemAllocator {
 
 typedef struct ExternalMemAllocator NRT_ExternalAllocator;
 
+typedef struct NRT_Arena NRT_Arena;
+
 typedef struct {
     /* Methods to create MemInfos.
 
@@ -58,6 +60,22 @@ typedef struct {
     /* Get MemInfo data pointer */
     void* (*get_data)(NRT_MemInfo* mi);
 
+    /* Push an allocation arena for the calling thread.
+
+    MemInfos the thread allocates until the arena is popped are carved from
+    chunks of *chunk_size* bytes (0 picks a default) owned by the arena.
+    Returns NULL on failure.
+    */
+    NRT_Arena* (*arena_push)(size_t chunk_size);
+
+    /* Pop the calling thread's innermost arena.
+
+    The chunks are freed once the MemInfos allocated from them are released,
+    MemInfos still alive keep their chunk alive. Returns the number of
+    MemInfos still alive.
+    */
+    size_t (*arena_pop)(NRT_Arena *arena);
+
 } NRT_api_functions;
 
 
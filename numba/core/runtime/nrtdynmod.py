@@ -11,12 +11,18 @@ from llvmlite import ir, binding
 _word_type = ir.IntType(config.MACHINE_BITS)
 _pointer_type = ir.PointerType(ir.IntType(8))
 
+# The layout of struct MemInfo in nrt.cpp. Unless `owner` is NULL, the
+# MemInfo has a biased reference count and `refct` is not a plain count, the
+# NRT_MemInfo_acquire/release functions must then be used to update it.
 _meminfo_struct_type = ir.LiteralStructType([
     _word_type,     # size_t refct
     _pointer_type,  # dtor_function dtor
     _pointer_type,  # void *dtor_info
     _pointer_type,  # void *data
     _word_type,     # size_t size
+    _pointer_type,  # NRT_ExternalAllocator *external_allocator
+    _pointer_type,  # nrt_refct_thread *owner
+    _word_type,     # size_t biased
     ])
 
 
@@ -38,6 +44,21 @@ def _define_nrt_meminfo_data(module):
     builder.ret(data_ptr)
 
 
+def _branch_biased(builder, ptr, fnname):
+    """
+    Emit a call to the NRT function `fnname` and return if the MemInfo at
+    `ptr` has a biased reference count.
+    """
+    fn = cgutils.get_or_insert_function(builder.module, incref_decref_ty,
+                                        fnname)
+    struct_ptr = builder.bitcast(ptr, _meminfo_struct_type.as_pointer())
+    owner = builder.load(cgutils.gep(builder, struct_ptr, 0, 6))
+    is_biased = cgutils.is_not_null(builder, owner)
+    with cgutils.if_unlikely(builder, is_biased):
+        builder.call(fn, [ptr])
+        builder.ret_void()
+
+
 def _define_nrt_incref(module, atomic_incr):
     """
     Implement NRT_incref in the module
@@ -52,6 +73,8 @@ def _define_nrt_incref(module, atomic_incr):
     with cgutils.if_unlikely(builder, is_null):
         builder.ret_void()
 
+    _branch_biased(builder, ptr, "NRT_MemInfo_acquire")
+
     word_ptr = builder.bitcast(ptr, atomic_incr.args[0].type)
     if config.DEBUG_NRT:
         cgutils.printf(builder, "*** NRT_Incref %zu [%p]\n", builder.load(word_ptr),
@@ -78,6 +101,7 @@ def _define_nrt_decref(module, atomic_decr):
     with cgutils.if_unlikely(builder, is_null):
         builder.ret_void()
 
+    _branch_biased(builder, ptr, "NRT_MemInfo_release")
 
     # For memory fence usage, see https://llvm.org/docs/Atomics.html
 
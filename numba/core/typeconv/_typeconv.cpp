@@ -23,6 +23,12 @@ set_compatible(PyObject* self, PyObject* args);
 static PyObject*
 get_pointer(PyObject* self, PyObject* args);
 
+static PyObject*
+dump_compatibility(PyObject* self, PyObject* args);
+
+static PyObject*
+load_compatibility(PyObject* self, PyObject* args);
+
 
 static PyMethodDef ext_methods[] = {
 #define declmethod(func) { #func , ( PyCFunction )func , METH_VARARGS , NULL }
@@ -31,6 +37,8 @@ static PyMethodDef ext_methods[] = {
     declmethod(check_compatible),
     declmethod(set_compatible),
     declmethod(get_pointer),
+    declmethod(dump_compatibility),
+    declmethod(load_compatibility),
     { NULL },
 #undef declmethod
 };
@@ -203,3 +211,42 @@ get_pointer(PyObject* self, PyObject* args)
 }
 
 
+
+PyObject*
+dump_compatibility(PyObject* self, PyObject* args)
+{
+    PyObject *tmcap;
+    if (!PyArg_ParseTuple(args, "O", &tmcap)) {
+        return NULL;
+    }
+
+    TypeManager *tm = unwrap_TypeManager(tmcap);
+    if (!tm) {
+        BAD_TM_ARGUMENT;
+        return NULL;
+    }
+    std::string data = tm->dumpCompatibility();
+    return PyBytes_FromStringAndSize(data.data(), data.size());
+}
+
+PyObject*
+load_compatibility(PyObject* self, PyObject* args)
+{
+    PyObject *tmcap;
+    const char *data;
+    Py_ssize_t size;
+    if (!PyArg_ParseTuple(args, "Oy#", &tmcap, &data, &size)) {
+        return NULL;
+    }
+
+    TypeManager *tm = unwrap_TypeManager(tmcap);
+    if (!tm) {
+        BAD_TM_ARGUMENT;
+        return NULL;
+    }
+    if (!tm->loadCompatibility(data, (size_t) size)) {
+        PyErr_SetString(PyExc_ValueError, "Malformed compatibility dump");
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
@@ -1,6 +1,7 @@
 import itertools
+import os
 from .typeconv import TypeManager, TypeCastingRules
-from numba.core import types
+from numba.core import config, types
 
 
 default_type_manager = TypeManager()
@@ -58,5 +59,45 @@ def _init_casting_rules(tm):
     return tcr
 
 
-default_casting_rules = _init_casting_rules(default_type_manager)
+# The types _init_casting_rules() refers to
+_casting_rule_types = types.number_domain | {types.boolean, types.float16,
+                                             types.voidptr}
+
+
+def _load_snapshot(tm, path):
+    try:
+        with open(path, 'rb') as f:
+            return tm.load_snapshot(f.read(), _casting_rule_types)
+    except OSError:
+        return False
+
+
+def _save_snapshot(tm, path):
+    # Write to a temporary file first, so that concurrent processes never
+    # read a partial snapshot.
+    tmp = '%s.%d.tmp' % (path, os.getpid())
+    try:
+        with open(tmp, 'wb') as f:
+            f.write(tm.snapshot())
+        os.replace(tmp, path)
+    except OSError:
+        pass
+
+
+def __getattr__(name):
+    # The casting rules are only built on demand when the compatibilities
+    # are loaded from a snapshot. Building them again on the same type
+    # manager sets the compatibilities it already has.
+    global default_casting_rules
+    if name == 'default_casting_rules':
+        default_casting_rules = _init_casting_rules(default_type_manager)
+        return default_casting_rules
+    raise AttributeError("module %r has no attribute %r" % (__name__, name))
+
+
+if not (config.TYPECONV_SNAPSHOT and
+        _load_snapshot(default_type_manager, config.TYPECONV_SNAPSHOT)):
+    default_casting_rules = _init_casting_rules(default_type_manager)
+    if config.TYPECONV_SNAPSHOT:
+        _save_snapshot(default_type_manager, config.TYPECONV_SNAPSHOT)
 
@@ -9,61 +9,179 @@
 // ------ TypeManager ------
 
 TCCMap::TCCMap()
-    : nb_records(0)
+    : dense_size(0), sparse_count(0), nb_records(0)
 {
 }
 
-size_t TCCMap::hash(const TypePair &key) const {
-    return std::hash<size_t>()(std::hash<Type>()(key.first)) ^
-           std::hash<Type>()(key.second);
+size_t TCCMap::hash(unsigned long long key) {
+    key ^= key >> 29;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    return (size_t) (key ^ (key >> 32));
+}
+
+void TCCMap::growDense(size_t size) {
+    size_t new_size = dense_size ? dense_size : 16;
+    while (new_size < size)
+        new_size *= 2;
+    std::vector<unsigned char> grown(new_size * new_size, TCC_FALSE);
+    for (size_t i = 0; i < dense_size; ++i) {
+        std::memcpy(&grown[i * new_size], &dense[i * dense_size], dense_size);
+    }
+    dense.swap(grown);
+    dense_size = new_size;
+}
+
+void TCCMap::growSparse() {
+    std::vector<Slot> old;
+    old.swap(sparse);
+    sparse.assign(old.empty() ? 64 : 2 * old.size(), Slot{EMPTY_KEY, 0});
+    const size_t mask = sparse.size() - 1;
+    for (size_t i = 0; i < old.size(); ++i) {
+        if (old[i].key == EMPTY_KEY)
+            continue;
+        size_t j = hash(old[i].key) & mask;
+        while (sparse[j].key != EMPTY_KEY)
+            j = (j + 1) & mask;
+        sparse[j] = old[i];
+    }
 }
 
 void TCCMap::insert(const TypePair &key, TypeCompatibleCode val) {
-    size_t i = hash(key) & (TCCMAP_SIZE - 1);
-    TCCMapBin &bin = records[i];
-    for (unsigned int j = 0; j < bin.size(); ++j) {
-        if (bin[j].key == key) {
-            bin[j].val = val;
+    const size_t from = (unsigned) key.first, to = (unsigned) key.second;
+    if (from < DENSE_MAX_SIZE && to < DENSE_MAX_SIZE) {
+        size_t size = std::max(from, to) + 1;
+        if (size > dense_size)
+            growDense(size);
+        unsigned char &cell = dense[from * dense_size + to];
+        if (cell == TCC_FALSE)
+            nb_records++;
+        cell = val;
+        return;
+    }
+    const unsigned long long k = packKey(key);
+    if (k == EMPTY_KEY)
+        return;
+    // Keep the load factor at most 1/2
+    if (2 * (sparse_count + 1) > sparse.size())
+        growSparse();
+    const size_t mask = sparse.size() - 1;
+    size_t i = hash(k) & mask;
+    while (sparse[i].key != EMPTY_KEY) {
+        if (sparse[i].key == k) {
+            sparse[i].val = val;
             return;
         }
+        i = (i + 1) & mask;
     }
-    bin.push_back({key, val});
+    sparse[i].key = k;
+    sparse[i].val = val;
+    sparse_count++;
     nb_records++;
 }
 
-TypeCompatibleCode TCCMap::find(const TypePair &key) const {
-    size_t i = hash(key) & (TCCMAP_SIZE - 1);
-    const TCCMapBin &bin = records[i];
-    for (unsigned int j = 0; j < bin.size(); ++j) {
-        if (bin[j].key == key) {
-            return bin[j].val;
-        }
+TypeCompatibleCode TCCMap::findSparse(const TypePair &key) const {
+    const unsigned long long k = packKey(key);
+    if (sparse.empty())
+        return TCC_FALSE;
+    const size_t mask = sparse.size() - 1;
+    for (size_t i = hash(k) & mask; sparse[i].key != EMPTY_KEY;
+         i = (i + 1) & mask) {
+        if (sparse[i].key == k)
+            return (TypeCompatibleCode) sparse[i].val;
     }
     return TCC_FALSE;
 }
 
-// ----- Ratings -----
-Rating::Rating() : promote(0), safe_convert(0), unsafe_convert(0) { }
+/*
+The dump format is a header of the magic, the format version and the number
+of records as 32-bit integers, followed by a record of the from and to type
+ids as 32-bit integers and the compatibility code as a byte for each pair.
+Everything is in the native byte order.
+*/
+static const char TCC_DUMP_MAGIC[4] = {'N', 'B', 'T', 'C'};
+static const unsigned int TCC_DUMP_VERSION = 1;
+static const size_t TCC_DUMP_HEADER_SIZE = 12;
+static const size_t TCC_DUMP_RECORD_SIZE = 9;
 
-inline bool Rating::operator < (const Rating &other) const {
-    if (unsafe_convert < other.unsafe_convert)
-        return true;
-    else if (unsafe_convert > other.unsafe_convert)
+static void appendRecord(std::string &out, Type from, Type to,
+                         unsigned char val) {
+    char buf[TCC_DUMP_RECORD_SIZE];
+    int from32 = from, to32 = to;
+    std::memcpy(buf, &from32, 4);
+    std::memcpy(buf + 4, &to32, 4);
+    buf[8] = (char) val;
+    out.append(buf, sizeof(buf));
+}
+
+void TCCMap::dump(std::string &out) const {
+    const unsigned int count = nb_records;
+    out.reserve(out.size() + TCC_DUMP_HEADER_SIZE +
+                count * TCC_DUMP_RECORD_SIZE);
+    out.append(TCC_DUMP_MAGIC, 4);
+    out.append((const char *) &TCC_DUMP_VERSION, 4);
+    out.append((const char *) &count, 4);
+    for (size_t i = 0; i < dense.size(); ++i) {
+        if (dense[i] != TCC_FALSE)
+            appendRecord(out, Type(i / dense_size), Type(i % dense_size),
+                         dense[i]);
+    }
+    for (size_t i = 0; i < sparse.size(); ++i) {
+        if (sparse[i].key != EMPTY_KEY)
+            appendRecord(out, Type(sparse[i].key >> 32),
+                         Type(sparse[i].key & 0xffffffffULL), sparse[i].val);
+    }
+}
+
+bool TCCMap::load(const char *data, size_t size) {
+    unsigned int version, count;
+    if (size < TCC_DUMP_HEADER_SIZE ||
+        std::memcmp(data, TCC_DUMP_MAGIC, 4) != 0)
         return false;
-    if (safe_convert < other.safe_convert)
-        return true;
-    else if (safe_convert > other.safe_convert)
+    std::memcpy(&version, data + 4, 4);
+    std::memcpy(&count, data + 8, 4);
+    if (version != TCC_DUMP_VERSION ||
+        size != TCC_DUMP_HEADER_SIZE + (size_t) count * TCC_DUMP_RECORD_SIZE)
         return false;
-    return (promote < other.promote);
+    const char *records = data + TCC_DUMP_HEADER_SIZE;
+    for (size_t i = 0; i < count; ++i) {
+        unsigned char val = records[i * TCC_DUMP_RECORD_SIZE + 8];
+        if (val == TCC_FALSE || val > TCC_CONVERT_UNSAFE)
+            return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const char *rec = records + i * TCC_DUMP_RECORD_SIZE;
+        int from, to;
+        std::memcpy(&from, rec, 4);
+        std::memcpy(&to, rec + 4, 4);
+        insert(TypePair(from, to), (TypeCompatibleCode) (unsigned char) rec[8]);
+    }
+    return true;
 }
 
-inline bool Rating::operator == (const Rating &other) const {
-    return promote == other.promote && safe_convert == other.safe_convert &&
-           unsafe_convert == other.unsafe_convert;
-}
+// ----- Ratings -----
+
+/* The increments of an OverloadScore for each compatibility code. Each count
+   has 21 bits, which is enough for any realistic number of arguments. */
+static const OverloadScore SCORE_PROMOTE = 1;
+static const OverloadScore SCORE_SAFE_CONVERT = 1ULL << 21;
+static const OverloadScore SCORE_UNSAFE_CONVERT = 1ULL << 42;
+
+static const OverloadScore tcc_scores[] = {
+    0,                      // TCC_FALSE
+    0,                      // TCC_EXACT
+    0,                      // TCC_SUBTYPE
+    SCORE_PROMOTE,          // TCC_PROMOTE
+    SCORE_SAFE_CONVERT,     // TCC_CONVERT_SAFE
+    SCORE_UNSAFE_CONVERT,   // TCC_CONVERT_UNSAFE
+};
 
 // ------ TypeManager ------
 
+TypeManager::TypeManager()
+    : version(0)
+{
+}
+
 bool TypeManager::canPromote(Type from, Type to) const {
     return isCompatible(from, to) == TCC_PROMOTE;
 }
@@ -91,6 +209,7 @@ void TypeManager::addSafeConversion(Type from, Type to) {
 void TypeManager::addCompatibility(Type from, Type to, TypeCompatibleCode tcc) {
     TypePair pair(from, to);
     tccmap.insert(pair, tcc);
+    ++version;
 }
 
 TypeCompatibleCode TypeManager::isCompatible(Type from, Type to) const {
@@ -100,6 +219,19 @@ TypeCompatibleCode TypeManager::isCompatible(Type from, Type to) const {
     return tccmap.find(pair);
 }
 
+std::string TypeManager::dumpCompatibility() const {
+    std::string out;
+    tccmap.dump(out);
+    return out;
+}
+
+bool TypeManager::loadCompatibility(const char *data, size_t size) {
+    if (!tccmap.load(data, size))
+        return false;
+    ++version;
+    return true;
+}
+
 
 int TypeManager::selectOverload(const Type sig[], const Type ovsigs[],
                                 int &selected,
@@ -108,19 +240,19 @@ int TypeManager::selectOverload(const Type sig[], const Type ovsigs[],
                                ) const {
     int count;
     if (ovct <= 16) {
-        Rating ratings[16];
+        OverloadScore scores[16];
         int candidates[16];
         count = _selectOverload(sig, ovsigs, selected, sigsz, ovct,
-                                allow_unsafe, exact_match_required, ratings,
+                                allow_unsafe, exact_match_required, scores,
                                 candidates);
     }
     else {
-        Rating *ratings = new Rating[ovct];
+        OverloadScore *scores = new OverloadScore[ovct];
         int *candidates = new int[ovct];
         count = _selectOverload(sig, ovsigs, selected, sigsz, ovct,
-                                allow_unsafe, exact_match_required, ratings,
+                                allow_unsafe, exact_match_required, scores,
                                 candidates);
-        delete [] ratings;
+        delete [] scores;
         delete [] candidates;
     }
     return count;
@@ -129,61 +261,57 @@ int TypeManager::selectOverload(const Type sig[], const Type ovsigs[],
 int TypeManager::_selectOverload(const Type sig[], const Type ovsigs[],
                                  int &selected, int sigsz, int ovct,
                                  bool allow_unsafe, bool exact_match_required,
-                                 Rating ratings[], int candidates[]) const {
-    // Generate rating table
-    // Use a penalize scheme.
-    int nb_candidates = 0;
+                                 OverloadScore scores[],
+                                 int candidates[]) const {
+    // The compatibility codes an argument may have, as a bitmask
+    unsigned int accepted;
+    if (exact_match_required) {
+        accepted = 1 << TCC_EXACT;
+    }
+    else {
+        accepted = (1 << TCC_EXACT) | (1 << TCC_SUBTYPE) |
+                   (1 << TCC_PROMOTE) | (1 << TCC_CONVERT_SAFE);
+        if (allow_unsafe)
+            accepted |= 1 << TCC_CONVERT_UNSAFE;
+    }
 
+    // Rate the candidates an argument at a time, i.e. a column of the
+    // overload signatures at a time, dropping the incompatible ones. The
+    // candidates are kept in the order of the overloads.
+    int nb_candidates = ovct;
     for (int i = 0; i < ovct; ++i) {
-        const Type *entry = &ovsigs[i * sigsz];
-        Rating rate;
-
-        for (int j = 0; j < sigsz; ++j) {
-            TypeCompatibleCode tcc = isCompatible(sig[j], entry[j]);
-            if (tcc == TCC_FALSE ||
-                (tcc == TCC_CONVERT_UNSAFE && !allow_unsafe) ||
-                (tcc != TCC_EXACT && exact_match_required)) {
-                // stop the loop early
-                goto _incompatible;
-            }
-            switch(tcc) {
-            case TCC_PROMOTE:
-                rate.promote += 1;
-                break;
-            case TCC_CONVERT_SAFE:
-                rate.safe_convert += 1;
-                break;
-            case TCC_CONVERT_UNSAFE:
-                rate.unsafe_convert += 1;
-                break;
-            default:
-                break;
-            }
+        candidates[i] = i;
+        scores[i] = 0;
+    }
+    for (int j = 0; j < sigsz && nb_candidates > 0; ++j) {
+        const Type from = sig[j];
+        int kept = 0;
+        for (int k = 0; k < nb_candidates; ++k) {
+            const int i = candidates[k];
+            TypeCompatibleCode tcc = isCompatible(from, ovsigs[i * sigsz + j]);
+            if (!((accepted >> tcc) & 1))
+                continue;
+            scores[kept] = scores[k] + tcc_scores[tcc];
+            candidates[kept] = i;
+            kept++;
         }
-        ratings[nb_candidates] = rate;
-        candidates[nb_candidates] = i;
-        nb_candidates++;
-    _incompatible:
-        ;
+        nb_candidates = kept;
     }
 
     // Bail if no match
     if (nb_candidates == 0)
         return 0;
 
-    // Find lowest rating
-    Rating best = ratings[0];
-    selected = candidates[0];
-
-    int matchcount = 1;
-    for (int i = 1; i < nb_candidates; ++i) {
-        if (ratings[i] < best) {
-            best = ratings[i];
-            selected = candidates[i];
-            matchcount = 1;
-        }
-        else if (ratings[i] == best) {
-            matchcount += 1;
+    // Find lowest rating, the first overload having it is selected
+    OverloadScore best = scores[0];
+    for (int k = 1; k < nb_candidates; ++k) {
+        best = std::min(best, scores[k]);
+    }
+    int matchcount = 0;
+    for (int k = nb_candidates - 1; k >= 0; --k) {
+        if (scores[k] == best) {
+            selected = candidates[k];
+            matchcount++;
         }
     }
     return matchcount;
@@ -25,42 +25,72 @@ enum TypeCompatibleCode{
 
 typedef std::pair<Type, Type> TypePair;
 
-struct TCCRecord {
-    TypePair key;
-    TypeCompatibleCode val;
-};
-
-typedef std::vector<TCCRecord> TCCMapBin;
-
+/*
+The compatibility codes of pairs of types. Those of pairs of small type ids,
+which are the most commonly used ones, are stored in a dense matrix, and the
+others in an open addressing hash table.
+*/
 class TCCMap {
 public:
     TCCMap();
 
     void insert(const TypePair &key, TypeCompatibleCode val);
-    TypeCompatibleCode find(const TypePair &key) const;
+    TypeCompatibleCode find(const TypePair &key) const {
+        const size_t from = (unsigned) key.first, to = (unsigned) key.second;
+        if (from < dense_size && to < dense_size)
+            return (TypeCompatibleCode) dense[from * dense_size + to];
+        if (from < DENSE_MAX_SIZE && to < DENSE_MAX_SIZE)
+            return TCC_FALSE;
+        return findSparse(key);
+    }
+
+    /* Append the records to `out`, in the format read by load() */
+    void dump(std::string &out) const;
+    /* Insert the records of a dump, returns false if it is malformed in
+       which case the map is left unchanged */
+    bool load(const char *data, size_t size);
+    int size() const { return nb_records; }
 private:
-    size_t hash(const TypePair &key) const;
-
-    /* Must be a power of two */
-    static const size_t TCCMAP_SIZE = 512;
-    TCCMapBin records[TCCMAP_SIZE];
+    struct Slot {
+        unsigned long long key;
+        unsigned char val;
+    };
+
+    static unsigned long long packKey(const TypePair &key) {
+        return ((unsigned long long) (unsigned) key.first << 32) |
+               (unsigned) key.second;
+    }
+    static size_t hash(unsigned long long key);
+    TypeCompatibleCode findSparse(const TypePair &key) const;
+    void growDense(size_t size);
+    void growSparse();
+
+    /* The pairs of ids below this go to the dense matrix, which is grown
+       as needed to cover the largest one */
+    static const size_t DENSE_MAX_SIZE = 256;
+    /* The key of the empty slots, that of a pair of -1 ids */
+    static const unsigned long long EMPTY_KEY = ~0ULL;
+
+    std::vector<unsigned char> dense;
+    size_t dense_size;
+    /* The size is a power of two */
+    std::vector<Slot> sparse;
+    size_t sparse_count;
     int nb_records;
 };
 
-struct Rating {
-    unsigned int promote;
-    unsigned int safe_convert;
-    unsigned int unsafe_convert;
-
-    Rating();
-
-    bool operator < (const Rating &other) const;
-    bool operator == (const Rating &other) const;
-};
+/*
+The rating of an overload, the number of unsafe conversions, safe conversions
+and promotions its arguments need packed into the fields of an integer such
+that comparing ratings is comparing integers. The lower the better.
+*/
+typedef unsigned long long OverloadScore;
 
 
 class TypeManager{
 public:
+    TypeManager();
+
     bool canPromote(Type from, Type to) const;
     bool canUnsafeConvert(Type from, Type to) const;
     bool canSafeConvert(Type from, Type to) const;
@@ -72,6 +102,18 @@ public:
 
     TypeCompatibleCode isCompatible(Type from, Type to) const;
 
+    /**
+    Serialize the compatibilities, such that loadCompatibility() restores
+    them without going through the individual add*() calls. The type ids
+    are stored as is, so a dump is only meaningful to a process assigning
+    the same ids to the same types.
+    */
+    std::string dumpCompatibility() const;
+    /**
+    Add the compatibilities of a dump. Returns false if it is malformed.
+    */
+    bool loadCompatibility(const char *data, size_t size);
+
     /**
     Output stored in selected.
     Returns
@@ -82,13 +124,20 @@ public:
                        bool exact_match_required
                       ) const;
 
+    /**
+    Incremented whenever a compatibility is added, so that callers caching
+    the results of selectOverload() can detect they may be stale.
+    */
+    unsigned long getVersion() const { return version; }
+
 private:
     int _selectOverload(const Type sig[], const Type ovsigs[], int &selected,
                         int sigsz, int ovct, bool allow_unsafe,
                         bool exact_match_required,
-                        Rating ratings[], int candidates[]) const;
+                        OverloadScore scores[], int candidates[]) const;
 
     TCCMap tccmap;
+    unsigned long version;
 };
 
 
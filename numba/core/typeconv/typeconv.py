@@ -15,6 +15,8 @@ except ImportError as e:
            f"please visit:\n\n{user_url}\n")
     raise ImportError(msg)
 
+import pickle
+
 from numba.core.typeconv import castgraph, Conversion
 from numba.core import types
 
@@ -66,6 +68,43 @@ class TypeManager(object):
     def get_pointer(self):
         return _typeconv.get_pointer(self._ptr)
 
+    def snapshot(self):
+        """
+        Return the compatibilities as bytes, for load_snapshot() to restore
+        them in one call rather than setting them one at a time.
+        """
+        # The codes of the types are assigned as they are created, hence
+        # they are recorded to detect a process where they differ.
+        registry = sorted((t._code, str(t)) for t in self._types)
+        data = _typeconv.dump_compatibility(self._ptr)
+        return pickle.dumps((registry, data), protocol=pickle.HIGHEST_PROTOCOL)
+
+    def load_snapshot(self, snapshot, candidates):
+        """
+        Add the compatibilities of a snapshot(), given the Numba types
+        `candidates` it may refer to. Returns False, leaving the type manager
+        unchanged, if a type of the snapshot isn't a candidate or has another
+        type code in this process, in which case the compatibilities must be
+        set anew.
+        """
+        try:
+            registry, data = pickle.loads(snapshot)
+        except Exception:
+            return False
+        by_name = {str(t): t for t in candidates}
+        referenced = []
+        for code, name in registry:
+            ty = by_name.get(name)
+            if ty is None or ty._code != code:
+                return False
+            referenced.append(ty)
+        try:
+            _typeconv.load_compatibility(self._ptr, data)
+        except (TypeError, ValueError):
+            return False
+        self._types.update(referenced)
+        return True
+
 
 class TypeCastingRules(object):
     """
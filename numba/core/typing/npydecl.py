@@ -874,18 +874,40 @@ class NdColumnStack(CallableTemplate):
 
 class MatMulTyperMixin(object):
 
+    # Whether stacks of matrices (>2-D arrays) are supported, with the
+    # semantics of np.matmul()
+    supports_stacks = False
+
     def matmul_typer(self, a, b, out=None):
         """
         Typer function for Numpy matrix multiplication.
         """
         if not isinstance(a, types.Array) or not isinstance(b, types.Array):
             return
-        if not all(x.ndim in (1, 2) for x in (a, b)):
+        stacked = (self.supports_stacks and out is None
+                   and max(a.ndim, b.ndim) > 2)
+        if stacked:
+            # Stacks of matrices of the same dimensionality, or a stack
+            # and a matrix or vector reused for every product
+            if min(a.ndim, b.ndim) > 2 and a.ndim != b.ndim:
+                raise TypingError("%s only supported on stacks of matrices "
+                                  "of the same dimensionality"
+                                  % (self.func_name, ))
+            if min(a.ndim, b.ndim) == 0:
+                raise TypingError("%s not supported on 0-d arrays"
+                                  % (self.func_name, ))
+        elif not all(x.ndim in (1, 2) for x in (a, b)):
             raise TypingError("%s only supported on 1-D and 2-D arrays"
                               % (self.func_name, ))
         # Output dimensionality
         ndims = set([a.ndim, b.ndim])
-        if ndims == set([2]):
+        if stacked:
+            if 1 in ndims:
+                # stack * V and V * stack
+                out_ndim = max(ndims) - 1
+            else:
+                out_ndim = max(ndims)
+        elif ndims == set([2]):
             # M * M
             out_ndim = 2
         elif ndims == set([1, 2]):
@@ -933,7 +955,7 @@ class Dot(MatMulTyperMixin, CallableTemplate):
     def generic(self):
         def typer(a, b, out=None):
             # NOTE: np.dot() and the '@' operator have distinct semantics
-            # for >2-D arrays, but we don't support them.
+            # for >2-D arrays, only the latter supports them.
             return self.matmul_typer(a, b, out)
 
         return typer
@@ -966,6 +988,7 @@ class VDot(CallableTemplate):
 class MatMul(MatMulTyperMixin, AbstractTemplate):
     key = operator.matmul
     func_name = "'@'"
+    supports_stacks = True
 
     def generic(self, args, kws):
         assert not kws
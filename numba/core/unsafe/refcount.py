@@ -9,6 +9,22 @@ from numba.core.extending import intrinsic
 from numba.core.runtime.nrtdynmod import _meminfo_struct_type
 
 
+def _load_refcount(builder, mi):
+    """Load the reference count of the MemInfo *mi*.  A biased count is
+    decoded as in nrt_refct_total(), which is exact only on the owning thread.
+    """
+    miptr = builder.bitcast(mi, _meminfo_struct_type.as_pointer())
+    word = builder.load(cgutils.gep_inbounds(builder, miptr, 0, 0))
+    owner = builder.load(cgutils.gep_inbounds(builder, miptr, 0, 6))
+    biased = builder.load(cgutils.gep_inbounds(builder, miptr, 0, 7))
+    # the low two bits of a biased count word are flags
+    flags = ir.Constant(word.type, 3)
+    count = builder.ashr(builder.and_(word, builder.not_(flags)),
+                         ir.Constant(word.type, 2))
+    count = builder.add(count, biased)
+    return builder.select(cgutils.is_not_null(builder, owner), count, word)
+
+
 @intrinsic
 def dump_refcount(typingctx, obj):
     """Dump the refcount of an object to stdout.
@@ -30,8 +46,7 @@ def dump_refcount(typingctx, obj):
             pyapi.print_string("dump refct of {}".format(ty))
             for ty, mi in meminfos:
                 miptr = builder.bitcast(mi, _meminfo_struct_type.as_pointer())
-                refctptr = cgutils.gep_inbounds(builder, miptr, 0, 0)
-                refct = builder.load(refctptr)
+                refct = _load_refcount(builder, mi)
 
                 pyapi.print_string(" | {} refct=".format(ty))
                 # "%zu" is not portable.  just truncate refcount to 32-bit.
@@ -69,9 +84,7 @@ def get_refcount(typingctx, obj):
         refcounts = []
         if meminfos:
             for ty, mi in meminfos:
-                miptr = builder.bitcast(mi, _meminfo_struct_type.as_pointer())
-                refctptr = cgutils.gep_inbounds(builder, miptr, 0, 0)
-                refct = builder.load(refctptr)
+                refct = _load_refcount(builder, mi)
                 refct_32bit = builder.trunc(refct, ir.IntType(32))
                 refcounts.append(refct_32bit)
         return refcounts[0]
@@ -136,6 +136,125 @@ def unary_math_intr(fn, intrcode):
     unary_math_int_impl(fn, float_impl)
     return float_impl
 
+# -----------------------------------------------------------------------------
+# Vector-width variants of the external math functions
+
+# The scalar functions with vector-width variants in _helperlib.c, mapped to
+# the base name of the variants (see vectormathnames.h).  The variants of
+# "<base>" are named "numba_<base>_v<width>".
+_vector_math_variants = {}
+for _name in ('erf', 'erfc', 'lgamma'):
+    _vector_math_variants[_name] = _name
+    _vector_math_variants[_name + 'f'] = _name + 'f'
+del _name
+
+# The CPU features needed by the variants, with their widths for
+# double and float arguments
+_vector_math_isas = ((('avx2', 'fma'), 4, 8), (('avx512f',), 8, 16))
+
+# The libraries declaring the variants, by codegen and scalar function
+_vector_math_libraries = {}
+
+
+def _can_emit_string_attributes():
+    # llvmlite only accepts the enum attributes, check that a string
+    # attribute added to the underlying set is emitted as is.
+    try:
+        mod = llvmlite.ir.Module()
+        fnty = llvmlite.ir.FunctionType(llvmlite.ir.VoidType(), ())
+        fn = llvmlite.ir.Function(mod, fnty, name="f")
+        builder = llvmlite.ir.IRBuilder(fn.append_basic_block())
+        call = builder.call(fn, ())
+        set.add(call.attributes, '"a"="b"')
+        return str(call).rstrip().endswith(' "a"="b"')
+    except Exception:
+        return False
+
+
+_string_attributes_supported = _can_emit_string_attributes()
+
+
+def _vector_math_widths(context, func_name, lty):
+    """
+    The widths of the vector variants of *func_name* usable with the
+    target of *context*.
+    """
+    if (config.DISABLE_VECTOR_MATH_VARIANTS
+            or getattr(config, 'USING_SVML', False) or context.aot_mode
+            or not _string_attributes_supported
+            or func_name not in _vector_math_variants):
+        return ()
+    features = getattr(context.codegen(), '_tm_features', None)
+    if not features:
+        return ()
+    features = set(features.split(','))
+    from numba import _helperlib
+    base = _vector_math_variants[func_name]
+    is_double = isinstance(lty, llvmlite.ir.DoubleType)
+    widths = []
+    for isas, dwidth, fwidth in _vector_math_isas:
+        width = dwidth if is_double else fwidth
+        if (all('+' + isa in features for isa in isas)
+                and '%s_v%d' % (base, width) in _helperlib.c_helpers):
+            widths.append(width)
+    return tuple(widths)
+
+
+def _get_vector_math_library(context, func_name, lty, nargs, widths):
+    """
+    Get a library declaring the vector variants of *func_name*, and keeping
+    these declarations through the optimizations until the loop vectorizer
+    looks up their signatures.
+    """
+    codegen = context.codegen()
+    key = codegen, func_name, widths
+    try:
+        return _vector_math_libraries[key]
+    except KeyError:
+        pass
+    base = _vector_math_variants[func_name]
+    library = codegen.create_library('vector_math.%s' % (func_name,))
+    mod = library.create_ir_module('vector_math.%s' % (func_name,))
+    voidptr = cgutils.voidptr_t
+    used = []
+    for width in widths:
+        vty = llvmlite.ir.VectorType(lty, width)
+        fnty = llvmlite.ir.FunctionType(vty, (vty,) * nargs)
+        fn = cgutils.insert_pure_function(mod, fnty,
+                                          name='numba_%s_v%d' % (base, width))
+        used.append(fn.bitcast(voidptr))
+    usedty = llvmlite.ir.ArrayType(voidptr, len(used))
+    gv = llvmlite.ir.GlobalVariable(mod, usedty, 'llvm.compiler.used')
+    gv.linkage = 'appending'
+    gv.section = 'llvm.metadata'
+    gv.initializer = Constant(usedty, used)
+    library.add_ir_module(mod)
+    library.finalize()
+    _vector_math_libraries[key] = library
+    return library
+
+
+def add_vector_math_variants(context, call, func_name, lty, nargs):
+    """
+    Let the loop vectorizer replace the *call* of the scalar math function
+    *func_name*, taking *nargs* arguments of type *lty*, with calls of its
+    vector-width variants.  The variants are declared to LLVM through the
+    "vector-function-abi-variant" attribute of the call.
+    """
+    widths = _vector_math_widths(context, func_name, lty)
+    if not widths:
+        return
+    library = _get_vector_math_library(context, func_name, lty, nargs,
+                                       widths)
+    context.add_linking_libs([library])
+    base = _vector_math_variants[func_name]
+    mappings = ','.join('_ZGV_LLVM_N%d%s_%s(numba_%s_v%d)'
+                        % (width, 'v' * nargs, func_name, base, width)
+                        for width in widths)
+    set.add(call.attributes,
+            '"vector-function-abi-variant"="%s"' % (mappings,))
+
+
 def unary_math_extern(fn, f32extern, f64extern, int_restype=False):
     """
     Register implementations of Python function *fn* using the
@@ -161,6 +280,7 @@ def unary_math_extern(fn, f32extern, f64extern, int_restype=False):
         fnty = llvmlite.ir.FunctionType(lty, [lty])
         fn = cgutils.insert_pure_function(builder.module, fnty, name=func_name)
         res = builder.call(fn, (val,))
+        add_vector_math_variants(context, res, func_name, lty, 1)
         res = context.cast(builder, res, input_type, sig.return_type)
         return impl_ret_untracked(context, builder, sig.return_type, res)
 
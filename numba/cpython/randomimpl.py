@@ -1255,6 +1255,66 @@ def permutation_impl(x):
 # ------------------------------------------------------------------------
 # Array-producing variants of scalar random functions
 
+# The bulk generation functions of _random.c filling float64 arrays, for the
+# array-producing variants of the functions taking float64 arguments.  They
+# produce the same stream as the scalar implementations.
+_bulk_fill_double = {
+    "np.random.random": "numba_rnd_fill_double",
+    "np.random.random_sample": "numba_rnd_fill_double",
+    "np.random.ranf": "numba_rnd_fill_double",
+    "np.random.sample": "numba_rnd_fill_double",
+    "np.random.uniform": "numba_rnd_fill_double",
+    "np.random.standard_normal": "numba_rnd_fill_gauss",
+    "np.random.normal": "numba_rnd_fill_gauss",
+}
+
+
+def _fill_random_array(context, builder, typing_key, arrty, arr, sig, args):
+    """
+    Fill the new C-contiguous array *arr* for *typing_key* in bulk, if there
+    is a bulk generation function for the types in *sig*.  Returns whether
+    the array was filled.
+    """
+    intp_t = context.get_value_type(types.intp)
+    scalar_types = sig.args[:-1]
+    if (typing_key in _bulk_fill_double and arrty.dtype == types.float64
+            and all(ty == types.float64 for ty in scalar_types)):
+        state_ptr = get_np_state_ptr(context, builder)
+        fnty = ir.FunctionType(ir.VoidType(),
+                               (rnd_state_ptr_t, double.as_pointer(), intp_t))
+        fn = cgutils.get_or_insert_function(builder.module, fnty,
+                                            _bulk_fill_double[typing_key])
+        builder.call(fn, (state_ptr, arr.data, arr.nitems))
+        if typing_key in ("np.random.uniform", "np.random.normal"):
+            # Scale in place, the same operations as the scalar versions
+            if typing_key == "np.random.uniform":
+                low, high = args[:-1]
+                offset, scale = low, builder.fsub(high, low)
+            else:
+                offset, scale = args[:-1]
+            with cgutils.for_range(builder, arr.nitems) as loop:
+                ptr = cgutils.gep(builder, arr.data, loop.index)
+                val = builder.fmul(scale, builder.load(ptr))
+                builder.store(builder.fadd(offset, val), ptr)
+        return True
+
+    if (typing_key == "np.random.randint" and arrty.dtype == types.int64
+            and all(ty == types.int64 for ty in scalar_types)):
+        state_ptr = get_np_state_ptr(context, builder)
+        fnty = ir.FunctionType(int32_t, (rnd_state_ptr_t, int64_t.as_pointer(),
+                                         intp_t, int64_t, int64_t))
+        fn = cgutils.get_or_insert_function(builder.module, fnty,
+                                            "numba_rnd_fill_randint64")
+        low, high = args[:-1]
+        status = builder.call(fn, (state_ptr, arr.data, arr.nitems, low, high))
+        with cgutils.if_unlikely(builder, cgutils.is_not_null(builder, status)):
+            msg = "empty range for randrange()"
+            context.call_conv.return_user_exc(builder, ValueError, (msg,))
+        return True
+
+    return False
+
+
 for typing_key, arity in [
     ("np.random.beta", 3),
     ("np.random.binomial", 3),
@@ -1306,6 +1366,11 @@ for typing_key, arity in [
         arr = arrayobj._empty_nd_impl(context, builder, arrty, shapes)
 
         # ... and populate it in natural order
+        if _fill_random_array(context, builder, typing_key, arrty, arr, sig,
+                              args):
+            return impl_ret_new_ref(context, builder, sig.return_type,
+                                    arr._getvalue())
+
         *mod, fname = typing_key.split('.')
         # Module must be numpy.random
         assert mod == ['np', 'random']
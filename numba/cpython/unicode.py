@@ -2,7 +2,7 @@ import sys
 import operator
 
 import numpy as np
-from llvmlite.ir import IntType, Constant
+from llvmlite.ir import IntType, Constant, FunctionType, VoidType
 
 from numba.core.extending import (
     models,
@@ -1830,8 +1830,66 @@ def unicode_replace(s, old_str, new_str, count=-1):
 # ------------------------------------------------------------------------------
 
 
+def _make_ascii_bulk_codegen(fname, nbufs):
+    # Call the bulk routine *fname* of _helperlib over *nbufs* buffers
+    def codegen(context, builder, sig, args):
+        ll_intp = context.get_value_type(types.intp)
+        restype = sig.return_type
+        ll_ret = IntType(32) if restype == types.boolean else VoidType()
+        fnty = FunctionType(ll_ret,
+                            [cgutils.voidptr_t] * nbufs + [ll_intp])
+        fn = cgutils.get_or_insert_function(builder.module, fnty, fname)
+        res = builder.call(fn, args)
+        if restype == types.boolean:
+            return builder.icmp_signed('!=', res, res.type(0))
+        return context.get_dummy_value()
+    return codegen
+
+
+@intrinsic
+def _ascii_bulk_upper(typingctx, src, dst, length):
+    """Write the upper case of the *length* ASCII characters at *src* to
+    *dst*"""
+    sig = types.none(types.voidptr, types.voidptr, types.intp)
+    return sig, _make_ascii_bulk_codegen("numba_ascii_upper", 2)
+
+
+@intrinsic
+def _ascii_bulk_lower(typingctx, src, dst, length):
+    """Write the lower case of the *length* ASCII characters at *src* to
+    *dst*"""
+    sig = types.none(types.voidptr, types.voidptr, types.intp)
+    return sig, _make_ascii_bulk_codegen("numba_ascii_lower", 2)
+
+
+@intrinsic
+def _ascii_bulk_isalpha(typingctx, src, length):
+    """Whether the *length* ASCII characters at *src* are all letters"""
+    sig = types.boolean(types.voidptr, types.intp)
+    return sig, _make_ascii_bulk_codegen("numba_ascii_isalpha", 1)
+
+
+@register_jitable
+def _ascii_isalnum(data):
+    for i in range(len(data)):
+        if not _Py_ISALNUM(_get_code_point(data, i)):
+            return False
+    return True
+
+
+@register_jitable
+def _ascii_isalpha(data):
+    # the bulk routine only handles the 1 byte kind, as for _ascii_upper
+    if data._kind == PY_UNICODE_1BYTE_KIND:
+        return _ascii_bulk_isalpha(data._data, len(data))
+    for i in range(len(data)):
+        if not _Py_ISALPHA(_get_code_point(data, i)):
+            return False
+    return True
+
+
 # generates isalpha/isalnum
-def gen_isAlX(ascii_func, unicode_func):
+def gen_isAlX(ascii_func, unicode_func, ascii_all_func):
     def unicode_isAlX(data):
 
         def impl(data):
@@ -1847,10 +1905,7 @@ def gen_isAlX(ascii_func, unicode_func):
                     return unicode_func(code_point)
 
             if data._is_ascii:
-                for i in range(length):
-                    code_point = _get_code_point(data, i)
-                    if not ascii_func(code_point):
-                        return False
+                return ascii_all_func(data)
 
             for i in range(length):
                 code_point = _get_code_point(data, i)
@@ -1865,7 +1920,8 @@ def gen_isAlX(ascii_func, unicode_func):
 
 # https://github.com/python/cpython/blob/1d4b6ba19466aba0eb91c4ba01ba509acf18c723/Objects/unicodeobject.c#L11928-L11964    # noqa: E501
 overload_method(types.UnicodeType, 'isalpha')(gen_isAlX(_Py_ISALPHA,
-                                                        _PyUnicode_IsAlpha))
+                                                        _PyUnicode_IsAlpha,
+                                                        _ascii_isalpha))
 
 _unicode_is_alnum = register_jitable(lambda x:
                                      (_PyUnicode_IsNumeric(x) or
@@ -1873,7 +1929,8 @@ _unicode_is_alnum = register_jitable(lambda x:
 
 # https://github.com/python/cpython/blob/1d4b6ba19466aba0eb91c4ba01ba509acf18c723/Objects/unicodeobject.c#L11975-L12006    # noqa: E501
 overload_method(types.UnicodeType, 'isalnum')(gen_isAlX(_Py_ISALNUM,
-                                                        _unicode_is_alnum))
+                                                        _unicode_is_alnum,
+                                                        _ascii_isalnum))
 
 
 def _is_upper(is_lower, is_upper, is_title):
@@ -2149,16 +2206,23 @@ _unicode_upper = register_jitable(_gen_unicode_upper_or_lower(False))
 _unicode_lower = register_jitable(_gen_unicode_upper_or_lower(True))
 
 
-def _gen_ascii_upper_or_lower(func):
+# An ASCII string may have a wider kind, e.g. when indexed from a wider string,
+# the bulk routines only handle the 1 byte kind
+def _gen_ascii_upper_or_lower(func, bulk_func):
     def _ascii_upper_or_lower(data, res):
+        if data._kind == PY_UNICODE_1BYTE_KIND:
+            bulk_func(data._data, res._data, len(data))
+            return
         for idx in range(len(data)):
             code_point = _get_code_point(data, idx)
             _set_code_point(res, idx, func(code_point))
     return _ascii_upper_or_lower
 
 
-_ascii_upper = register_jitable(_gen_ascii_upper_or_lower(_Py_TOUPPER))
-_ascii_lower = register_jitable(_gen_ascii_upper_or_lower(_Py_TOLOWER))
+_ascii_upper = register_jitable(_gen_ascii_upper_or_lower(_Py_TOUPPER,
+                                                          _ascii_bulk_upper))
+_ascii_lower = register_jitable(_gen_ascii_upper_or_lower(_Py_TOLOWER,
+                                                          _ascii_bulk_lower))
 
 
 @overload_method(types.UnicodeType, 'lower')
@@ -5,6 +5,9 @@
 
 #include "_pymodule.h"
 
+#include <stdlib.h>
+#include <string.h>
+
 
 #define CUDA_IPC_HANDLE_SIZE 64
 
@@ -15,21 +18,331 @@ typedef struct CUipcMemHandle_st{
     char reserved[CUDA_IPC_HANDLE_SIZE];
 } CUipcMemHandle;
 
+typedef void* CUcontext;
+
 typedef CUresult (*cuIpcOpenMemHandle_t)(CUdeviceptr* pdptr, CUipcMemHandle handle, unsigned int flags );
+typedef CUresult (*cuIpcCloseMemHandle_t)(CUdeviceptr dptr);
+typedef CUresult (*cuCtxGetCurrent_t)(CUcontext* pctx);
+typedef CUresult (*cuCtxPushCurrent_t)(CUcontext ctx);
+typedef CUresult (*cuCtxPopCurrent_t)(CUcontext* pctx);
+
+#define CUDA_SUCCESS 0
+#define CUDA_ERROR_OUT_OF_MEMORY 2
 
 static
 cuIpcOpenMemHandle_t cuIpcOpenMemHandle = 0;
 
+static
+cuIpcCloseMemHandle_t cuIpcCloseMemHandle = 0;
+
+static
+cuCtxGetCurrent_t cuCtxGetCurrent = 0;
+
+static
+cuCtxPushCurrent_t cuCtxPushCurrent = 0;
+
+static
+cuCtxPopCurrent_t cuCtxPopCurrent = 0;
+
 static
 void set_cuIpcOpenMemHandle(void* fnptr)
 {
     cuIpcOpenMemHandle = (cuIpcOpenMemHandle_t)fnptr;
 }
 
+static
+void set_ipc_cache_functions(void* close_fnptr, void* getcurrent_fnptr,
+                             void* push_fnptr, void* pop_fnptr)
+{
+    cuIpcCloseMemHandle = (cuIpcCloseMemHandle_t)close_fnptr;
+    cuCtxGetCurrent = (cuCtxGetCurrent_t)getcurrent_fnptr;
+    cuCtxPushCurrent = (cuCtxPushCurrent_t)push_fnptr;
+    cuCtxPopCurrent = (cuCtxPopCurrent_t)pop_fnptr;
+}
+
+
+/*
+ * Per-process cache of opened IPC handles.
+ *
+ * An entry records the device pointer a handle was opened at in a context,
+ * with the number of opens not yet closed.  Reopening a handle in the same
+ * context returns the cached pointer without calling cuIpcOpenMemHandle.
+ * When all the opens of an entry are closed it becomes idle and is kept
+ * unless there are more than `ipc_cache_size` idle entries, in which case
+ * the least recently used idle entries are closed.
+ *
+ * The ctypes calls are made without the GIL, the cache has its own lock
+ * which is held while calling the driver.
+ */
+
+#define IPC_CACHE_BUCKETS 256
+
+typedef struct ipc_cache_entry {
+    CUipcMemHandle handle;
+    CUcontext ctx;
+    CUdeviceptr dptr;
+    unsigned int flags;
+    size_t refct;
+    /* Chains of the buckets by handle and by device pointer */
+    struct ipc_cache_entry *handle_next;
+    struct ipc_cache_entry *dptr_next;
+    /* Links of the idle list, most recently used first */
+    struct ipc_cache_entry *idle_prev;
+    struct ipc_cache_entry *idle_next;
+} ipc_cache_entry;
+
+static ipc_cache_entry *ipc_cache_by_handle[IPC_CACHE_BUCKETS];
+static ipc_cache_entry *ipc_cache_by_dptr[IPC_CACHE_BUCKETS];
+static ipc_cache_entry *ipc_cache_idle_head = NULL;
+static ipc_cache_entry *ipc_cache_idle_tail = NULL;
+static size_t ipc_cache_count = 0;
+static size_t ipc_cache_idle_count = 0;
+static size_t ipc_cache_size = 0;
+
+#if defined(_WIN32)
+static SRWLOCK ipc_cache_lock = SRWLOCK_INIT;
+#define IPC_CACHE_LOCK() AcquireSRWLockExclusive(&ipc_cache_lock)
+#define IPC_CACHE_UNLOCK() ReleaseSRWLockExclusive(&ipc_cache_lock)
+#else
+#include <pthread.h>
+static pthread_mutex_t ipc_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+#define IPC_CACHE_LOCK() pthread_mutex_lock(&ipc_cache_lock)
+#define IPC_CACHE_UNLOCK() pthread_mutex_unlock(&ipc_cache_lock)
+#endif
+
+/* FNV-1a hash of the handle bytes */
+static size_t
+ipc_handle_bucket(const CUipcMemHandle *handle)
+{
+    size_t i;
+    unsigned int h = 2166136261u;
+    for (i = 0; i < CUDA_IPC_HANDLE_SIZE; i++) {
+        h ^= (unsigned char) handle->reserved[i];
+        h *= 16777619u;
+    }
+    return h % IPC_CACHE_BUCKETS;
+}
+
+static size_t
+ipc_dptr_bucket(CUdeviceptr dptr)
+{
+    size_t h = (size_t) dptr;
+    return (h ^ (h >> 12) ^ (h >> 24)) % IPC_CACHE_BUCKETS;
+}
+
+static void
+ipc_idle_unlink(ipc_cache_entry *entry)
+{
+    if (entry->idle_prev)
+        entry->idle_prev->idle_next = entry->idle_next;
+    else
+        ipc_cache_idle_head = entry->idle_next;
+    if (entry->idle_next)
+        entry->idle_next->idle_prev = entry->idle_prev;
+    else
+        ipc_cache_idle_tail = entry->idle_prev;
+    entry->idle_prev = entry->idle_next = NULL;
+    ipc_cache_idle_count--;
+}
+
+static void
+ipc_idle_push(ipc_cache_entry *entry)
+{
+    entry->idle_prev = NULL;
+    entry->idle_next = ipc_cache_idle_head;
+    if (ipc_cache_idle_head)
+        ipc_cache_idle_head->idle_prev = entry;
+    else
+        ipc_cache_idle_tail = entry;
+    ipc_cache_idle_head = entry;
+    ipc_cache_idle_count++;
+}
+
+/* Remove an entry from the cache and free it */
+static void
+ipc_cache_remove(ipc_cache_entry *entry)
+{
+    ipc_cache_entry **link;
+    link = &ipc_cache_by_handle[ipc_handle_bucket(&entry->handle)];
+    while (*link != entry)
+        link = &(*link)->handle_next;
+    *link = entry->handle_next;
+    link = &ipc_cache_by_dptr[ipc_dptr_bucket(entry->dptr)];
+    while (*link != entry)
+        link = &(*link)->dptr_next;
+    *link = entry->dptr_next;
+    if (entry->refct == 0)
+        ipc_idle_unlink(entry);
+    ipc_cache_count--;
+    free(entry);
+}
+
+/* Close the mapping of an entry in its context and remove it.  The entry
+   is removed even if closing fails, e.g. if its context was destroyed, the
+   error is returned afterwards. */
+static CUresult
+ipc_cache_close_entry(ipc_cache_entry *entry)
+{
+    CUresult res, popres;
+    CUcontext popped;
+    CUdeviceptr dptr = entry->dptr;
+    CUcontext ctx = entry->ctx;
+    ipc_cache_remove(entry);
+    res = cuCtxPushCurrent(ctx);
+    if (res != CUDA_SUCCESS)
+        return res;
+    res = cuIpcCloseMemHandle(dptr);
+    popres = cuCtxPopCurrent(&popped);
+    return res != CUDA_SUCCESS ? res : popres;
+}
+
+/* Close the least recently used idle entries until at most `limit` idle
+   entries remain, returns the first error */
+static CUresult
+ipc_cache_evict(size_t limit)
+{
+    CUresult res, first = CUDA_SUCCESS;
+    while (ipc_cache_idle_count > limit) {
+        res = ipc_cache_close_entry(ipc_cache_idle_tail);
+        if (first == CUDA_SUCCESS)
+            first = res;
+    }
+    return first;
+}
+
 static
 CUresult call_cuIpcOpenMemHandle(CUdeviceptr* pdptr, CUipcMemHandle* handle, unsigned int flags)
 {
-    return cuIpcOpenMemHandle(pdptr, *handle, flags);
+    CUresult res;
+    CUcontext ctx;
+    ipc_cache_entry *entry;
+    size_t bucket;
+
+    if (cuIpcCloseMemHandle == NULL)
+        return cuIpcOpenMemHandle(pdptr, *handle, flags);
+
+    IPC_CACHE_LOCK();
+    res = cuCtxGetCurrent(&ctx);
+    if (res != CUDA_SUCCESS)
+        goto done;
+    bucket = ipc_handle_bucket(handle);
+    for (entry = ipc_cache_by_handle[bucket]; entry != NULL;
+         entry = entry->handle_next) {
+        if (entry->ctx == ctx && entry->flags == flags &&
+            memcmp(entry->handle.reserved, handle->reserved,
+                   CUDA_IPC_HANDLE_SIZE) == 0) {
+            if (entry->refct++ == 0)
+                ipc_idle_unlink(entry);
+            *pdptr = entry->dptr;
+            goto done;
+        }
+    }
+
+    res = cuIpcOpenMemHandle(pdptr, *handle, flags);
+    if (res != CUDA_SUCCESS)
+        goto done;
+    entry = (ipc_cache_entry *) calloc(1, sizeof(ipc_cache_entry));
+    if (entry == NULL) {
+        cuIpcCloseMemHandle(*pdptr);
+        res = CUDA_ERROR_OUT_OF_MEMORY;
+        goto done;
+    }
+    entry->handle = *handle;
+    entry->ctx = ctx;
+    entry->dptr = *pdptr;
+    entry->flags = flags;
+    entry->refct = 1;
+    entry->handle_next = ipc_cache_by_handle[bucket];
+    ipc_cache_by_handle[bucket] = entry;
+    bucket = ipc_dptr_bucket(entry->dptr);
+    entry->dptr_next = ipc_cache_by_dptr[bucket];
+    ipc_cache_by_dptr[bucket] = entry;
+    ipc_cache_count++;
+
+done:
+    IPC_CACHE_UNLOCK();
+    return res;
+}
+
+static
+CUresult call_cuIpcCloseMemHandle(CUdeviceptr dptr)
+{
+    CUresult res;
+    CUcontext ctx;
+    ipc_cache_entry *entry;
+
+    IPC_CACHE_LOCK();
+    res = cuCtxGetCurrent(&ctx);
+    if (res != CUDA_SUCCESS)
+        goto done;
+    for (entry = ipc_cache_by_dptr[ipc_dptr_bucket(dptr)]; entry != NULL;
+         entry = entry->dptr_next) {
+        if (entry->ctx == ctx && entry->dptr == dptr && entry->refct > 0)
+            break;
+    }
+    if (entry == NULL) {
+        /* Not opened through the cache */
+        res = cuIpcCloseMemHandle(dptr);
+        goto done;
+    }
+    if (--entry->refct == 0) {
+        ipc_idle_push(entry);
+        res = ipc_cache_evict(ipc_cache_size);
+    }
+
+done:
+    IPC_CACHE_UNLOCK();
+    return res;
+}
+
+/* Set the maximum number of idle entries, closing the excess ones */
+static
+CUresult set_ipc_cache_size(size_t size)
+{
+    CUresult res;
+    IPC_CACHE_LOCK();
+    ipc_cache_size = size;
+    res = ipc_cache_evict(size);
+    IPC_CACHE_UNLOCK();
+    return res;
+}
+
+/* Close the idle entries of a context, and forget its other entries as
+   their mappings go away with the context.  Returns the first error. */
+static
+CUresult purge_ipc_cache(CUcontext ctx)
+{
+    CUresult res, first = CUDA_SUCCESS;
+    ipc_cache_entry *entry, *next;
+    size_t i;
+    IPC_CACHE_LOCK();
+    for (i = 0; i < IPC_CACHE_BUCKETS; i++) {
+        for (entry = ipc_cache_by_handle[i]; entry != NULL; entry = next) {
+            next = entry->handle_next;
+            if (entry->ctx != ctx)
+                continue;
+            if (entry->refct == 0) {
+                res = ipc_cache_close_entry(entry);
+                if (first == CUDA_SUCCESS)
+                    first = res;
+            }
+            else {
+                ipc_cache_remove(entry);
+            }
+        }
+    }
+    IPC_CACHE_UNLOCK();
+    return first;
+}
+
+/* Get the number of entries and of idle entries of the cache */
+static
+void get_ipc_cache_info(size_t* count, size_t* idle)
+{
+    IPC_CACHE_LOCK();
+    *count = ipc_cache_count;
+    *idle = ipc_cache_idle_count;
+    IPC_CACHE_UNLOCK();
 }
 
 
@@ -40,6 +353,11 @@ MOD_INIT(_extras) {
         return MOD_ERROR_VAL;
     PyModule_AddObject(m, "set_cuIpcOpenMemHandle", PyLong_FromVoidPtr(&set_cuIpcOpenMemHandle));
     PyModule_AddObject(m, "call_cuIpcOpenMemHandle", PyLong_FromVoidPtr(&call_cuIpcOpenMemHandle));
+    PyModule_AddObject(m, "set_ipc_cache_functions", PyLong_FromVoidPtr(&set_ipc_cache_functions));
+    PyModule_AddObject(m, "call_cuIpcCloseMemHandle", PyLong_FromVoidPtr(&call_cuIpcCloseMemHandle));
+    PyModule_AddObject(m, "set_ipc_cache_size", PyLong_FromVoidPtr(&set_ipc_cache_size));
+    PyModule_AddObject(m, "purge_ipc_cache", PyLong_FromVoidPtr(&purge_ipc_cache));
+    PyModule_AddObject(m, "get_ipc_cache_info", PyLong_FromVoidPtr(&get_ipc_cache_info));
     PyModule_AddIntConstant(m, "CUDA_IPC_HANDLE_SIZE", CUDA_IPC_HANDLE_SIZE);
     return MOD_SUCCESS_VAL(m);
 }
@@ -275,6 +275,67 @@ class Driver(object):
         # override cuIpcOpenMemHandle
         self.cuIpcOpenMemHandle = safe_call
 
+        # cache the opened IPC handles, see _extras.c
+        set_proto = ctypes.CFUNCTYPE(None, c_void_p, c_void_p, c_void_p,
+                                     c_void_p)
+        set_ipc_cache_functions = set_proto(_extras.set_ipc_cache_functions)
+        set_ipc_cache_functions(self._find_api('cuIpcCloseMemHandle'),
+                                self._find_api('cuCtxGetCurrent'),
+                                self._find_api('cuCtxPushCurrent'),
+                                self._find_api('cuCtxPopCurrent'))
+        close_proto = ctypes.CFUNCTYPE(c_int, drvapi.cu_device_ptr)
+        call_cuIpcCloseMemHandle = close_proto(
+            _extras.call_cuIpcCloseMemHandle)
+        call_cuIpcCloseMemHandle.__name__ = 'call_cuIpcCloseMemHandle'
+        self.cuIpcCloseMemHandle = self._ctypes_wrap_fn(
+            'call_cuIpcCloseMemHandle', call_cuIpcCloseMemHandle)
+
+        size_proto = ctypes.CFUNCTYPE(c_int, c_size_t)
+        set_ipc_cache_size = size_proto(_extras.set_ipc_cache_size)
+        set_ipc_cache_size.__name__ = 'set_ipc_cache_size'
+        self._set_ipc_cache_size = self._ctypes_wrap_fn('set_ipc_cache_size',
+                                                        set_ipc_cache_size)
+        purge_proto = ctypes.CFUNCTYPE(c_int, drvapi.cu_context)
+        purge_ipc_cache = purge_proto(_extras.purge_ipc_cache)
+        purge_ipc_cache.__name__ = 'purge_ipc_cache'
+        self._purge_ipc_cache = self._ctypes_wrap_fn('purge_ipc_cache',
+                                                     purge_ipc_cache)
+        info_proto = ctypes.CFUNCTYPE(None, ctypes.POINTER(c_size_t),
+                                      ctypes.POINTER(c_size_t))
+        self._get_ipc_cache_info = info_proto(_extras.get_ipc_cache_info)
+        self._set_ipc_cache_size(config.CUDA_IPC_CACHE_SIZE)
+
+    def set_ipc_cache_size(self, size):
+        """
+        Set the number of opened IPC handles that are kept open after they
+        are closed, so that reopening them is free.  The least recently used
+        handles in excess are closed.  The cache is only used with Numba's
+        ctypes binding.
+        """
+        self.ensure_initialized()
+        if not USE_NV_BINDING:
+            self._set_ipc_cache_size(size)
+
+    def get_ipc_cache_info(self):
+        """
+        Returns the number of IPC handles in the cache and the number of these
+        that are closed and only kept open by the cache.
+        """
+        self.ensure_initialized()
+        if USE_NV_BINDING:
+            return 0, 0
+        count = c_size_t()
+        idle = c_size_t()
+        self._get_ipc_cache_info(byref(count), byref(idle))
+        return count.value, idle.value
+
+    def purge_ipc_cache(self, context_handle):
+        """
+        Close the cached IPC handles of a context and forget its open ones.
+        """
+        if not USE_NV_BINDING:
+            self._purge_ipc_cache(context_handle)
+
     @property
     def is_available(self):
         self.ensure_initialized()
@@ -1243,6 +1304,7 @@ class Context(object):
         _logger.info('reset context of device %s', self.device.id)
         self.memory_manager.reset()
         self.modules.clear()
+        driver.purge_ipc_cache(self.handle)
         # Clear trash
         self.deallocations.clear()
 
@@ -54,6 +54,28 @@ def serialize_ipc_handle_test(handle, result_queue):
     core_ipc_handle_test(the_work, result_queue)
 
 
+def cached_ipc_handle_test(handle, result_queue):
+    def the_work():
+        driver.driver.set_ipc_cache_size(4)
+        ctx = cuda.current_context()
+        dtype = np.dtype(np.intp)
+        ptrs = []
+        for _ in range(2):
+            darr = handle.open_array(ctx, shape=handle.size // dtype.itemsize,
+                                     dtype=dtype)
+            ptrs.append(darr.device_ctypes_pointer.value)
+            arr = darr.copy_to_host()
+            del darr
+            handle.close()
+        count, idle = driver.driver.get_ipc_cache_info()
+        if ptrs[0] != ptrs[1] or (count, idle) != (1, 1):
+            raise AssertionError('handle not cached: %s %s' % (ptrs,
+                                                               (count, idle)))
+        return arr
+
+    core_ipc_handle_test(the_work, result_queue)
+
+
 def ipc_array_test(ipcarr, result_queue):
     try:
         with ipcarr as darr:
@@ -114,6 +136,26 @@ class TestIpcMemory(ContextResettingTestCase):
             np.testing.assert_equal(arr, out)
         proc.join(3)
 
+    @unittest.skipIf(driver.USE_NV_BINDING,
+                     'IPC handle cache is only used by the ctypes binding')
+    def test_ipc_handle_cache(self):
+        arr = np.arange(10, dtype=np.intp)
+        devarr = cuda.to_device(arr)
+        ipch = cuda.current_context().get_ipc_handle(devarr.gpu_data)
+
+        # spawn new process for testing
+        ctx = mp.get_context('spawn')
+        result_queue = ctx.Queue()
+        args = (ipch, result_queue)
+        proc = ctx.Process(target=cached_ipc_handle_test, args=args)
+        proc.start()
+        succ, out = result_queue.get()
+        if not succ:
+            self.fail(out)
+        else:
+            np.testing.assert_equal(arr, out)
+        proc.join(3)
+
     def variants(self):
         # Test with no slicing and various different slices
         indices = (None, slice(3, None), slice(3, 8), slice(None, 8))
@@ -2,6 +2,7 @@
 Implements jitclass Box type in python c-api level.
 */
 #include "../../_pymodule.h"
+#include <stdint.h>
 
 typedef struct {
     PyObject_HEAD
@@ -92,6 +93,359 @@ static PyTypeObject BoxType = {
 };
 
 
+/*
+ * FieldDescriptor
+ * A data descriptor reading and writing a scalar field of the jitclass data
+ * structure at box->dataptr + offset, so that Python access to the field
+ * doesn't go through a compiled getter and setter.
+ *
+ * The kind of the field is one of 'b' (boolean), 'i' (signed integer),
+ * 'u' (unsigned integer), 'f' (float) and 'c' (complex).  Values the
+ * descriptor can't convert itself, e.g. NumPy scalars, are passed to the
+ * optional fallback setter `fset(box, value)`.
+ */
+typedef struct {
+    PyObject_HEAD
+    PyObject *name;
+    PyObject *fset;
+    Py_ssize_t offset;
+    Py_ssize_t itemsize;
+    char kind;
+} FieldDescriptorObject;
+
+
+static int
+FieldDescriptor_init(FieldDescriptorObject *self, PyObject *args,
+                     PyObject *kwds)
+{
+    static char *keywords[] = {"name", "offset", "kind", "itemsize", "fset",
+                               NULL};
+    PyObject *name, *fset = Py_None;
+    Py_ssize_t offset, itemsize;
+    char kind;
+    int valid;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "UnCn|O", keywords,
+                                     &name, &offset, &kind, &itemsize,
+                                     &fset))
+    {
+        return -1;
+    }
+    switch (kind) {
+    case 'b':
+        valid = itemsize == 1;
+        break;
+    case 'i':
+    case 'u':
+        valid = (itemsize == 1 || itemsize == 2 || itemsize == 4 ||
+                 itemsize == 8);
+        break;
+    case 'f':
+        valid = itemsize == 4 || itemsize == 8;
+        break;
+    case 'c':
+        valid = itemsize == 8 || itemsize == 16;
+        break;
+    default:
+        valid = 0;
+    }
+    if (!valid) {
+        PyErr_Format(PyExc_ValueError,
+                     "unsupported field kind '%c' of itemsize %zd",
+                     kind, itemsize);
+        return -1;
+    }
+    if (offset < 0) {
+        PyErr_SetString(PyExc_ValueError, "negative field offset");
+        return -1;
+    }
+    Py_INCREF(name);
+    Py_XSETREF(self->name, name);
+    if (fset == Py_None) {
+        Py_CLEAR(self->fset);
+    }
+    else {
+        Py_INCREF(fset);
+        Py_XSETREF(self->fset, fset);
+    }
+    self->offset = offset;
+    self->itemsize = itemsize;
+    self->kind = kind;
+    return 0;
+}
+
+static int
+FieldDescriptor_traverse(FieldDescriptorObject *self, visitproc visit,
+                         void *arg)
+{
+    Py_VISIT(self->fset);
+    return 0;
+}
+
+static int
+FieldDescriptor_clear(FieldDescriptorObject *self)
+{
+    Py_CLEAR(self->fset);
+    return 0;
+}
+
+static void
+FieldDescriptor_dealloc(FieldDescriptorObject *self)
+{
+    PyObject_GC_UnTrack((PyObject *) self);
+    Py_CLEAR(self->name);
+    Py_CLEAR(self->fset);
+    Py_TYPE(self)->tp_free((PyObject *) self);
+}
+
+/* Get the address of the field in `obj`, or NULL with an exception set */
+static char *
+FieldDescriptor_address(FieldDescriptorObject *self, PyObject *obj)
+{
+    BoxObject *box;
+    if (!PyObject_TypeCheck(obj, &BoxType)) {
+        PyErr_Format(PyExc_TypeError,
+                     "descriptor '%U' requires a jitclass instance, "
+                     "not '%.200s'", self->name, Py_TYPE(obj)->tp_name);
+        return NULL;
+    }
+    box = (BoxObject *) obj;
+    if (box->dataptr == NULL) {
+        PyErr_Format(PyExc_AttributeError,
+                     "jitclass instance has no data for field '%U'",
+                     self->name);
+        return NULL;
+    }
+    return (char *) box->dataptr + self->offset;
+}
+
+static PyObject *
+FieldDescriptor_get(FieldDescriptorObject *self, PyObject *obj,
+                    PyObject *type)
+{
+    char *addr;
+    if (obj == NULL || obj == Py_None) {
+        Py_INCREF(self);
+        return (PyObject *) self;
+    }
+    addr = FieldDescriptor_address(self, obj);
+    if (addr == NULL)
+        return NULL;
+
+    switch (self->kind) {
+    case 'b':
+        return PyBool_FromLong(*(unsigned char *) addr != 0);
+    case 'i':
+        switch (self->itemsize) {
+        case 1: return PyLong_FromLong(*(int8_t *) addr);
+        case 2: return PyLong_FromLong(*(int16_t *) addr);
+        case 4: return PyLong_FromLong(*(int32_t *) addr);
+        default: return PyLong_FromLongLong(*(int64_t *) addr);
+        }
+    case 'u':
+        switch (self->itemsize) {
+        case 1: return PyLong_FromUnsignedLong(*(uint8_t *) addr);
+        case 2: return PyLong_FromUnsignedLong(*(uint16_t *) addr);
+        case 4: return PyLong_FromUnsignedLong(*(uint32_t *) addr);
+        default: return PyLong_FromUnsignedLongLong(*(uint64_t *) addr);
+        }
+    case 'f':
+        if (self->itemsize == 4)
+            return PyFloat_FromDouble(*(float *) addr);
+        return PyFloat_FromDouble(*(double *) addr);
+    default: /* 'c' */
+        if (self->itemsize == 8)
+            return PyComplex_FromDoubles(((float *) addr)[0],
+                                         ((float *) addr)[1]);
+        return PyComplex_FromDoubles(((double *) addr)[0],
+                                     ((double *) addr)[1]);
+    }
+}
+
+/* Convert `value` to an integer wrapping around like the cast of an int64
+ * or uint64 to a narrower type.  Returns 0 on success, 1 if `value` isn't
+ * an int or is out of range of both int64 and uint64.
+ */
+static int
+FieldDescriptor_as_integer(PyObject *value, uint64_t *out)
+{
+    int overflow;
+    long long sval;
+    unsigned long long uval;
+    if (!PyLong_Check(value))
+        return 1;
+    sval = PyLong_AsLongLongAndOverflow(value, &overflow);
+    if (!overflow) {
+        if (sval == -1 && PyErr_Occurred()) {
+            PyErr_Clear();
+            return 1;
+        }
+        *out = (uint64_t) sval;
+        return 0;
+    }
+    if (overflow < 0)
+        return 1;
+    uval = PyLong_AsUnsignedLongLong(value);
+    if (uval == (unsigned long long) -1 && PyErr_Occurred()) {
+        PyErr_Clear();
+        return 1;
+    }
+    *out = (uint64_t) uval;
+    return 0;
+}
+
+/* Store `value` at `addr` as per the field kind.  Returns 0 on success,
+ * 1 if `value` must be handled by the fallback setter.
+ */
+static int
+FieldDescriptor_store(FieldDescriptorObject *self, char *addr,
+                      PyObject *value)
+{
+    uint64_t ival;
+    double dval;
+    Py_complex cval;
+
+    switch (self->kind) {
+    case 'b':
+        if (!PyBool_Check(value))
+            return 1;
+        *(unsigned char *) addr = value == Py_True;
+        return 0;
+    case 'i':
+    case 'u':
+        if (FieldDescriptor_as_integer(value, &ival))
+            return 1;
+        switch (self->itemsize) {
+        case 1: *(uint8_t *) addr = (uint8_t) ival; break;
+        case 2: *(uint16_t *) addr = (uint16_t) ival; break;
+        case 4: *(uint32_t *) addr = (uint32_t) ival; break;
+        default: *(uint64_t *) addr = ival;
+        }
+        return 0;
+    case 'f':
+        if (!PyFloat_Check(value) && !PyLong_Check(value))
+            return 1;
+        dval = PyFloat_AsDouble(value);
+        if (dval == -1.0 && PyErr_Occurred()) {
+            PyErr_Clear();
+            return 1;
+        }
+        if (self->itemsize == 4)
+            *(float *) addr = (float) dval;
+        else
+            *(double *) addr = dval;
+        return 0;
+    default: /* 'c' */
+        if (!PyComplex_Check(value) && !PyFloat_Check(value) &&
+            !PyLong_Check(value))
+            return 1;
+        cval = PyComplex_AsCComplex(value);
+        if (cval.real == -1.0 && PyErr_Occurred()) {
+            PyErr_Clear();
+            return 1;
+        }
+        if (self->itemsize == 8) {
+            ((float *) addr)[0] = (float) cval.real;
+            ((float *) addr)[1] = (float) cval.imag;
+        }
+        else {
+            ((double *) addr)[0] = cval.real;
+            ((double *) addr)[1] = cval.imag;
+        }
+        return 0;
+    }
+}
+
+static int
+FieldDescriptor_set(FieldDescriptorObject *self, PyObject *obj,
+                    PyObject *value)
+{
+    char *addr;
+    PyObject *res;
+    if (value == NULL) {
+        PyErr_Format(PyExc_AttributeError,
+                     "cannot delete jitclass field '%U'", self->name);
+        return -1;
+    }
+    addr = FieldDescriptor_address(self, obj);
+    if (addr == NULL)
+        return -1;
+    if (!FieldDescriptor_store(self, addr, value))
+        return 0;
+
+    if (self->fset == NULL) {
+        PyErr_Format(PyExc_TypeError,
+                     "cannot assign '%.200s' to jitclass field '%U'",
+                     Py_TYPE(value)->tp_name, self->name);
+        return -1;
+    }
+    res = PyObject_CallFunctionObjArgs(self->fset, obj, value, NULL);
+    if (res == NULL)
+        return -1;
+    Py_DECREF(res);
+    return 0;
+}
+
+
+static PyMemberDef FieldDescriptor_members[] = {
+    {"__name__", T_OBJECT, offsetof(FieldDescriptorObject, name), READONLY,
+     NULL},
+    {"fset", T_OBJECT, offsetof(FieldDescriptorObject, fset), READONLY,
+     NULL},
+    {"offset", T_PYSSIZET, offsetof(FieldDescriptorObject, offset), READONLY,
+     NULL},
+    {"itemsize", T_PYSSIZET, offsetof(FieldDescriptorObject, itemsize),
+     READONLY, NULL},
+    {NULL}  /* Sentinel */
+};
+
+
+static const char FieldDescriptor_doc[] =
+    "FieldDescriptor(name, offset, kind, itemsize, fset=None)\n"
+    "Native accessor of a scalar field of jit-class instances";
+
+
+static PyTypeObject FieldDescriptorType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "_box.FieldDescriptor",    /*tp_name*/
+    sizeof(FieldDescriptorObject), /*tp_basicsize*/
+    0,                         /*tp_itemsize*/
+    (destructor)FieldDescriptor_dealloc, /*tp_dealloc*/
+    0,                         /*tp_print*/
+    0,                         /*tp_getattr*/
+    0,                         /*tp_setattr*/
+    0,                         /*tp_compare*/
+    0,                         /*tp_repr*/
+    0,                         /*tp_as_number*/
+    0,                         /*tp_as_sequence*/
+    0,                         /*tp_as_mapping*/
+    0,                         /*tp_hash */
+    0,                         /*tp_call*/
+    0,                         /*tp_str*/
+    0,                         /*tp_getattro*/
+    0,                         /*tp_setattro*/
+    0,                         /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC, /*tp_flags*/
+    FieldDescriptor_doc,       /* tp_doc */
+    (traverseproc)FieldDescriptor_traverse, /* tp_traverse */
+    (inquiry)FieldDescriptor_clear, /* tp_clear */
+    0,                         /* tp_richcompare */
+    0,                         /* tp_weaklistoffset */
+    0,                         /* tp_iter */
+    0,                         /* tp_iternext */
+    0,                         /* tp_methods */
+    FieldDescriptor_members,   /* tp_members */
+    0,                         /* tp_getset */
+    0,                         /* tp_base */
+    0,                         /* tp_dict */
+    (descrgetfunc)FieldDescriptor_get, /* tp_descr_get */
+    (descrsetfunc)FieldDescriptor_set, /* tp_descr_set */
+    0,                         /* tp_dictoffset */
+    (initproc)FieldDescriptor_init, /* tp_init */
+    0,                         /* tp_alloc */
+    PyType_GenericNew,         /* tp_new */
+};
+
+
 /* Import MemInfo_Release from numba.core.runtime._nrt_python once for use in
  * Box_dealloc.
  */
@@ -161,6 +515,10 @@ MOD_INIT(_box) {
     if (PyType_Ready(&BoxType))
         return MOD_ERROR_VAL;
 
+    /* init FieldDescriptorType */
+    if (PyType_Ready(&FieldDescriptorType))
+        return MOD_ERROR_VAL;
+
     /* import and cache NRT_MemInfo_release function pointer */
     MemInfo_release = import_meminfo_release();
     if (!MemInfo_release) return MOD_ERROR_VAL;
@@ -168,6 +526,9 @@ MOD_INIT(_box) {
     /* bind BoxType */
     Py_INCREF(&BoxType);
     PyModule_AddObject(m, "Box", (PyObject *) (&BoxType));
+    Py_INCREF(&FieldDescriptorType);
+    PyModule_AddObject(m, "FieldDescriptor",
+                       (PyObject *) (&FieldDescriptorType));
 
     /* bind address to direct access utils */;
     PyModule_AddObject(m, "box_meminfoptr_offset",
@@ -7,6 +7,7 @@ from functools import wraps, partial
 
 from llvmlite import ir
 
+from numba import _dispatcher
 from numba.core import types, cgutils
 from numba.core.decorators import njit
 from numba.core.pythonapi import box, unbox, NativeValue
@@ -63,6 +64,43 @@ def _generate_method(name, func):
     return wrapper
 
 
+def _native_field_kind(fety):
+    """
+    Return the (kind, itemsize) of the _box.FieldDescriptor accessing a field
+    of type *fety*, or None if the field must be accessed through compiled
+    code.
+    """
+    if isinstance(fety, types.Boolean):
+        return 'b', 1
+    elif isinstance(fety, types.Integer) and fety.bitwidth in (8, 16, 32, 64):
+        return ('i' if fety.signed else 'u'), fety.bitwidth // 8
+    elif isinstance(fety, types.Float) and fety.bitwidth in (32, 64):
+        return 'f', fety.bitwidth // 8
+    elif isinstance(fety, types.Complex) and fety.bitwidth in (64, 128):
+        return 'c', fety.bitwidth // 8
+    return None
+
+
+def _native_field_offsets(typ):
+    """
+    Return a dict of the byte offsets of the fields in the data structure of
+    the jitclass instance type *typ*, as laid out by the CPU target.
+    """
+    from numba.core.registry import cpu_target
+
+    context = cpu_target.target_context
+    datamodel = context.data_model_manager[typ.get_data_type()]
+    lltys = datamodel.get_data_type().elements
+    offsets = {}
+    offset = 0
+    for field, llty in zip(typ.struct, lltys):
+        align = context.get_abi_alignment(llty)
+        offset = (offset + align - 1) // align * align
+        offsets[field] = offset
+        offset += context.get_abi_sizeof(llty)
+    return offsets
+
+
 _cache_specialized_box = {}
 
 
@@ -79,11 +117,19 @@ def _specialize_box(typ):
            '_numba_type_': typ,
            '__doc__': typ.class_type.class_doc,
            }
-    # Inject attributes as class properties
-    for field in typ.struct:
-        getter = _generate_getter(field)
+    # Inject attributes as class properties, scalar fields are accessed
+    # natively by a descriptor
+    offsets = _native_field_offsets(typ)
+    for field, fety in typ.struct.items():
         setter = _generate_setter(field)
-        dct[field] = property(getter, setter)
+        native = _native_field_kind(fety)
+        if native is not None and field in offsets:
+            kind, itemsize = native
+            dct[field] = _box.FieldDescriptor(field, offsets[field], kind,
+                                              itemsize, setter)
+        else:
+            getter = _generate_getter(field)
+            dct[field] = property(getter, setter)
     # Inject properties as class properties
     for field, impdct in typ.jit_props.items():
         getter = None
@@ -254,3 +300,7 @@ def _unbox_class_instance(typ, val, c):
 @typeof_impl.register(_box.Box)
 def _typeof_jitclass_box(val, c):
     return getattr(type(val), "_numba_type_")
+
+
+# The dispatcher caches the typecodes of boxed jitclasses on their class
+_dispatcher.typeof_register_type(_box.Box, None)
@@ -0,0 +1,240 @@
+"""
+Benchmarks of the per-call cost of the native dispatch path, that is of
+Dispatcher_call(), typeof_typecode(), the overload resolution and
+call_cfunc(). Each case calls a jitted function whose body does nothing, so
+the time per call is almost entirely dispatch overhead.
+
+Run with::
+
+    $ python -m numba.misc.dispatch_benchmark [--json FILE] [-k PATTERN]
+
+The JSON output records the environment along with the time per call of
+each case so that results can be tracked over time.
+"""
+
+import argparse
+import json
+import platform
+import sys
+import timeit
+from datetime import datetime
+
+import numpy as np
+
+from numba import njit, __version__ as numba_version
+
+
+def _make_function(nargs, defaults=()):
+    """Make a jitted function of `nargs` arguments returning 0, the last
+    len(defaults) arguments have these default values.
+    """
+    names = ['a%d' % i for i in range(nargs)]
+    params = list(names)
+    for i, val in enumerate(defaults):
+        idx = nargs - len(defaults) + i
+        params[idx] = '%s=%r' % (names[idx], val)
+    ns = {}
+    exec('def f(%s):\n    return 0\n' % ', '.join(params), ns)
+    return njit(ns['f'])
+
+
+def _call_stmt(nargs, keywords=False):
+    names = ['a%d' % i for i in range(nargs)]
+    if keywords:
+        return 'f(%s)' % ', '.join('%s=%s' % (n, n) for n in names)
+    return 'f(%s)' % ', '.join(names)
+
+
+class _Case(object):
+    """A benchmark case, calling `func` with `args` as per `stmt`, after
+    running `setup` which compiles the overloads.
+    """
+
+    def __init__(self, name, group, params, func, args, stmt, setup=None,
+                 tracing=False):
+        self.name = name
+        self.group = group
+        self.params = params
+        self.func = func
+        self.args = args
+        self.stmt = stmt
+        self.setup = setup
+        self.tracing = tracing
+
+    def prepare(self):
+        if self.setup is not None:
+            self.setup(self.func)
+        # compile the signature being timed
+        return self.make_timer().timeit(number=1)
+
+    def make_timer(self):
+        ns = {'f': self.func}
+        if self.func is not None:
+            ns['tp_call'] = type(self.func).__call__
+        ns.update(('a%d' % i, a) for i, a in enumerate(self.args))
+        return timeit.Timer(self.stmt, globals=ns)
+
+
+def _overload_values(count):
+    """Return `count` values of distinct Numba types"""
+    dtypes = [np.int8, np.int16, np.int32, np.int64, np.uint8, np.uint16,
+              np.uint32, np.uint64, np.float32, np.float64, np.complex64,
+              np.complex128]
+    values = [dt(1) for dt in dtypes]
+    for layout in 'CF':
+        for ndim in (1, 2, 3):
+            for dt in dtypes:
+                values.append(np.ones((2,) * ndim, dtype=dt, order=layout))
+    if count > len(values):
+        raise ValueError('at most %d overloads are supported' % len(values))
+    return values[:count]
+
+
+def _compile_overloads(values):
+    def setup(func):
+        for v in values:
+            func(v)
+    return setup
+
+
+def _noop_profiler(frame, event, arg):
+    pass
+
+
+def make_cases():
+    """Return the list of benchmark cases"""
+    cases = []
+
+    for nargs in (0, 1, 2, 4, 8, 16, 23, 24, 32):
+        cases.append(_Case('positional/argc=%d' % nargs, 'positional',
+                           {'argc': nargs}, _make_function(nargs),
+                           (1,) * nargs, _call_stmt(nargs)))
+
+    for nargs in (1, 4):
+        cases.append(_Case('tp_call/argc=%d' % nargs, 'tp_call',
+                           {'argc': nargs}, _make_function(nargs),
+                           (1,) * nargs,
+                           _call_stmt(nargs).replace('f(', 'tp_call(f, ', 1)))
+
+    for nargs in (1, 4, 8):
+        cases.append(_Case('kwargs/argc=%d' % nargs, 'kwargs',
+                           {'argc': nargs}, _make_function(nargs),
+                           (1,) * nargs, _call_stmt(nargs, keywords=True)))
+        cases.append(_Case('defaults/argc=%d' % nargs, 'defaults',
+                           {'argc': nargs},
+                           _make_function(nargs, defaults=(1,)),
+                           (1,) * nargs, _call_stmt(nargs - 1)))
+
+    for ndim in (1, 2, 3):
+        arr = np.ones((2,) * ndim)
+        cases.append(_Case('array/ndim=%d' % ndim, 'array', {'ndim': ndim},
+                           _make_function(1), (arr,), _call_stmt(1)))
+    for nargs in (4, 16):
+        arr = np.ones(2)
+        cases.append(_Case('array/argc=%d' % nargs, 'array',
+                           {'argc': nargs, 'ndim': 1}, _make_function(nargs),
+                           (arr,) * nargs, _call_stmt(nargs)))
+    cases.append(_Case('record/argc=1', 'record', {'argc': 1},
+                       _make_function(1),
+                       (np.zeros(1, dtype=[('a', np.int32),
+                                           ('b', np.float64)])[0],),
+                       _call_stmt(1)))
+
+    for count in (1, 4, 16, 64):
+        values = _overload_values(count)
+        cases.append(_Case('overloads/count=%d' % count, 'overloads',
+                           {'count': count}, _make_function(1),
+                           (values[-1],), _call_stmt(1),
+                           setup=_compile_overloads(values)))
+
+    for tracing in (False, True):
+        cases.append(_Case('tracing/%s' % ('on' if tracing else 'off'),
+                           'tracing', {'tracing': tracing},
+                           _make_function(1), (1,), _call_stmt(1),
+                           tracing=tracing))
+    return cases
+
+
+def _time_case(case, repeat, min_time):
+    timer = case.make_timer()
+    if case.tracing:
+        sys.setprofile(_noop_profiler)
+    try:
+        number = 1
+        while True:
+            if timer.timeit(number) >= min_time:
+                break
+            number *= 10
+        best = min(timer.repeat(repeat=repeat, number=number))
+    finally:
+        if case.tracing:
+            sys.setprofile(None)
+    return best / number, number
+
+
+def run(pattern=None, repeat=5, min_time=0.2):
+    """Run the benchmarks whose name contains `pattern`, or all of them.
+    Each case is timed `repeat` times with enough calls to take at least
+    `min_time` seconds, keeping the best time.
+
+    Returns a dict of JSON serializable results.
+    """
+    cases = [c for c in make_cases() if pattern is None or pattern in c.name]
+    # the overhead of the timing loop itself, subtracted from the results
+    loop, _ = _time_case(_Case('loop', 'loop', {}, None, (), 'pass'),
+                         repeat, min_time)
+    results = []
+    for case in cases:
+        case.prepare()
+        per_call, number = _time_case(case, repeat, min_time)
+        results.append({
+            'name': case.name,
+            'group': case.group,
+            'params': case.params,
+            'ns_per_call': max(per_call - loop, 0.0) * 1e9,
+            'calls': number,
+            'repeat': repeat,
+        })
+    return {
+        'numba_version': numba_version,
+        'python_version': platform.python_version(),
+        'platform': platform.platform(),
+        'machine': platform.machine(),
+        'timestamp': datetime.utcnow().isoformat(),
+        'loop_ns': loop * 1e9,
+        'results': results,
+    }
+
+
+def make_parser():
+    parser = argparse.ArgumentParser(
+        description='Benchmark the per-call overhead of jitted functions')
+    parser.add_argument('-k', dest='pattern', default=None,
+                        help='only run the cases whose name contains PATTERN')
+    parser.add_argument('--repeat', type=int, default=5,
+                        help='number of timings per case (default: 5)')
+    parser.add_argument('--min-time', type=float, default=0.2,
+                        help='minimum duration of a timing in seconds '
+                             '(default: 0.2)')
+    parser.add_argument('--json', dest='json_file', default=None,
+                        help="write the results as JSON to FILE, '-' for "
+                             "stdout")
+    return parser
+
+
+def main(argv=None):
+    args = make_parser().parse_args(argv)
+    out = run(args.pattern, repeat=args.repeat, min_time=args.min_time)
+    if args.json_file == '-':
+        json.dump(out, sys.stdout, indent=2)
+        print()
+    elif args.json_file:
+        with open(args.json_file, 'w') as f:
+            json.dump(out, f, indent=2)
+    if args.json_file != '-':
+        for res in out['results']:
+            print('%-24s %10.1f ns' % (res['name'], res['ns_per_call']))
+
+
+if __name__ == '__main__':
+    main()
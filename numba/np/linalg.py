@@ -110,6 +110,50 @@ class _BLAS:
         )
         return types.ExternalFunction("numba_xxgemm", sig)
 
+    @classmethod
+    def numba_xxgemm_batched(cls, dtype):
+        sig = types.intc(
+            types.char,             # kind
+            types.char,             # transa
+            types.char,             # transb
+            types.intp,             # m
+            types.intp,             # n
+            types.intp,             # k
+            types.CPointer(dtype),  # alpha
+            types.CPointer(dtype),  # a
+            types.intp,             # lda
+            types.intp,             # stride_a
+            types.CPointer(dtype),  # b
+            types.intp,             # ldb
+            types.intp,             # stride_b
+            types.CPointer(dtype),  # beta
+            types.CPointer(dtype),  # c
+            types.intp,             # ldc
+            types.intp,             # stride_c
+            types.intp              # batch
+        )
+        return types.ExternalFunction("numba_xxgemm_batched", sig)
+
+    @classmethod
+    def numba_xxgemv_batched(cls, dtype):
+        sig = types.intc(
+            types.char,             # kind
+            types.char,             # trans
+            types.intp,             # m
+            types.intp,             # n
+            types.CPointer(dtype),  # alpha
+            types.CPointer(dtype),  # a
+            types.intp,             # lda
+            types.intp,             # stride_a
+            types.CPointer(dtype),  # x
+            types.intp,             # stride_x
+            types.CPointer(dtype),  # beta
+            types.CPointer(dtype),  # y
+            types.intp,             # stride_y
+            types.intp              # batch
+        )
+        return types.ExternalFunction("numba_xxgemv_batched", sig)
+
 
 class _LAPACK:
     """
@@ -521,6 +565,133 @@ def dot_2_vv(context, builder, sig, args, conjugate=False):
     return builder.load(out)
 
 
+def _stacked_batch_shape(a, b):
+    pass
+
+
+@overload(_stacked_batch_shape)
+def _stacked_batch_shape_impl(a, b):
+    """
+    The shape of the stack of products of a @ b, at least one of a and b
+    being a stack of matrices.
+    """
+    if a.ndim > 2 and b.ndim > 2:
+        def impl(a, b):
+            if a.shape[:-2] != b.shape[:-2]:
+                raise ValueError("incompatible stack shapes for '@'")
+            return a.shape[:-2]
+    elif a.ndim > 2:
+        def impl(a, b):
+            return a.shape[:-2]
+    else:
+        def impl(a, b):
+            return b.shape[:-2]
+    return impl
+
+
+def dot_2_stacked(context, builder, sig, args):
+    """
+    a @ b where a or b is a stack of matrices (more than 2 dimensions).
+    The products are all computed by a single call of the batched BLAS
+    wrappers, the data being contiguous so that consecutive matrices
+    are at a constant stride from each other.
+    """
+    aty, bty = sig.args
+    dtype = aty.dtype
+    kind = ord(get_blas_kind(dtype))
+    dt = np_support.as_dtype(dtype)
+    zero = np.array([0.], dtype=dt)
+    one = np.array([1.], dtype=dt)
+    notrans = ord('N')
+    trans = ord('T')
+
+    if aty.ndim == 1 or bty.ndim == 1:
+        numba_xxgemv_batched = _BLAS().numba_xxgemv_batched(dtype)
+
+        if aty.ndim == 1:
+            def dot_impl(a, b):
+                k, = a.shape
+                _k, n = b.shape[-2:]
+                if k != _k:
+                    raise ValueError("incompatible array sizes for '@' "
+                                     "(vector * stacked matrices)")
+                batch_shape = b.shape[:-2]
+                if k == 0:
+                    return np.zeros(batch_shape + (n,), a.dtype)
+                out = np.empty(batch_shape + (n,), a.dtype)
+                if out.size == 0:
+                    return out
+                bc = np.ascontiguousarray(b)
+                # Each matrix of b is seen as its n x k column-major transpose
+                r = numba_xxgemv_batched(kind, notrans, n, k, one.ctypes,
+                                         bc.ctypes, n, n * k, a.ctypes, 0,
+                                         zero.ctypes, out.ctypes, n,
+                                         out.size // n)
+                if r < 0:
+                    fatal_error_func()
+                _dummy_liveness_func([bc.size, one.size, zero.size])
+                return out
+        else:
+            def dot_impl(a, b):
+                m, k = a.shape[-2:]
+                _k, = b.shape
+                if k != _k:
+                    raise ValueError("incompatible array sizes for '@' "
+                                     "(stacked matrices * vector)")
+                batch_shape = a.shape[:-2]
+                if k == 0:
+                    return np.zeros(batch_shape + (m,), a.dtype)
+                out = np.empty(batch_shape + (m,), a.dtype)
+                if out.size == 0:
+                    return out
+                ac = np.ascontiguousarray(a)
+                # Each matrix of a is seen as its k x m column-major transpose
+                r = numba_xxgemv_batched(kind, trans, k, m, one.ctypes,
+                                         ac.ctypes, k, m * k, b.ctypes, 0,
+                                         zero.ctypes, out.ctypes, m,
+                                         out.size // m)
+                if r < 0:
+                    fatal_error_func()
+                _dummy_liveness_func([ac.size, one.size, zero.size])
+                return out
+    else:
+        numba_xxgemm_batched = _BLAS().numba_xxgemm_batched(dtype)
+        a_stacked = aty.ndim > 2
+        b_stacked = bty.ndim > 2
+
+        def dot_impl(a, b):
+            m, k = a.shape[-2:]
+            _k, n = b.shape[-2:]
+            if k != _k:
+                raise ValueError("incompatible array sizes for '@' "
+                                 "(stacked matrices)")
+            batch_shape = _stacked_batch_shape(a, b)
+            if k == 0:
+                return np.zeros(batch_shape + (m, n), a.dtype)
+            out = np.empty(batch_shape + (m, n), a.dtype)
+            if out.size == 0:
+                return out
+            ac = np.ascontiguousarray(a)
+            bc = np.ascontiguousarray(b)
+            # The row-major product out = a @ b is computed as the
+            # column-major product out.T = b.T @ a.T, stacked operands
+            # being at a stride of one matrix and the others reused.
+            r = numba_xxgemm_batched(kind, notrans, notrans, n, m, k,
+                                     one.ctypes,
+                                     bc.ctypes, n, k * n if b_stacked else 0,
+                                     ac.ctypes, k, m * k if a_stacked else 0,
+                                     zero.ctypes,
+                                     out.ctypes, n, m * n,
+                                     out.size // (m * n))
+            if r < 0:
+                fatal_error_func()
+            _dummy_liveness_func([ac.size, bc.size, one.size, zero.size])
+            return out
+
+    res = context.compile_internal(builder, dot_impl, sig, args)
+    return impl_ret_new_ref(context, builder, sig.return_type, res)
+
+
 @glue_lowering(np.dot, types.Array, types.Array)
 def dot_2(context, builder, sig, args):
     """
@@ -539,12 +710,27 @@ def dot_2(context, builder, sig, args):
             return dot_2_vm(context, builder, sig, args)
         elif ndims == [1, 1]:
             return dot_2_vv(context, builder, sig, args)
+        elif max(ndims) > 2:
+            # Only typed for '@'
+            return dot_2_stacked(context, builder, sig, args)
         else:
             assert 0
 
 
 lower_builtin(operator.matmul, types.Array, types.Array)(dot_2)
 
+
+@overload(np.matmul)
+def matmul_impl(a, b):
+    """
+    np.matmul(a, b), the function form of a @ b
+    """
+    if isinstance(a, types.Array) and isinstance(b, types.Array):
+        def impl(a, b):
+            return a @ b
+        return impl
+
+
 @glue_lowering(np.vdot, types.Array, types.Array)
 def vdot(context, builder, sig, args):
     """
@@ -0,0 +1,115 @@
+"""
+Counter-based random number generation with the Philox4x32-10 generator of
+Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3" (SC11).
+
+Unlike the thread-local states of np.random, which are seeded independently
+for each thread, every variate here is a pure function of a seed, a stream
+and an index within the stream.  Drawing variate ``j`` of stream ``i`` in
+iteration ``i`` of a ``prange`` loop therefore gives the same results whatever
+the number of threads and the scheduling of the iterations, and distinct
+(stream, index) pairs use distinct counters of the generator, hence
+independent variates.
+
+The functions can be called from jitted code and from the interpreter.
+"""
+
+import math
+
+import numpy as np
+
+from numba import uint64
+from numba.core.extending import register_jitable
+
+
+_MASK32 = np.uint64(0xFFFFFFFF)
+_ZERO = np.uint64(0)
+_ONE = np.uint64(1)
+_SHIFT11 = np.uint64(11)
+_SHIFT32 = np.uint64(32)
+
+# Multipliers and Weyl sequence increments of the key schedule
+_PHILOX_M0 = np.uint64(0xD2511F53)
+_PHILOX_M1 = np.uint64(0xCD9E8D57)
+_PHILOX_W0 = np.uint64(0x9E3779B9)
+_PHILOX_W1 = np.uint64(0xBB67AE85)
+_PHILOX_ROUNDS = 10
+
+
+@register_jitable
+def philox4x32(c0, c1, c2, c3, k0, k1):
+    """
+    Return the four 32-bit words of the Philox4x32-10 block for the counter
+    (c0, c1, c2, c3) and the key (k0, k1).  All the words are held in uint64
+    values.
+    """
+    c0 = uint64(c0)
+    c1 = uint64(c1)
+    c2 = uint64(c2)
+    c3 = uint64(c3)
+    k0 = uint64(k0)
+    k1 = uint64(k1)
+    for _ in range(_PHILOX_ROUNDS):
+        p0 = _PHILOX_M0 * c0
+        p1 = _PHILOX_M1 * c2
+        c0, c1, c2, c3 = ((p1 >> _SHIFT32) ^ c1 ^ k0, p1 & _MASK32,
+                          (p0 >> _SHIFT32) ^ c3 ^ k1, p0 & _MASK32)
+        k0 = (k0 + _PHILOX_W0) & _MASK32
+        k1 = (k1 + _PHILOX_W1) & _MASK32
+    return c0, c1, c2, c3
+
+
+@register_jitable
+def _philox_block(seed, stream, block):
+    # The key is the seed, the counter the block index and the stream
+    seed = uint64(seed)
+    stream = uint64(stream)
+    block = uint64(block)
+    return philox4x32(block & _MASK32, block >> _SHIFT32,
+                      stream & _MASK32, stream >> _SHIFT32,
+                      seed & _MASK32, seed >> _SHIFT32)
+
+
+@register_jitable
+def _to_unit_float64(hi, lo):
+    # 53 bits to a float64 in [0.0, 1.0)
+    x = (hi << _SHIFT32) | lo
+    return float(x >> _SHIFT11) * (1.0 / 9007199254740992.0)
+
+
+@register_jitable
+def philox_uint64(seed, stream, index):
+    """
+    Return the uint64 variate at *index* of *stream* for *seed*, all three
+    being integers in [0, 2**64).
+    """
+    index = uint64(index)
+    w0, w1, w2, w3 = _philox_block(seed, stream, index >> _ONE)
+    if (index & _ONE) == _ZERO:
+        return (w0 << _SHIFT32) | w1
+    else:
+        return (w2 << _SHIFT32) | w3
+
+
+@register_jitable
+def philox_uniform(seed, stream, index):
+    """
+    Return the float64 variate uniform in [0.0, 1.0) at *index* of *stream*
+    for *seed*.
+    """
+    x = philox_uint64(seed, stream, index)
+    return float(x >> _SHIFT11) * (1.0 / 9007199254740992.0)
+
+
+@register_jitable
+def philox_normal(seed, stream, index):
+    """
+    Return the standard normal float64 variate at *index* of *stream* for
+    *seed*, computed with the Box-Muller transform from a block of its own.
+    This block is also that of the uniform variates at 2 * index and
+    2 * index + 1, use distinct streams for variates that must be independent.
+    """
+    w0, w1, w2, w3 = _philox_block(seed, stream, index)
+    # u1 is in (0.0, 1.0] so that its log is finite
+    u1 = 1.0 - _to_unit_float64(w0, w1)
+    u2 = _to_unit_float64(w2, w3)
+    return math.sqrt(-2.0 * math.log(u1)) * math.cos(2.0 * math.pi * u2)
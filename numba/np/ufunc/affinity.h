@@ -0,0 +1,126 @@
+/*
+CPU affinity for the worker threads of the threading layers.
+
+The placement policy (see NUMBA_THREAD_AFFINITY) is resolved in Python into an
+ordered list of CPUs and the NUMA node of each, worker slot `i` is then
+pinned to the CPU at index `i % ncpus` of that list. The static schedule
+hands its blocks out to the worker slots in node order (see
+thread_affinity_block_slots()), so whatever the ordering of the CPUs the
+blocks run on a node's workers form one contiguous range of the iteration
+space and the pages they first touch stay on that node.
+
+This header is shared by all the threading layers and is intended to be
+included after _pymodule.h (which defines _GNU_SOURCE on Linux).
+*/
+
+#ifndef NUMBA_UFUNC_AFFINITY_H_
+#define NUMBA_UFUNC_AFFINITY_H_
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#elif defined(__linux__)
+#include <sched.h>
+#endif
+
+static int *affinity_cpus = NULL;
+static int *affinity_nodes = NULL;
+static int affinity_ncpus = 0;
+
+/* Set the ordered list of CPUs worker slots are pinned to and the
+ * (non-negative) NUMA node of each, a count of zero disables pinning. Must be
+ * called before the threads are launched.
+ */
+static void
+set_thread_affinity(int *cpus, int *nodes, int ncpus)
+{
+    int *copy = NULL;
+    if (ncpus > 0)
+    {
+        copy = (int *)malloc(2 * sizeof(int) * ncpus);
+        if (!copy)
+            return;  /* leave affinity unset rather than fail the launch */
+        memcpy(copy, cpus, sizeof(int) * ncpus);
+        memcpy(copy + ncpus, nodes, sizeof(int) * ncpus);
+    }
+    free(affinity_cpus);
+    affinity_cpus = copy;
+    affinity_nodes = copy ? copy + ncpus : NULL;
+    affinity_ncpus = copy ? ncpus : 0;
+}
+
+static int
+thread_affinity_enabled(void)
+{
+    return affinity_ncpus > 0;
+}
+
+/* Fill `slots` with the worker slot running each of the `count` blocks of a
+ * static schedule, block `i` is on slot `i` unless affinity is set. With
+ * affinity the slots are taken in order of the NUMA node of their CPU, e.g.
+ * with a scatter ordering over two nodes the blocks go to slots 0, 2, 4, ...
+ * then 1, 3, 5, ..., so that each node runs a contiguous range of blocks.
+ * The tbb layer can't choose the thread running a block so doesn't use this.
+ */
+static inline void
+thread_affinity_block_slots(int *slots, int count)
+{
+    int i, k = 0, node, prev = -1;
+    if (!thread_affinity_enabled())
+    {
+        for (i = 0; i < count; i++)
+            slots[i] = i;
+        return;
+    }
+    /* one pass per node in increasing order, there are few nodes */
+    while (k < count)
+    {
+        node = -1;
+        for (i = 0; i < count; i++)
+        {
+            int n = affinity_nodes[i % affinity_ncpus];
+            if (n > prev && (node < 0 || n < node))
+                node = n;
+        }
+        for (i = 0; i < count; i++)
+        {
+            if (affinity_nodes[i % affinity_ncpus] == node)
+                slots[k++] = i;
+        }
+        prev = node;
+    }
+}
+
+/* Pin the calling thread to the CPU for worker `slot`, this is a no-op if no
+ * affinity is set or the platform doesn't support it. Returns 0 on success.
+ */
+static int
+pin_current_thread(int slot)
+{
+    int cpu;
+    if (affinity_ncpus <= 0 || slot < 0)
+        return -1;
+    cpu = affinity_cpus[slot % affinity_ncpus];
+#if defined(_MSC_VER)
+    if (cpu < 0 || cpu >= (int)(sizeof(DWORD_PTR) * 8))
+        return -1;
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) ? 0 : -1;
+#elif defined(__linux__)
+    {
+        cpu_set_t set;
+        if (cpu < 0 || cpu >= CPU_SETSIZE)
+            return -1;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        /* pid 0 is the calling thread */
+        return sched_setaffinity(0, sizeof(set), &set);
+    }
+#else
+    (void)cpu;
+    return -1;
+#endif
+}
+
+#endif /* NUMBA_UFUNC_AFFINITY_H_ */
@@ -22,6 +22,20 @@
 // Default 0 value means one evenly-sized chunk of work per worker thread.
 static THREAD_LOCAL(uintp) parallel_chunksize = 0;
 
+// How the threading layer hands out the chunks to the worker threads, one of
+// the SCHEDULE_* kinds.
+static THREAD_LOCAL(uintp) parallel_schedule = SCHEDULE_STATIC;
+
+// When greater than 1, split points in the innermost (contiguous) dimension
+// are rounded to a multiple of this many iterations so that adjacent threads
+// don't write into the same cache line of the output.
+static THREAD_LOCAL(uintp) parallel_split_alignment = 0;
+
+// The chunksize the next parallel region launched by this thread was divided
+// with, recorded by get_sched_size as parfors reset parallel_chunksize before
+// launching the region.
+static THREAD_LOCAL(uintp) region_chunksize = 0;
+
 // round not available on VS2010.
 double guround (double number) {
 	return number < 0.0 ? ceil(number - 0.5) : floor(number + 0.5);
@@ -110,13 +124,49 @@ extern "C" uintp get_parallel_chunksize() {
     return parallel_chunksize;
 }
 
+extern "C" uintp set_parallel_schedule(uintp kind) {
+    uintp orig = parallel_schedule;
+    parallel_schedule = kind;
+    return orig;
+}
+
+extern "C" uintp get_parallel_schedule() {
+    return parallel_schedule;
+}
+
+extern "C" uintp set_parallel_split_alignment(uintp n) {
+    uintp orig = parallel_split_alignment;
+    parallel_split_alignment = n;
+    return orig;
+}
+
+extern "C" uintp get_parallel_split_alignment() {
+    return parallel_split_alignment;
+}
+
+extern "C" uintp take_region_chunksize() {
+    uintp ret = region_chunksize;
+    region_chunksize = 0;
+    return ret;
+}
+
 extern "C" uintp get_sched_size(uintp num_threads, uintp num_dim, intp *starts, intp *ends) {
-    if (parallel_chunksize == 0) {
+    region_chunksize = parallel_chunksize;
+    if (parallel_chunksize == 0 && parallel_schedule == SCHEDULE_STATIC) {
         return num_threads;
     }
     RangeActual ra(num_dim, starts, ends);
     uintp total_work_size = ra.total_size();
-    uintp num_divisions = total_work_size / parallel_chunksize;
+    uintp num_divisions;
+    if (parallel_chunksize == 0) {
+        // Dynamic kinds need more chunks than threads to balance the load.
+        num_divisions = num_threads * SCHEDULE_CHUNKS_PER_THREAD;
+        if (num_divisions > total_work_size) {
+            num_divisions = total_work_size;
+        }
+    } else {
+        num_divisions = total_work_size / parallel_chunksize;
+    }
     return num_divisions < num_threads ? num_threads : num_divisions;
 }
 
@@ -194,6 +244,39 @@ chunk_info equalizing_chunk(intp rs, intp re, intp divisions, float thread_perce
     }
 }
 
+/*
+ * Round the split point next (the start of the following partition) of a
+ * space running from rs to re to the nearest multiple of align. The split
+ * point is left alone if rounding would leave this partition empty or leave
+ * fewer than "remaining" iterations for the partitions that follow.
+ */
+intp align_split(intp next, intp rs, intp re, uintp align, intp remaining) {
+    re -= remaining - 1;
+    if (align <= 1 || next <= rs || next > re) {
+        return next;
+    }
+    intp a = (intp)align;
+    intp rem = next % a;
+    if (rem < 0) rem += a;
+    intp aligned = (rem * 2 < a) ? next - rem : next - rem + a;
+    if (aligned <= rs || aligned > re) {
+        return next;
+    }
+    return aligned;
+}
+
+/*
+ * As equalizing_chunk but with the split point aligned, see align_split.
+ */
+chunk_info aligned_chunk(intp rs, intp re, intp divisions, float thread_percent, uintp align) {
+    chunk_info ret = equalizing_chunk(rs, re, divisions, thread_percent);
+    if (divisions > 1) {
+        intp next = align_split(ret.m_c, rs, re, align, divisions - 1);
+        ret = chunk_info(rs, next - 1, next);
+    }
+    return ret;
+}
+
 RangeActual isfRangeToActual(const std::vector<isf_range> &build) {
     std::vector<isf_range> bunsort(build);
     std::sort(bunsort.begin(), bunsort.end(), isf_range_by_dim());
@@ -270,7 +353,9 @@ void divide_work(const RangeActual &full_iteration_space,
             chunk_info chunk_thread = chunk(threadstart, threadend, divisions_for_this_dim - i);
             // Number of threads used for this division.
             uintp threads_used_here = (1 + (chunk_thread.m_b - chunk_thread.m_a));
-            chunk_info chunk_index = equalizing_chunk(chunkstart, chunkend, divisions_for_this_dim - i, threads_used_here / (float)num_threads);
+            // Only the innermost dimension is contiguous so only its splits are aligned.
+            uintp align = dims[index].dim == full_iteration_space.ndim() - 1 ? parallel_split_alignment : 0;
+            chunk_info chunk_index = aligned_chunk(chunkstart, chunkend, divisions_for_this_dim - i, threads_used_here / (float)num_threads, align);
             // Remember that the next division has threads_used_here fewer threads to allocate.
             num_threads -= threads_used_here;
             // m_c contains the next start value so update the iteration space and thread space in preparation for next iteration of this loop.
@@ -350,7 +435,9 @@ std::vector<RangeActual> create_schedule(const RangeActual &full_space, uintp nu
                 // than the start iteration number of the next thread.  If it is the last
                 // thread then assign all remaining iterations to it.
                 if(i < num_sched-1) {
-                    end = full_space.start[0] + (cur + ilen) - 1;
+                    intp next = align_split(full_space.start[0] + cur + ilen, start, full_space.end[0], parallel_split_alignment, num_sched - i - 1);
+                    end = next - 1;
+                    ilen = next - start;
                 } else {
                     end = full_space.end[0];
                 }
@@ -388,6 +475,114 @@ void print_schedule(const std::vector<RangeActual> &vra) {
     }
 }
 
+/*
+ * A small per-thread cache of flattened schedules. Parallel regions are often
+ * launched repeatedly over the same iteration space so the schedule computed
+ * for a given (num_dim, starts, ends, num_threads) is remembered and copied
+ * out on the next request rather than being recomputed. The chunksize doesn't
+ * need to be part of the key as it only affects num_threads, which is the
+ * number of divisions by the time the schedule is computed, the split
+ * alignment does affect the schedule so is part of the key. The cache is
+ * direct mapped, a colliding entry is simply replaced.
+ */
+class schedule_cache {
+public:
+    static const uintp num_entries = 16;
+    // Don't cache schedules holding more than this many values.
+    static const uintp max_sched_size = 4096;
+
+    class entry {
+    public:
+        bool valid;
+        uintp num_dim, num_threads, align;
+        std::vector<intp> bounds;  // starts followed by ends
+        std::vector<intp> sched;
+        entry() : valid(false), num_dim(0), num_threads(0), align(0) {}
+    };
+
+    entry entries[num_entries];
+    // The number of requests served from and missing the cache.
+    uintp hits = 0, misses = 0;
+
+    static uintp hash(uintp num_dim, intp *starts, intp *ends, uintp num_threads) {
+        uintp h = num_dim * 31 + num_threads;
+        for (uintp i = 0; i < num_dim; ++i) {
+            h = h * 1000003 ^ (uintp)starts[i];
+            h = h * 1000003 ^ (uintp)ends[i];
+        }
+        return h ^ (h >> 17);
+    }
+
+    entry &slot(uintp num_dim, intp *starts, intp *ends, uintp num_threads) {
+        return entries[hash(num_dim, starts, ends, num_threads) % num_entries];
+    }
+
+    static bool matches(const entry &e, uintp num_dim, intp *starts, intp *ends, uintp num_threads, uintp align) {
+        if (!e.valid || e.num_dim != num_dim || e.num_threads != num_threads || e.align != align) {
+            return false;
+        }
+        for (uintp i = 0; i < num_dim; ++i) {
+            if (e.bounds[i] != starts[i] || e.bounds[num_dim + i] != ends[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// Not THREAD_LOCAL(): the __thread and __declspec(thread) it expands to can't
+// hold a type with constructors and destructors such as the cache's vectors,
+// C++11 thread_local also frees the cache when its thread exits.
+static thread_local schedule_cache sched_cache;
+
+/*
+ * Computes the flattened schedule into out_sched, going via the cache unless
+ * debug is set, in which case the schedule is always computed and printed.
+ */
+template<class T>
+void cached_schedule(uintp num_dim, intp *starts, intp *ends, uintp num_threads, T *out_sched, intp debug) {
+    uintp sched_size = num_threads * num_dim * 2;
+    if (debug || sched_size > schedule_cache::max_sched_size) {
+        RangeActual full_space(num_dim, starts, ends);
+        std::vector<RangeActual> ret = create_schedule(full_space, num_threads);
+        if (debug) {
+            print_schedule(ret);
+        }
+        flatten_schedule(ret, out_sched);
+        return;
+    }
+
+    schedule_cache::entry &e = sched_cache.slot(num_dim, starts, ends, num_threads);
+    if (schedule_cache::matches(e, num_dim, starts, ends, num_threads, parallel_split_alignment)) {
+        sched_cache.hits++;
+    } else {
+        sched_cache.misses++;
+        RangeActual full_space(num_dim, starts, ends);
+        std::vector<RangeActual> ret = create_schedule(full_space, num_threads);
+        e.valid = false;
+        e.sched.resize(sched_size);
+        flatten_schedule(ret, e.sched.data());
+        e.bounds.assign(starts, starts + num_dim);
+        e.bounds.insert(e.bounds.end(), ends, ends + num_dim);
+        e.num_dim = num_dim;
+        e.num_threads = num_threads;
+        e.align = parallel_split_alignment;
+        e.valid = true;
+    }
+    for (uintp i = 0; i < sched_size; ++i) {
+        out_sched[i] = (T)e.sched[i];
+    }
+}
+
+/*
+ * Reports the number of schedule requests of the calling thread served from
+ * the cache and computed afresh, for testing.
+ */
+extern "C" void get_schedule_cache_stats(uintp *hits, uintp *misses) {
+    *hits = sched_cache.hits;
+    *misses = sched_cache.misses;
+}
+
 /*
     num_dim (D) is the number of dimensions of the iteration space.
     starts is the range-start of each of those dimensions, inclusive.
@@ -410,12 +605,7 @@ extern "C" void do_scheduling_signed(uintp num_dim, intp *starts, intp *ends, ui
 
     if (num_threads == 0) return;
 
-    RangeActual full_space(num_dim, starts, ends);
-    std::vector<RangeActual> ret = create_schedule(full_space, num_threads);
-    if (debug) {
-        print_schedule(ret);
-    }
-    flatten_schedule(ret, sched);
+    cached_schedule(num_dim, starts, ends, num_threads, sched, debug);
 }
 
 extern "C" void do_scheduling_unsigned(uintp num_dim, intp *starts, intp *ends, uintp num_threads, uintp *sched, intp debug) {
@@ -432,10 +622,5 @@ extern "C" void do_scheduling_unsigned(uintp num_dim, intp *starts, intp *ends,
 
     if (num_threads == 0) return;
 
-    RangeActual full_space(num_dim, starts, ends);
-    std::vector<RangeActual> ret = create_schedule(full_space, num_threads);
-    if (debug) {
-        print_schedule(ret);
-    }
-    flatten_schedule(ret, sched);
+    cached_schedule(num_dim, starts, ends, num_threads, sched, debug);
 }
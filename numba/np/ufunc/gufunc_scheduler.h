@@ -33,6 +33,19 @@
     #define uintp unsigned
 #endif
 
+/* Scheduling kinds, the values must match those in numba.np.ufunc.parallel.
+   SCHEDULE_STATIC gives each thread one contiguous block of the chunks, the
+   other kinds have threads claim chunks from a shared cursor at run time,
+   either a fixed number at a time (SCHEDULE_DYNAMIC) or a decreasing number
+   proportional to the remaining work (SCHEDULE_GUIDED). */
+#define SCHEDULE_STATIC 0
+#define SCHEDULE_DYNAMIC 1
+#define SCHEDULE_GUIDED 2
+
+/* The number of chunks per thread the iteration space is divided into for the
+   non-static scheduling kinds when no chunksize is set. */
+#define SCHEDULE_CHUNKS_PER_THREAD 4
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -43,6 +56,16 @@ void do_scheduling_unsigned(uintp num_dim, intp *starts, intp *ends, uintp num_t
 uintp set_parallel_chunksize(uintp);
 uintp get_parallel_chunksize(void);
 uintp get_sched_size(uintp num_threads, uintp num_dim, intp *starts, intp *ends);
+uintp set_parallel_schedule(uintp);
+uintp get_parallel_schedule(void);
+uintp set_parallel_split_alignment(uintp);
+uintp get_parallel_split_alignment(void);
+/* Returns and clears the chunksize recorded by the last get_sched_size call
+   on this thread, used by threading layers that schedule chunks themselves. */
+uintp take_region_chunksize(void);
+/* Gets the number of schedules of the calling thread served from the cache
+   and computed afresh. */
+void get_schedule_cache_stats(uintp *hits, uintp *misses);
 
 #ifdef __cplusplus
 }
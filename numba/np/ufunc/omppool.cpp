@@ -14,6 +14,8 @@ Threading layer on top of OpenMP.
 #include <stdio.h>
 #include "workqueue.h"
 #include "gufunc_scheduler.h"
+#include "affinity.h"
+#include "profiling.h"
 
 #ifdef _MSC_VER
 #include <malloc.h>
@@ -135,6 +137,8 @@ parallel_for(void *fn, char **args, size_t *dimensions, size_t *steps, void *dat
     // but present to force thinking about the scope of validity
     int agreed_nthreads = num_threads;
 
+    prof_u64 *profile = profile_region_begin(num_threads);
+
     if(_DEBUG)
     {
         printf("inner_ndim: %zu\n",inner_ndim);
@@ -152,10 +156,30 @@ parallel_for(void *fn, char **args, size_t *dimensions, size_t *steps, void *dat
         printf("\n");
     }
 
+    // parallel_chunksize has been reset by the time the region is launched,
+    // the chunksize it was divided with is recorded by get_sched_size.
+    uintp kind = get_parallel_schedule();
+    uintp chunksize = take_region_chunksize();
+    if (kind == SCHEDULE_STATIC && chunksize != 0)
+    {
+        // The region is divided into chunks of chunksize iterations which,
+        // as with the other backends, are handed out as threads finish.
+        kind = SCHEDULE_DYNAMIC;
+    }
+    // The number of iterations a thread claims at a time for the dynamic
+    // kinds, the minimum claim for SCHEDULE_GUIDED.
+    int claim = 1;
+    if (kind == SCHEDULE_DYNAMIC && chunksize == 0)
+    {
+        claim = (int)(size / ((ptrdiff_t)num_threads * SCHEDULE_CHUNKS_PER_THREAD));
+        if (claim < 1)
+            claim = 1;
+    }
+
     // Set the thread mask on the pragma such that the state is scope limited
     // and passed via a register on the OMP region call site, this limiting
     // global state and racing
-    #pragma omp parallel num_threads(num_threads), shared(agreed_nthreads)
+    #pragma omp parallel num_threads(num_threads), shared(agreed_nthreads, profile, kind, claim)
     {
         size_t * count_space = (size_t *)alloca(sizeof(size_t) * arg_len);
         char ** array_arg_space = (char**)alloca(sizeof(char*) * array_count);
@@ -163,8 +187,7 @@ parallel_for(void *fn, char **args, size_t *dimensions, size_t *steps, void *dat
         // tell the active thread team about the number of threads
         set_num_threads(agreed_nthreads);
 
-        #pragma omp for
-        for(ptrdiff_t r = 0; r < size; r++)
+        auto run = [&](ptrdiff_t r)
         {
             memcpy(count_space, dimensions, arg_len * sizeof(size_t));
             count_space[0] = 1;
@@ -201,9 +224,82 @@ parallel_for(void *fn, char **args, size_t *dimensions, size_t *steps, void *dat
                     printf("%p, ", (void *)array_arg_space[j]);
                 printf("\n");
             }
-            func(array_arg_space, count_space, steps, data);
+            if (profile)
+            {
+                prof_u64 begin = profile_now();
+                func(array_arg_space, count_space, steps, data);
+                profile_chunk(profile, omp_get_thread_num(), begin, profile_now());
+            }
+            else
+            {
+                func(array_arg_space, count_space, steps, data);
+            }
+        };
+
+        // The schedule clause kind must be known at compile time so there is
+        // a loop per kind.
+        if (kind == SCHEDULE_DYNAMIC)
+        {
+            #pragma omp for schedule(dynamic, claim)
+            for(ptrdiff_t r = 0; r < size; r++)
+                run(r);
+        }
+        else if (kind == SCHEDULE_GUIDED)
+        {
+            #pragma omp for schedule(guided, claim)
+            for(ptrdiff_t r = 0; r < size; r++)
+                run(r);
+        }
+        else if (thread_affinity_enabled())
+        {
+            // The blocks of the static schedule, handed out to the pinned
+            // threads in NUMA node order.
+            int nthreads = omp_get_num_threads();
+            int tid = omp_get_thread_num();
+            int *slots = (int *)alloca(sizeof(int) * nthreads);
+            thread_affinity_block_slots(slots, nthreads);
+            int block = 0;
+            while (slots[block] != tid)
+                block++;
+            ptrdiff_t base = size / nthreads, rem = size % nthreads;
+            ptrdiff_t lo = block * base + (block < rem ? block : rem);
+            ptrdiff_t hi = lo + base + (block < rem ? 1 : 0);
+            for(ptrdiff_t r = lo; r < hi; r++)
+                run(r);
+        }
+        else
+        {
+            #pragma omp for
+            for(ptrdiff_t r = 0; r < size; r++)
+                run(r);
         }
     }
+    if (profile)
+        profile_region_end(profile);
+}
+
+// OpenMP offers no way for a parallel region to carry on once the
+// encountering thread has left it, so the async launch runs the region to
+// completion and returns the NULL handle of a completed region.
+static void *
+parallel_for_async(void *fn, char **args, size_t *dimensions, size_t *steps,
+                   void *data, size_t inner_ndim, size_t array_count,
+                   int num_threads)
+{
+    parallel_for(fn, args, dimensions, steps, data, inner_ndim, array_count,
+                 num_threads);
+    return NULL;
+}
+
+static int
+parallel_for_poll(void *handle)
+{
+    return 1;
+}
+
+static void
+parallel_for_wait(void *handle)
+{
 }
 
 static void launch_threads(int count)
@@ -226,6 +322,18 @@ static void launch_threads(int count)
     omp_set_num_threads(count);
     omp_set_nested(0x1); // enable nesting, control depth with OMP env var
     _INIT_NUM_THREADS = count;
+    if (thread_affinity_enabled())
+    {
+        // Pin the team's worker threads, these are reused by the runtime for
+        // subsequent regions. The master thread is the calling Python thread,
+        // it's left alone as threads it creates would inherit its mask.
+        #pragma omp parallel num_threads(count)
+        {
+            int tid = omp_get_thread_num();
+            if (tid > 0)
+                pin_current_thread(tid);
+        }
+    }
 }
 
 static void synchronize(void)
@@ -248,14 +356,27 @@ MOD_INIT(omppool)
     SetAttrStringFromVoidPointer(m, ready);
     SetAttrStringFromVoidPointer(m, add_task);
     SetAttrStringFromVoidPointer(m, parallel_for);
+    SetAttrStringFromVoidPointer(m, parallel_for_async);
+    SetAttrStringFromVoidPointer(m, parallel_for_poll);
+    SetAttrStringFromVoidPointer(m, parallel_for_wait);
     SetAttrStringFromVoidPointer(m, do_scheduling_signed);
     SetAttrStringFromVoidPointer(m, do_scheduling_unsigned);
+    SetAttrStringFromVoidPointer(m, get_schedule_cache_stats);
     SetAttrStringFromVoidPointer(m, set_num_threads);
     SetAttrStringFromVoidPointer(m, get_num_threads);
     SetAttrStringFromVoidPointer(m, get_thread_id);
     SetAttrStringFromVoidPointer(m, set_parallel_chunksize);
     SetAttrStringFromVoidPointer(m, get_parallel_chunksize);
     SetAttrStringFromVoidPointer(m, get_sched_size);
+    SetAttrStringFromVoidPointer(m, set_parallel_schedule);
+    SetAttrStringFromVoidPointer(m, get_parallel_schedule);
+    SetAttrStringFromVoidPointer(m, set_parallel_split_alignment);
+    SetAttrStringFromVoidPointer(m, get_parallel_split_alignment);
+    SetAttrStringFromVoidPointer(m, set_thread_affinity);
+    SetAttrStringFromVoidPointer(m, set_region_profiling);
+    SetAttrStringFromVoidPointer(m, reset_region_profile);
+    SetAttrStringFromVoidPointer(m, get_region_profile_count);
+    SetAttrStringFromVoidPointer(m, get_region_profile);
 
     PyObject *tmp = PyString_FromString(_OMP_VENDOR);
     PyObject_SetAttrString(m, "openmp_vendor", tmp);
@@ -14,7 +14,8 @@ import os
 import sys
 import warnings
 from threading import RLock as threadRLock
-from ctypes import CFUNCTYPE, c_int, CDLL, POINTER, c_uint
+from ctypes import (CFUNCTYPE, c_int, CDLL, POINTER, c_uint, c_size_t,
+                    c_ulonglong, c_void_p, byref)
 
 import numpy as np
 
@@ -325,6 +326,108 @@ def _set_init_process_lock():
         _backend_init_process_lock = _nop()
 
 
+def _parse_cpulist(text):
+    """
+    Parses a Linux style CPU list, e.g. "0-3,8,10-11", into a list of ints
+    in the order given.
+    """
+    cpus = []
+    for part in text.split(','):
+        part = part.strip()
+        if not part:
+            continue
+        if '-' in part:
+            lo, hi = part.split('-', 1)
+            lo, hi = int(lo), int(hi)
+            if hi < lo:
+                raise ValueError("Invalid CPU range '%s'" % part)
+            cpus.extend(range(lo, hi + 1))
+        else:
+            cpus.append(int(part))
+    if any(cpu < 0 for cpu in cpus):
+        raise ValueError("CPU numbers must be non-negative")
+    return cpus
+
+
+def _numa_nodes():
+    """
+    Returns the CPUs of each NUMA node as a list of lists, falls back to a
+    single node of all CPUs where the topology isn't available.
+    """
+    nodes = []
+    base = '/sys/devices/system/node'
+    if _IS_LINUX and os.path.isdir(base):
+        names = [x for x in os.listdir(base)
+                 if x.startswith('node') and x[4:].isdigit()]
+        for name in sorted(names, key=lambda x: int(x[4:])):
+            try:
+                with open(os.path.join(base, name, 'cpulist')) as f:
+                    cpus = _parse_cpulist(f.read())
+            except (OSError, ValueError):
+                continue
+            if cpus:
+                nodes.append(cpus)
+    if not nodes:
+        nodes = [list(range(os.cpu_count() or 1))]
+    return nodes
+
+
+def _thread_affinity_cpus(spec):
+    """
+    Resolves a NUMBA_THREAD_AFFINITY spec into the ordered list of CPUs the
+    threading layer worker slots are pinned to, an empty list means no
+    pinning. The spec is one of:
+
+    * "" or "none" - no pinning.
+    * "compact" - fill the CPUs of each NUMA node in turn.
+    * "scatter" - round robin the NUMA nodes.
+    * an explicit CPU list, e.g. "0-3,8-11".
+
+    Only CPUs the process is allowed to run on are used.
+    """
+    spec = spec.strip().lower()
+    if spec in ('', 'none'):
+        return []
+    if hasattr(os, 'sched_getaffinity'):
+        allowed = os.sched_getaffinity(0)
+    else:
+        allowed = set(range(os.cpu_count() or 1))
+    if spec in ('compact', 'scatter'):
+        nodes = [[c for c in node if c in allowed] for node in _numa_nodes()]
+        nodes = [node for node in nodes if node]
+        if spec == 'compact':
+            cpus = [c for node in nodes for c in node]
+        else:
+            cpus = []
+            for i in range(max(len(node) for node in nodes) if nodes else 0):
+                cpus.extend(node[i] for node in nodes if i < len(node))
+    else:
+        try:
+            cpus = _parse_cpulist(spec)
+        except ValueError:
+            msg = ("NUMBA_THREAD_AFFINITY must be 'compact', 'scatter' or a "
+                   "CPU list such as '0-3,8', got '%s'")
+            raise ValueError(msg % spec)
+        cpus = [c for c in cpus if c in allowed]
+    if not cpus:
+        warnings.warn("NUMBA_THREAD_AFFINITY '%s' selects no usable CPUs, "
+                      "thread affinity is not set." % spec,
+                      errors.NumbaWarning)
+    return cpus
+
+
+def _thread_affinity_nodes(cpus):
+    """
+    Returns the index of the NUMA node of each of *cpus*, CPUs that aren't
+    on any node are taken to be on the first.
+    """
+    node_of = {}
+    for i, node in enumerate(_numa_nodes()):
+        for cpu in node:
+            node_of.setdefault(cpu, i)
+    return [node_of.get(cpu, 0) for cpu in cpus]
+
+
 _is_initialized = False
 
 # this is set by _launch_threads
@@ -512,9 +615,26 @@ def _launch_threads():
                 raise_with_hint(requirements)
 
             ll.add_symbol('numba_parallel_for', lib.parallel_for)
+            ll.add_symbol('numba_parallel_for_async', lib.parallel_for_async)
+            ll.add_symbol('numba_parallel_for_poll', lib.parallel_for_poll)
+            ll.add_symbol('numba_parallel_for_wait', lib.parallel_for_wait)
             ll.add_symbol('do_scheduling_signed', lib.do_scheduling_signed)
             ll.add_symbol('do_scheduling_unsigned', lib.do_scheduling_unsigned)
 
+            if libname == 'workqueue':
+                set_wait_spin = CFUNCTYPE(None, c_int)(lib.set_wait_spin)
+                set_wait_spin(config.WORKQUEUE_SPIN)
+
+            affinity = _thread_affinity_cpus(config.THREAD_AFFINITY)
+            if affinity:
+                n = len(affinity)
+                cpus = (c_int * n)(*affinity)
+                nodes = (c_int * n)(*_thread_affinity_nodes(affinity))
+                set_thread_affinity = CFUNCTYPE(None, POINTER(c_int),
+                                                POINTER(c_int), c_int)(
+                    lib.set_thread_affinity)
+                set_thread_affinity(cpus, nodes, n)
+
             launch_threads = CFUNCTYPE(None, c_int)(lib.launch_threads)
             launch_threads(NUM_THREADS)
 
@@ -557,6 +677,56 @@ def _load_threading_functions(lib):
                                 POINTER(c_int),
                                 POINTER(c_int))(lib.get_sched_size)
 
+    ll.add_symbol('set_parallel_schedule', lib.set_parallel_schedule)
+    ll.add_symbol('get_parallel_schedule', lib.get_parallel_schedule)
+    global _set_parallel_schedule
+    _set_parallel_schedule = CFUNCTYPE(c_uint,
+                                       c_uint)(lib.set_parallel_schedule)
+    global _get_parallel_schedule
+    _get_parallel_schedule = CFUNCTYPE(c_uint)(lib.get_parallel_schedule)
+
+    ll.add_symbol('set_parallel_split_alignment',
+                  lib.set_parallel_split_alignment)
+    ll.add_symbol('get_parallel_split_alignment',
+                  lib.get_parallel_split_alignment)
+    global _set_parallel_split_alignment
+    _set_parallel_split_alignment = CFUNCTYPE(c_uint, c_uint)(
+        lib.set_parallel_split_alignment)
+    global _get_parallel_split_alignment
+    _get_parallel_split_alignment = CFUNCTYPE(c_uint)(
+        lib.get_parallel_split_alignment)
+
+    global _set_region_profiling
+    _set_region_profiling = CFUNCTYPE(c_int, c_int,
+                                      c_int)(lib.set_region_profiling)
+    global _reset_region_profile
+    _reset_region_profile = CFUNCTYPE(None)(lib.reset_region_profile)
+    global _get_region_profile_count
+    _get_region_profile_count = CFUNCTYPE(c_size_t)(
+        lib.get_region_profile_count)
+    global _get_region_profile
+    _get_region_profile = CFUNCTYPE(c_int,
+                                    c_size_t,
+                                    POINTER(c_ulonglong),
+                                    POINTER(c_ulonglong),
+                                    POINTER(c_ulonglong))(
+        lib.get_region_profile)
+
+    global _get_schedule_cache_stats
+    _get_schedule_cache_stats = CFUNCTYPE(None, POINTER(c_size_t),
+                                          POINTER(c_size_t))(
+        lib.get_schedule_cache_stats)
+
+    global _parallel_for_async
+    _parallel_for_async = CFUNCTYPE(c_void_p, c_void_p, POINTER(c_void_p),
+                                    POINTER(c_size_t), POINTER(c_size_t),
+                                    c_void_p, c_size_t, c_size_t, c_int)(
+        lib.parallel_for_async)
+    global _parallel_for_poll
+    _parallel_for_poll = CFUNCTYPE(c_int, c_void_p)(lib.parallel_for_poll)
+    global _parallel_for_wait
+    _parallel_for_wait = CFUNCTYPE(None, c_void_p)(lib.parallel_for_wait)
+
 
 # Some helpers to make set_num_threads jittable
 
@@ -756,3 +926,287 @@ def ol_get_parallel_chunksize():
     def impl():
         return _get_parallel_chunksize()
     return impl
+
+
+# The scheduling kinds, the position of each name is its value in
+# gufunc_scheduler.h
+_PARALLEL_SCHEDULES = ('static', 'dynamic', 'guided')
+
+
+def _schedule_kind(kind):
+    if not isinstance(kind, str):
+        raise TypeError("The parallel schedule must be a string")
+    if kind not in _PARALLEL_SCHEDULES:
+        msg = "The parallel schedule must be one of %s, got '%s'"
+        raise ValueError(msg % (_PARALLEL_SCHEDULES, kind))
+    return _PARALLEL_SCHEDULES.index(kind)
+
+
+def set_parallel_schedule(kind):
+    """
+    Set how the iterations of parallel regions invoked by this thread are
+    handed out to the threads executing them.
+
+    * ``'static'`` (the default) - each thread gets one contiguous block of the
+      chunks the iteration space is divided into.
+    * ``'dynamic'`` - threads claim the next available chunk when they finish
+      their current one.
+    * ``'guided'`` - as ``'dynamic'`` but threads claim a number of chunks
+      proportional to the remaining work, so claims get smaller towards the end
+      of the region.
+
+    For the non-static kinds the iteration space is divided into several
+    chunks per thread, or into chunks of the size given to
+    :func:`set_parallel_chunksize` if one is set.
+
+    This function can be used inside of a jitted function, in which case the
+    kind must be a compile time constant. Returns the previous kind.
+    """
+    _launch_threads()
+    code = _schedule_kind(kind)
+    return _PARALLEL_SCHEDULES[_set_parallel_schedule(code)]
+
+
+def get_parallel_schedule():
+    """
+    Get the scheduling kind used for parallel regions invoked by this thread,
+    see :func:`set_parallel_schedule`.
+    """
+    _launch_threads()
+    return _PARALLEL_SCHEDULES[_get_parallel_schedule()]
+
+
+@overload(set_parallel_schedule, prefer_literal=True)
+def ol_set_parallel_schedule(kind):
+    _launch_threads()
+    if not isinstance(kind, types.StringLiteral):
+        msg = "The parallel schedule must be a constant string"
+        raise errors.TypingError(msg)
+    try:
+        code = _schedule_kind(kind.literal_value)
+    except ValueError as e:
+        raise errors.TypingError(str(e))
+    schedules = _PARALLEL_SCHEDULES
+
+    def impl(kind):
+        return schedules[_set_parallel_schedule(code)]
+    return impl
+
+
+@overload(get_parallel_schedule)
+def ol_get_parallel_schedule():
+    _launch_threads()
+    schedules = _PARALLEL_SCHEDULES
+
+    def impl():
+        return schedules[_get_parallel_schedule()]
+    return impl
+
+
+def set_parallel_split_alignment(n):
+    """
+    Set the number of iterations that the split points in the innermost
+    dimension of the iteration space of parallel regions invoked by this
+    thread are rounded to a multiple of. With a value of ``n`` such that ``n``
+    elements of the array being written fill a cache line, e.g. 8 for
+    ``float64`` with 64 byte cache lines, adjacent threads no longer write to
+    the same cache line of the output, avoiding false sharing. A split point
+    is only moved when the rounding leaves every chunk some work. A value of
+    0 (the default) or 1 disables the rounding.
+
+    This function can be used inside of a jitted function. Returns the
+    previous value.
+    """
+    _launch_threads()
+    if not isinstance(n, (int, np.integer)):
+        raise TypeError("The parallel split alignment must be an integer")
+    if n < 0:
+        raise ValueError("split alignment must be greater than or equal to "
+                         "zero")
+    return _set_parallel_split_alignment(n)
+
+
+def get_parallel_split_alignment():
+    """
+    Get the split alignment used for parallel regions invoked by this thread,
+    see :func:`set_parallel_split_alignment`.
+    """
+    _launch_threads()
+    return _get_parallel_split_alignment()
+
+
+@overload(set_parallel_split_alignment)
+def ol_set_parallel_split_alignment(n):
+    _launch_threads()
+    if not isinstance(n, types.Integer):
+        msg = "The parallel split alignment must be an integer"
+        raise errors.TypingError(msg)
+
+    def impl(n):
+        if n < 0:
+            raise ValueError("split alignment must be greater than or equal "
+                             "to zero")
+        return _set_parallel_split_alignment(n)
+    return impl
+
+
+@overload(get_parallel_split_alignment)
+def ol_get_parallel_split_alignment():
+    _launch_threads()
+
+    def impl():
+        return _get_parallel_split_alignment()
+    return impl
+
+
+def _schedule_cache_stats():
+    """
+    Return the number of schedules the calling thread got from the schedule
+    cache and the number it computed, as a tuple (hits, misses), for testing.
+    """
+    _launch_threads()
+    hits, misses = c_size_t(), c_size_t()
+    _get_schedule_cache_stats(byref(hits), byref(misses))
+    return hits.value, misses.value
+
+
+# The number of header values in a region profile record, see profiling.h
+_PROFILE_HEADER_SIZE = 4
+
+
+def enable_parallel_profiling(enable=True):
+    """
+    Enable or disable the recording of a profile for each parallel region
+    executed by the threading layer. Profiling is disabled by default, when it
+    is enabled each region records its wall time, the time taken before the
+    first chunk of work started and, per thread, the time spent executing
+    chunks and the number of chunks executed. The most recent 1024 regions
+    are kept, see :func:`get_parallel_profile`.
+    """
+    _launch_threads()
+    if _set_region_profiling(1 if enable else 0, NUM_THREADS) != 0:
+        raise MemoryError("Unable to allocate the parallel profile buffer")
+
+
+def reset_parallel_profile():
+    """
+    Discard the parallel region profiles recorded so far.
+    """
+    _launch_threads()
+    _reset_region_profile()
+
+
+def get_parallel_profile():
+    """
+    Return the recorded parallel region profiles, oldest first. Each profile
+    is a dict with the keys:
+
+    * ``num_threads`` - the number of threads the region was run with.
+    * ``wall_ns`` - the wall time of the region.
+    * ``launch_ns`` - the time from the region starting to the first chunk of
+      work starting, this is the scheduling and wake-up overhead.
+    * ``busy_ns`` - a list of the time each thread spent executing chunks,
+      indexed by thread id (see :func:`get_thread_id`).
+    * ``wait_ns`` - a list of the time each of the region's threads was not
+      executing chunks, this is the load imbalance.
+    * ``chunks`` - a list of the number of chunks each thread executed.
+
+    All times are in nanoseconds.
+    """
+    _launch_threads()
+    header = (c_ulonglong * _PROFILE_HEADER_SIZE)()
+    busy = (c_ulonglong * NUM_THREADS)()
+    chunks = (c_ulonglong * NUM_THREADS)()
+    profiles = []
+    for idx in range(_get_region_profile_count()):
+        nworkers = _get_region_profile(idx, header, busy, chunks)
+        if nworkers < 0:
+            break
+        num_threads, start, first_chunk, end = header
+        wall = end - start if end >= start else 0
+        launch = first_chunk - start if start <= first_chunk <= end else 0
+        thread_busy = list(busy[:nworkers])
+        nthreads = min(num_threads, nworkers)
+        profiles.append({
+            'num_threads': num_threads,
+            'wall_ns': wall,
+            'launch_ns': launch,
+            'busy_ns': thread_busy,
+            'wait_ns': [max(wall - b, 0) for b in thread_busy[:nthreads]],
+            'chunks': list(chunks[:nworkers]),
+        })
+    return profiles
+
+
+class ParallelForHandle(object):
+    """
+    The handle of a parallel region started by :func:`parallel_for_async`.
+    The region's arrays are kept alive until it is waited on, which happens
+    at the latest when the handle is garbage collected.
+    """
+
+    def __init__(self, handle, keepalive):
+        self._handle = handle
+        self._keepalive = keepalive
+
+    def poll(self):
+        """
+        Return True if the region has completed, :meth:`wait` must still be
+        called to release it.
+        """
+        if self._keepalive is None:
+            return True
+        return bool(_parallel_for_poll(self._handle))
+
+    def wait(self):
+        """
+        Wait for the region to complete and release it, waiting again does
+        nothing.
+        """
+        if self._keepalive is not None:
+            _parallel_for_wait(self._handle)
+            self._handle = self._keepalive = None
+
+    def __del__(self):
+        self.wait()
+
+
+def parallel_for_async(kernel, arrays, num_threads=None):
+    """
+    Run *kernel* over the first dimension of the 1D *arrays* on the threading
+    layer's thread pool, returning a :class:`ParallelForHandle` as soon as the
+    region has started. The caller can carry on with other work, or launch
+    more regions, and wait on the handle later.
+
+    *kernel* is the address of a ufunc loop, i.e. of a function with the
+    signature ``void(void **args, intp *dims, intp *steps, void *data)``, or
+    an object with an ``address`` attribute such as a :func:`numba.cfunc`. It
+    is called from the pool's threads without the GIL, with ``args`` pointing
+    to the start of each array's part of the region, ``dims[0]`` the length
+    of that part and ``steps`` the arrays' strides. *num_threads* defaults to
+    :func:`get_num_threads`.
+
+    How much of the region overlaps with the caller depends on the threading
+    layer: ``tbb`` runs the regions concurrently, ``workqueue`` runs one
+    region at a time, a launch first waiting for the previous one, and
+    ``omp`` completes the region before returning.
+    """
+    _launch_threads()
+    address = getattr(kernel, 'address', kernel)
+    arrays = [np.asarray(a) for a in arrays]
+    if not arrays:
+        raise ValueError("parallel_for_async needs at least one array")
+    n = len(arrays[0])
+    for a in arrays:
+        if a.ndim != 1 or len(a) != n:
+            raise ValueError("the arrays must be 1D and of the same length")
+    if num_threads is None:
+        num_threads = get_num_threads()
+    snt_check(num_threads)
+    count = len(arrays)
+    args = (c_void_p * count)(*[a.ctypes.data for a in arrays])
+    dims = (c_size_t * 1)(n)
+    steps = (c_size_t * count)(*[a.strides[0] for a in arrays])
+    handle = _parallel_for_async(address, args, dims, steps, None, 0, count,
+                                 num_threads)
+    return ParallelForHandle(handle, (arrays, args, dims, steps))
@@ -0,0 +1,179 @@
+/*
+Opt-in profiling of parallel regions for the threading layers.
+
+When enabled every parallel_for call claims a record in a ring buffer holding
+the most recent PROFILE_CAPACITY regions. A record holds the region's thread
+count and timestamps for its start, the start of its first chunk and its end,
+followed by the per-worker busy time and chunk count, indexed by thread id.
+Workers accumulate into the record with atomics so concurrent and nested
+regions each get their own record. If more than PROFILE_CAPACITY regions are
+in flight at once their records may be overwritten.
+
+This header is shared by all the threading layers.
+*/
+
+#ifndef NUMBA_UFUNC_PROFILING_H_
+#define NUMBA_UFUNC_PROFILING_H_
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+typedef unsigned long long prof_u64;
+
+#define PROFILE_CAPACITY 1024
+
+/* Record header slots */
+#define PROFILE_NUM_THREADS 0
+#define PROFILE_START 1
+#define PROFILE_FIRST_CHUNK 2
+#define PROFILE_END 3
+#define PROFILE_HEADER_SIZE 4
+
+#if defined(_MSC_VER)
+#define PROF_FETCH_ADD(ptr, val) \
+    ((prof_u64)InterlockedExchangeAdd64((volatile LONG64 *)(ptr), (LONG64)(val)))
+#define PROF_CAS(ptr, old, repl) \
+    (InterlockedCompareExchange64((volatile LONG64 *)(ptr), (LONG64)(repl), \
+                                  (LONG64)(old)) == (LONG64)(old))
+#define PROF_LOAD(ptr) ((prof_u64)InterlockedOr64((volatile LONG64 *)(ptr), 0))
+#else
+#define PROF_FETCH_ADD(ptr, val) __atomic_fetch_add((ptr), (val), __ATOMIC_RELAXED)
+#define PROF_CAS(ptr, old, repl) __sync_bool_compare_and_swap((ptr), (old), (repl))
+#define PROF_LOAD(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#endif
+
+static volatile int region_profiling = 0;
+static int profile_max_workers = 0;
+static prof_u64 *profile_data = NULL;
+static prof_u64 profile_seq = 0;
+
+static size_t
+profile_record_size(void)
+{
+    return PROFILE_HEADER_SIZE + 2 * (size_t)profile_max_workers;
+}
+
+/* Monotonic timestamp in nanoseconds */
+static prof_u64
+profile_now(void)
+{
+#if defined(_MSC_VER)
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER count;
+    if (freq.QuadPart == 0)
+        QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (prof_u64)((double)count.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (prof_u64)ts.tv_sec * 1000000000ULL + (prof_u64)ts.tv_nsec;
+#endif
+}
+
+/* Enable or disable profiling. The buffer is sized for `max_workers` thread
+ * ids the first time profiling is enabled and is kept thereafter, as running
+ * regions may still be writing to it. Returns 0 on success.
+ */
+static int
+set_region_profiling(int enable, int max_workers)
+{
+    if (enable && !profile_data)
+    {
+        if (max_workers < 1)
+            return -1;
+        profile_max_workers = max_workers;
+        profile_data = (prof_u64 *)calloc(PROFILE_CAPACITY,
+                                          sizeof(prof_u64) * profile_record_size());
+        if (!profile_data)
+            return -1;
+    }
+    region_profiling = enable ? 1 : 0;
+    return 0;
+}
+
+static void
+reset_region_profile(void)
+{
+    profile_seq = 0;
+}
+
+/* Claim and initialize a record for a region run by num_threads threads,
+ * returns NULL if profiling is disabled.
+ */
+static prof_u64 *
+profile_region_begin(int num_threads)
+{
+    prof_u64 *rec;
+    prof_u64 seq;
+    if (!region_profiling || !profile_data)
+        return NULL;
+    seq = PROF_FETCH_ADD(&profile_seq, 1);
+    rec = profile_data + (seq % PROFILE_CAPACITY) * profile_record_size();
+    memset(rec, 0, sizeof(prof_u64) * profile_record_size());
+    rec[PROFILE_NUM_THREADS] = num_threads;
+    rec[PROFILE_START] = profile_now();
+    rec[PROFILE_FIRST_CHUNK] = ~0ULL;
+    return rec;
+}
+
+/* Account a chunk run by thread `tid` between `start` and `end` */
+static void
+profile_chunk(prof_u64 *rec, int tid, prof_u64 start, prof_u64 end)
+{
+    prof_u64 first;
+    if (tid < 0 || tid >= profile_max_workers)
+        return;
+    PROF_FETCH_ADD(&rec[PROFILE_HEADER_SIZE + tid], end - start);
+    PROF_FETCH_ADD(&rec[PROFILE_HEADER_SIZE + profile_max_workers + tid], 1);
+    first = PROF_LOAD(&rec[PROFILE_FIRST_CHUNK]);
+    while (start < first && !PROF_CAS(&rec[PROFILE_FIRST_CHUNK], first, start))
+    {
+        first = PROF_LOAD(&rec[PROFILE_FIRST_CHUNK]);
+    }
+}
+
+static void
+profile_region_end(prof_u64 *rec)
+{
+    rec[PROFILE_END] = profile_now();
+}
+
+/* The number of records available, at most PROFILE_CAPACITY */
+static size_t
+get_region_profile_count(void)
+{
+    prof_u64 seq = PROF_LOAD(&profile_seq);
+    if (!profile_data)
+        return 0;
+    return (size_t)(seq < PROFILE_CAPACITY ? seq : PROFILE_CAPACITY);
+}
+
+/* Copy out record `idx`, 0 being the oldest available. `header` receives
+ * PROFILE_HEADER_SIZE values, `busy` and `chunks` receive max_workers values.
+ * Returns the max_workers the buffer is sized for, or -1 if idx is invalid.
+ */
+static int
+get_region_profile(size_t idx, prof_u64 *header, prof_u64 *busy, prof_u64 *chunks)
+{
+    prof_u64 seq = PROF_LOAD(&profile_seq);
+    prof_u64 *rec;
+    size_t count = get_region_profile_count();
+    if (idx >= count)
+        return -1;
+    rec = profile_data + ((seq - count + idx) % PROFILE_CAPACITY) * profile_record_size();
+    memcpy(header, rec, sizeof(prof_u64) * PROFILE_HEADER_SIZE);
+    memcpy(busy, rec + PROFILE_HEADER_SIZE,
+           sizeof(prof_u64) * profile_max_workers);
+    memcpy(chunks, rec + PROFILE_HEADER_SIZE + profile_max_workers,
+           sizeof(prof_u64) * profile_max_workers);
+    return profile_max_workers;
+}
+
+#endif /* NUMBA_UFUNC_PROFILING_H_ */
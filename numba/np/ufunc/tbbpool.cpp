@@ -16,9 +16,15 @@ Implement parallel vectorize workqueue on top of Intel TBB.
 #include <string.h>
 #include <stdio.h>
 #include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <vector>
 #include "workqueue.h"
 
 #include "gufunc_scheduler.h"
+#include "affinity.h"
+#include "profiling.h"
 
 /* TBB 2019 U5 is the minimum required version as this is needed:
  * https://github.com/intel/tbb/blob/18070344d755ece04d169e6cc40775cae9288cee/CHANGES#L133-L134
@@ -53,6 +59,10 @@ static int _INIT_NUM_THREADS = -1;
 // This is the per-thread thread mask, each thread can carry its own mask.
 static THREAD_LOCAL(int) _TLS_num_threads = 0;
 
+// The number of parallel_for kernel bodies the thread is currently executing,
+// non-zero means a parallel_for call from this thread is a nested region.
+static THREAD_LOCAL(int) _TLS_region_depth = 0;
+
 
 static void
 set_num_threads(int count)
@@ -100,8 +110,96 @@ public:
     }
 };
 
+// TBB workers have no stable index, each is given the next free affinity slot
+// the first time it joins an arena. Slot 0 is left for the main thread.
+static std::atomic<int> affinity_next_slot(1);
+static THREAD_LOCAL(bool) _TLS_affinity_pinned = false;
+
 void fix_tls_observer::on_scheduler_entry(bool worker) {
     set_num_threads(mask_val);
+    if (worker && !_TLS_affinity_pinned && thread_affinity_enabled())
+    {
+        pin_current_thread(affinity_next_slot.fetch_add(1));
+        _TLS_affinity_pinned = true;
+    }
+}
+
+// An initialized task_arena and the observer fixing the TLS slots of threads
+// joining it, the observer is declared last so it's destroyed first. `busy` is
+// set whilst a parallel region is using the arena.
+struct cached_arena {
+    tbb::task_arena arena;
+    fix_tls_observer observer;
+    std::atomic<bool> busy;
+    cached_arena(int num_threads) : arena(num_threads), observer(arena, num_threads), busy(false)
+    {
+        arena.initialize();
+    }
+};
+
+// Arenas are cached by thread count, slot `n` holds the arena for `n` threads.
+// Lookups are lock free, the mutex only guards creation and destruction.
+static std::vector<std::atomic<cached_arena *>> *arena_cache = NULL;
+static std::mutex arena_cache_mutex;
+
+static void
+init_arena_cache(int max_threads)
+{
+    std::lock_guard<std::mutex> lock(arena_cache_mutex);
+    if (arena_cache || max_threads < 1)
+        return;
+    arena_cache = new std::vector<std::atomic<cached_arena *>>(max_threads + 1);
+    for (auto &slot : *arena_cache)
+        slot.store(NULL);
+}
+
+// Returns the cached arena for num_threads with its `busy` flag acquired,
+// creating the arena if needed. Returns NULL if num_threads is outside of the
+// range the cache was sized for, or if the arena is already in use.
+static cached_arena *
+acquire_cached_arena(int num_threads)
+{
+    if (!arena_cache || num_threads < 1 || (size_t)num_threads >= arena_cache->size())
+        return NULL;
+    std::atomic<cached_arena *> &slot = (*arena_cache)[num_threads];
+    cached_arena *entry = slot.load(std::memory_order_acquire);
+    if (!entry)
+    {
+        std::lock_guard<std::mutex> lock(arena_cache_mutex);
+        entry = slot.load(std::memory_order_relaxed);
+        if (!entry)
+        {
+            if(_DEBUG)
+            {
+                printf("Creating cached task_arena for %d threads\n", num_threads);
+            }
+            entry = new cached_arena(num_threads);
+            slot.store(entry, std::memory_order_release);
+        }
+    }
+    if (entry->busy.exchange(true, std::memory_order_acquire))
+        return NULL;
+    return entry;
+}
+
+static void
+release_cached_arena(cached_arena *entry)
+{
+    entry->busy.store(false, std::memory_order_release);
+}
+
+// Destroys all the cached arenas, this must only be called when no parallel
+// region is running, i.e. before fork or on unload.
+static void
+clear_arena_cache(void)
+{
+    std::lock_guard<std::mutex> lock(arena_cache_mutex);
+    if (!arena_cache)
+        return;
+    for (auto &slot : *arena_cache)
+    {
+        delete slot.exchange(NULL);
+    }
 }
 
 static void
@@ -114,6 +212,134 @@ add_task(void *fn, void *args, void *dims, void *steps, void *data)
     });
 }
 
+// The arguments of a parallel region, the schedule is resolved on the
+// launching thread as it's thread local.
+struct region_args {
+    void *fn;
+    char **args;
+    size_t *dimensions;
+    size_t *steps;
+    void *data;
+    size_t arg_len, array_count;
+    uintp kind;
+    size_t grain;
+    prof_u64 *profile;
+};
+
+// Runs the region over the arena the calling thread is in.
+static void
+run_region(const region_args &region)
+{
+    void *fn = region.fn;
+    char **args = region.args;
+    size_t *dimensions = region.dimensions;
+    size_t *steps = region.steps;
+    void *data = region.data;
+    size_t arg_len = region.arg_len;
+    size_t array_count = region.array_count;
+    uintp kind = region.kind;
+    size_t grain = region.grain;
+    prof_u64 *profile = region.profile;
+
+    using range_t = tbb::blocked_range<size_t>;
+    auto body = [=](const range_t &range)
+    {
+        size_t * count_space = (size_t *)alloca(sizeof(size_t) * arg_len);
+        char ** array_arg_space = (char**)alloca(sizeof(char*) * array_count);
+        memcpy(count_space, dimensions, arg_len * sizeof(size_t));
+        count_space[0] = range.size();
+
+        if(_DEBUG && _TRACE_SPLIT > 1)
+        {
+            printf("THREAD %p:", count_space);
+            printf("count_space: ");
+            for(size_t j = 0; j < arg_len; j++)
+                printf("%lu, ", count_space[j]);
+            printf("\n");
+        }
+        for(size_t j = 0; j < array_count; j++)
+        {
+            char * base = args[j];
+            size_t step = steps[j];
+            ptrdiff_t offset = step * range.begin();
+            array_arg_space[j] = base + offset;
+
+            if(_DEBUG && _TRACE_SPLIT > 2)
+            {
+                printf("Index %ld\n", j);
+                printf("-->Got base %p\n", (void *)base);
+                printf("-->Got step %lu\n", step);
+                printf("-->Got offset %ld\n", offset);
+                printf("-->Got addr %p\n", (void *)array_arg_space[j]);
+            }
+        }
+
+        if(_DEBUG && _TRACE_SPLIT > 2)
+        {
+            printf("array_arg_space: ");
+            for(size_t j = 0; j < array_count; j++)
+                printf("%p, ", (void *)array_arg_space[j]);
+            printf("\n");
+        }
+        auto func = reinterpret_cast<void (*)(char **args, size_t *dims, size_t *steps, void *data)>(fn);
+        _TLS_region_depth++;
+        if (profile)
+        {
+            prof_u64 begin = profile_now();
+            func(array_arg_space, count_space, steps, data);
+            profile_chunk(profile, get_thread_id(), begin, profile_now());
+        }
+        else
+        {
+            func(array_arg_space, count_space, steps, data);
+        }
+        _TLS_region_depth--;
+    };
+    if (kind == SCHEDULE_DYNAMIC)
+    {
+        tbb::parallel_for(range_t(0, dimensions[0], grain), body,
+                          tbb::simple_partitioner());
+    }
+    else if (kind == SCHEDULE_STATIC && thread_affinity_enabled())
+    {
+        // Keep the mapping of blocks to pinned threads stable across
+        // launches so first touched pages stay local to their thread.
+        tbb::parallel_for(range_t(0, dimensions[0]), body,
+                          tbb::static_partitioner());
+    }
+    else
+    {
+        tbb::parallel_for(range_t(0, dimensions[0]), body);
+    }
+}
+
+// TBB balances the load by work stealing, for SCHEDULE_DYNAMIC the range
+// is split down to a fixed grain size instead of being auto partitioned.
+static region_args
+make_region_args(void *fn, char **args, size_t *dimensions, size_t *steps,
+                 void *data, size_t inner_ndim, size_t array_count,
+                 int num_threads)
+{
+    region_args region;
+    region.fn = fn;
+    region.args = args;
+    region.dimensions = dimensions;
+    region.steps = steps;
+    region.data = data;
+    region.arg_len = inner_ndim + 1;
+    region.array_count = array_count;
+    region.kind = get_parallel_schedule();
+    region.grain = 1;
+    if (region.kind == SCHEDULE_DYNAMIC)
+    {
+        region.grain = dimensions[0] / ((size_t)num_threads * SCHEDULE_CHUNKS_PER_THREAD);
+        if (region.grain < 1)
+            region.grain = 1;
+    }
+    region.profile = profile_region_begin(num_threads);
+    return region;
+}
+
 static void
 parallel_for(void *fn, char **args, size_t *dimensions, size_t *steps, void *data,
              size_t inner_ndim, size_t array_count, int num_threads)
@@ -160,54 +386,112 @@ parallel_for(void *fn, char **args, size_t *dimensions, size_t *steps, void *dat
     // doing any work. Any further call to query the TLS slot value made by any
     // thread in the arena is then safe and were any thread to create a nested
     // parallel region the same logic applies as per program start/reinit.
-    tbb::task_arena limited(num_threads);
-    fix_tls_observer observer(limited, num_threads);
+    // The arena and its observer only depend on num_threads, so for calls
+    // made from outside of any parallel region they are created once per
+    // thread count and reused. Nested regions, and concurrent calls from other
+    // threads whilst the cached arena is in use, get a fresh arena as sharing
+    // one could deadlock or limit their concurrency.
+    region_args region = make_region_args(fn, args, dimensions, steps, data,
+                                          inner_ndim, array_count, num_threads);
+    auto run = [&]{ run_region(region); };
+
+    cached_arena *cached = NULL;
+    if (_TLS_region_depth == 0)
+    {
+        cached = acquire_cached_arena(num_threads);
+    }
+    if (cached)
+    {
+        cached->arena.execute(run);
+        release_cached_arena(cached);
+    }
+    else
+    {
+        tbb::task_arena limited(num_threads);
+        fix_tls_observer observer(limited, num_threads);
+        limited.execute(run);
+    }
+    if (region.profile)
+        profile_region_end(region.profile);
+}
 
-    limited.execute([&]{
-        using range_t = tbb::blocked_range<size_t>;
-        tbb::parallel_for(range_t(0, dimensions[0]), [=](const range_t &range)
-        {
-            size_t * count_space = (size_t *)alloca(sizeof(size_t) * arg_len);
-            char ** array_arg_space = (char**)alloca(sizeof(char*) * array_count);
-            memcpy(count_space, dimensions, arg_len * sizeof(size_t));
-            count_space[0] = range.size();
+// A region launched by parallel_for_async(). It runs in its own arena with no
+// slot reserved for the launching thread so that the arena's workers run it
+// whilst the launching thread carries on, `complete` is set when it's done.
+struct async_region {
+    tbb::task_arena arena;
+    fix_tls_observer observer;
+    region_args region;
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::atomic<bool> complete;
+    async_region(int num_threads, const region_args &r)
+        : arena(num_threads, 0), observer(arena, num_threads), region(r), complete(false)
+    {
+    }
+};
 
-            if(_DEBUG && _TRACE_SPLIT > 1)
-            {
-                printf("THREAD %p:", count_space);
-                printf("count_space: ");
-                for(size_t j = 0; j < arg_len; j++)
-                    printf("%lu, ", count_space[j]);
-                printf("\n");
-            }
-            for(size_t j = 0; j < array_count; j++)
-            {
-                char * base = args[j];
-                size_t step = steps[j];
-                ptrdiff_t offset = step * range.begin();
-                array_arg_space[j] = base + offset;
-
-                if(_DEBUG && _TRACE_SPLIT > 2)
-                {
-                    printf("Index %ld\n", j);
-                    printf("-->Got base %p\n", (void *)base);
-                    printf("-->Got step %lu\n", step);
-                    printf("-->Got offset %ld\n", offset);
-                    printf("-->Got addr %p\n", (void *)array_arg_space[j]);
-                }
-            }
+static void *
+parallel_for_async(void *fn, char **args, size_t *dimensions, size_t *steps,
+                   void *data, size_t inner_ndim, size_t array_count,
+                   int num_threads)
+{
+    // Blocking a worker on a nested region's completion could starve the
+    // region of threads, so nested regions are run synchronously.
+    if (_TLS_region_depth > 0)
+    {
+        parallel_for(fn, args, dimensions, steps, data, inner_ndim,
+                     array_count, num_threads);
+        return NULL;
+    }
+    region_args region = make_region_args(fn, args, dimensions, steps, data,
+                                          inner_ndim, array_count, num_threads);
+    async_region *handle = new (std::nothrow) async_region(num_threads, region);
+    if (!handle)
+    {
+        // run it synchronously rather than fail the launch
+        tbb::task_arena limited(num_threads);
+        fix_tls_observer observer(limited, num_threads);
+        limited.execute([&]{ run_region(region); });
+        if (region.profile)
+            profile_region_end(region.profile);
+        return NULL;
+    }
+    handle->arena.enqueue([handle]
+    {
+        run_region(handle->region);
+        if (handle->region.profile)
+            profile_region_end(handle->region.profile);
+        // notify under the lock, the waiter may release the handle as soon as
+        // it observes completion
+        std::lock_guard<std::mutex> lock(handle->mutex);
+        handle->complete.store(true, std::memory_order_release);
+        handle->cond.notify_all();
+    });
+    return handle;
+}
 
-            if(_DEBUG && _TRACE_SPLIT > 2)
-            {
-                printf("array_arg_space: ");
-                for(size_t j = 0; j < array_count; j++)
-                    printf("%p, ", (void *)array_arg_space[j]);
-                printf("\n");
-            }
-            auto func = reinterpret_cast<void (*)(char **args, size_t *dims, size_t *steps, void *data)>(fn);
-            func(array_arg_space, count_space, steps, data);
+static int
+parallel_for_poll(void *handle)
+{
+    async_region *region = static_cast<async_region *>(handle);
+    return !region || region->complete.load(std::memory_order_acquire);
+}
+
+static void
+parallel_for_wait(void *handle)
+{
+    async_region *region = static_cast<async_region *>(handle);
+    if (!region)
+        return;
+    {
+        std::unique_lock<std::mutex> lock(region->mutex);
+        region->cond.wait(lock, [region]
+        {
+            return region->complete.load(std::memory_order_acquire);
         });
-    });
+    }
+    delete region;
 }
 
 static std::thread::id init_thread_id;
@@ -233,6 +517,8 @@ static void prepare_fork(void)
     {
         if(is_main_thread())
         {
+            // cached arenas must not be alive when the scheduler finalizes
+            clear_arena_cache();
             if (!tbb::finalize(tsh, std::nothrow))
             {
                 tbb::task_scheduler_handle::release(tsh);
@@ -279,6 +565,7 @@ static void unload_tbb(void)
         delete tg;
         tg = NULL;
     }
+    clear_arena_cache();
     if (tsh_was_initialized)
     {
         // blocking terminate is not strictly required here, ignore return value
@@ -305,6 +592,7 @@ static void launch_threads(int count)
     tg->run([] {}); // start creating threads asynchronously
 
     _INIT_NUM_THREADS = count;
+    init_arena_cache(count);
 
     set_main_thread();
 
@@ -339,14 +627,27 @@ MOD_INIT(tbbpool)
     SetAttrStringFromVoidPointer(m, ready);
     SetAttrStringFromVoidPointer(m, add_task);
     SetAttrStringFromVoidPointer(m, parallel_for);
+    SetAttrStringFromVoidPointer(m, parallel_for_async);
+    SetAttrStringFromVoidPointer(m, parallel_for_poll);
+    SetAttrStringFromVoidPointer(m, parallel_for_wait);
     SetAttrStringFromVoidPointer(m, do_scheduling_signed);
     SetAttrStringFromVoidPointer(m, do_scheduling_unsigned);
+    SetAttrStringFromVoidPointer(m, get_schedule_cache_stats);
     SetAttrStringFromVoidPointer(m, set_num_threads);
     SetAttrStringFromVoidPointer(m, get_num_threads);
     SetAttrStringFromVoidPointer(m, get_thread_id);
     SetAttrStringFromVoidPointer(m, set_parallel_chunksize);
     SetAttrStringFromVoidPointer(m, get_parallel_chunksize);
     SetAttrStringFromVoidPointer(m, get_sched_size);
+    SetAttrStringFromVoidPointer(m, set_parallel_schedule);
+    SetAttrStringFromVoidPointer(m, get_parallel_schedule);
+    SetAttrStringFromVoidPointer(m, set_parallel_split_alignment);
+    SetAttrStringFromVoidPointer(m, get_parallel_split_alignment);
+    SetAttrStringFromVoidPointer(m, set_thread_affinity);
+    SetAttrStringFromVoidPointer(m, set_region_profiling);
+    SetAttrStringFromVoidPointer(m, reset_region_profile);
+    SetAttrStringFromVoidPointer(m, get_region_profile_count);
+    SetAttrStringFromVoidPointer(m, get_region_profile);
 
     return MOD_SUCCESS_VAL(m);
 }
@@ -2,7 +2,8 @@
 Implement parallel vectorize workqueue.
 
 This keeps a set of worker threads running all the time.
-They wait and spin on a task queue for jobs.
+They wait and spin on a task queue for jobs, parking on a condition variable
+if no job arrives within the spin budget (see NUMBA_WORKQUEUE_SPIN).
 
 **WARNING**
 This module is not thread-safe.  Adding task to queue is not protected from
@@ -37,6 +38,7 @@ race conditions.
 #include <sys/types.h>
 #include <unistd.h>
 #include <signal.h>
+#include <sched.h>
 #define NUMBA_PTHREAD
 #endif
 
@@ -45,6 +47,8 @@ race conditions.
 #include <stdio.h>
 #include "workqueue.h"
 #include "gufunc_scheduler.h"
+#include "affinity.h"
+#include "profiling.h"
 
 #define _DEBUG 0
 
@@ -53,8 +57,8 @@ race conditions.
  */
 /* This variable is the nesting level, it's incremented at the start of each
  * parallel region and decremented at the end, if parallel regions are nested
- * on entry the value == 1 and workqueue will abort (this in preference to just
- * hanging or segfaulting).
+ * on entry the value == 1 and workqueue will run the nested region inline on
+ * the calling thread (this in preference to just hanging or segfaulting).
  */
 static int _nesting_level = 0;
 
@@ -64,6 +68,9 @@ static void reset_after_fork(void);
 
 static void
 add_task_internal(void *fn, void *args, void *dims, void *steps, void *data, int tid);
+static void
+add_task_to_queue(int index, void *fn, void *args, void *dims, void *steps,
+                  void *data, int tid);
 
 /* PThread */
 #ifdef NUMBA_PTHREAD
@@ -102,10 +109,10 @@ queue_condition_unlock(queue_condition_t *qc)
 }
 
 static void
-queue_condition_signal(queue_condition_t *qc)
+queue_condition_broadcast(queue_condition_t *qc)
 {
     /* XXX errors? */
-    pthread_cond_signal(&qc->cond);
+    pthread_cond_broadcast(&qc->cond);
 }
 
 static void
@@ -191,9 +198,9 @@ queue_condition_unlock(queue_condition_t *qc)
 }
 
 static void
-queue_condition_signal(queue_condition_t *qc)
+queue_condition_broadcast(queue_condition_t *qc)
 {
-    WakeConditionVariable(&qc->cv);
+    WakeAllConditionVariable(&qc->cv);
 }
 
 static void
@@ -264,6 +271,54 @@ platform_launch(void)
 
 #endif /* Windows threading */
 
+/* Atomic operations on the queue state words, these are all sequentially
+ * consistent as the parking protocol in queue_state_wait() relies on it. The
+ * relaxed load and store are for the spin budget, which is only a hint.
+ */
+#ifdef _MSC_VER
+#define WQ_CAS(ptr, old, repl) \
+    (InterlockedCompareExchange((volatile LONG *)(ptr), (repl), (old)) == (old))
+#define WQ_LOAD(ptr) InterlockedOr((volatile LONG *)(ptr), 0)
+#define WQ_STORE(ptr, val) InterlockedExchange((volatile LONG *)(ptr), (val))
+/* aligned volatile 32-bit accesses are atomic with MSVC */
+#define WQ_LOAD_RELAXED(ptr) (*(volatile LONG *)(ptr))
+#define WQ_STORE_RELAXED(ptr, val) (*(volatile LONG *)(ptr) = (val))
+#define WQ_FETCH_ADD(ptr, val) \
+    InterlockedExchangeAdd((volatile LONG *)(ptr), (val))
+#define WQ_PAUSE() YieldProcessor()
+#define WQ_YIELD() SwitchToThread()
+#ifdef _WIN64
+#define WQ_SIZE_CAS(ptr, old, repl) \
+    (InterlockedCompareExchange64((volatile LONG64 *)(ptr), (repl), (old)) == (LONG64)(old))
+#define WQ_SIZE_FETCH_ADD(ptr, val) \
+    ((size_t)InterlockedExchangeAdd64((volatile LONG64 *)(ptr), (val)))
+#define WQ_SIZE_LOAD(ptr) ((size_t)InterlockedOr64((volatile LONG64 *)(ptr), 0))
+#else
+#define WQ_SIZE_CAS WQ_CAS
+#define WQ_SIZE_FETCH_ADD(ptr, val) ((size_t)WQ_FETCH_ADD(ptr, val))
+#define WQ_SIZE_LOAD(ptr) ((size_t)WQ_LOAD(ptr))
+#endif
+#else
+#define WQ_SIZE_CAS WQ_CAS
+#define WQ_SIZE_FETCH_ADD WQ_FETCH_ADD
+#define WQ_SIZE_LOAD WQ_LOAD
+#define WQ_YIELD() sched_yield()
+#define WQ_CAS(ptr, old, repl) __sync_bool_compare_and_swap((ptr), (old), (repl))
+#define WQ_LOAD(ptr) __atomic_load_n((ptr), __ATOMIC_SEQ_CST)
+#define WQ_STORE(ptr, val) __atomic_store_n((ptr), (val), __ATOMIC_SEQ_CST)
+#define WQ_LOAD_RELAXED(ptr) __atomic_load_n((ptr), __ATOMIC_RELAXED)
+#define WQ_STORE_RELAXED(ptr, val) \
+    __atomic_store_n((ptr), (val), __ATOMIC_RELAXED)
+#define WQ_FETCH_ADD(ptr, val) __atomic_fetch_add((ptr), (val), __ATOMIC_SEQ_CST)
+#if defined(__i386__) || defined(__x86_64__)
+#define WQ_PAUSE() __builtin_ia32_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+#define WQ_PAUSE() __asm__ __volatile__("yield")
+#else
+#define WQ_PAUSE() do { } while (0)
+#endif
+#endif
+
 typedef struct Task
 {
     void (*func)(void *args, void *dims, void *steps, void *data);
@@ -271,11 +326,37 @@ typedef struct Task
     int tid;
 } Task;
 
+/* Per-worker task queue.
+
+A FIFO of the tasks of one worker, consumed by that worker only. Tasks are
+only ever pushed whilst the owning queue is IDLE (i.e. by the launching thread
+before ready()), and are claimed from `head` with an atomic fetch-and-add once
+the queue is READY, so no lock is needed to consume them. The worker resets
+the queue once it has drained it, before moving to DONE, and then spin-waits
+for its next READY state in queue_state_wait() before parking.
+
+Idle workers don't steal from the other queues: each task carries the thread
+id it runs as (see get_thread_id()), which parfors reductions use to index
+their per-thread storage, so two threads must never run tasks of the same id
+at once. The dynamic and guided schedules balance the load instead, by having
+the workers claim iterations from a shared cursor.
+*/
+typedef struct
+{
+    Task *tasks;
+    int capacity;
+    int head;   /* index of the next task to claim */
+    int tail;   /* one past the last task pushed */
+} TaskQueue;
+
 typedef struct
 {
     queue_condition_t cond;
     int state;
-    Task task;
+    int sleepers;   /* number of threads parked on `cond` */
+    int spin;       /* adaptive spin budget for queue_state_wait(), read and
+                       written by both of its waiters with relaxed atomics */
+    TaskQueue pending;
 } Queue;
 
 
@@ -284,19 +365,116 @@ static int queue_count;
 static int queue_pivot = 0;
 static int NUM_THREADS = -1;
 
+/* Upper bound on the number of iterations queue_state_wait() busy-waits for a
+ * state change before parking on the condition variable. Zero means always
+ * park immediately. Set from NUMBA_WORKQUEUE_SPIN via set_wait_spin().
+ */
+static int queue_max_spin = 0;
+
+static void
+set_wait_spin(int count)
+{
+    queue_max_spin = count < 0 ? 0 : count;
+}
+
+/* Wake any thread parked on the queue, it will re-check the state. */
+static void
+queue_state_notify(Queue *queue)
+{
+    queue_condition_t *cond = &queue->cond;
+
+    if (WQ_LOAD(&queue->sleepers) > 0)
+    {
+        queue_condition_lock(cond);
+        queue_condition_broadcast(cond);
+        queue_condition_unlock(cond);
+    }
+}
+
+/* Wait for the queue to be in state `old` and atomically move it to `repl`.
+
+The waiter first spins on the state word for up to `queue->spin` iterations,
+the budget grows when a spin succeeds and shrinks when the waiter ends up
+parking, so that long running tasks don't burn CPU in the launching thread.
+The spin periodically yields so oversubscribed hosts still make progress.
+Parking registers the waiter in `sleepers` before its last check of the state,
+and notifiers check `sleepers` after their transition, so one of the two
+always observes the other and wake ups cannot be lost.
+*/
 static void
 queue_state_wait(Queue *queue, int old, int repl)
 {
     queue_condition_t *cond = &queue->cond;
+    int i, spin = WQ_LOAD_RELAXED(&queue->spin);
+
+    for (i = 0; i < spin; ++i)
+    {
+        if (WQ_CAS(&queue->state, old, repl))
+        {
+            if (spin < queue_max_spin)
+                WQ_STORE_RELAXED(&queue->spin, spin * 2 < queue_max_spin ?
+                                               spin * 2 : queue_max_spin);
+            queue_state_notify(queue);
+            return;
+        }
+        if ((i & 63) == 63)
+            WQ_YIELD();
+        else
+            WQ_PAUSE();
+    }
 
     queue_condition_lock(cond);
-    while (queue->state != old)
+    WQ_FETCH_ADD(&queue->sleepers, 1);
+    while (!WQ_CAS(&queue->state, old, repl))
     {
         queue_condition_wait(cond);
     }
-    queue->state = repl;
-    queue_condition_signal(cond);
+    WQ_FETCH_ADD(&queue->sleepers, -1);
     queue_condition_unlock(cond);
+    WQ_STORE_RELAXED(&queue->spin, spin / 2 > 0 ? spin / 2
+                                                : (queue_max_spin > 0));
+    queue_state_notify(queue);
+}
+
+static void
+task_queue_push(TaskQueue *tq, Task *task)
+{
+    if (tq->tail == tq->capacity)
+    {
+        int capacity = tq->capacity ? tq->capacity * 2 : 4;
+        Task *tasks = realloc(tq->tasks, sizeof(Task) * capacity);
+        if (!tasks)
+        {
+            fprintf(stderr, "%s", "Terminating: workqueue failed to allocate "
+                                  "task storage.\n");
+            raise(SIGABRT);
+            return;
+        }
+        tq->tasks = tasks;
+        tq->capacity = capacity;
+    }
+    tq->tasks[tq->tail] = *task;
+    WQ_STORE(&tq->tail, tq->tail + 1);
+}
+
+/* Claim the next task from the queue, returns NULL if it's drained. */
+static Task *
+task_queue_pop(TaskQueue *tq)
+{
+    int idx;
+    if (WQ_LOAD(&tq->head) >= WQ_LOAD(&tq->tail))
+        return NULL;
+    idx = WQ_FETCH_ADD(&tq->head, 1);
+    if (idx >= WQ_LOAD(&tq->tail))
+        return NULL;
+    return &tq->tasks[idx];
+}
+
+static void
+task_queue_reset(TaskQueue *tq)
+{
+    WQ_STORE(&tq->tail, 0);
+    WQ_STORE(&tq->head, 0);
 }
 
 // break on this for debug
@@ -362,9 +540,146 @@ static void sync_tls(void *args, void *dims, void *steps, void *data) {
 };
 
 
+/* The state shared by the tasks of a dynamically scheduled parallel_for. The
+ * workers claim iterations of the outer dimension from `cursor` until it
+ * reaches `total`.
+ */
+typedef struct
+{
+    void (*func)(char **args, size_t *dims, size_t *steps, void *data);
+    char **args;
+    size_t *dims;
+    size_t *steps;
+    void *data;
+    size_t arg_len, array_count;
+    size_t total;
+    size_t claim;       /* iterations per claim for SCHEDULE_DYNAMIC */
+    uintp kind;
+    int num_threads;
+    size_t cursor;
+    prof_u64 *profile;  /* region profile record, NULL if not profiling */
+} DynamicLoop;
+
+/* Claim the next block of iterations from the loop, returns its size and
+ * stores its start in `start`, zero means there is no work left.
+ */
+static size_t
+dynamic_loop_claim(DynamicLoop *loop, size_t *start)
+{
+    size_t begin, claim, remain;
+    if (loop->kind == SCHEDULE_GUIDED)
+    {
+        do
+        {
+            begin = WQ_SIZE_LOAD(&loop->cursor);
+            if (begin >= loop->total)
+                return 0;
+            remain = loop->total - begin;
+            claim = remain / (2 * loop->num_threads);
+            if (claim < 1)
+                claim = 1;
+        } while (!WQ_SIZE_CAS(&loop->cursor, begin, begin + claim));
+    }
+    else
+    {
+        if (WQ_SIZE_LOAD(&loop->cursor) >= loop->total)
+            return 0;
+        begin = WQ_SIZE_FETCH_ADD(&loop->cursor, loop->claim);
+        if (begin >= loop->total)
+            return 0;
+        remain = loop->total - begin;
+        claim = remain < loop->claim ? remain : loop->claim;
+    }
+    *start = begin;
+    return claim;
+}
+
 static void
-parallel_for(void *fn, char **args, size_t *dimensions, size_t *steps, void *data,
-             size_t inner_ndim, size_t array_count, int num_threads)
+dynamic_loop_task(void *args, void *dims, void *steps, void *data)
+{
+    DynamicLoop *loop = (DynamicLoop *)args;
+    size_t *count_space = alloca(sizeof(size_t) * loop->arg_len);
+    char **array_arg_space = alloca(sizeof(char*) * loop->array_count);
+    size_t start, count, j;
+
+    memcpy(count_space, loop->dims, loop->arg_len * sizeof(size_t));
+    while ((count = dynamic_loop_claim(loop, &start)) != 0)
+    {
+        count_space[0] = count;
+        for (j = 0; j < loop->array_count; j++)
+        {
+            array_arg_space[j] = loop->args[j] + loop->steps[j] * start;
+        }
+        if (loop->profile)
+        {
+            prof_u64 begin = profile_now();
+            loop->func(array_arg_space, count_space, loop->steps, loop->data);
+            profile_chunk(loop->profile, get_thread_id(), begin, profile_now());
+        }
+        else
+        {
+            loop->func(array_arg_space, count_space, loop->steps, loop->data);
+        }
+    }
+}
+
+/* A statically scheduled task of a region that is being profiled, this runs
+ * the kernel and accounts its run time to the region's record.
+ */
+typedef struct
+{
+    void (*func)(void *args, void *dims, void *steps, void *data);
+    void *args, *dims, *steps, *data;
+    prof_u64 *profile;
+} ProfiledTask;
+
+static void
+profiled_task(void *args, void *dims, void *steps, void *data)
+{
+    ProfiledTask *task = (ProfiledTask *)args;
+    prof_u64 begin = profile_now();
+    task->func(task->args, task->dims, task->steps, task->data);
+    profile_chunk(task->profile, get_thread_id(), begin, profile_now());
+}
+
+/* The state of a launched parallel region that parallel_for_async() hands
+ * back as the completion handle. The per-task arguments live in `storage`,
+ * see region_storage_size(), as the launching frame may be gone by the time
+ * the tasks run.
+ */
+typedef struct
+{
+    int old_queue_count;
+    prof_u64 *profile;
+    int complete;
+    char *storage;
+} Region;
+
+/* The workqueue runs one region at a time, this is the region launched by
+ * parallel_for_async() that has not been completed yet, if any.
+ */
+static Region *pending_region = NULL;
+
+/* Non-zero on the pool's worker threads. */
+static THREAD_LOCAL(int) _TLS_is_worker = 0;
+
+/* The size of the storage needed for the task arguments of a region */
+static size_t
+region_storage_size(size_t inner_ndim, size_t array_count, int num_threads)
+{
+    size_t per_task = sizeof(ProfiledTask) + sizeof(size_t) * (inner_ndim + 1)
+                      + sizeof(char *) * array_count;
+    return sizeof(DynamicLoop) + per_task * (size_t)num_threads;
+}
+
+/* Hand the region out to the pool and start it running, the task arguments
+ * are placed in `region->storage`. region_finish() must be called to wait for
+ * the region to complete before the pool is used again.
+ */
+static void
+region_launch(Region *region, void *fn, char **args, size_t *dimensions,
+              size_t *steps, void *data, size_t inner_ndim, size_t array_count,
+              int num_threads)
 {
 
     //     args = <ir.Argument '.1' of type i8**>,
@@ -372,17 +687,6 @@ parallel_for(void *fn, char **args, size_t *dimensions, size_t *steps, void *dat
     //     steps = <ir.Argument '.3' of type i64*>
     //     data = <ir.Argument '.4' of type i8*>
 
-    // check the nesting level, if it's already 1, abort, workqueue cannot
-    // handle nesting.
-    if (_nesting_level >= 1){
-        fprintf(stderr, "%s", "Terminating: Nested parallel kernel launch "
-                              "detected, the workqueue threading layer does "
-                              "not supported nested parallelism. Try the TBB "
-                              "threading layer.\n");
-        raise(SIGABRT);
-        return;
-    }
-
     // increment the nest level
     _nesting_level += 1;
 
@@ -390,16 +694,26 @@ parallel_for(void *fn, char **args, size_t *dimensions, size_t *steps, void *dat
     char ** array_arg_space = NULL;
     const size_t arg_len = (inner_ndim + 1);
     int i; // induction var for chunking, thread count unlikely to overflow int
+    int *slots;
     size_t j, count, remain, total;
 
     ptrdiff_t offset;
     char * base;
-    int old_queue_count = -1;
+    uintp kind;
+    prof_u64 *profile;
+    DynamicLoop *loop = (DynamicLoop *)region->storage;
+    ProfiledTask *profiled = (ProfiledTask *)(loop + 1);
+    size_t *count_storage = (size_t *)(profiled + num_threads);
+    char **arg_storage = (char **)(count_storage + arg_len * num_threads);
 
     size_t step;
 
     debug_marker();
 
+    profile = profile_region_begin(num_threads);
+    region->profile = profile;
+    region->complete = 0;
+
     total = *((size_t *)dimensions);
     count = total / num_threads;
     remain = total;
@@ -442,12 +756,47 @@ parallel_for(void *fn, char **args, size_t *dimensions, size_t *steps, void *dat
     synchronize();
 
     // This backend isn't threadsafe so just mutate the global
-    old_queue_count = queue_count;
+    region->old_queue_count = queue_count;
     queue_count = num_threads;
 
+    kind = get_parallel_schedule();
+    if (kind != SCHEDULE_STATIC)
+    {
+        // Workers claim iterations from a shared cursor rather than each
+        // taking a fixed block.
+        loop->func = fn;
+        loop->args = args;
+        loop->dims = dimensions;
+        loop->steps = steps;
+        loop->data = data;
+        loop->arg_len = arg_len;
+        loop->array_count = array_count;
+        loop->total = total;
+        loop->claim = total / ((size_t)num_threads * SCHEDULE_CHUNKS_PER_THREAD);
+        if (loop->claim < 1)
+            loop->claim = 1;
+        loop->kind = kind;
+        loop->num_threads = num_threads;
+        loop->cursor = 0;
+        loop->profile = profile;
+
+        for (i = 0; i < num_threads; i++)
+        {
+            add_task_internal(dynamic_loop_task, (void *)loop, NULL, NULL, NULL, i);
+        }
+        ready();
+        return;
+    }
+
+    // Block i is queued for worker slots[i], in NUMA node order when the
+    // workers are pinned. It keeps the thread id i so per-thread storage is
+    // still indexed in block order.
+    slots = (int *)alloca(sizeof(int) * num_threads);
+    thread_affinity_block_slots(slots, num_threads);
+
     for (i = 0; i < num_threads; i++)
     {
-        count_space = (size_t *)alloca(sizeof(size_t) * arg_len);
+        count_space = count_storage + arg_len * i;
         memcpy(count_space, dimensions, arg_len * sizeof(size_t));
         if(i == num_threads - 1)
         {
@@ -471,7 +820,7 @@ parallel_for(void *fn, char **args, size_t *dimensions, size_t *steps, void *dat
             printf("\n");
         }
 
-        array_arg_space = alloca(sizeof(char*) * array_count);
+        array_arg_space = arg_storage + array_count * i;
 
         for(j = 0; j < array_count; j++)
         {
@@ -498,19 +847,157 @@ parallel_for(void *fn, char **args, size_t *dimensions, size_t *steps, void *dat
                 printf("%p, ", (void *)array_arg_space[j]);
             }
         }
-        add_task_internal(fn, (void *)array_arg_space, (void *)count_space, steps, data, i);
+        if (profile)
+        {
+            profiled[i].func = fn;
+            profiled[i].args = (void *)array_arg_space;
+            profiled[i].dims = (void *)count_space;
+            profiled[i].steps = steps;
+            profiled[i].data = data;
+            profiled[i].profile = profile;
+            add_task_to_queue(slots[i], profiled_task, (void *)&profiled[i],
+                              NULL, NULL, NULL, i);
+        }
+        else
+        {
+            add_task_to_queue(slots[i], fn, (void *)array_arg_space,
+                              (void *)count_space, steps, data, i);
+        }
     }
 
     ready();
+}
+
+/* Wait for the region started by region_launch() to complete */
+static void
+region_finish(Region *region)
+{
     synchronize();
 
-    queue_count = old_queue_count;
+    if (region->profile)
+        profile_region_end(region->profile);
+    queue_count = region->old_queue_count;
+    region->complete = 1;
     // decrement the nest level
     _nesting_level -= 1;
 }
 
 static void
-add_task_internal(void *fn, void *args, void *dims, void *steps, void *data, int tid)
+complete_pending_region(void)
+{
+    region_finish(pending_region);
+    pending_region = NULL;
+}
+
+static int
+region_is_nested(void)
+{
+    // check the nesting level, if it's already 1 this is a nested parallel
+    // region. The workqueue cannot hand out work to the pool from within a
+    // parallel region as the pool's state is not threadsafe, so the nested
+    // region is run inline by the calling thread over the whole of its
+    // iteration space. The calling thread already has its TLS slots
+    // synchronized with the outer region so thread masks and thread ids
+    // remain valid for the nested kernel. A region launched asynchronously
+    // also holds the nesting level, a launch from outside of the pool first
+    // completes it.
+    if (pending_region && !_TLS_is_worker)
+    {
+        complete_pending_region();
+    }
+    return _nesting_level >= 1;
+}
+
+static void
+run_inline(void *fn, char **args, size_t *dimensions, size_t *steps, void *data)
+{
+    void (*func)(char **args, size_t *dims, size_t *steps, void *data) = fn;
+    if(_DEBUG)
+    {
+        printf("Nested parallel_for, running inline on thread %d\n",
+               get_thread_id());
+    }
+    func(args, dimensions, steps, data);
+}
+
+static void
+parallel_for(void *fn, char **args, size_t *dimensions, size_t *steps, void *data,
+             size_t inner_ndim, size_t array_count, int num_threads)
+{
+    Region region;
+
+    if (region_is_nested())
+    {
+        run_inline(fn, args, dimensions, steps, data);
+        return;
+    }
+    region.storage = alloca(region_storage_size(inner_ndim, array_count, num_threads));
+    region_launch(&region, fn, args, dimensions, steps, data, inner_ndim,
+                  array_count, num_threads);
+    region_finish(&region);
+}
+
+static void *
+parallel_for_async(void *fn, char **args, size_t *dimensions, size_t *steps,
+                   void *data, size_t inner_ndim, size_t array_count,
+                   int num_threads)
+{
+    Region *region;
+
+    if (region_is_nested())
+    {
+        run_inline(fn, args, dimensions, steps, data);
+        return NULL;
+    }
+    region = malloc(sizeof(Region) +
+                    region_storage_size(inner_ndim, array_count, num_threads));
+    if (!region)
+    {
+        // run it synchronously rather than fail the launch
+        parallel_for(fn, args, dimensions, steps, data, inner_ndim,
+                     array_count, num_threads);
+        return NULL;
+    }
+    region->storage = (char *)(region + 1);
+    region_launch(region, fn, args, dimensions, steps, data, inner_ndim,
+                  array_count, num_threads);
+    pending_region = region;
+    return region;
+}
+
+static int
+parallel_for_poll(void *handle)
+{
+    Region *region = (Region *)handle;
+    int i;
+
+    if (!region || region->complete)
+        return 1;
+    for (i = 0; i < queue_count; ++i)
+    {
+        if (WQ_LOAD(&queues[i].state) != DONE)
+            return 0;
+    }
+    return 1;
+}
+
+static void
+parallel_for_wait(void *handle)
+{
+    Region *region = (Region *)handle;
+
+    // The region may have been completed by a later launch already.
+    if (region && region == pending_region)
+    {
+        complete_pending_region();
+    }
+    free(region);
+}
+
+/* Queue a task running as thread id `tid` for the worker of queue `index` */
+static void
+add_task_to_queue(int index, void *fn, void *args, void *dims, void *steps,
+                  void *data, int tid)
 {
     void (*func)(void *args, void *dims, void *steps, void *data) = fn;
 
@@ -519,15 +1006,23 @@ add_task_internal(void *fn, void *args, void *dims, void *steps, void *data, int
         launch_threads(NUM_THREADS);
     }
 
-    Queue *queue = &queues[queue_pivot];
+    Queue *queue = &queues[index];
+
+    Task task;
+    task.func = func;
+    task.args = args;
+    task.dims = dims;
+    task.steps = steps;
+    task.data = data;
+    task.tid = tid;
+    task_queue_push(&queue->pending, &task);
+}
 
-    Task *task = &queue->task;
-    task->func = func;
-    task->args = args;
-    task->dims = dims;
-    task->steps = steps;
-    task->data = data;
-    task->tid = tid;
+/* Queue a task for the next worker in round robin order */
+static void
+add_task_internal(void *fn, void *args, void *dims, void *steps, void *data, int tid)
+{
+    add_task_to_queue(queue_pivot, fn, args, dims, steps, data, tid);
 
     /* Move pivot */
     if ( ++queue_pivot == queue_count )
@@ -548,6 +1043,10 @@ void thread_worker(void *arg)
     Queue *queue = (Queue*)arg;
     Task *task;
 
+    /* Worker i always serves queue i, so pin it to the CPU of slot i. */
+    pin_current_thread((int)(queue - queues));
+    _TLS_is_worker = 1;
+
     while (1)
     {
         /* Wait for the queue to be in READY state (i.e. for some task
@@ -555,11 +1054,15 @@ void thread_worker(void *arg)
          */
         queue_state_wait(queue, READY, RUNNING);
 
-        task = &queue->task;
-        set_thread_id(task->tid);
-        task->func(task->args, task->dims, task->steps, task->data);
+        /* Drain all the tasks queued for this worker. */
+        while ((task = task_queue_pop(&queue->pending)) != NULL)
+        {
+            set_thread_id(task->tid);
+            task->func(task->args, task->dims, task->steps, task->data);
+        }
+        task_queue_reset(&queue->pending);
 
-        /* Task is done. */
+        /* Tasks are done. */
         queue_state_wait(queue, RUNNING, DONE);
     }
 }
@@ -585,6 +1088,7 @@ static void launch_threads(int count)
         for (i = 0; i < count; ++i)
         {
             queue_condition_init(&queues[i].cond);
+            queues[i].spin = queue_max_spin;
             numba_new_thread(thread_worker, &queues[i]);
         }
 
@@ -622,6 +1126,14 @@ static void ready(void)
 
 static void reset_after_fork(void)
 {
+    int i;
+    if (queues)
+    {
+        for (i = 0; i < NUM_THREADS; ++i)
+        {
+            free(queues[i].pending.tasks);
+        }
+    }
     free(queues);
     queues = NULL;
     if (_INIT_NUM_THREADS != -1)
@@ -629,6 +1141,7 @@ static void reset_after_fork(void)
         NUM_THREADS = _INIT_NUM_THREADS;
     }
     _nesting_level = 0;
+    pending_region = NULL;
 }
 
 MOD_INIT(workqueue)
@@ -643,14 +1156,28 @@ MOD_INIT(workqueue)
     SetAttrStringFromVoidPointer(m, ready);
     SetAttrStringFromVoidPointer(m, add_task);
     SetAttrStringFromVoidPointer(m, parallel_for);
+    SetAttrStringFromVoidPointer(m, parallel_for_async);
+    SetAttrStringFromVoidPointer(m, parallel_for_poll);
+    SetAttrStringFromVoidPointer(m, parallel_for_wait);
     SetAttrStringFromVoidPointer(m, do_scheduling_signed);
     SetAttrStringFromVoidPointer(m, do_scheduling_unsigned);
+    SetAttrStringFromVoidPointer(m, get_schedule_cache_stats);
     SetAttrStringFromVoidPointer(m, set_num_threads);
     SetAttrStringFromVoidPointer(m, get_num_threads);
     SetAttrStringFromVoidPointer(m, get_thread_id);
     SetAttrStringFromVoidPointer(m, set_parallel_chunksize);
     SetAttrStringFromVoidPointer(m, get_parallel_chunksize);
     SetAttrStringFromVoidPointer(m, get_sched_size);
+    SetAttrStringFromVoidPointer(m, set_parallel_schedule);
+    SetAttrStringFromVoidPointer(m, get_parallel_schedule);
+    SetAttrStringFromVoidPointer(m, set_parallel_split_alignment);
+    SetAttrStringFromVoidPointer(m, get_parallel_split_alignment);
+    SetAttrStringFromVoidPointer(m, set_wait_spin);
+    SetAttrStringFromVoidPointer(m, set_thread_affinity);
+    SetAttrStringFromVoidPointer(m, set_region_profiling);
+    SetAttrStringFromVoidPointer(m, reset_region_profile);
+    SetAttrStringFromVoidPointer(m, get_region_profile_count);
+    SetAttrStringFromVoidPointer(m, get_region_profile);
 
     return MOD_SUCCESS_VAL(m);
 }
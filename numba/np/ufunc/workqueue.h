@@ -55,6 +55,24 @@ static void
 parallel_for(void *fn, char **args, size_t *dims, size_t *steps, void *data,\
              size_t inner_ndim, size_t array_count, int num_threads);
 
+/* Asynchronous parallel_for, the region is started and a handle to it is
+ returned without waiting for it to complete. args, dims, steps and data must
+ remain valid until the region completes. A NULL handle means the region has
+ already completed, e.g. it ran inline as a nested region.
+ */
+static void *
+parallel_for_async(void *fn, char **args, size_t *dims, size_t *steps,
+                   void *data, size_t inner_ndim, size_t array_count,
+                   int num_threads);
+
+/* Returns non-zero if the region of the handle has completed */
+static int
+parallel_for_poll(void *handle);
+
+/* Wait for the region of the handle to complete and release the handle */
+static void
+parallel_for_wait(void *handle);
+
 
 /* Masking API cf. OpenMP */
 static void
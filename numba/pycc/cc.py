@@ -68,6 +68,7 @@ class CC(object):
         self._output_dir = os.path.dirname(self._source_path)
         self._output_file = self._toolchain.get_ext_filename(extension_name)
         self._use_nrt = True
+        self._lazy_environments = True
         self._target_cpu = ''
 
     @property
@@ -107,6 +108,18 @@ class CC(object):
     def use_nrt(self, value):
         self._use_nrt = value
 
+    @property
+    def lazy_environments(self):
+        """
+        Whether the environments of the exported functions are recreated on
+        their first call rather than when the extension module is imported.
+        """
+        return self._lazy_environments
+
+    @lazy_environments.setter
+    def lazy_environments(self, value):
+        self._lazy_environments = value
+
     @property
     def target_cpu(self):
         """
@@ -162,6 +175,7 @@ class CC(object):
         return [
             ('PYCC_MODULE_NAME', self._basename),
             ('PYCC_USE_NRT', int(self._use_nrt)),
+            ('PYCC_LAZY_ENV', int(self._lazy_environments)),
             ]
 
     def _get_extra_cflags(self):
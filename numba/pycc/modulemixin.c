@@ -58,6 +58,10 @@ VISIBILITY_HIDDEN void **PYCC(_unused_) = {
     (void *) Numba_make_generator,
 };
 
+#ifndef PYCC_LAZY_ENV
+#define PYCC_LAZY_ENV 0
+#endif
+
 /* The structure type constructed by PythonAPI.serialize_uncached() */
 typedef struct {
     const char *data;
@@ -72,7 +76,7 @@ typedef void **env_gv_t;
  * Recreate an environment object from a env_def_t structure.
  */
 static EnvironmentObject *
-recreate_environment(PyObject *module, env_def_t env)
+recreate_environment(PyObject *globals, env_def_t env)
 {
     EnvironmentObject *envobj;
     PyObject *env_consts;
@@ -94,15 +98,102 @@ recreate_environment(PyObject *module, env_def_t env)
         return NULL;
     }
     envobj->consts = env_consts;
-    envobj->globals = PyModule_GetDict(module);
-    if (envobj->globals == NULL) {
-        Py_DECREF(envobj);
-        return NULL;
-    }
+    envobj->globals = globals;
     Py_INCREF(envobj->globals);
     return envobj;
 }
 
+#if PYCC_LAZY_ENV
+
+/*
+ * Lazy environments: the closures of the exported functions are created
+ * without an environment and call lazy_env_trampoline(), which recreates
+ * the environment on the first call, stores it in the closure and in the
+ * environment global, then redirects the closure to the compiled wrapper.
+ * The closure's keepalive is a (globals, capsule of lazy_env_t) tuple.
+ */
+typedef struct {
+    env_def_t def;
+    env_gv_t gv;
+    PyCFunction meth;
+} lazy_env_t;
+
+static const char lazy_env_capsule_name[] = "numba.pycc.lazy_env";
+
+static void
+lazy_env_capsule_dtor(PyObject *capsule)
+{
+    PyMem_Free(PyCapsule_GetPointer(capsule, lazy_env_capsule_name));
+}
+
+static PyObject *
+lazy_env_trampoline(PyObject *self, PyObject *args, PyObject *kws)
+{
+    ClosureObject *clo = (ClosureObject *) self;
+    lazy_env_t *lazy;
+    EnvironmentObject *envobj;
+
+    lazy = (lazy_env_t *) PyCapsule_GetPointer(
+        PyTuple_GET_ITEM(clo->keepalive, 1), lazy_env_capsule_name);
+    if (lazy == NULL)
+        return NULL;
+    if (clo->env == NULL) {
+        envobj = recreate_environment(PyTuple_GET_ITEM(clo->keepalive, 0),
+                                      lazy->def);
+        if (envobj == NULL)
+            return NULL;
+        /* Unpickling may have released the GIL and let another thread
+           set the environment first */
+        if (clo->env == NULL) {
+            *lazy->gv = envobj;
+            clo->env = envobj;
+            clo->def.ml_meth = lazy->meth;
+        }
+        else {
+            Py_DECREF(envobj);
+        }
+    }
+    return ((PyCFunctionWithKeywords) lazy->meth)(self, args, kws);
+}
+
+/*
+ * Create the closure of an exported function whose environment is
+ * recreated on its first call.
+ */
+static PyObject *
+lazy_pycfunction_new(PyObject *module, PyObject *nameobj, PyObject *docobj,
+                     PyMethodDef *fdef, env_def_t env, env_gv_t envgv)
+{
+    lazy_env_t *lazy;
+    PyObject *capsule, *keepalive, *func;
+
+    lazy = (lazy_env_t *) PyMem_Malloc(sizeof(lazy_env_t));
+    if (lazy == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    lazy->def = env;
+    lazy->gv = envgv;
+    lazy->meth = fdef->ml_meth;
+    capsule = PyCapsule_New(lazy, lazy_env_capsule_name,
+                            lazy_env_capsule_dtor);
+    if (capsule == NULL) {
+        PyMem_Free(lazy);
+        return NULL;
+    }
+    keepalive = PyTuple_Pack(2, PyModule_GetDict(module), capsule);
+    Py_DECREF(capsule);
+    if (keepalive == NULL)
+        return NULL;
+    func = pycfunction_new(module, nameobj, docobj,
+                           (PyCFunction) lazy_env_trampoline, NULL,
+                           keepalive);
+    Py_DECREF(keepalive);
+    return func;
+}
+
+#endif  /* PYCC_LAZY_ENV */
+
 /*
  * Subroutine to initialize all resources required for running the
  * pycc-compiled functions.
@@ -161,23 +252,31 @@ PYCC(pycc_init_) (PyObject *module, PyMethodDef *defs,
     for (i = 0, fdef = defs; fdef->ml_name != NULL; i++, fdef++) {
         PyObject *func;
         PyObject *nameobj;
-        EnvironmentObject *envobj;
 
-        envobj = recreate_environment(module, envs[i]);
-        if (envobj == NULL) {
-            goto error;
-        }
         nameobj = PyString_FromString(fdef->ml_name);
         if (nameobj == NULL) {
-            Py_DECREF(envobj);
             goto error;
         }
-        // Store the environment pointer into the global
-        *envgvs[i] = envobj;
+#if PYCC_LAZY_ENV
+        func = lazy_pycfunction_new(module, nameobj, docobj, fdef,
+                                    envs[i], envgvs[i]);
+#else
+        {
+            EnvironmentObject *envobj;
+
+            envobj = recreate_environment(PyModule_GetDict(module), envs[i]);
+            if (envobj == NULL) {
+                Py_DECREF(nameobj);
+                goto error;
+            }
+            // Store the environment pointer into the global
+            *envgvs[i] = envobj;
 
-        func = pycfunction_new(module, nameobj, docobj,
-                               fdef->ml_meth, envobj, NULL);
-        Py_DECREF(envobj);
+            func = pycfunction_new(module, nameobj, docobj,
+                                   fdef->ml_meth, envobj, NULL);
+            Py_DECREF(envobj);
+        }
+#endif
         Py_DECREF(nameobj);
 
         if (func == NULL) {
@@ -4,12 +4,14 @@ Testing C implementation of the numba dictionary
 
 import ctypes
 import random
+import threading
 
 from numba.tests.support import TestCase
 from numba import generated_jit, _helperlib, jit, typed, types
 from numba.core.config import IS_32BITS
 from numba.core.datamodel.models import UniTupleModel
 from numba.extending import register_model, typeof_impl, unbox
+from numba.typed import dictobject
 
 
 DKIX_EMPTY = -1
@@ -604,6 +606,30 @@ class TestDictImpl(TestCase):
         for i in range(1, 8):
             self.check_sizing(key_size=i, val_size=i, nmax=2**i)
 
+    def test_pod_key_sizes(self):
+        # Keys of 4, 8 and 16 bytes are compared by the specialized kernels,
+        # the keys only differ in their last bytes
+        nmax = 1000
+        for key_size in (4, 8, 16):
+            d = Dict(self, key_size, 8)
+
+            def make_key(v):
+                return "{:0{}}".format(v, key_size)
+
+            def make_val(v):
+                return "{:08}".format(v)
+
+            for i in range(nmax):
+                d[make_key(i)] = make_val(i)
+            for i in range(0, nmax, 2):
+                del d[make_key(i)]
+            self.assertEqual(len(d), nmax // 2)
+            for i in range(nmax):
+                if i % 2:
+                    self.assertEqual(d[make_key(i)], make_val(i))
+                else:
+                    self.assertIsNone(d.get(make_key(i)))
+
     def test_parametrized_types(self):
         """https://github.com/numba/numba/issues/6401"""
 
@@ -649,3 +675,212 @@ class TestDictImpl(TestCase):
 
         for ii in range(50):  # <- sometimes works a few times
             self.assertIsNone(set_parametrized_data(x, y))
+
+
+class TestDictImplSwiss(TestDictImpl):
+    """Runs the tests of TestDictImpl with the swiss layout.
+    """
+    def setUp(self):
+        super().setUp()
+        previous = dictobject.set_default_layout(dictobject.Layout.SWISS)
+        self.addCleanup(dictobject.set_default_layout, previous)
+
+    def test_layout(self):
+        proto = ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_void_p)
+        dict_layout = proto(_helperlib.c_helpers['dict_layout'])
+        d = Dict(self, 8, 8)
+        self.assertEqual(dict_layout(d.dp), dictobject.Layout.SWISS)
+
+    def test_delete_reinsert(self):
+        # The deleted slots are reused by the new keys
+        d = Dict(self, 8, 8)
+        nmax = 2000
+
+        def make_key(v):
+            return "k_{:06x}".format(v)
+
+        def make_val(v):
+            return "v_{:06x}".format(v)
+
+        for i in range(nmax):
+            d[make_key(i)] = make_val(i)
+        for i in range(nmax):
+            if i % 3:
+                del d[make_key(i)]
+        for i in range(nmax, 2 * nmax):
+            d[make_key(i)] = make_val(i)
+
+        expected = [i for i in range(nmax) if i % 3 == 0]
+        expected += list(range(nmax, 2 * nmax))
+        self.assertEqual(len(d), len(expected))
+        present = set(expected)
+        for i in range(2 * nmax):
+            if i in present:
+                self.assertEqual(d[make_key(i)], make_val(i))
+            else:
+                self.assertIsNone(d.get(make_key(i)))
+        # Insertion order is kept
+        self.assertEqual(list(d.items()),
+                         [(make_key(i), make_val(i)) for i in expected])
+
+
+class TestConcurrentDictImpl(TestCase):
+    """Tests of the concurrent dict and of the update and merge operations,
+    with int64 keys and values.
+    """
+    def setUp(self):
+        dict_t = ctypes.c_void_p
+        ptr_t = ctypes.c_void_p
+        hash_t = ctypes.c_ssize_t
+        status_t = ctypes.c_int
+
+        def wrap(name, restype, argtypes=()):
+            proto = ctypes.CFUNCTYPE(restype, *argtypes)
+            return proto(_helperlib.c_helpers[name])
+
+        self.dict_new_minsize = wrap(
+            'dict_new_minsize', status_t,
+            [ctypes.POINTER(dict_t), ctypes.c_ssize_t, ctypes.c_ssize_t],
+        )
+        self.dict_free = wrap('dict_free', None, [dict_t])
+        self.dict_length = wrap('dict_length', ctypes.c_ssize_t, [dict_t])
+        self.dict_lookup = wrap(
+            'dict_lookup', ctypes.c_ssize_t, [dict_t, ptr_t, hash_t, ptr_t],
+        )
+        self.dict_update = wrap(
+            'dict_update', status_t, [dict_t, ptr_t, hash_t, ptr_t, ptr_t],
+        )
+        self.dict_merge = wrap('dict_merge', status_t, [dict_t, dict_t, ptr_t])
+        self.cdict_new = wrap(
+            'cdict_new', status_t,
+            [ctypes.POINTER(dict_t), ctypes.c_ssize_t, ctypes.c_ssize_t,
+             ctypes.c_ssize_t],
+        )
+        self.cdict_free = wrap('cdict_free', None, [dict_t])
+        self.cdict_length = wrap('cdict_length', ctypes.c_ssize_t, [dict_t])
+        self.cdict_nshards = wrap('cdict_nshards', ctypes.c_ssize_t, [dict_t])
+        self.cdict_shard = wrap(
+            'cdict_shard', dict_t, [dict_t, ctypes.c_ssize_t],
+        )
+        self.cdict_lookup = wrap(
+            'cdict_lookup', ctypes.c_ssize_t, [dict_t, ptr_t, hash_t, ptr_t],
+        )
+        self.cdict_insert = wrap(
+            'cdict_insert', status_t, [dict_t, ptr_t, hash_t, ptr_t, ptr_t],
+        )
+        self.cdict_update = wrap(
+            'cdict_update', status_t, [dict_t, ptr_t, hash_t, ptr_t, ptr_t],
+        )
+        self.cdict_merge_shard = wrap(
+            'cdict_merge_shard', status_t,
+            [dict_t, ctypes.c_ssize_t, dict_t, ptr_t],
+        )
+        self.add_int64 = _helperlib.c_helpers['dict_update_add_int64']
+
+    def new_dict(self):
+        dp = ctypes.c_void_p()
+        self.assertEqual(self.dict_new_minsize(ctypes.byref(dp), 8, 8), 0)
+        self.addCleanup(self.dict_free, dp)
+        return dp
+
+    def new_cdict(self, nshards):
+        cdp = ctypes.c_void_p()
+        status = self.cdict_new(ctypes.byref(cdp), nshards, 8, 8)
+        self.assertEqual(status, 0)
+        self.addCleanup(self.cdict_free, cdp)
+        return cdp
+
+    def lookup(self, fn, dp, key):
+        k, v = ctypes.c_int64(key), ctypes.c_int64()
+        ix = fn(dp, ctypes.byref(k), hash(key), ctypes.byref(v))
+        return v.value if ix > DKIX_EMPTY else None
+
+    def update(self, fn, dp, key, value, op):
+        k, v = ctypes.c_int64(key), ctypes.c_int64(value)
+        return fn(dp, ctypes.byref(k), hash(key), ctypes.byref(v), op)
+
+    def test_update(self):
+        dp = self.new_dict()
+        self.assertEqual(self.update(self.dict_update, dp, 1, 10,
+                                     self.add_int64), 0)
+        self.assertEqual(self.update(self.dict_update, dp, 1, 5,
+                                     self.add_int64), 1)
+        self.assertEqual(self.lookup(self.dict_lookup, dp, 1), 15)
+        # no update operation replaces the value
+        self.assertEqual(self.update(self.dict_update, dp, 1, 7, None), 1)
+        self.assertEqual(self.lookup(self.dict_lookup, dp, 1), 7)
+        self.assertEqual(self.dict_length(dp), 1)
+
+    def test_basic(self):
+        cdp = self.new_cdict(5)
+        self.assertEqual(self.cdict_nshards(cdp), 8)
+        for i in range(100):
+            k, v = ctypes.c_int64(i), ctypes.c_int64(i)
+            old = ctypes.c_int64()
+            status = self.cdict_insert(cdp, ctypes.byref(k), hash(i),
+                                       ctypes.byref(v), ctypes.byref(old))
+            self.assertEqual(status, 0)
+        for i in range(0, 100, 2):
+            self.assertEqual(self.update(self.cdict_update, cdp, i, 1,
+                                         self.add_int64), 1)
+        self.assertEqual(self.cdict_length(cdp), 100)
+        for i in range(100):
+            self.assertEqual(self.lookup(self.cdict_lookup, cdp, i),
+                             i + (i % 2 == 0))
+        self.assertIsNone(self.lookup(self.cdict_lookup, cdp, 100))
+        # the keys are spread over the shards
+        lengths = [self.dict_length(self.cdict_shard(cdp, i))
+                   for i in range(8)]
+        self.assertEqual(sum(lengths), 100)
+        self.assertGreater(min(lengths), 0)
+
+    def test_threads(self):
+        cdp = self.new_cdict(4)
+        nthreads, nkeys = 4, 500
+
+        def work():
+            for i in range(nkeys):
+                self.update(self.cdict_update, cdp, i, 1, self.add_int64)
+
+        threads = [threading.Thread(target=work) for _ in range(nthreads)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        self.assertEqual(self.cdict_length(cdp), nkeys)
+        for i in range(nkeys):
+            self.assertEqual(self.lookup(self.cdict_lookup, cdp, i), nthreads)
+
+    def test_merge(self):
+        # Merge per-thread dicts into a concurrent dict, a thread per shard,
+        # then collect the shards into a single dict
+        nparts, nkeys = 3, 300
+        parts = [self.new_dict() for _ in range(nparts)]
+        for j, dp in enumerate(parts):
+            for i in range(j, nkeys):
+                self.update(self.dict_update, dp, i, j + 1, None)
+
+        cdp = self.new_cdict(4)
+        nshards = self.cdict_nshards(cdp)
+
+        def merge(shard):
+            for dp in parts:
+                status = self.cdict_merge_shard(cdp, shard, dp,
+                                                self.add_int64)
+                self.assertEqual(status, 0)
+
+        threads = [threading.Thread(target=merge, args=(i,))
+                   for i in range(nshards)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+
+        out = self.new_dict()
+        for i in range(nshards):
+            self.assertEqual(self.dict_merge(out, self.cdict_shard(cdp, i),
+                                             None), 0)
+        self.assertEqual(self.dict_length(out), nkeys)
+        for i in range(nkeys):
+            expect = sum(j + 1 for j in range(nparts) if j <= i)
+            self.assertEqual(self.lookup(self.dict_lookup, out, i), expect)
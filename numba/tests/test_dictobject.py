@@ -11,15 +11,16 @@ import warnings
 
 import numpy as np
 
-from numba import njit, literally
+from numba import njit, literally, prange
 from numba import int32, int64, float32, float64
 from numba import typeof
-from numba.typed import Dict, dictobject
+from numba.typed import Dict, dictobject, concurrentdict
 from numba.typed.typedobjectutils import _sentry_safe_cast
 from numba.core.errors import TypingError
 from numba.core import types
 from numba.tests.support import (TestCase, MemoryLeakMixin, unittest,
-                                 override_config, forbid_codegen)
+                                 override_config, forbid_codegen,
+                                 skip_parfors_unsupported)
 from numba.experimental import jitclass
 from numba.extending import overload
 
@@ -1179,6 +1180,72 @@ class TestTypedDict(MemoryLeakMixin, TestCase):
         if prefix:
             self.assertTrue(strfn(nbd).startswith('DictType'))
 
+    def test_insert_lookup_many(self):
+        keys = np.arange(0, 2000, 2, dtype=np.int64)
+        values = keys * 0.5
+
+        @njit
+        def fill(keys, values):
+            d = Dict.empty(int64, float64)
+            d.insert_many(keys, values)
+            return d
+
+        d = fill(keys, values)
+        self.assertEqual(dict(d), dict(zip(keys.tolist(), values.tolist())))
+
+        # a strided view of the keys, half of them missing
+        probe = np.arange(0, 4000, 2, dtype=np.int64)[::-1]
+        expect = np.array([d.get(k, -1.0) for k in probe])
+        np.testing.assert_equal(d.lookup_many(probe, -1.0), expect)
+
+        # replacing values
+        d.insert_many(keys[:10], values[:10] + 1)
+        self.assertEqual(d[keys[0]], values[0] + 1)
+        self.assertEqual(len(d), len(keys))
+
+        with self.assertRaises(ValueError) as raises:
+            d.insert_many(keys[:3], values[:2])
+        self.assertIn('same length', str(raises.exception))
+
+        with self.assertRaises(TypingError) as raises:
+            d.insert_many(keys.astype(np.int32), values)
+        self.assertIn('keys must be an array of int64', str(raises.exception))
+
+    def test_reserve_compact(self):
+        @njit
+        def fill(n):
+            d = Dict.empty(int64, int64, n_keys=n)
+            for i in range(n):
+                d[i] = i
+            return d
+
+        @njit
+        def drop(d, step):
+            for i in range(len(d)):
+                if i % step:
+                    del d[i]
+            d.compact()
+
+        d = fill(1000)
+        self.assertEqual(dict(d), {i: i for i in range(1000)})
+        drop(d, 10)
+        self.assertEqual(list(d.items()), [(i, i) for i in range(0, 1000, 10)])
+        # the dict is usable after compacting
+        d[1] = 2
+        self.assertEqual(d[1], 2)
+        self.assertEqual(len(d), 101)
+
+        d = Dict.empty(int64, int64, n_keys=10)
+        d.reserve(500)
+        for i in range(500):
+            d[i] = -i
+        d.compact()
+        self.assertEqual(dict(d), {i: -i for i in range(500)})
+
+        with self.assertRaises(RuntimeError) as raises:
+            fill(-1)
+        self.assertIn('expecting *n_keys* to be >= 0', str(raises.exception))
+
     def test_repr(self):
         self.check_stringify(repr, prefix=True)
 
@@ -2425,5 +2492,92 @@ class TestLiteralStrKeyDict(MemoryLeakMixin, TestCase):
         )
 
 
+class TestConcurrentDict(MemoryLeakMixin, TestCase):
+    """Exercise the concurrent dictionary from jitted code. """
+
+    def test_concurrent_dict_basic(self):
+        @njit
+        def foo(n):
+            d = concurrentdict.new_concurrent_dict(int64, float64, 4)
+            for i in range(n):
+                d[i] = i + 0.5
+            # replace a value
+            d[3] = -1.0
+            return (len(d), d[3], d[n - 1], d.get(n, -2.0), d.get(0),
+                    n - 1 in d, n in d)
+
+        self.assertEqual(foo(100), (100, -1.0, 99.5, -2.0, 0.5, True, False))
+
+    def test_concurrent_dict_getitem_missing(self):
+        @njit
+        def foo(k):
+            d = concurrentdict.new_concurrent_dict(int64, int64)
+            d[1] = 2
+            return d[k]
+
+        self.assertEqual(foo(1), 2)
+        with self.assertRaises(KeyError):
+            foo(2)
+
+    def test_concurrent_dict_cast(self):
+        @njit
+        def foo():
+            d = concurrentdict.new_concurrent_dict(int64, float64)
+            d[int32(7)] = 3
+            return d[7], d.get(int32(7))
+
+        self.assertEqual(foo(), (3.0, 3.0))
+
+    def test_concurrent_dict_refcounted_types(self):
+        @njit
+        def foo():
+            return concurrentdict.new_concurrent_dict(types.unicode_type,
+                                                      int64)
+
+        with self.assertRaises(TypingError) as raises:
+            foo()
+        self.assertIn("concurrent dicts can't hold values that are "
+                      "reference counted", str(raises.exception))
+
+    @skip_parfors_unsupported
+    def test_concurrent_dict_prange_inserts(self):
+        @njit(parallel=True)
+        def foo(n):
+            d = concurrentdict.new_concurrent_dict(int64, float64)
+            for i in prange(n):
+                d[i] = i * 0.5
+            out = np.empty(n)
+            for i in prange(n):
+                out[i] = d[i]
+            return len(d), out
+
+        n = 10000
+        length, out = foo(n)
+        self.assertEqual(length, n)
+        np.testing.assert_equal(out, np.arange(n) * 0.5)
+
+    @skip_parfors_unsupported
+    def test_concurrent_dict_prange_colliding_inserts(self):
+        # every iteration writes one of a few keys, so the threads contend
+        # on the same shards
+        @njit(parallel=True)
+        def foo(n, m):
+            d = concurrentdict.new_concurrent_dict(int64, int64)
+            for i in prange(n):
+                d[i % m] = i % m
+            total = 0
+            for k in range(m):
+                total += d[k]
+            return len(d), total
+
+        self.assertEqual(foo(10000, 7), (7, sum(range(7))))
+
+    def test_concurrent_dict_no_jit(self):
+        with override_config('DISABLE_JIT', True):
+            with forbid_codegen():
+                d = concurrentdict.new_concurrent_dict(int64, float64)
+                self.assertEqual(type(d), dict)
+
+
 if __name__ == '__main__':
     unittest.main()
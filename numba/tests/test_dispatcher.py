@@ -2,6 +2,7 @@ import multiprocessing
 import platform
 import threading
 import pickle
+import json
 import weakref
 from itertools import chain
 from io import StringIO
@@ -179,6 +180,211 @@ class TestDispatcher(BaseTest):
         self.assertEqual(len(foo.overloads), 4, "didn't compile a new "
                                                 "version")
 
+    def test_resolution_cache(self):
+        # Repeated calls are resolved from a cache, which must follow the
+        # changes to the overloads and to the compilation mode
+        @jit(nopython=True)
+        def foo(x):
+            return x
+
+        for _ in range(3):
+            self.assertPreciseEqual(foo(1.5), 1.5)
+        self.assertEqual(len(foo.overloads), 1)
+        for _ in range(3):
+            self.assertPreciseEqual(foo(1), 1)
+        self.assertEqual(len(foo.overloads), 2)
+        foo.disable_compile()
+        # int32 converts to int64 once compilation is disabled
+        for _ in range(3):
+            self.assertPreciseEqual(foo(np.int32(2)), 2)
+        self.assertEqual(len(foo.overloads), 2)
+        foo.disable_compile(False)
+        self.assertEqual(foo(np.int32(2)), 2)
+        self.assertEqual(len(foo.overloads), 3)
+
+    def test_vectorcall(self):
+        # Calls with exactly the positional arguments take the vectorcall
+        # fast path, the others go through tp_call
+        @jit(nopython=True)
+        def foo(a, b=2):
+            return a + b
+
+        tp_call = type(foo).__call__
+        for args, kws in [((1, 2), {}), ((1,), {}), ((1,), {'b': 3}),
+                          ((), {'a': 1.5, 'b': 2}), ((1.5, 2), {})]:
+            self.assertPreciseEqual(foo(*args, **kws),
+                                    tp_call(foo, *args, **kws))
+        self.assertEqual(len(foo.overloads), 2)
+        with self.assertRaises(TypeError):
+            foo(1, 2, 3)
+
+    def test_scalar_tuple_typecodes(self):
+        # Bools and small tuples of scalars get their typecodes from
+        # direct lookup tables, which must agree with typeof()
+        @jit(nopython=True)
+        def foo(x):
+            return x
+
+        class MyFloat(float):
+            pass
+
+        values = [True, (), (1,), (1, 2.5), (1.5, 2), (True, 1j, 2, 3.0),
+                  (1,) * 16, (1,) * 17, (1, 2, 3, 4, 5.5), (1, (2,)),
+                  (MyFloat(1.5), 2.5)]
+        for val in values:
+            for _ in range(2):
+                self.assertEqual(foo(val), val)
+        self.assertEqual(len(foo.overloads), len(values))
+        self.assertEqual(set(foo.signatures),
+                         set((typeof(v),) for v in values))
+
+    def test_array_typecodes(self):
+        # Arrays whose typecode comes from the tables of cached typecodes
+        # must get the same type as from typeof()
+        @jit(nopython=True)
+        def foo(x):
+            return x.ndim
+
+        rec_dtype = np.dtype([('a', np.int32), ('b', np.float64)])
+        readonly = np.zeros(3, dtype=rec_dtype)
+        readonly.flags.writeable = False
+        arrays = [np.zeros(()), np.zeros(3, dtype=np.bool_),
+                  np.zeros((1,) * 7), np.zeros((1,) * 10),
+                  np.zeros(3, dtype='M8[ns]'), np.zeros(3, dtype='m8[s]'),
+                  np.zeros(3, dtype=rec_dtype), readonly,
+                  np.zeros(3, dtype=np.longlong)]
+        for arr in arrays:
+            for _ in range(2):
+                self.assertEqual(foo(arr), arr.ndim)
+                # an equal but distinct dtype
+                self.assertEqual(foo(arr.astype(arr.dtype.str
+                                                if arr.dtype.names is None
+                                                else rec_dtype)), arr.ndim)
+        self.assertEqual(set(foo.signatures),
+                         set((typeof(a),) for a in arrays))
+
+        @jit(nopython=True)
+        def bar(r):
+            return r.a
+
+        rec = np.ones(2, dtype=rec_dtype)[0]
+        for _ in range(2):
+            self.assertEqual(bar(rec), 1)
+        self.assertEqual(len(bar.overloads), 1)
+
+    def test_registered_typecodes(self):
+        # Typed containers and jitclass instances get their typecode
+        # natively, which must agree with typeof()
+        from numba.typed import List, Dict
+        from numba.experimental import jitclass
+
+        @jitclass([('x', types.intp)])
+        class Point(object):
+            def __init__(self, x):
+                self.x = x
+
+        @jit(nopython=True)
+        def foo(x):
+            return len(x)
+
+        @jit(nopython=True)
+        def bar(p):
+            return p.x
+
+        lst_int = List([1, 2])
+        lst_float = List([1.5])
+        dct = Dict()
+        dct[1] = 2.5
+        for _ in range(2):
+            self.assertEqual(foo(lst_int), 2)
+            self.assertEqual(foo(List([3])), 1)
+            self.assertEqual(foo(lst_float), 1)
+            self.assertEqual(foo(dct), 1)
+            self.assertEqual(bar(Point(3)), 3)
+        self.assertEqual(set(foo.signatures),
+                         set((typeof(v),) for v in (lst_int, lst_float, dct)))
+        self.assertEqual(len(bar.overloads), 1)
+
+    def test_call_batch(self):
+        @jit(nopython=True)
+        def foo(a, b=2):
+            return a + b
+
+        args = [(1, 2), (3, 4), (1.5, 2), (5,), (6, 7)]
+        expected = [foo(*a) for a in args]
+        self.assertPreciseEqual(foo.call_batch(args), expected)
+        self.assertPreciseEqual(foo.call_batch(iter(args)), expected)
+        self.assertEqual(foo.call_batch([]), [])
+        # compiles the new signatures
+        self.assertPreciseEqual(foo.call_batch([(np.int8(1), 2)]), [3])
+
+        out = np.zeros(len(args))
+        self.assertIs(foo.call_batch(args, out), out)
+        self.assertPreciseEqual(out, np.array(expected, dtype=np.float64))
+
+        with self.assertRaises(ValueError):
+            foo.call_batch(args, np.zeros(2))
+        with self.assertRaises(TypeError):
+            foo.call_batch([1, 2])
+        with self.assertRaises(TypeError):
+            foo.call_batch([(1, 2, 3)])
+
+    def test_call_batch_nullary(self):
+        @jit(nopython=True)
+        def foo():
+            return 42
+
+        foo.enable_stats()
+        self.assertEqual(foo.call_batch([(), (), ()]), [42] * 3)
+        stats = foo.get_stats()
+        self.assertEqual(stats['calls'], 3)
+        self.assertEqual(stats['compiles'], 1)
+        self.assertEqual(stats['overloads'], {(): 2})
+        self.assertEqual(stats['cache_misses'], 0)
+
+    def test_stats(self):
+        @jit(nopython=True)
+        def foo(x):
+            return x
+
+        self.assertIsNone(foo.get_stats())
+        foo.enable_stats(sample_interval=2)
+        for _ in range(3):
+            foo(1)
+        foo(x=1.5)
+        foo(2.5)
+        stats = foo.get_stats()
+        self.assertEqual(stats['calls'], 5)
+        self.assertEqual(stats['misses'], 2)
+        self.assertEqual(stats['compiles'], 2)
+        self.assertEqual(stats['fallbacks'], 0)
+        # the compiling calls aren't counted as calls of their overload
+        self.assertEqual(stats['overloads'],
+                         {(types.intp,): 2, (types.float64,): 1})
+        self.assertEqual(stats['sample_interval'], 2)
+        self.assertGreater(stats['samples'], 0)
+        self.assertGreaterEqual(stats['dispatch_ns'],
+                                stats['dispatch_max_ns'])
+
+        foo.reset_stats()
+        self.assertEqual(foo.get_stats()['calls'], 0)
+        self.assertEqual(foo.get_stats()['overloads'], {})
+        foo.enable_stats(False)
+        self.assertIsNone(foo.get_stats())
+
+    def test_stats_cache_misses(self):
+        @jit(nopython=True)
+        def foo(x):
+            return x
+
+        foo.enable_stats()
+        foo(1)      # there are no overloads to look up
+        foo(1)      # misses, then is cached
+        foo(1)
+        foo(1.5)    # misses once, although it is resolved again to compile
+        foo(1.5)    # the new overload emptied the cache
+        self.assertEqual(foo.get_stats()['cache_misses'], 3)
+
     def test_lock(self):
         """
         Test that (lazy) compiling from several threads at once doesn't
@@ -568,6 +774,27 @@ class TestDispatcher(BaseTest):
         self.assertIn(f"{type(BaseTest)}", err_msg)
 
 
+class TestDispatchBenchmark(TestCase):
+
+    def test_run(self):
+        from numba.misc import dispatch_benchmark
+
+        names = set(c.name for c in dispatch_benchmark.make_cases())
+        self.assertIn('positional/argc=32', names)
+        self.assertIn('overloads/count=64', names)
+        self.assertIn('tracing/on', names)
+
+        out = dispatch_benchmark.run('argc=1', repeat=1, min_time=1e-4)
+        # must be JSON serializable
+        out = json.loads(json.dumps(out))
+        results = out['results']
+        self.assertGreater(len(results), 0)
+        for res in results:
+            self.assertIn('argc=1', res['name'])
+            self.assertGreaterEqual(res['ns_per_call'], 0)
+            self.assertGreaterEqual(res['calls'], 1)
+
+
 class TestSignatureHandling(BaseTest):
     """
     Test support for various parameter passing styles.
@@ -367,6 +367,42 @@ class TestGenerators(MemoryLeakMixin, TestCase):
         got = list(njit(pyfunc)())
         self.assertEqual(expected, got)
 
+    def test_fill(self):
+        @njit
+        def squares(n):
+            for i in range(n):
+                yield i * i
+
+        @njit
+        def halves(n):
+            for i in range(n):
+                if i == 5:
+                    raise ValueError("five")
+                yield i / 2
+
+        # Arrays of the yielded type are filled natively, others item by item
+        for dtype in (np.int64, np.float64, np.int8):
+            gen = squares(10)
+            out = np.zeros(4, dtype=dtype)
+            self.assertEqual(gen.fill(out), 4)
+            self.assertPreciseEqual(out, np.arange(4, dtype=dtype) ** 2)
+            view = np.zeros(8, dtype=dtype)[::2]
+            self.assertEqual(gen.fill(view), 4)
+            self.assertPreciseEqual(view, np.arange(4, 8, dtype=dtype) ** 2)
+            lst = [None] * 3
+            self.assertEqual(gen.fill(lst), 2)
+            self.assertEqual(lst, [64, 81, None])
+            self.assertEqual(gen.fill(out), 0)
+            self.assertEqual(list(gen), [])
+
+        gen = halves(10)
+        out = np.zeros(3)
+        self.assertEqual(gen.fill(out), 3)
+        self.assertPreciseEqual(out, np.array([0.0, 0.5, 1.0]))
+        with self.assertRaises(ValueError) as raises:
+            gen.fill(out)
+        self.assertEqual(str(raises.exception), "five")
+
 
 def nrt_gen0(ary):
     for elem in ary:
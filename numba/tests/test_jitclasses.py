@@ -361,6 +361,59 @@ class TestJitClass(TestCase, MemoryLeakMixin):
         self.assertEqual(cstruct.b, st.b)
         self.assertEqual(cstruct.c, st.c)
 
+    def test_native_field_access(self):
+        spec = OrderedDict()
+        spec["a"] = int32
+        spec["b"] = types.uint8
+        spec["c"] = float32
+        spec["d"] = boolean
+        spec["e"] = types.complex128
+        spec["f"] = types.float64[:]
+
+        @jitclass(spec)
+        class Struct(object):
+
+            def __init__(self):
+                self.a = 1
+                self.b = 2
+                self.c = 3.0
+                self.d = False
+                self.e = 4j
+                self.f = np.zeros(2)
+
+            def total(self):
+                return self.a + self.b + self.c + self.d + self.e.imag
+
+        st = Struct()
+        cls = type(st)
+        for name in "abcde":
+            self.assertIsInstance(getattr(cls, name), _box.FieldDescriptor)
+        self.assertIsInstance(cls.f, property)
+
+        self.assertEqual((st.a, st.b, st.c, st.d, st.e),
+                         (1, 2, 3.0, False, 4j))
+        self.assertIs(type(st.a), int)
+        self.assertIs(type(st.d), bool)
+
+        st.a = -7
+        st.b = 258
+        st.c = 0.5
+        st.d = True
+        st.e = 1
+        self.assertEqual((st.a, st.b, st.c, st.d, st.e),
+                         (-7, 2, 0.5, True, 1))
+        # the writes are seen by compiled code
+        self.assertPreciseEqual(st.total(), -7 + 2 + 0.5 + 1 + 0.0)
+
+        # values not handled natively go through the compiled setter
+        st.a = np.int64(5)
+        st.c = np.float32(1.5)
+        self.assertEqual((st.a, st.c), (5, 1.5))
+        with self.assertRaises(TypingError):
+            st.a = "a"
+        with self.assertRaises(AttributeError):
+            del st.a
+
     def test_is(self):
         Vector = self._make_Vector2()
         vec_a = Vector(1, 2)
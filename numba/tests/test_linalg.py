@@ -5,6 +5,8 @@ import sys
 import warnings
 from numbers import Number, Integral
 import platform
+import threading
+import time
 
 import numpy as np
 
@@ -28,6 +30,10 @@ def vdot(a, b):
     return np.vdot(a, b)
 
 
+def matmul(a, b):
+    return np.matmul(a, b)
+
+
 class TestProduct(TestCase):
     """
     Tests for dot products.
@@ -305,6 +311,65 @@ class TestProduct(TestCase):
         """
         self.check_dot_mm(matmul_usecase, None, "'@'")
 
+    @needs_blas
+    def test_matmul_stacked(self):
+        """
+        Test @ and np.matmul() on stacks of matrices
+        """
+        cfunc = jit(nopython=True)(matmul_usecase)
+
+        def stack(shape, m, n, dtype):
+            size = int(np.prod(shape))
+            mat = self.sample_vector(size * m * n, dtype)
+            return mat.reshape(shape + (m, n))
+
+        # The last sizes exceed those of the small matrix kernel
+        for m, n, k in [(2, 3, 4), (1, 1, 3), (0, 3, 2), (3, 2, 0),
+                        (33, 2, 3)]:
+            for dtype in self.dtypes:
+                for shape in [(3,), (2, 3), (0,)]:
+                    a = stack(shape, m, k, dtype)
+                    b = stack(shape, k, n, dtype)
+                    self.check_func(matmul_usecase, cfunc, (a, b))
+                    # Stack and matrix, in both orders
+                    self.check_func(matmul_usecase, cfunc,
+                                    (a, self.sample_matrix(k, n, dtype)))
+                    self.check_func(matmul_usecase, cfunc,
+                                    (self.sample_matrix(m, k, dtype), b))
+                    # Stack and vector, in both orders
+                    x = self.sample_vector(k, dtype)
+                    self.check_func(matmul_usecase, cfunc, (a, x))
+                    self.check_func(matmul_usecase, cfunc, (x, b))
+            # Non-contiguous and Fortran ordered stacks
+            a = stack((2, 3), m, k, np.float64)
+            b = stack((2, 3), k, n, np.float64)
+            self.check_func(matmul_usecase, cfunc, (a[:, ::-1], b[::-1]))
+            self.check_func(matmul_usecase, cfunc,
+                            (np.asfortranarray(a), np.asfortranarray(b)))
+
+        cfunc = jit(nopython=True)(matmul)
+        a = stack((2, 3), 2, 4, np.float64)
+        b = stack((2, 3), 4, 3, np.float64)
+        self.check_func(matmul, cfunc, (a, b))
+
+        # Mismatching sizes
+        a = stack((3,), 2, 4, np.float64)
+        self.assert_mismatching_sizes(cfunc, (a, stack((3,), 3, 3,
+                                                       np.float64)))
+        self.assert_mismatching_sizes(cfunc, (a, stack((2,), 4, 3,
+                                                       np.float64)))
+        self.assert_mismatching_sizes(cfunc,
+                                      (a, self.sample_vector(3, np.float64)))
+        # Stacks of different dimensionalities
+        with self.assertRaises(errors.TypingError) as raises:
+            cfunc(a, stack((2, 3), 4, 3, np.float64))
+        self.assertIn("same dimensionality", str(raises.exception))
+        # np.dot() keeps rejecting >2-D arrays
+        with self.assertRaises(errors.TypingError) as raises:
+            jit(nopython=True)(dot2)(a, a)
+        self.assertIn("only supported on 1-D and 2-D arrays",
+                      str(raises.exception))
+
     @needs_blas
     def test_contiguity_warnings(self):
         m, k, n = 2, 3, 4
@@ -2687,5 +2752,66 @@ class TestHelpers(TestCase):
 
         check(slice_to_any, expected_slice_to_any, shapes, dtypes, orders)
 
+    @needs_lapack
+    def test_lapack_workspace_cache(self):
+        from numba import _helperlib
+
+        cfunc = jit(nopython=True)(svd_matrix)
+        rng = np.random.RandomState(0)
+
+        def check(n, dtype):
+            a = rng.uniform(size=(n, n)).astype(dtype)
+            got = cfunc(a)[1]
+            expected = np.linalg.svd(a)[1]
+            np.testing.assert_allclose(got, expected, rtol=1e-4)
+
+        _helperlib.lapack_release_workspace()
+        self.assertEqual(_helperlib.lapack_workspace_size(), 0)
+        for dtype in (np.float64, np.float32, np.complex128):
+            check(8, dtype)
+        size = _helperlib.lapack_workspace_size()
+        self.assertGreater(size, 0)
+        # The work arrays of smaller problems are reused
+        for _ in range(3):
+            for dtype in (np.float64, np.float32, np.complex128):
+                check(4, dtype)
+        self.assertEqual(_helperlib.lapack_workspace_size(), size)
+        # and grown for larger ones
+        check(16, np.float64)
+        self.assertGreater(_helperlib.lapack_workspace_size(), size)
+        _helperlib.lapack_release_workspace()
+        self.assertEqual(_helperlib.lapack_workspace_size(), 0)
+        check(4, np.float64)
+
+    @needs_lapack
+    def test_lapack_workspace_freed_at_thread_exit(self):
+        from numba import _helperlib
+
+        cfunc = jit(nopython=True)(svd_matrix)
+        a = np.random.RandomState(0).uniform(size=(8, 8))
+        cfunc(a)
+        before = _helperlib.lapack_workspace_total_size()
+        sizes = []
+
+        def run():
+            cfunc(a)
+            sizes.append(_helperlib.lapack_workspace_size())
+
+        threads = [threading.Thread(target=run) for _ in range(4)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        self.assertEqual(len(sizes), 4)
+        self.assertGreater(min(sizes), 0)
+        # The destructors run as the threads exit, which may be just after
+        # join() returns.
+        deadline = time.time() + 10
+        while (_helperlib.lapack_workspace_total_size() != before
+               and time.time() < deadline):
+            time.sleep(0.01)
+        self.assertEqual(_helperlib.lapack_workspace_total_size(), before)
+
+
 if __name__ == '__main__':
     unittest.main()
@@ -3,6 +3,7 @@ import math
 import sys
 import warnings
 
+import llvmlite.ir
 import numpy as np
 
 from numba.core.compiler import compile_isolated, Flags
@@ -650,6 +651,58 @@ class TestMathLib(TestCase):
     def test_ldexp_npm(self):
         self.test_ldexp(flags=no_pyobj_flags)
 
+    def vector_math_loop(self, func):
+        from numba import njit
+
+        def impl(x, out):
+            for i in range(x.size):
+                out[i] = func(x[i])
+        return njit(impl)
+
+    def test_vector_math_variants(self):
+        # Loops of math functions without an LLVM intrinsic may be vectorized
+        # with the vector-width variants of _helperlib, which are accurate to
+        # a few units in the last place.
+        from numba import njit
+
+        cases = [(erf, -7, 7), (erfc, -7, 26), (lgamma, -7, 200),
+                 (lgamma, 1e-8, 1e-3)]
+        for dtype, prec, ulps in ((np.float64, 'double', 4),
+                                  (np.float32, 'single', 3)):
+            for pyfunc, lo, hi in cases:
+                scalar = njit(pyfunc)
+                cfunc = self.vector_math_loop(getattr(math, pyfunc.__name__))
+                x = np.linspace(lo, hi, 1003).astype(dtype)
+                out = np.empty_like(x)
+                cfunc(x, out)
+                expected = np.array([scalar(a) for a in x], dtype=dtype)
+                self.assertPreciseEqual(out, expected, prec=prec, ulps=ulps)
+
+    def test_vector_math_variants_called(self):
+        # The vectorized loops must call the vector-width variants when
+        # the CPU has the features they need.
+        from numba.core.registry import cpu_target
+        from numba.cpython import mathimpl
+
+        context = cpu_target.target_context
+        cases = []
+        for name in ('erf', 'erfc', 'lgamma'):
+            func = getattr(math, name)
+            cases.append((func, name, np.float64, llvmlite.ir.DoubleType()))
+            cases.append((func, name + 'f', np.float32,
+                          llvmlite.ir.FloatType()))
+        for func, name, dtype, lty in cases:
+            widths = mathimpl._vector_math_widths(context, name, lty)
+            if not widths:
+                self.skipTest("the variants are unavailable or disabled")
+            cfunc = self.vector_math_loop(func)
+            x = np.linspace(0.5, 5, 64).astype(dtype)
+            cfunc(x, np.empty_like(x))
+            llvm_ir = cfunc.inspect_llvm(cfunc.signatures[0])
+            variants = ['@numba_%s_v%d(' % (name, width) for width in widths]
+            self.assertTrue(any(v in llvm_ir for v in variants),
+                            "none of %s is called" % (variants,))
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -1,12 +1,16 @@
+import gc
 import math
 import os
 import platform
 import sys
 import re
+import threading
+import weakref
 
 import numpy as np
 
-from numba import njit
+from numba import njit, prange
+from numba.typed import List
 from numba.core import types
 from numba.core.compiler import compile_isolated, Flags
 from numba.core.runtime import (
@@ -239,6 +243,31 @@ class TestNrtMemInfo(unittest.TestCase):
             msg = f"Cannot allocate a negative number of bytes: {size}."
             self.assertIn(msg, str(raises.exception))
 
+    @unittest.skipUnless(rtsys.stats_enabled, "NRT stats are compiled out")
+    def test_allocation_stats_threads(self):
+        # Allocations counted on many threads are all accounted for
+        nthreads, nalloc = 8, 500
+
+        def worker():
+            for _ in range(nalloc):
+                mi = rtsys.meminfo_alloc(16)
+                del mi
+
+        before = rtsys.get_allocation_stats()
+        threads = [threading.Thread(target=worker) for _ in range(nthreads)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        after = rtsys.get_allocation_stats()
+        expected = nthreads * nalloc
+        self.assertGreaterEqual(after.alloc - before.alloc, expected)
+        self.assertGreaterEqual(after.mi_alloc - before.mi_alloc, expected)
+        self.assertEqual(after.alloc - before.alloc,
+                         after.free - before.free)
+        self.assertEqual(after.mi_alloc - before.mi_alloc,
+                         after.mi_free - before.mi_free)
+
 
 class TestTracemalloc(unittest.TestCase):
     """
@@ -399,6 +428,29 @@ class TestNRTIssue(MemoryLeakMixin, TestCase):
 
         self.assertEqual(expect, got)
 
+    def test_box_array_tuple(self):
+        # Homogeneous tuples of arrays are boxed in a single call
+        @njit
+        def f(a):
+            return np.arange(3.0), a, a[2:], np.ones((2, 2))[0]
+
+        a = np.arange(6.0)
+        got = f(a)
+        self.assertEqual(len(got), 4)
+        self.assertIs(got[1], a)
+        self.assertPreciseEqual(got[0], np.arange(3.0))
+        self.assertPreciseEqual(got[2], a[2:])
+        self.assertPreciseEqual(got[3], np.ones(2))
+        for arr in got[0], got[3]:
+            self.assertIsInstance(arr.base, _nrt_python._MemInfo)
+            self.assertTrue(arr.flags.writeable)
+        del got
+
+        # The MemInfo objects are recycled safely
+        results = [f(a) for _ in range(100)]
+        for res in results:
+            self.assertPreciseEqual(res[0], np.arange(3.0))
+
 
 class TestRefCtPruning(unittest.TestCase):
 
@@ -574,6 +626,398 @@ br i1 %.294, label %B42, label %B160
 
 
 @unittest.skipUnless(cffi_support.SUPPORTED, "cffi required")
+class TestNrtPoolAllocator(TestCase):
+    """Tests for the thread-local pool allocation mode of the NRT, see
+    NUMBA_NRT_POOL_ALLOCATOR.
+    """
+
+    _pool_env = {'NUMBA_NRT_POOL_ALLOCATOR': '1'}
+
+    @TestCase.run_test_in_subprocess(envvars=_pool_env)
+    def test_allocations(self):
+        @njit(parallel=True)
+        def small_temporaries(n):
+            out = np.zeros(n)
+            for i in prange(n):
+                # a temporary per iteration, of a size spanning the classes
+                tmp = np.arange(i % 5000)
+                out[i] = tmp.sum()
+            return out
+
+        @njit
+        def grow_list(n):
+            lst = []
+            for i in range(n):
+                lst.append(np.ones(i % 100))
+            return sum([x.sum() for x in lst])
+
+        # large blocks bypass the pool
+        @njit
+        def large(n):
+            a = np.ones(n)
+            return a.sum()
+
+        n = 20000
+        before = rtsys.get_allocation_stats()
+        got = small_temporaries(n)
+        expected = np.array([(i % 5000) * (i % 5000 - 1) // 2
+                             for i in range(n)], dtype=np.float64)
+        np.testing.assert_equal(got, expected)
+        self.assertEqual(grow_list(1000), grow_list.py_func(1000))
+        self.assertEqual(large(100000), 100000.)
+
+        # blocks allocated on other threads are released by this one
+        @njit
+        def ones(n):
+            return np.ones(n)
+
+        ones(1)
+        results = []
+
+        def worker():
+            results.extend(ones(i) for i in range(0, 2000, 7))
+
+        threads = [threading.Thread(target=worker) for _ in range(4)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        self.assertEqual(sum(x.sum() for x in results),
+                         4 * sum(range(0, 2000, 7)))
+
+        del got, results
+        after = rtsys.get_allocation_stats()
+        self.assertEqual(after.alloc - before.alloc,
+                         after.free - before.free)
+        self.assertEqual(after.mi_alloc - before.mi_alloc,
+                         after.mi_free - before.mi_free)
+
+    def test_mode_change_with_live_blocks(self):
+        cpu_target.target_context
+        mi = rtsys.meminfo_alloc(16)
+        with self.assertRaises(RuntimeError) as raises:
+            _nrt_python.memsys_set_pool_allocator(True)
+        self.assertIn("allocation mode", str(raises.exception))
+        del mi
+
+
+class TestNrtTracing(TestCase):
+    """Tests for the NRT allocation tracing.
+    """
+
+    def setUp(self):
+        cpu_target.target_context
+        rtsys.enable_tracing()
+
+    def tearDown(self):
+        rtsys.enable_tracing(False)
+
+    def test_summary(self):
+        @njit
+        def make(n):
+            return np.empty(n, dtype=np.uint8)
+
+        make(1)
+        rtsys.enable_tracing()
+        keep = [make(1000) for _ in range(4)]
+        make(100)
+        summary = rtsys.get_trace_summary()
+        self.assertEqual(summary['total_count'], 5)
+        self.assertEqual(summary['live_count'], 4)
+        self.assertEqual(summary['live_bytes'], 4000)
+        self.assertEqual(summary['peak_live_bytes'], 4100)
+        # 1000 bytes is in [2**9, 2**10), 100 bytes in [2**6, 2**7)
+        self.assertEqual(summary['size_histogram'][10], 4)
+        self.assertEqual(summary['size_histogram'][7], 1)
+        self.assertEqual(sum(summary['lifetime_histogram']), 1)
+        del keep
+        summary = rtsys.get_trace_summary()
+        self.assertEqual(summary['live_count'], 0)
+        self.assertEqual(summary['live_bytes'], 0)
+        self.assertEqual(sum(summary['lifetime_histogram']), 5)
+
+    def test_live_meminfos_and_tags(self):
+        @njit
+        def make(n):
+            return np.empty(n, dtype=np.uint8)
+
+        @njit
+        def grow(n):
+            lst = List()
+            for i in range(n):
+                lst.append(i)
+            return lst
+
+        make(1)
+        before = make(10)
+        checkpoint = rtsys.trace_checkpoint()
+        with rtsys.trace_tag("leaky"):
+            leaked = [make(64), make(128)]
+            make(256)
+        with rtsys.trace_tag("lists"):
+            lst = grow(100)
+        live = rtsys.get_live_meminfos(checkpoint)
+        self.assertEqual([x.tag for x in live[:2]], ["leaky", "leaky"])
+        self.assertEqual([x.size for x in live[:2]], [64, 128])
+        self.assertTrue(all(x.refcount >= 1 for x in live))
+        self.assertTrue(all(x.seq >= checkpoint for x in live))
+        self.assertEqual(set(x.tag for x in live), {"leaky", "lists"})
+        older = [x.size for x in rtsys.get_live_meminfos()
+                 if x.seq < checkpoint]
+        self.assertIn(10, older)
+        tags = rtsys.get_trace_tags()
+        self.assertEqual(tags["leaky"].count, 3)
+        self.assertEqual(tags["leaky"].bytes, 64 + 128 + 256)
+        self.assertEqual(tags["leaky"].live_count, 2)
+        self.assertGreater(tags["lists"].live_count, 0)
+        del leaked, lst, before
+        self.assertEqual(rtsys.get_live_meminfos(checkpoint), [])
+        self.assertEqual(rtsys.get_trace_tags()["leaky"].live_count, 0)
+
+
+class TestNrtLargeAllocation(MemoryLeakMixin, TestCase):
+    """Tests for mapping large NRT allocations directly, see
+    NUMBA_NRT_LARGE_ALLOC_THRESHOLD.
+    """
+
+    def setUp(self):
+        super().setUp()
+        cpu_target.target_context
+
+    def check_allocations(self):
+        @njit
+        def fill(n):
+            a = np.empty(n)
+            for i in range(n):
+                a[i] = i
+            return a
+
+        n = 1 << 19
+        a = fill(n)
+        self.assertEqual(a.sum(), n * (n - 1) / 2)
+        self.assertEqual(a.ctypes.data % 64, 0)
+        # small allocations are unaffected
+        np.testing.assert_equal(fill(10), np.arange(10.))
+
+    @linux_only
+    def test_large_allocation(self):
+        _nrt_python.memsys_set_large_allocation(
+            1 << 20, _nrt_python.NRT_LARGE_THP |
+            _nrt_python.NRT_LARGE_NUMA_LOCAL)
+        try:
+            self.check_allocations()
+        finally:
+            _nrt_python.memsys_set_large_allocation(0, 0)
+
+    @linux_only
+    @TestCase.run_test_in_subprocess(envvars={
+        'NUMBA_NRT_LARGE_ALLOC_THRESHOLD': str(1 << 20),
+        'NUMBA_NRT_LARGE_ALLOC_FLAGS': 'hugetlb, thp'})
+    def test_large_allocation_envvar(self):
+        # falls back to the other kinds of mapping without reserved huge pages
+        self.check_allocations()
+
+    def test_invalid_threshold(self):
+        with self.assertRaises(ValueError):
+            _nrt_python.memsys_set_large_allocation(-1, 0)
+
+
+class TestNrtVarsize(TestCase):
+    """Tests for the growth of the buffers of varsize MemInfos
+    """
+
+    def setUp(self):
+        super().setUp()
+        cpu_target.target_context
+
+    def get_function(self, name, restype, *argtypes):
+        from ctypes import CFUNCTYPE
+        return CFUNCTYPE(restype, *argtypes)(_nrt_python.c_helpers[name])
+
+    def test_varsize_growth(self):
+        self.check_varsize_growth()
+
+    @linux_only
+    def test_varsize_growth_hugetlb(self):
+        # buffers past the mapping threshold are backed by reserved huge
+        # pages if there are any, remapping must keep their length a
+        # multiple of the huge page size
+        _nrt_python.memsys_set_large_allocation(
+            1 << 20, _nrt_python.NRT_LARGE_HUGETLB)
+        try:
+            self.check_varsize_growth()
+        finally:
+            _nrt_python.memsys_set_large_allocation(0, 0)
+
+    def check_varsize_growth(self):
+        from ctypes import c_void_p, c_size_t, c_char, POINTER, cast
+        new_varsize = self.get_function('MemInfo_new_varsize', c_void_p,
+                                        c_size_t)
+        realloc = self.get_function('MemInfo_varsize_realloc', c_void_p,
+                                    c_void_p, c_size_t)
+        capacity = self.get_function('MemInfo_varsize_capacity', c_size_t,
+                                     c_void_p)
+        release = self.get_function('MemInfo_release', None, c_void_p)
+
+        mi = new_varsize(8)
+        self.assertEqual(capacity(mi), 8)
+        data = realloc(mi, 1)
+        cast(data, POINTER(c_char))[0] = b'x'
+        moves = 0
+        size = 1
+        # grow by small steps past the size mapped directly
+        while size < 8 * 1024 * 1024:
+            size += 4096
+            new_data = realloc(mi, size)
+            self.assertIsNotNone(new_data)
+            self.assertGreaterEqual(capacity(mi), size)
+            moves += new_data != data
+            data = new_data
+        self.assertEqual(cast(data, POINTER(c_char))[0], b'x')
+        self.assertLess(moves, 50)
+        # shrinking releases most of the capacity
+        realloc(mi, 16)
+        self.assertEqual(capacity(mi), 16)
+        release(mi)
+
+
+class TestNrtBiasedRefcount(TestCase):
+    """Tests for biasing MemInfo reference counts to their allocating thread,
+    see NUMBA_NRT_BIASED_REFCOUNT.
+    """
+
+    @TestCase.run_test_in_subprocess(envvars={
+        'NUMBA_NRT_BIASED_REFCOUNT': '1'})
+    def test_biased_refcount(self):
+        @njit
+        def make(n):
+            return np.arange(n)
+
+        @njit
+        def share(arrs):
+            # take and drop references to each array
+            total = 0
+            for a in arrs:
+                b = a
+                total += b.sum()
+            return total
+
+        @njit
+        def touch():
+            return np.zeros(1)
+
+        def stats():
+            s = rtsys.get_allocation_stats()
+            return s.mi_alloc - s.mi_free
+
+        # compile before taking the baseline
+        self.assertEqual(share(List([make(10)])), 45)
+        touch()
+        start = stats()
+        arrs = List([make(10) for _ in range(100)])
+        self.assertEqual(share(arrs), 100 * 45)
+        self.assertEqual(arrs[0].base.refcount, 1)
+
+        results = []
+
+        def worker(arrs):
+            results.append(share(arrs))
+
+        threads = [threading.Thread(target=worker, args=(arrs,))
+                   for _ in range(4)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        self.assertEqual(results, [100 * 45] * 4)
+        self.assertEqual(arrs[0].base.refcount, 1)
+
+        # hand the last references to another thread, the arrays are freed
+        # once the allocating thread runs NRT code again
+        handoff = [make(10) for _ in range(10)]
+        del arrs
+        before = stats()
+        t = threading.Thread(target=handoff.clear)
+        t.start()
+        t.join()
+        self.assertEqual(stats(), before)
+        touch()
+        self.assertEqual(stats(), start)
+
+
+    @TestCase.run_test_in_subprocess(envvars={
+        'NUMBA_NRT_BIASED_REFCOUNT': '1'})
+    def test_biased_get_refcount(self):
+        from numba.core.unsafe.refcount import get_refcount
+
+        @njit
+        def foo():
+            # use some tricks to make ref-counted unicode
+            i, j = 'ab', 'c'
+            a = i + j
+            m, n = 'zy', 'x'
+            z = m + n
+            l = List.empty_list(types.unicode_type)
+            l.append(a)
+            l[0] = z
+            ra, rz = get_refcount(a), get_refcount(z)
+            return l, ra, rz
+
+        l, ra, rz = foo()
+        self.assertEqual(l[0], "zyx")
+        self.assertEqual(ra, 1)
+        self.assertEqual(rz, 2)
+
+
+@unittest.skipUnless(hasattr(np.ndarray, '__dlpack__'),
+                     'needs NumPy with DLPack support')
+class TestNrtDLPack(MemoryLeakMixin, TestCase):
+
+    def test_from_dlpack(self):
+        for src in (np.arange(12.0), np.arange(12, dtype=np.int32)[::3],
+                    np.arange(12.0).reshape(3, 4).T,
+                    np.ones(3, dtype=np.complex64), np.zeros(0)):
+            arr = rtsys.from_dlpack(src)
+            self.assertIsInstance(arr.base, _nrt_python._MemInfo)
+            self.assertEqual(arr.dtype, src.dtype)
+            self.assertEqual(arr.shape, src.shape)
+            if src.size:
+                self.assertEqual(arr.strides, src.strides)
+                self.assertEqual(arr.ctypes.data, src.ctypes.data)
+            self.assertPreciseEqual(arr, src)
+
+    def test_from_dlpack_lifetime(self):
+        @njit
+        def f(a):
+            a[0] = 42.0
+            return a[1:]
+
+        src = np.arange(5.0)
+        ref = weakref.ref(src)
+        arr = rtsys.from_dlpack(src)
+        del src
+        res = f(arr)
+        del arr
+        # The tensor is alive as long as a value derived from it
+        self.assertIsNotNone(ref())
+        self.assertPreciseEqual(ref(), np.array([42.0, 1, 2, 3, 4]))
+        self.assertPreciseEqual(res, np.arange(1.0, 5.0))
+        del res
+        gc.collect()
+        self.assertIsNone(ref())
+
+    def test_from_dlpack_capsule(self):
+        src = np.arange(4.0)
+        capsule = src.__dlpack__()
+        arr = rtsys.from_dlpack(capsule)
+        self.assertPreciseEqual(arr, src)
+        # A capsule is consumed once
+        with self.assertRaises(ValueError):
+            rtsys.from_dlpack(capsule)
+        with self.assertRaises(AttributeError):
+            rtsys.from_dlpack(object())
+
+
 class TestNrtExternalCFFI(MemoryLeakMixin, TestCase):
     """Testing the use of externally compiled C code that use NRT
     """
@@ -679,6 +1123,50 @@ NRT_MemInfo* test_nrt_api(NRT_api_functions *nrt, size_t n) {
         arr = np.ndarray(shape=(3,), dtype=np.intp, buffer=buffer)
         np.testing.assert_equal(arr, [0xded, 0xabc, 0xdef])
 
+    def test_arena(self):
+        name = "{}_test_arena".format(self.__class__.__name__)
+        source = r"""
+#include <stdio.h>
+#include "numba/core/runtime/nrt_external.h"
+
+size_t alive = 0;
+
+NRT_MemInfo* test_nrt_api(NRT_api_functions *nrt, size_t n) {
+    size_t i, *data;
+    NRT_MemInfo *keep = NULL;
+    NRT_Arena *arena = nrt->arena_push(0);
+    if (arena == NULL)
+        return NULL;
+    for (i = 0; i < n; i++) {
+        NRT_MemInfo *mi = nrt->allocate(sizeof(size_t) * (i % 64 + 1));
+        data = nrt->get_data(mi);
+        data[0] = i;
+        if (i == n / 2)
+            keep = mi;  /* escapes the arena */
+        else
+            nrt->release(mi);
+    }
+    alive = nrt->arena_pop(arena);
+    return keep;
+}
+        """
+        cdef = """
+void* test_nrt_api(void *nrt, size_t n);
+extern size_t alive;
+        """
+        ffi, mod = self.compile_cffi_module(name, source, cdef)
+
+        table = self.get_nrt_api_table()
+        out = mod.lib.test_nrt_api(table, 1000)
+        self.assertEqual(mod.lib.alive, 1)
+
+        mi_addr = int(ffi.cast("size_t", out))
+        mi = nrt.MemInfo(mi_addr)
+        self.assertEqual(mi.refcount, 1)
+        data = ffi.cast("size_t *", mi.data)
+        self.assertEqual(data[0], 500)
+        del mi
+
     def test_get_api(self):
         from cffi import FFI
 
@@ -650,12 +650,55 @@ class TestMiscBackendIssues(ThreadLayerTestHelper):
         env['NUMBA_NUM_THREADS'] = "1"
         self.run_cmd(cmdline, env=env)
 
-    def test_workqueue_aborts_on_nested_parallelism(self):
+    @skip_no_tbb
+    def test_tbb_arena_reuse(self):
+        """
+        Tests the TBB layer gives correct results when its cached task arenas
+        are reused across calls with differing thread masks and from nested
+        parallel regions.
+        """
+        runme = """if 1:
+            from numba import (njit, prange, set_num_threads, get_num_threads,
+                               threading_layer)
+            import numpy as np
+
+            @njit(parallel=True)
+            def inner(x):
+                acc = 0
+                for i in prange(len(x)):
+                    acc += x[i]
+                return acc, get_num_threads()
+
+            @njit(parallel=True)
+            def outer(x, mask):
+                out = np.zeros(len(x), dtype=np.int64)
+                for i in prange(len(x)):
+                    set_num_threads(mask)
+                    acc, n = inner(x)
+                    out[i] = acc + n
+                return out
+
+            x = np.arange(100)
+            for i in range(100):
+                set_num_threads(1 + i % 2)
+                acc, n = inner(x)
+                assert acc == x.sum() and n == 1 + i % 2
+                np.testing.assert_equal(outer(x, 1), x.sum() + 1)
+            assert threading_layer() == "tbb"
+        """
+        cmdline = [sys.executable, '-c', runme]
+        env = os.environ.copy()
+        env['NUMBA_THREADING_LAYER'] = "tbb"
+        env['NUMBA_NUM_THREADS'] = "2"
+        self.run_cmd(cmdline, env=env)
+
+    def test_workqueue_handles_nested_parallelism(self):
         """
-        Tests workqueue raises sigabrt if a nested parallel call is performed
+        Tests workqueue runs nested parallel regions inline on the calling
+        thread rather than aborting
         """
         runme = """if 1:
-            from numba import njit, prange
+            from numba import njit, prange, threading_layer
             import numpy as np
 
             @njit(parallel=True)
@@ -663,6 +706,12 @@ class TestMiscBackendIssues(ThreadLayerTestHelper):
                 for i in prange(len(x)):
                     x[i] += 1
 
+            @njit(parallel=True)
+            def nested_reduction(x):
+                acc = 0.
+                for i in prange(len(x)):
+                    acc += x[i]
+                return acc
 
             @njit(parallel=True)
             def main():
@@ -671,24 +720,24 @@ class TestMiscBackendIssues(ThreadLayerTestHelper):
                     nested(Z[i])
                 return Z
 
-            main()
+            @njit(parallel=True)
+            def main_reduction():
+                Z = np.ones((7, 100))
+                acc = np.zeros(Z.shape[0])
+                for i in prange(Z.shape[0]):
+                    acc[i] = nested_reduction(Z[i])
+                return acc
+
+            np.testing.assert_equal(main(), np.ones((5, 10)))
+            np.testing.assert_equal(main_reduction(), np.full(7, 100.))
+            assert threading_layer() == "workqueue"
         """
         cmdline = [sys.executable, '-c', runme]
         env = os.environ.copy()
         env['NUMBA_THREADING_LAYER'] = "workqueue"
         env['NUMBA_NUM_THREADS'] = "4"
 
-        try:
-            out, err = self.run_cmd(cmdline, env=env)
-        except AssertionError as e:
-            if self._DEBUG:
-                print(out, err)
-            e_msg = str(e)
-            self.assertIn("failed with code", e_msg)
-            # raised a SIGABRT, but the value is platform specific so just check
-            # the error message
-            self.assertIn("Terminating: Nested parallel kernel launch detected",
-                          e_msg)
+        self.run_cmd(cmdline, env=env)
 
     @unittest.skipUnless(_HAVE_OS_FORK, "Test needs fork(2)")
     def test_workqueue_handles_fork_from_non_main_thread(self):
@@ -732,6 +781,390 @@ class TestMiscBackendIssues(ThreadLayerTestHelper):
         self.run_cmd(cmdline, env=env)
 
 
+    def test_workqueue_spin_wait(self):
+        """
+        Tests the workqueue gives correct results with the spin-then-park
+        wait enabled, including when the thread mask is varied.
+        """
+        runme = """if 1:
+            from numba import njit, prange, set_num_threads, threading_layer
+            import numpy as np
+
+            @njit(parallel=True)
+            def func(x):
+                for i in prange(len(x)):
+                    x[i] += 1
+
+            x = np.zeros(1000)
+            for i in range(200):
+                set_num_threads(1 + i % 4)
+                func(x)
+            np.testing.assert_equal(x, 200)
+            assert threading_layer() == "workqueue"
+        """
+        cmdline = [sys.executable, '-c', runme]
+        for spin in ("0", "1000"):
+            env = os.environ.copy()
+            env['NUMBA_THREADING_LAYER'] = "workqueue"
+            env['NUMBA_NUM_THREADS'] = "4"
+            env['NUMBA_WORKQUEUE_SPIN'] = spin
+            self.run_cmd(cmdline, env=env)
+
+
+class TestThreadAffinity(ThreadLayerTestHelper):
+    """
+    Checks the NUMBA_THREAD_AFFINITY placement policies
+    """
+    _DEBUG = False
+
+    def test_parse_cpulist(self):
+        from numba.np.ufunc.parallel import _parse_cpulist
+        self.assertEqual(_parse_cpulist("0-3,8,10-11"),
+                         [0, 1, 2, 3, 8, 10, 11])
+        self.assertEqual(_parse_cpulist("5, 1"), [5, 1])
+        self.assertEqual(_parse_cpulist(""), [])
+        for bad in ("3-1", "a", "-1"):
+            with self.assertRaises(ValueError):
+                _parse_cpulist(bad)
+
+    def test_policies(self):
+        from numba.np.ufunc.parallel import _thread_affinity_cpus
+        self.assertEqual(_thread_affinity_cpus(""), [])
+        self.assertEqual(_thread_affinity_cpus("none"), [])
+        compact = _thread_affinity_cpus("compact")
+        scatter = _thread_affinity_cpus("scatter")
+        self.assertTrue(compact)
+        self.assertEqual(sorted(compact), sorted(scatter))
+        self.assertEqual(len(set(compact)), len(compact))
+        self.assertEqual(_thread_affinity_cpus(str(compact[0])), compact[:1])
+        with self.assertRaises(ValueError) as raised:
+            _thread_affinity_cpus("bogus")
+        self.assertIn("NUMBA_THREAD_AFFINITY must be", str(raised.exception))
+
+    @linux_only
+    @skip_parfors_unsupported
+    def test_workqueue_workers_pinned(self):
+        runme = """if 1:
+            import os
+            from numba import njit, prange, threading_layer
+            import numpy as np
+
+            @njit(parallel=True)
+            def func(x):
+                for i in prange(len(x)):
+                    x[i] += 1
+
+            x = np.zeros(100)
+            func(x)
+            np.testing.assert_equal(x, 1)
+            assert threading_layer() == "workqueue"
+            cpu = min(os.sched_getaffinity(0))
+            tids = [int(t) for t in os.listdir('/proc/self/task')]
+            workers = [t for t in tids if t != os.getpid()]
+            pinned = [t for t in workers if os.sched_getaffinity(t) == {cpu}]
+            assert len(pinned) >= 2, (cpu, pinned)
+        """
+        cmdline = [sys.executable, '-c', runme]
+        env = os.environ.copy()
+        env['NUMBA_THREADING_LAYER'] = "workqueue"
+        env['NUMBA_NUM_THREADS'] = "2"
+        cpu = min(os.sched_getaffinity(0))
+        env['NUMBA_THREAD_AFFINITY'] = str(cpu)
+        self.run_cmd(cmdline, env=env)
+
+    @linux_only
+    @skip_parfors_unsupported
+    def test_workqueue_blocks_in_node_order(self):
+        cpus = sorted(os.sched_getaffinity(0))
+        if len(cpus) < 2:
+            self.skipTest("needs two CPUs")
+        runme = """if 1:
+            import ctypes
+            from numba import njit, prange, threading_layer
+            from numba.np.ufunc import parallel
+            import numpy as np
+
+            sched_getcpu = ctypes.CDLL(None).sched_getcpu
+            sched_getcpu.restype = ctypes.c_int
+            sched_getcpu.argtypes = []
+
+            # two nodes, the workers are placed on them round robin
+            parallel._numa_nodes = lambda: [[%d], [%d]]
+
+            @njit(parallel=True)
+            def func(x):
+                for i in prange(len(x)):
+                    x[i] = sched_getcpu()
+
+            x = np.zeros(400, dtype=np.int64)
+            func(x)
+            assert threading_layer() == "workqueue"
+            # the first two blocks run on the CPU of node 0
+            np.testing.assert_equal(x, np.repeat([%d, %d, %d, %d], 100))
+        """ % (cpus[0], cpus[1], cpus[0], cpus[0], cpus[1], cpus[1])
+        cmdline = [sys.executable, '-c', runme]
+        env = os.environ.copy()
+        env['NUMBA_THREADING_LAYER'] = "workqueue"
+        env['NUMBA_NUM_THREADS'] = "4"
+        env['NUMBA_THREAD_AFFINITY'] = "%d,%d" % (cpus[0], cpus[1])
+        self.run_cmd(cmdline, env=env)
+
+    def test_affinity_nodes(self):
+        from numba.np.ufunc import parallel
+        nodes = parallel._numa_nodes()
+        cpus = [node[0] for node in nodes]
+        self.assertEqual(parallel._thread_affinity_nodes(cpus),
+                         list(range(len(nodes))))
+
+
+@skip_parfors_unsupported
+class TestAsyncParallelFor(ThreadLayerTestHelper):
+    """
+    Checks the asynchronous parallel_for launch of the threading layers
+    """
+    _DEBUG = False
+
+    def run_async(self, backend):
+        runme = """if 1:
+            import numpy as np
+            from numba import cfunc, carray, types, threading_layer
+            from numba.np.ufunc import parallel
+
+            sig = types.void(types.CPointer(types.voidptr),
+                             types.CPointer(types.intp),
+                             types.CPointer(types.intp),
+                             types.voidptr)
+
+            @cfunc(sig)
+            def kernel(args, dims, steps, data):
+                out = carray(args[0], (dims[0],), np.int64)
+                inp = carray(args[1], (dims[0],), np.int64)
+                for i in range(dims[0]):
+                    out[i] += inp[i]
+
+            n = 10000
+            ones = np.ones(n, dtype=np.int64)
+            arrays = [np.zeros(n, dtype=np.int64) for _ in range(4)]
+
+            handle = parallel.parallel_for_async(kernel, [arrays[0], ones],
+                                                 num_threads=2)
+            assert threading_layer() == "%s"
+            while not handle.poll():
+                pass
+            handle.wait()
+            np.testing.assert_equal(arrays[0], 1)
+            # waiting again is a no-op
+            handle.wait()
+            assert handle.poll()
+
+            # back to back launches, waited on out of order
+            first = parallel.parallel_for_async(kernel, [arrays[1], ones])
+            second = parallel.parallel_for_async(kernel.address,
+                                                 [arrays[2], ones])
+            second.wait()
+            first.wait()
+            np.testing.assert_equal(arrays[1], 1)
+            np.testing.assert_equal(arrays[2], 1)
+
+            # a handle dropped without waiting completes the region, and
+            # keeps the temporary strided input alive until then
+            parallel.parallel_for_async(kernel, [arrays[3],
+                                                 np.arange(2 * n)[::2]])
+            np.testing.assert_equal(arrays[3], np.arange(0, 2 * n, 2))
+
+            try:
+                parallel.parallel_for_async(kernel, [arrays[0], ones[1:]])
+            except ValueError as e:
+                assert "same length" in str(e)
+            else:
+                raise AssertionError("no ValueError raised")
+        """
+        cmdline = [sys.executable, '-c', runme % backend]
+        env = os.environ.copy()
+        env['NUMBA_THREADING_LAYER'] = backend
+        env['NUMBA_NUM_THREADS'] = "2"
+        self.run_cmd(cmdline, env=env)
+
+    def test_workqueue_async(self):
+        self.run_async('workqueue')
+
+    @skip_no_omp
+    def test_omp_async(self):
+        self.run_async('omp')
+
+    @skip_no_tbb
+    def test_tbb_async(self):
+        self.run_async('tbb')
+
+
+@skip_parfors_unsupported
+@skip_no_omp
+class TestOMPScheduling(ThreadLayerTestHelper):
+    """
+    Checks the OpenMP layer honours the scheduling kind and chunksize
+    """
+    _DEBUG = False
+
+    def test_omp_schedules(self):
+        runme = """if 1:
+            from numba import (njit, prange, threading_layer,
+                               set_parallel_schedule, set_parallel_chunksize)
+            import numpy as np
+
+            @njit(parallel=True)
+            def func(n):
+                res = np.zeros(n)
+                acc = 0
+                for i in prange(n):
+                    res[i] = i
+                    acc += i
+                return res, acc
+
+            for kind in ('static', 'dynamic', 'guided'):
+                set_parallel_schedule(kind)
+                for cs in (0, 1, 7):
+                    set_parallel_chunksize(cs)
+                    for n in (1, 3, 997):
+                        res, acc = func(n)
+                        np.testing.assert_equal(res, np.arange(n))
+                        assert acc == n * (n - 1) // 2
+            assert threading_layer() == "omp"
+        """
+        cmdline = [sys.executable, '-c', runme]
+        env = os.environ.copy()
+        env['NUMBA_THREADING_LAYER'] = "omp"
+        env['NUMBA_NUM_THREADS'] = "4"
+        self.run_cmd(cmdline, env=env)
+
+
+@skip_parfors_unsupported
+class TestParallelProfiling(ThreadLayerTestHelper):
+    """
+    Checks the per-region profiles recorded by the threading layers
+    """
+    _DEBUG = False
+
+    def run_profiled(self, backend):
+        runme = """if 1:
+            from numba import njit, prange, threading_layer
+            from numba.np.ufunc import parallel
+            import numpy as np
+
+            @njit(parallel=True)
+            def func(x):
+                for i in prange(len(x)):
+                    x[i] += 1
+
+            x = np.zeros(1000)
+            func(x)
+            assert parallel.get_parallel_profile() == []
+            parallel.enable_parallel_profiling()
+            for _ in range(3):
+                func(x)
+            parallel.enable_parallel_profiling(False)
+            func(x)
+            np.testing.assert_equal(x, 5)
+            assert threading_layer() == "%s"
+            profiles = parallel.get_parallel_profile()
+            assert len(profiles) == 3, profiles
+            for p in profiles:
+                assert p['num_threads'] == 2, p
+                assert len(p['busy_ns']) == 2, p
+                assert sum(p['chunks']) >= 1, p
+                assert p['launch_ns'] <= p['wall_ns'], p
+                assert len(p['wait_ns']) == 2, p
+            parallel.reset_parallel_profile()
+            assert parallel.get_parallel_profile() == []
+        """
+        cmdline = [sys.executable, '-c', runme % backend]
+        env = os.environ.copy()
+        env['NUMBA_THREADING_LAYER'] = backend
+        env['NUMBA_NUM_THREADS'] = "2"
+        self.run_cmd(cmdline, env=env)
+
+    def test_workqueue_profile(self):
+        self.run_profiled('workqueue')
+
+    @skip_no_omp
+    def test_omp_profile(self):
+        self.run_profiled('omp')
+
+    @skip_no_tbb
+    def test_tbb_profile(self):
+        self.run_profiled('tbb')
+
+
+@skip_parfors_unsupported
+class TestScheduleCache(TestCase):
+    """
+    Checks the parallel region schedules are cached by iteration space and
+    thread count
+    """
+
+    def schedule(self, start, end, num_threads):
+        import importlib
+        from ctypes import CFUNCTYPE, POINTER, c_size_t, c_ssize_t
+        from numba.np.ufunc import parallel
+
+        parallel._launch_threads()
+        modules = {'workqueue': 'workqueue', 'omp': 'omppool',
+                   'tbb': 'tbbpool'}
+        lib = importlib.import_module("numba.np.ufunc." +
+                                      modules[parallel.threading_layer()])
+        do_scheduling = CFUNCTYPE(None, c_size_t, POINTER(c_ssize_t),
+                                  POINTER(c_ssize_t), c_size_t,
+                                  POINTER(c_ssize_t), c_ssize_t)(
+            lib.do_scheduling_signed)
+        sched = (c_ssize_t * (2 * num_threads))()
+        do_scheduling(1, (c_ssize_t * 1)(start), (c_ssize_t * 1)(end),
+                      num_threads, sched, 0)
+        return list(sched)
+
+    def test_schedule_reused(self):
+        from numba.np.ufunc.parallel import _schedule_cache_stats
+
+        first = self.schedule(0, 999, 4)
+        hits, misses = _schedule_cache_stats()
+        for _ in range(3):
+            self.assertEqual(self.schedule(0, 999, 4), first)
+        self.assertEqual(_schedule_cache_stats(), (hits + 3, misses))
+        self.assertEqual(first, [0, 249, 250, 499, 500, 749, 750, 999])
+
+    def test_new_shape_or_thread_count(self):
+        from numba.np.ufunc.parallel import _schedule_cache_stats
+
+        self.schedule(0, 999, 4)
+        hits, misses = _schedule_cache_stats()
+        # a different iteration space
+        self.assertEqual(self.schedule(0, 1999, 4),
+                         [0, 499, 500, 999, 1000, 1499, 1500, 1999])
+        self.assertEqual(_schedule_cache_stats(), (hits, misses + 1))
+        # a different thread count
+        self.assertEqual(self.schedule(0, 999, 2), [0, 499, 500, 999])
+        self.assertEqual(_schedule_cache_stats(), (hits, misses + 2))
+
+    def test_parallel_region_reuses_schedule(self):
+        from numba import njit, prange
+        from numba.np.ufunc.parallel import _schedule_cache_stats
+
+        @njit(parallel=True)
+        def func(x):
+            for i in prange(len(x)):
+                x[i] += 1
+
+        x = np.zeros(1000)
+        func(x)
+        hits, misses = _schedule_cache_stats()
+        func(x)
+        func(x)
+        self.assertEqual(_schedule_cache_stats(), (hits + 2, misses))
+        y = np.zeros(1237)
+        func(y)
+        self.assertEqual(_schedule_cache_stats(), (hits + 2, misses + 1))
+        np.testing.assert_equal(x, 3)
+        np.testing.assert_equal(y, 1)
+
+
 # 32bit or windows py27 (not that this runs on windows)
 @skip_parfors_unsupported
 @skip_unless_gnu_omp
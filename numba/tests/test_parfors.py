@@ -26,6 +26,8 @@ import subprocess as subp
 import numba.parfors.parfor
 from numba import (njit, prange, parallel_chunksize,
                    get_parallel_chunksize, set_parallel_chunksize,
+                   get_parallel_schedule, set_parallel_schedule,
+                   get_parallel_split_alignment, set_parallel_split_alignment,
                    set_num_threads, get_num_threads, typeof)
 from numba.core import (types, utils, typing, errors, ir, rewrites,
                         typed_passes, inline_closurecall, config, compiler, cpu)
@@ -4347,6 +4349,131 @@ class TestParforChunksizing(TestCase):
         self.assertIn(msg, str(raised.exception))
 
 
+@skip_parfors_unsupported
+class TestParforScheduling(TestCase):
+    """
+    Tests scheduling kind handling in ParallelAccelerator.
+    """
+    _numba_parallel_test_ = False
+
+    def setUp(self):
+        set_parallel_schedule('static')
+
+    def tearDown(self):
+        set_parallel_schedule('static')
+        set_parallel_chunksize(0)
+        set_parallel_split_alignment(0)
+
+    def test_python_parallel_schedule_basic(self):
+        self.assertEqual(get_parallel_schedule(), 'static')
+        for kind in ('dynamic', 'guided', 'static'):
+            prev = get_parallel_schedule()
+            self.assertEqual(set_parallel_schedule(kind), prev)
+            self.assertEqual(get_parallel_schedule(), kind)
+
+    def test_njit_parallel_schedule_basic(self):
+        @njit
+        def get_sched():
+            return get_parallel_schedule()
+
+        @njit
+        def set_guided():
+            return set_parallel_schedule('guided')
+
+        self.assertEqual(get_sched(), 'static')
+        self.assertEqual(set_guided(), 'static')
+        self.assertEqual(get_sched(), 'guided')
+
+    def test_all_iterations_run(self):
+        @njit(parallel=True)
+        def test_impl(n):
+            res = np.zeros(n)
+            acc = 0
+            for i in numba.prange(n):
+                res[i] = i
+                acc += i
+            return res, acc
+
+        for kind in ('dynamic', 'guided'):
+            set_parallel_schedule(kind)
+            for cs in (0, 1, 7):
+                set_parallel_chunksize(cs)
+                for n in (1, 3, 997, 1000):
+                    res, acc = test_impl(n)
+                    np.testing.assert_equal(res, np.arange(n))
+                    self.assertEqual(acc, n * (n - 1) // 2)
+
+    def test_python_parallel_schedule_invalid(self):
+        with self.assertRaises(ValueError) as raised:
+            set_parallel_schedule('bogus')
+        self.assertIn("The parallel schedule must be one of",
+                      str(raised.exception))
+
+        with self.assertRaises(TypeError) as raised:
+            set_parallel_schedule(1)
+        self.assertIn("The parallel schedule must be a string",
+                      str(raised.exception))
+
+    def test_python_split_alignment_basic(self):
+        self.assertEqual(get_parallel_split_alignment(), 0)
+        self.assertEqual(set_parallel_split_alignment(8), 0)
+        self.assertEqual(get_parallel_split_alignment(), 8)
+        self.assertEqual(set_parallel_split_alignment(0), 8)
+        with self.assertRaises(ValueError) as raised:
+            set_parallel_split_alignment(-1)
+        self.assertIn("split alignment must be greater than or equal to zero",
+                      str(raised.exception))
+
+    def test_njit_split_alignment_basic(self):
+        @njit
+        def set_align(n):
+            return set_parallel_split_alignment(n)
+
+        @njit
+        def get_align():
+            return get_parallel_split_alignment()
+
+        self.assertEqual(set_align(16), 0)
+        self.assertEqual(get_align(), 16)
+
+    def test_split_alignment_all_iterations_run(self):
+        @njit(parallel=True)
+        def test_impl(n, m):
+            res = np.zeros((n, m))
+            for i in numba.prange(n):
+                for j in numba.prange(m):
+                    res[i, j] += i * m + j
+            return res
+
+        @njit(parallel=True)
+        def test_impl_1d(n):
+            res = np.zeros(n)
+            for i in numba.prange(n):
+                res[i] += i
+            return res
+
+        for kind in ('static', 'dynamic'):
+            set_parallel_schedule(kind)
+            for align in (1, 3, 8):
+                set_parallel_split_alignment(align)
+                for n, m in ((1, 1), (2, 17), (5, 3), (3, 1000)):
+                    res = test_impl(n, m)
+                    np.testing.assert_equal(res,
+                                            np.arange(n * m).reshape(n, m))
+                for n in (1, 7, 1001):
+                    np.testing.assert_equal(test_impl_1d(n), np.arange(n))
+
+    def test_njit_parallel_schedule_invalid(self):
+        with self.assertRaises(errors.TypingError) as raised:
+            @njit
+            def impl():
+                set_parallel_schedule('bogus')
+
+            impl()
+        self.assertIn("The parallel schedule must be one of",
+                      str(raised.exception))
+
+
 @skip_parfors_unsupported
 @x86_only
 class TestParforsVectorizer(TestPrangeBase):
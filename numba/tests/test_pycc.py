@@ -224,6 +224,19 @@ class TestCC(BasePYCCTest):
             with self.assertRaises(ZeroDivisionError):
                 lib.div(1, 0)
 
+    def test_compile_eager_environments(self):
+        cc = self._test_module.cc
+        self.assertTrue(cc.lazy_environments)
+        cc.lazy_environments = False
+
+        with self.check_cc_compiled(cc) as lib:
+            for _ in range(2):
+                res = lib.multi(123, 321)
+                self.assertPreciseEqual(res, 123 * 321)
+                self.assertIs(lib.get_none(), None)
+                with self.assertRaises(ZeroDivisionError):
+                    lib.div(1, 0)
+
     def check_compile_for_cpu(self, cpu_name):
         cc = self._test_module.cc
         cc.target_cpu = cpu_name
@@ -12,10 +12,12 @@ import itertools
 import numpy as np
 
 import unittest
-from numba import jit, _helperlib
+from numba import jit, _helperlib, config, prange, set_num_threads
 from numba.core import types
 from numba.core.compiler import compile_isolated
-from numba.tests.support import TestCase, compile_function, tag
+from numba.np.random import philox
+from numba.tests.support import (TestCase, compile_function, tag,
+                                 skip_parfors_unsupported)
 from numba.core.errors import TypingError
 
 
@@ -988,6 +990,44 @@ class TestRandomArrays(BaseTest):
         self.assertGreaterEqual(mean, 0.45)
         self.assertLessEqual(mean, 0.55)
 
+    def test_bulk_same_stream(self):
+        # The array variants filled in bulk produce the same stream as the
+        # scalar functions, across reshuffles of the state
+        @jit(nopython=True)
+        def arrays(seed, n):
+            np.random.seed(seed)
+            return (np.random.random(n), np.random.standard_normal(n),
+                    np.random.uniform(0.5, 2.5, n),
+                    np.random.normal(1.0, 3.0, n),
+                    np.random.randint(-3, 1 << 40, n),
+                    np.random.randint(0, 7, n), np.random.random())
+
+        @jit(nopython=True)
+        def scalars(seed, n):
+            np.random.seed(seed)
+            a = np.empty(n)
+            b = np.empty(n)
+            c = np.empty(n)
+            d = np.empty(n)
+            e = np.empty(n, np.int64)
+            f = np.empty(n, np.int64)
+            for i in range(n):
+                a[i] = np.random.random()
+            for i in range(n):
+                b[i] = np.random.standard_normal()
+            for i in range(n):
+                c[i] = np.random.uniform(0.5, 2.5)
+            for i in range(n):
+                d[i] = np.random.normal(1.0, 3.0)
+            for i in range(n):
+                e[i] = np.random.randint(-3, 1 << 40)
+            for i in range(n):
+                f[i] = np.random.randint(0, 7)
+            return a, b, c, d, e, f, np.random.random()
+
+        for seed, n in [(0, 0), (1, 1), (2, 313), (3, 1001)]:
+            self.assertPreciseEqual(arrays(seed, n), scalars(seed, n))
+
     # Sanity-check various distributions.  For convenience, we only check
     # those distributions that produce the exact same values as Numpy's.
 
@@ -1055,6 +1095,75 @@ class TestRandomArrays(BaseTest):
         self._check_array_dist("zipf", (2.5,))
 
 
+class TestPhilox(TestCase):
+    """
+    Test the counter-based generator of numba.np.random.philox.
+    """
+
+    # Known answers from the Random123 distribution
+    kat_vectors = [
+        ((0, 0, 0, 0), (0, 0),
+         (0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8)),
+        ((0xffffffff,) * 4, (0xffffffff,) * 2,
+         (0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd)),
+        ((0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344),
+         (0xa4093822, 0x299f31d0),
+         (0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1)),
+    ]
+
+    def test_known_answers(self):
+        cfunc = jit(nopython=True)(philox.philox4x32)
+        for ctr, key, expected in self.kat_vectors:
+            got = cfunc(*ctr, *key)
+            self.assertEqual(tuple(int(x) for x in got), expected)
+            got = philox.philox4x32(*ctr, *key)
+            self.assertEqual(tuple(int(x) for x in got), expected)
+
+    def test_variates(self):
+        @jit(nopython=True)
+        def draw(seed, stream, n):
+            u = np.empty(n)
+            z = np.empty(n)
+            for i in range(n):
+                u[i] = philox.philox_uniform(seed, stream, i)
+                z[i] = philox.philox_normal(seed, stream + 1, i)
+            return u, z
+
+        u, z = draw(42, 0, 10000)
+        self.assertTrue(np.all(u >= 0.0) and np.all(u < 1.0))
+        self.assertAlmostEqual(u.mean(), 0.5, delta=0.02)
+        self.assertTrue(np.all(np.isfinite(z)))
+        self.assertAlmostEqual(z.mean(), 0.0, delta=0.05)
+        self.assertAlmostEqual(z.std(), 1.0, delta=0.05)
+        # The same in the interpreter
+        for i in (0, 1, 9999):
+            self.assertPreciseEqual(philox.philox_uniform(42, 0, i), u[i])
+        # Another seed or stream gives other variates
+        self.assertFalse(np.any(draw(43, 0, 100)[0] == u[:100]))
+        self.assertFalse(np.any(draw(42, 2, 100)[0] == u[:100]))
+
+    @skip_parfors_unsupported
+    def test_prange_reproducible(self):
+        @jit(nopython=True, parallel=True)
+        def simulate(seed, n, m):
+            out = np.empty(n)
+            for i in prange(n):
+                acc = 0.0
+                for j in range(m):
+                    acc += philox.philox_normal(seed, i, j)
+                out[i] = acc
+            return out
+
+        expected = jit(nopython=True)(simulate.py_func)(7, 50, 20)
+        for nthreads in sorted({1, 2, config.NUMBA_NUM_THREADS}):
+            set_num_threads(min(nthreads, config.NUMBA_NUM_THREADS))
+            try:
+                got = simulate(7, 50, 20)
+            finally:
+                set_num_threads(config.NUMBA_NUM_THREADS)
+            self.assertPreciseEqual(got, expected)
+
+
 class TestRandomChoice(BaseTest):
     """
     Test np.random.choice.
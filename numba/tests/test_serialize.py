@@ -208,6 +208,32 @@ class TestSerializationMisc(TestCase):
         # unpickled results are the same objects
         self.assertIs(got1, got2)
 
+    def test_native_unpickle_cache(self):
+        # Test that numba_unpickle() in _helperlib.c caches its output,
+        # keyed by the data address and the hash
+        import ctypes
+        import hashlib
+        from numba import _helperlib
+
+        proto = ctypes.PYFUNCTYPE(ctypes.py_object, ctypes.c_void_p,
+                                  ctypes.c_int, ctypes.c_char_p)
+        unpickle = proto(_helperlib.c_helpers['unpickle'])
+
+        payload = (ValueError, ("some message",), None)
+        bytebuf = pickle.dumps(payload)
+        data = ctypes.create_string_buffer(bytebuf, len(bytebuf))
+        hashed = hashlib.sha1(bytebuf).digest()
+
+        got1 = unpickle(ctypes.addressof(data), len(bytebuf), hashed)
+        self.assertEqual(got1, payload)
+        got2 = unpickle(ctypes.addressof(data), len(bytebuf), hashed)
+        self.assertIs(got1, got2)
+        # Another hash at the same address is another constant
+        other = hashlib.sha1(bytebuf + b"x").digest()
+        got3 = unpickle(ctypes.addressof(data), len(bytebuf), other)
+        self.assertEqual(got3, payload)
+        self.assertIsNot(got3, got1)
+
 
 
 class TestCloudPickleIssues(TestCase):
@@ -3,7 +3,7 @@ import itertools
 from numba.core import types
 from numba.core.typeconv.typeconv import TypeManager, TypeCastingRules
 from numba.core.typeconv import rules
-from numba.core.typeconv import castgraph, Conversion
+from numba.core.typeconv import castgraph, Conversion, _typeconv
 import unittest
 
 
@@ -91,6 +91,53 @@ class TestTypeConv(CompatibilityTestMixin, unittest.TestCase):
         with self.assertRaises(TypeError):
             sel = tm.select_overload(sig, ovs, False, False)
 
+    def test_large_typecodes(self):
+        # The compatibilities of small and of large typecodes are stored
+        # differently, check pairs of both
+        tm = TypeManager()
+        codes = [0, 1, 15, 16, 255, 256, 1000, 2 ** 20]
+        convs = [Conversion.promote, Conversion.safe, Conversion.unsafe]
+        expected = {}
+        for a, b in itertools.permutations(codes, 2):
+            if (a + b) % 3:
+                conv = convs[(a * b) % 3]
+                _typeconv.set_compatible(tm._ptr, a, b,
+                                         tm._conversion_codes[conv])
+                expected[a, b] = conv
+        for a, b in itertools.product(codes, codes):
+            name = _typeconv.check_compatible(tm._ptr, a, b)
+            conv = Conversion[name] if name is not None else None
+            if a == b:
+                self.assertEqual(conv, Conversion.exact)
+            else:
+                self.assertEqual(conv, expected.get((a, b)), (a, b))
+
+    def test_snapshot(self):
+        tm = TypeManager()
+        rules._init_casting_rules(tm)
+        snapshot = tm.snapshot()
+
+        loaded = TypeManager()
+        self.assertTrue(loaded.load_snapshot(snapshot,
+                                             rules._casting_rule_types))
+        self.check_number_compatibility(loaded.check_compatible)
+        for ta, tb in itertools.product(rules._casting_rule_types,
+                                        repeat=2):
+            self.assertEqual(loaded.check_compatible(ta, tb),
+                             tm.check_compatible(ta, tb))
+
+        # A referenced type is missing from the candidates
+        other = TypeManager()
+        self.assertFalse(other.load_snapshot(snapshot, types.number_domain))
+        self.assertIsNone(other.check_compatible(types.int32, types.int64))
+        # Malformed snapshots
+        self.assertFalse(other.load_snapshot(b'', rules._casting_rule_types))
+        self.assertFalse(other.load_snapshot(snapshot[:-8],
+                                             rules._casting_rule_types))
+        with self.assertRaises(ValueError):
+            _typeconv.load_compatibility(other._ptr, b'NBTC')
+        self.assertIsNone(other.check_compatible(types.int32, types.int64))
+
     def test_default_rules(self):
         tm = rules.default_type_manager
         self.check_number_compatibility(tm.check_compatible)
@@ -186,6 +233,31 @@ class TestTypeConv(CompatibilityTestMixin, unittest.TestCase):
         self.assertEqual(tm.select_overload(sig, ovs, allow_unsafe=True,
                                             exact_match_required=False), 0)
 
+    def test_overload_many(self):
+        # More overloads than are rated on the stack
+        tm = rules.default_type_manager
+
+        i32 = types.int32
+        i64 = types.int64
+        f64 = types.float64
+        c128 = types.complex128
+
+        sig = (i32,) * 8
+        filler = [(c128,) * 8] * 10
+        # Promotions are preferred over safe conversions
+        ovs = filler + [(f64,) * 8, (i64,) * 7 + (f64,)] + filler + [(i64,) * 8]
+        self.assertEqual(tm.select_overload(sig, ovs, allow_unsafe=False,
+                                            exact_match_required=False),
+                         len(ovs) - 1)
+        # Two equally rated overloads are ambiguous
+        with self.assertRaises(TypeError):
+            tm.select_overload(sig, ovs + [(i64,) * 8], allow_unsafe=False,
+                               exact_match_required=False)
+        # No exact match
+        with self.assertRaises(TypeError):
+            tm.select_overload(sig, filler * 2, allow_unsafe=True,
+                               exact_match_required=True)
+
     def test_type_casting_rules(self):
         tm = TypeManager()
         tcr = TypeCastingRules(tm)
@@ -821,6 +821,163 @@ class TestExtend(MemoryLeakMixin, TestCase):
         self.assertEqual(len(l), 1)
         self.assertTrue(l._typed)
 
+    def test_extend_array(self):
+        @njit
+        def impl(arr):
+            l = List.empty_list(types.float64)
+            l.append(-1.0)
+            l.extend(arr)
+            # a strided view goes through a contiguous copy
+            l.extend(arr[::2])
+            return l
+
+        arr = np.arange(10.0)
+        expected = [-1.0] + list(arr) + list(arr[::2])
+        self.assertEqual(list(impl(arr)), expected)
+
+    def test_extend_refcounted(self):
+        @njit
+        def impl(other):
+            l = List.empty_list(types.unicode_type)
+            l.extend(other)
+            l.extend(l)
+            return l
+
+        other = List(['a' * 10, 'b' * 10, 'c' * 10])
+        self.assertEqual(list(impl(other)), list(other) * 2)
+
+    def test_reserve(self):
+        @njit
+        def impl(n):
+            l = List.empty_list(types.int64)
+            l.reserve(n)
+            allocated = l._allocated()
+            for i in range(n):
+                l.append(i)
+            return allocated, l._allocated(), len(l)
+
+        # appending into the reserved space doesn't reallocate
+        self.assertEqual(impl(1000), (1000, 1000, 1000))
+
+        l = List.empty_list(types.int64)
+        l.reserve(10)
+        l.reserve(5)
+        self.assertEqual(l._allocated(), 10)
+
+
+class TestAsArray(MemoryLeakMixin, TestCase):
+    """Zero-copy array views of typed lists"""
+
+    def test_view(self):
+        for dtype in (np.int32, np.float64, np.bool_):
+            values = np.arange(10).astype(dtype)
+            l = List(values)
+            arr = l.as_array()
+            self.assertEqual(arr.dtype, values.dtype)
+            self.assertPreciseEqual(arr, values)
+            self.assertFalse(arr.flags.writeable)
+            self.assertFalse(l._is_mutable())
+            with self.assertRaises(ValueError) as raises:
+                l.append(values[0])
+            self.assertIn("list is immutable", str(raises.exception))
+            # the view still sees the items in place
+            self.assertPreciseEqual(l.as_array(), arr)
+
+    def test_keeps_list_alive(self):
+        @njit
+        def impl(n):
+            l = List.empty_list(types.float64)
+            for i in range(n):
+                l.append(i)
+            return l.as_array()
+
+        arr = impl(100)
+        self.assertPreciseEqual(arr, np.arange(100.0))
+        self.assertPreciseEqual(impl(0), np.zeros(0))
+
+    def test_jit(self):
+        @njit
+        def impl(l):
+            return l.as_array().sum(), l._is_mutable()
+
+        self.assertEqual(impl(List([1, 2, 3])), (6, False))
+
+    def test_not_pod(self):
+        l = List(['a', 'b'])
+        with self.assertRaises(TypingError) as raises:
+            l.as_array()
+        self.assertIn("requires a list of numbers or booleans",
+                      str(raises.exception))
+        with self.assertRaises(RuntimeError):
+            List().as_array()
+
+
+class TestSliceAssignBulk(MemoryLeakMixin, TestCase):
+    """Slice assignments from lists of the same item type and from arrays,
+    which are done in bulk.
+    """
+
+    def check(self, pyfunc, source_factory):
+        cfunc = njit(pyfunc)
+        for start, stop in [(0, 0), (2, 5), (5, 2), (0, 10), (8, 20),
+                            (-3, -1), (3, 4)]:
+            for n in (0, 1, 3, 6):
+                expected = list(range(10))
+                pyfunc(expected, start, stop, list(range(100, 100 + n)))
+                got = List(range(10))
+                cfunc(got, start, stop, source_factory(n))
+                self.assertEqual(list(got), expected,
+                                 msg=(start, stop, n))
+
+    def test_from_list(self):
+        def impl(l, start, stop, items):
+            l[start:stop] = items
+
+        self.check(impl, lambda n: List.empty_list(types.int64)
+                   if n == 0 else List(range(100, 100 + n)))
+
+    def test_from_array(self):
+        def impl(l, start, stop, items):
+            l[start:stop] = items
+
+        self.check(impl, lambda n: np.arange(100, 100 + n))
+
+    def test_self(self):
+        @njit
+        def impl(l):
+            l[2:4] = l
+            return l
+
+        expected = list(range(6))
+        expected[2:4] = list(expected)
+        self.assertEqual(list(impl(List(range(6)))), expected)
+
+    def test_extended_slice(self):
+        @njit
+        def impl(l, items):
+            l[::2] = items
+            return l
+
+        got = impl(List(range(6)), List([10, 11, 12]))
+        self.assertEqual(list(got), [10, 1, 11, 3, 12, 5])
+        with self.assertRaises(ValueError) as raises:
+            impl(List(range(6)), List([10]))
+        self.assertIn("length mismatch", str(raises.exception))
+
+    def test_refcounted(self):
+        @njit
+        def impl(l, items):
+            l[1:2] = items
+            l[0:3] = l
+            return l
+
+        strs = ['x' * 10, 'y' * 10, 'z' * 10]
+        expected = list(strs)
+        expected[1:2] = ['u' * 10, 'v' * 10]
+        expected[0:3] = list(expected)
+        got = impl(List(strs), List(['u' * 10, 'v' * 10]))
+        self.assertEqual(list(got), expected)
+
 
 @njit
 def cmp(a, b):
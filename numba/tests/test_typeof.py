@@ -15,7 +15,7 @@ from numba.core import types
 from numba.core.errors import NumbaValueError
 from numba.misc.special import typeof
 from numba.core.dispatcher import OmittedArg
-from numba._dispatcher import compute_fingerprint
+from numba._dispatcher import compute_fingerprint, hashtable_test
 
 from numba.tests.support import TestCase, tag
 from numba.tests.test_numpy_support import ValueTypingTestBase
@@ -565,5 +565,15 @@ class TestFingerprint(TestCase):
         s = compute_fingerprint(t)
 
 
+
+class TestFingerprintHashtable(TestCase):
+    """
+    Tests for the hash table caching the type codes of fingerprints
+    """
+
+    def test_simple_c_test(self):
+        # Runs the insert, lookup, delete and resize tests in C.
+        self.assertEqual(hashtable_test(), 0)
+
 if __name__ == '__main__':
     unittest.main()
@@ -2254,6 +2254,32 @@ class TestUnicode(BaseTest):
         for s in UNICODE_EXAMPLES + [''] + extras + cpython + sigma:
             self.assertEqual(pyfunc(s), cfunc(s), msg=msg.format(s))
 
+    def test_ascii_bulk_case_and_class(self):
+        # Long ASCII strings go through the bulk routines of _helperlib, and
+        # ASCII characters indexed from wider strings through the loops
+        @njit
+        def case(x):
+            return x.upper(), x.lower(), x.isalpha(), x.isalnum()
+
+        @njit
+        def case_of_item(x, i):
+            return case(x[i])
+
+        printable = ''.join(chr(i) for i in range(128))
+        samples = ['', 'a', 'Z', '@', '[', '`', '{', printable,
+                   printable[::-1], 'Hello World' * 7, 'abcXYZ' * 11,
+                   'abcXYZ' * 11 + '1', '1' + 'abcXYZ' * 11,
+                   'abcdefghijklmnopq[', 'ABCDEFGHIJKLMNOP@q']
+        for s in samples:
+            for t in s, s[3:]:
+                self.assertEqual(case(t), case.py_func(t),
+                                 msg='failed on {!r}'.format(t))
+
+        wide = 'aZ大'
+        for i in range(2):
+            self.assertEqual(case_of_item(wide, i),
+                             case_of_item.py_func(wide, i))
+
     def test_isnumeric(self):
         def pyfunc(x):
             return x.isnumeric()
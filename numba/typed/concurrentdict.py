@@ -0,0 +1,385 @@
+"""
+Compiler-side implementation of the concurrent dictionary, a dictionary safe
+to insert into and look up from many threads at once (e.g. from the
+iterations of a prange loop).
+"""
+import operator
+
+from llvmlite import ir
+
+from numba.core.extending import (
+    overload,
+    overload_method,
+    intrinsic,
+    register_model,
+    models,
+)
+from numba.core import types, cgutils, config
+from numba.core.types import ConcurrentDictType
+from numba.core.errors import TypingError
+from numba.typed.dictobject import DKIX, Status, _raise_if_error
+from numba.typed.typedobjectutils import (_as_bytes, _cast, _nonoptional,
+                                          _sentry_safe_cast_default,
+                                          _container_get_data,)
+
+ll_cdict_type = cgutils.voidptr_t
+ll_status = cgutils.int32_t
+ll_ssize_t = cgutils.intp_t
+ll_hash = ll_ssize_t
+ll_bytes = cgutils.voidptr_t
+
+
+_meminfo_cdictptr = types.MemInfoPointer(types.voidptr)
+
+
+def new_concurrent_dict(key, value, n_shards=0):
+    """Construct a new concurrent dict.
+
+    Parameters
+    ----------
+    key, value : TypeRef
+        Key type and value type of the new dict.  They can't be types
+        needing reference counting, such as strings or arrays.
+    n_shards : int
+        The number of independently locked parts the keys are spread over,
+        rounded up to a power of two.  The default is a multiple of the
+        number of threads.
+    """
+    # With JIT disabled, ignore all arguments and return a Python dict.
+    return dict()
+
+
+@register_model(ConcurrentDictType)
+class ConcurrentDictModel(models.StructModel):
+    def __init__(self, dmm, fe_type):
+        members = [
+            ('meminfo', _meminfo_cdictptr),
+            ('data', types.voidptr),   # ptr to the C concurrent dict
+        ]
+        super(ConcurrentDictModel, self).__init__(dmm, fe_type, members)
+
+
+def _imp_dtor(context, module):
+    """Define the dtor for the concurrent dictionary
+    """
+    llvoidptr = context.get_value_type(types.voidptr)
+    llsize = context.get_value_type(types.uintp)
+    fnty = ir.FunctionType(
+        ir.VoidType(),
+        [llvoidptr, llsize, llvoidptr],
+    )
+    fname = '_numba_cdict_dtor'
+    fn = cgutils.get_or_insert_function(module, fnty, fname)
+
+    if fn.is_declaration:
+        # Set linkage
+        fn.linkage = 'linkonce_odr'
+        # Define
+        builder = ir.IRBuilder(fn.append_basic_block())
+        dp = builder.bitcast(fn.args[0], ll_cdict_type.as_pointer())
+        d = builder.load(dp)
+        free_fnty = ir.FunctionType(ir.VoidType(), [ll_cdict_type])
+        free = cgutils.get_or_insert_function(module, free_fnty,
+                                              'numba_cdict_free')
+        builder.call(free, [d])
+        builder.ret_void()
+
+    return fn
+
+
+@intrinsic
+def _cdict_new(typingctx, n_shards, keyty, valty):
+    """Wrap numba_cdict_new and make the concurrent dictionary struct owning
+    the new dictionary.
+    """
+    cdict_ty = ConcurrentDictType(keyty.instance_type, valty.instance_type)
+    sig = cdict_ty(types.intp, keyty, valty)
+
+    def codegen(context, builder, sig, args):
+        fnty = ir.FunctionType(
+            ll_status,
+            [ll_cdict_type.as_pointer(), ll_ssize_t, ll_ssize_t, ll_ssize_t],
+        )
+        fn = cgutils.get_or_insert_function(builder.module, fnty,
+                                            'numba_cdict_new')
+        # Determine sizeof key and value types
+        ll_key = context.get_data_type(cdict_ty.key_type)
+        ll_val = context.get_data_type(cdict_ty.value_type)
+        sz_key = context.get_abi_sizeof(ll_key)
+        sz_val = context.get_abi_sizeof(ll_val)
+        refdp = cgutils.alloca_once(builder, ll_cdict_type, zfill=True)
+        status = builder.call(
+            fn,
+            [refdp, args[0], ll_ssize_t(sz_key), ll_ssize_t(sz_val)],
+        )
+        _raise_if_error(
+            context, builder, status,
+            msg="Failed to allocate concurrent dictionary",
+        )
+        ptr = builder.load(refdp)
+
+        ctor = cgutils.create_struct_proxy(cdict_ty)
+        dstruct = ctor(context, builder)
+        dstruct.data = ptr
+
+        alloc_size = context.get_abi_sizeof(
+            context.get_value_type(types.voidptr),
+        )
+        dtor = _imp_dtor(context, builder.module)
+        meminfo = context.nrt.meminfo_alloc_dtor(
+            builder,
+            context.get_constant(types.uintp, alloc_size),
+            dtor,
+        )
+
+        data_pointer = context.nrt.meminfo_data(builder, meminfo)
+        data_pointer = builder.bitcast(data_pointer,
+                                       ll_cdict_type.as_pointer())
+        builder.store(ptr, data_pointer)
+
+        dstruct.meminfo = meminfo
+
+        return dstruct._getvalue()
+
+    return sig, codegen
+
+
+@intrinsic
+def _cdict_insert(typingctx, d, key, hashval, val):
+    """Wrap numba_cdict_insert
+    """
+    resty = types.int32
+    sig = resty(d, d.key_type, types.intp, d.value_type)
+
+    def codegen(context, builder, sig, args):
+        fnty = ir.FunctionType(
+            ll_status,
+            [ll_cdict_type, ll_bytes, ll_hash, ll_bytes, ll_bytes],
+        )
+        [d, key, hashval, val] = args
+        [td, tkey, thashval, tval] = sig.args
+        fn = cgutils.get_or_insert_function(builder.module, fnty,
+                                            'numba_cdict_insert')
+
+        dm_key = context.data_model_manager[tkey]
+        dm_val = context.data_model_manager[tval]
+
+        data_key = dm_key.as_data(builder, key)
+        data_val = dm_val.as_data(builder, val)
+
+        ptr_key = cgutils.alloca_once_value(builder, data_key)
+        cgutils.memset_padding(builder, ptr_key)
+
+        ptr_val = cgutils.alloca_once_value(builder, data_val)
+        ptr_oldval = cgutils.alloca_once(builder, data_val.type)
+
+        dp = _container_get_data(context, builder, td, d)
+        status = builder.call(
+            fn,
+            [
+                dp,
+                _as_bytes(builder, ptr_key),
+                hashval,
+                _as_bytes(builder, ptr_val),
+                _as_bytes(builder, ptr_oldval),
+            ],
+        )
+        return status
+
+    return sig, codegen
+
+
+@intrinsic
+def _cdict_lookup(typingctx, d, key, hashval):
+    """Wrap numba_cdict_lookup
+
+    Returns 2-tuple of (intp, ?value_type)
+    """
+    resty = types.Tuple([types.intp, types.Optional(d.value_type)])
+    sig = resty(d, key, hashval)
+
+    def codegen(context, builder, sig, args):
+        fnty = ir.FunctionType(
+            ll_ssize_t,
+            [ll_cdict_type, ll_bytes, ll_hash, ll_bytes],
+        )
+        [td, tkey, thashval] = sig.args
+        [d, key, hashval] = args
+        fn = cgutils.get_or_insert_function(builder.module, fnty,
+                                            'numba_cdict_lookup')
+
+        dm_key = context.data_model_manager[tkey]
+        dm_val = context.data_model_manager[td.value_type]
+
+        data_key = dm_key.as_data(builder, key)
+        ptr_key = cgutils.alloca_once_value(builder, data_key)
+        cgutils.memset_padding(builder, ptr_key)
+
+        ll_val = context.get_data_type(td.value_type)
+        ptr_val = cgutils.alloca_once(builder, ll_val)
+
+        dp = _container_get_data(context, builder, td, d)
+        ix = builder.call(
+            fn,
+            [
+                dp,
+                _as_bytes(builder, ptr_key),
+                hashval,
+                _as_bytes(builder, ptr_val),
+            ],
+        )
+        # Load value if output is available
+        found = builder.icmp_signed('>', ix, ix.type(int(DKIX.EMPTY)))
+
+        out = context.make_optional_none(builder, td.value_type)
+        pout = cgutils.alloca_once_value(builder, out)
+
+        with builder.if_then(found):
+            val = dm_val.load_from_data_pointer(builder, ptr_val)
+            loaded = context.make_optional_value(builder, td.value_type, val)
+            builder.store(loaded, pout)
+
+        out = builder.load(pout)
+        return context.make_tuple(builder, resty, [ix, out])
+
+    return sig, codegen
+
+
+@intrinsic
+def _cdict_length(typingctx, d):
+    """Wrap numba_cdict_length
+    """
+    resty = types.intp
+    sig = resty(d)
+
+    def codegen(context, builder, sig, args):
+        fnty = ir.FunctionType(
+            ll_ssize_t,
+            [ll_cdict_type],
+        )
+        fn = cgutils.get_or_insert_function(builder.module, fnty,
+                                            'numba_cdict_length')
+        [d] = args
+        [td] = sig.args
+        dp = _container_get_data(context, builder, td, d)
+        return builder.call(fn, [dp])
+
+    return sig, codegen
+
+
+@overload(new_concurrent_dict)
+def impl_new_concurrent_dict(key, value, n_shards=0):
+    """Creates a new concurrent dictionary with *key* and *value* as the
+    type of the dictionary key and value, respectively.
+    """
+    if any([
+        not isinstance(key, types.TypeRef),
+        not isinstance(value, types.TypeRef),
+    ]):
+        raise TypeError("expecting *key* and *value* to be a numba Type")
+
+    from numba.core.datamodel import default_manager
+    for ty in (key.instance_type, value.instance_type):
+        if default_manager[ty].contains_nrt_meminfo():
+            raise TypingError("concurrent dicts can't hold values that are "
+                              "reference counted, got {}".format(ty))
+
+    keyty, valty = key, value
+    # four shards per thread keep the threads mostly on different locks
+    default_shards = 4 * config.NUMBA_NUM_THREADS
+
+    def imp(key, value, n_shards=0):
+        if n_shards < 0:
+            raise RuntimeError("expecting *n_shards* to be >= 0")
+        if n_shards == 0:
+            n_shards = default_shards
+        return _cdict_new(n_shards, keyty, valty)
+
+    return imp
+
+
+@overload(len)
+def impl_len(d):
+    """len(concurrent dict)
+    """
+    if not isinstance(d, types.ConcurrentDictType):
+        return
+
+    def impl(d):
+        return _cdict_length(d)
+
+    return impl
+
+
+@overload_method(types.ConcurrentDictType, '__setitem__')
+@overload(operator.setitem)
+def impl_setitem(d, key, value):
+    if not isinstance(d, types.ConcurrentDictType):
+        return
+
+    keyty, valty = d.key_type, d.value_type
+
+    def impl(d, key, value):
+        castedkey = _cast(key, keyty)
+        castedval = _cast(value, valty)
+        status = _cdict_insert(d, castedkey, hash(castedkey), castedval)
+        if status == Status.OK or status == Status.OK_REPLACED:
+            return
+        elif status == Status.ERR_CMP_FAILED:
+            raise ValueError('key comparison failed')
+        else:
+            raise RuntimeError('dict.__setitem__ failed unexpectedly')
+
+    return impl
+
+
+@overload_method(types.ConcurrentDictType, 'get')
+def impl_get(dct, key, default=None):
+    if not isinstance(dct, types.ConcurrentDictType):
+        return
+    keyty = dct.key_type
+    valty = dct.value_type
+    _sentry_safe_cast_default(default, valty)
+
+    def impl(dct, key, default=None):
+        castedkey = _cast(key, keyty)
+        ix, val = _cdict_lookup(dct, castedkey, hash(castedkey))
+        if ix > DKIX.EMPTY:
+            return val
+        return default
+
+    return impl
+
+
+@overload(operator.getitem)
+def impl_getitem(d, key):
+    if not isinstance(d, types.ConcurrentDictType):
+        return
+
+    keyty = d.key_type
+
+    def impl(d, key):
+        castedkey = _cast(key, keyty)
+        ix, val = _cdict_lookup(d, castedkey, hash(castedkey))
+        if ix == DKIX.EMPTY:
+            raise KeyError()
+        elif ix < DKIX.EMPTY:
+            raise AssertionError("internal dict error during lookup")
+        else:
+            return _nonoptional(val)
+
+    return impl
+
+
+@overload(operator.contains)
+def impl_contains(d, k):
+    if not isinstance(d, types.ConcurrentDictType):
+        return
+
+    keyty = d.key_type
+
+    def impl(d, k):
+        k = _cast(k, keyty)
+        ix, val = _cdict_lookup(d, k, hash(k))
+        return ix > DKIX.EMPTY
+    return impl
@@ -5,6 +5,7 @@ import ctypes
 import operator
 from enum import IntEnum
 
+import numpy as np
 from llvmlite import ir
 
 from numba import _helperlib
@@ -20,7 +21,7 @@ from numba.core.extending import (
     make_attribute_wrapper,
 )
 from numba.core.imputils import iternext_impl, impl_ret_untracked
-from numba.core import types, cgutils
+from numba.core import types, cgutils, config
 from numba.core.types import (
     DictType,
     DictItemsIterableType,
@@ -32,6 +33,7 @@ from numba.core.types import (
 from numba.core.imputils import impl_ret_borrowed, RefType
 from numba.core.errors import TypingError, LoweringError
 from numba.core import typing
+from numba.np.numpy_support import as_dtype
 from numba.typed.typedobjectutils import (_as_bytes, _cast, _nonoptional,
                                           _sentry_safe_cast_default,
                                           _get_incref_decref,
@@ -69,13 +71,39 @@ class Status(IntEnum):
     ERR_CMP_FAILED = -5
 
 
-def new_dict(key, value):
+class Layout(IntEnum):
+    """Layout of the hash table, must match the D_LAYOUT_* in dictobject.h
+    """
+    COMPACT = 0
+    SWISS = 1
+
+
+def set_default_layout(layout):
+    """Set the layout of the hash table of the dicts created from now on,
+    returns the previous one.
+    """
+    proto = ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_int)
+    fn = proto(_helperlib.c_helpers['dict_set_default_layout'])
+    return Layout(fn(Layout(layout)))
+
+
+if config.DICT_LAYOUT != 'compact':
+    try:
+        set_default_layout(Layout[config.DICT_LAYOUT.upper()])
+    except KeyError:
+        raise ValueError("NUMBA_DICT_LAYOUT must be 'compact' or 'swiss', "
+                         "got %r" % config.DICT_LAYOUT)
+
+
+def new_dict(key, value, n_keys=0):
     """Construct a new dict.
 
     Parameters
     ----------
     key, value : TypeRef
         Key type and value type of the new dict.
+    n_keys : int
+        The number of keys the dict holds before it is resized.
     """
     # With JIT disabled, ignore all arguments and return a Python dict.
     return dict()
@@ -253,6 +281,50 @@ def _dict_new_minsize(typingctx, keyty, valty):
     return sig, codegen
 
 
+@intrinsic
+def _dict_new_sized(typingctx, n_keys, keyty, valty):
+    """Wrap numba_dict_new_sized.
+
+    Allocate a new dictionary object with room for *n_keys* keys.
+
+    Parameters
+    ----------
+    n_keys: int
+        The number of keys the dictionary holds before it is resized.
+    keyty, valty: Type
+        Type of the key and value, respectively.
+
+    """
+    resty = types.voidptr
+    sig = resty(types.intp, keyty, valty)
+
+    def codegen(context, builder, sig, args):
+        fnty = ir.FunctionType(
+            ll_status,
+            [ll_dict_type.as_pointer(), ll_ssize_t, ll_ssize_t, ll_ssize_t],
+        )
+        fn = cgutils.get_or_insert_function(builder.module, fnty,
+                                            'numba_dict_new_sized')
+        # Determine sizeof key and value types
+        ll_key = context.get_data_type(keyty.instance_type)
+        ll_val = context.get_data_type(valty.instance_type)
+        sz_key = context.get_abi_sizeof(ll_key)
+        sz_val = context.get_abi_sizeof(ll_val)
+        refdp = cgutils.alloca_once(builder, ll_dict_type, zfill=True)
+        status = builder.call(
+            fn,
+            [refdp, args[0], ll_ssize_t(sz_key), ll_ssize_t(sz_val)],
+        )
+        _raise_if_error(
+            context, builder, status,
+            msg="Failed to allocate dictionary",
+        )
+        dp = builder.load(refdp)
+        return dp
+
+    return sig, codegen
+
+
 @intrinsic
 def _dict_set_method_table(typingctx, dp, keyty, valty):
     """Wrap numba_dict_set_method_table
@@ -371,6 +443,50 @@ def _dict_insert(typingctx, d, key, hashval, val):
     return sig, codegen
 
 
+@intrinsic
+def _dict_reserve(typingctx, d, n_keys):
+    """Wrap numba_dict_reserve
+    """
+    resty = types.int32
+    sig = resty(d, types.intp)
+
+    def codegen(context, builder, sig, args):
+        fnty = ir.FunctionType(
+            ll_status,
+            [ll_dict_type, ll_ssize_t],
+        )
+        fn = cgutils.get_or_insert_function(builder.module, fnty,
+                                            'numba_dict_reserve')
+        [d, n_keys] = args
+        [td, _] = sig.args
+        dp = _container_get_data(context, builder, td, d)
+        return builder.call(fn, [dp, n_keys])
+
+    return sig, codegen
+
+
+@intrinsic
+def _dict_compact(typingctx, d):
+    """Wrap numba_dict_compact
+    """
+    resty = types.int32
+    sig = resty(d)
+
+    def codegen(context, builder, sig, args):
+        fnty = ir.FunctionType(
+            ll_status,
+            [ll_dict_type],
+        )
+        fn = cgutils.get_or_insert_function(builder.module, fnty,
+                                            'numba_dict_compact')
+        [d] = args
+        [td] = sig.args
+        dp = _container_get_data(context, builder, td, d)
+        return builder.call(fn, [dp])
+
+    return sig, codegen
+
+
 @intrinsic
 def _dict_length(typingctx, d):
     """Wrap numba_dict_length
@@ -477,6 +593,90 @@ def _dict_lookup(typingctx, d, key, hashval):
     return sig, codegen
 
 
+@intrinsic
+def _dict_insert_many(typingctx, d, keys, hashes, vals):
+    """Wrap numba_dict_insert_many
+
+    *keys*, *hashes* and *vals* are C-contiguous 1D arrays of the same length,
+    the dtype of *keys* and *vals* matching the key and value type of *d*.
+    """
+    resty = types.int32
+    sig = resty(d, keys, hashes, vals)
+
+    def codegen(context, builder, sig, args):
+        fnty = ir.FunctionType(
+            ll_status,
+            [ll_dict_type, ll_bytes, ll_bytes, ll_bytes, ll_ssize_t],
+        )
+        [td, tkeys, thashes, tvals] = sig.args
+        [d, keys, hashes, vals] = args
+        fn = cgutils.get_or_insert_function(builder.module, fnty,
+                                            'numba_dict_insert_many')
+
+        ary_keys = context.make_array(tkeys)(context, builder, keys)
+        ary_hashes = context.make_array(thashes)(context, builder, hashes)
+        ary_vals = context.make_array(tvals)(context, builder, vals)
+        n = builder.extract_value(ary_keys.shape, 0)
+
+        dp = _container_get_data(context, builder, td, d)
+        status = builder.call(
+            fn,
+            [
+                dp,
+                _as_bytes(builder, ary_keys.data),
+                _as_bytes(builder, ary_hashes.data),
+                _as_bytes(builder, ary_vals.data),
+                n,
+            ],
+        )
+        return status
+
+    return sig, codegen
+
+
+@intrinsic
+def _dict_lookup_many(typingctx, d, keys, hashes, ixs, out):
+    """Wrap numba_dict_lookup_many
+
+    The entry index of each key is written to *ixs* and its value, if found,
+    to *out*. Returns the number of keys found, or a negative value on error.
+    """
+    resty = types.intp
+    sig = resty(d, keys, hashes, ixs, out)
+
+    def codegen(context, builder, sig, args):
+        fnty = ir.FunctionType(
+            ll_ssize_t,
+            [ll_dict_type, ll_bytes, ll_bytes, ll_ssize_t, ll_bytes, ll_bytes],
+        )
+        [td, tkeys, thashes, tixs, tout] = sig.args
+        [d, keys, hashes, ixs, out] = args
+        fn = cgutils.get_or_insert_function(builder.module, fnty,
+                                            'numba_dict_lookup_many')
+
+        ary_keys = context.make_array(tkeys)(context, builder, keys)
+        ary_hashes = context.make_array(thashes)(context, builder, hashes)
+        ary_ixs = context.make_array(tixs)(context, builder, ixs)
+        ary_out = context.make_array(tout)(context, builder, out)
+        n = builder.extract_value(ary_keys.shape, 0)
+
+        dp = _container_get_data(context, builder, td, d)
+        found = builder.call(
+            fn,
+            [
+                dp,
+                _as_bytes(builder, ary_keys.data),
+                _as_bytes(builder, ary_hashes.data),
+                n,
+                _as_bytes(builder, ary_ixs.data),
+                _as_bytes(builder, ary_out.data),
+            ],
+        )
+        return found
+
+    return sig, codegen
+
+
 @intrinsic
 def _dict_popitem(typingctx, d):
     """Wrap numba_dict_popitem
@@ -644,9 +844,10 @@ def _make_dict(typingctx, keyty, valty, ptr):
 
 
 @overload(new_dict)
-def impl_new_dict(key, value):
+def impl_new_dict(key, value, n_keys=0):
     """Creates a new dictionary with *key* and *value* as the type
-    of the dictionary key and value, respectively.
+    of the dictionary key and value, respectively, with room for
+    *n_keys* keys.
     """
     if any([
         not isinstance(key, Type),
@@ -656,8 +857,10 @@ def impl_new_dict(key, value):
 
     keyty, valty = key, value
 
-    def imp(key, value):
-        dp = _dict_new_minsize(keyty, valty)
+    def imp(key, value, n_keys=0):
+        if n_keys < 0:
+            raise RuntimeError("expecting *n_keys* to be >= 0")
+        dp = _dict_new_sized(n_keys, keyty, valty)
         _dict_set_method_table(dp, keyty, valty)
         d = _make_dict(keyty, valty, dp)
         return d
@@ -857,7 +1060,7 @@ def impl_copy(d):
     key_type, val_type = d.key_type, d.value_type
 
     def impl(d):
-        newd = new_dict(key_type, val_type)
+        newd = new_dict(key_type, val_type, len(d))
         for k, v in d.items():
             newd[k] = v
         return newd
@@ -878,6 +1081,98 @@ def impl_setdefault(dct, key, default=None):
     return impl
 
 
+def _sentry_bulk_array(arr, ty, what):
+    """Check that *arr* is a 1D array of scalars of type *ty*
+    """
+    if not (isinstance(arr, types.Array) and arr.ndim == 1):
+        raise TypingError('{} must be a 1D array, got {}'.format(what, arr))
+    if not isinstance(ty, (types.Number, types.Boolean)):
+        raise TypingError('bulk operations require scalar keys and values, '
+                          'got {}'.format(ty))
+    if arr.dtype != ty:
+        raise TypingError('{} must be an array of {}, got {}'.format(
+            what, ty, arr))
+
+
+@overload_method(types.DictType, 'insert_many')
+def impl_insert_many(d, keys, values):
+    if not isinstance(d, types.DictType):
+        return
+    _sentry_bulk_array(keys, d.key_type, 'keys')
+    _sentry_bulk_array(values, d.value_type, 'values')
+
+    def impl(d, keys, values):
+        n = len(keys)
+        if len(values) != n:
+            raise ValueError('keys and values must have the same length')
+        keys = np.ascontiguousarray(keys)
+        hashes = np.empty(n, np.intp)
+        for i in range(n):
+            hashes[i] = hash(keys[i])
+        status = _dict_insert_many(d, keys, hashes,
+                                   np.ascontiguousarray(values))
+        if status == Status.ERR_NO_MEMORY:
+            raise MemoryError()
+        elif status == Status.ERR_CMP_FAILED:
+            raise ValueError('key comparison failed')
+        elif status < Status.OK:
+            raise RuntimeError('dict.insert_many failed unexpectedly')
+
+    return impl
+
+
+@overload_method(types.DictType, 'lookup_many')
+def impl_lookup_many(d, keys, default):
+    if not isinstance(d, types.DictType):
+        return
+    _sentry_bulk_array(keys, d.key_type, 'keys')
+    _sentry_safe_cast_default(default, d.value_type)
+    dtype = as_dtype(d.value_type).type
+
+    def impl(d, keys, default):
+        n = len(keys)
+        keys = np.ascontiguousarray(keys)
+        hashes = np.empty(n, np.intp)
+        for i in range(n):
+            hashes[i] = hash(keys[i])
+        ixs = np.empty(n, np.intp)
+        out = np.empty(n, dtype)
+        found = _dict_lookup_many(d, keys, hashes, ixs, out)
+        if found < 0:
+            raise ValueError('key comparison failed')
+        if found < n:
+            for i in range(n):
+                if ixs[i] == DKIX.EMPTY:
+                    out[i] = default
+        return out
+
+    return impl
+
+
+@overload_method(types.DictType, 'reserve')
+def impl_reserve(d, n_keys):
+    if not isinstance(d, types.DictType):
+        return
+
+    def impl(d, n_keys):
+        if _dict_reserve(d, n_keys) != Status.OK:
+            raise MemoryError()
+
+    return impl
+
+
+@overload_method(types.DictType, 'compact')
+def impl_compact(d):
+    if not isinstance(d, types.DictType):
+        return
+
+    def impl(d):
+        if _dict_compact(d) != Status.OK:
+            raise MemoryError()
+
+    return impl
+
+
 @overload_method(types.DictType, 'items')
 def impl_items(d):
     if not isinstance(d, types.DictType):
@@ -4,6 +4,7 @@ Compiler-side implementation of the Numba  typed-list.
 import operator
 from enum import IntEnum
 
+import numpy as np
 from llvmlite import ir
 
 from numba.core.extending import (
@@ -589,6 +590,195 @@ def _list_append(typingctx, l, item):
     return sig, codegen
 
 
+def _is_bulk_source(items, itemty):
+    """Whether the items of *items* can be copied into a list of *itemty*
+    in bulk: a list of the same item type, or a 1D array of scalars of the
+    item type.
+    """
+    if isinstance(items, types.ListType):
+        return items.item_type == itemty
+    return (isinstance(items, types.Array) and items.ndim == 1 and
+            items.layout == 'C' and items.dtype == itemty and
+            isinstance(itemty, (types.Number, types.Boolean)))
+
+
+def _bulk_source_codegen(context, builder, ty, val):
+    """Return the pointer to and the number of the items of a bulk source
+    """
+    if isinstance(ty, types.ListType):
+        other = _container_get_data(context, builder, ty, val)
+        fn_base = cgutils.get_or_insert_function(
+            builder.module,
+            ir.FunctionType(ll_bytes, [ll_list_type]),
+            'numba_list_base_ptr',
+        )
+        fn_length = cgutils.get_or_insert_function(
+            builder.module,
+            ir.FunctionType(ll_ssize_t, [ll_list_type]),
+            'numba_list_length',
+        )
+        return builder.call(fn_base, [other]), builder.call(fn_length, [other])
+    ary = context.make_array(ty)(context, builder, val)
+    return (_as_bytes(builder, ary.data),
+            builder.extract_value(ary.shape, 0))
+
+
+@intrinsic
+def _list_extend(typingctx, l, items):
+    """Wrap numba_list_extend
+
+    *items* is a list of the same item type or a C-contiguous 1D array.
+    """
+    resty = types.int32
+    sig = resty(l, items)
+
+    def codegen(context, builder, sig, args):
+        fnty = ir.FunctionType(
+            ll_status,
+            [ll_list_type, ll_bytes, ll_ssize_t],
+        )
+        [l, items] = args
+        [tl, titems] = sig.args
+        fn = cgutils.get_or_insert_function(builder.module, fnty,
+                                            'numba_list_extend')
+        ptr, n = _bulk_source_codegen(context, builder, titems, items)
+        lp = _container_get_data(context, builder, tl, l)
+        return builder.call(fn, [lp, ptr, n])
+
+    return sig, codegen
+
+
+@intrinsic
+def _list_assign_slice(typingctx, l, start, stop, items):
+    """Wrap numba_list_assign_slice
+
+    *items* is a list of the same item type or a C-contiguous 1D array.
+    """
+    resty = types.int32
+    sig = resty(l, INDEXTY, INDEXTY, items)
+
+    def codegen(context, builder, sig, args):
+        fnty = ir.FunctionType(
+            ll_status,
+            [ll_list_type, ll_ssize_t, ll_ssize_t, ll_bytes, ll_ssize_t],
+        )
+        [l, start, stop, items] = args
+        [tl, _, _, titems] = sig.args
+        fn = cgutils.get_or_insert_function(builder.module, fnty,
+                                            'numba_list_assign_slice')
+        ptr, n = _bulk_source_codegen(context, builder, titems, items)
+        lp = _container_get_data(context, builder, tl, l)
+        return builder.call(fn, [lp, start, stop, ptr, n])
+
+    return sig, codegen
+
+
+@intrinsic
+def _list_reserve(typingctx, l, allocated):
+    """Wrap numba_list_reserve
+    """
+    resty = types.int32
+    sig = resty(l, INDEXTY)
+
+    def codegen(context, builder, sig, args):
+        fnty = ir.FunctionType(
+            ll_status,
+            [ll_list_type, ll_ssize_t],
+        )
+        [l, allocated] = args
+        [tl, _] = sig.args
+        fn = cgutils.get_or_insert_function(builder.module, fnty,
+                                            'numba_list_reserve')
+        lp = _container_get_data(context, builder, tl, l)
+        return builder.call(fn, [lp, allocated])
+
+    return sig, codegen
+
+
+@register_jitable
+def _raise_if_bulk_failed(status):
+    if status == ListStatus.LIST_OK:
+        return
+    elif status == ListStatus.LIST_ERR_IMMUTABLE:
+        raise ValueError('list is immutable')
+    elif status == ListStatus.LIST_ERR_NO_MEMORY:
+        raise MemoryError('Unable to allocate memory to add the items')
+    else:
+        raise AssertionError('internal list error during bulk operation')
+
+
+@overload_method(types.ListType, 'reserve')
+def impl_reserve(l, allocated):
+    """list.reserve(allocated)
+
+    Make room for *allocated* items in total, such that appending up to that
+    many items does not reallocate the list.
+    """
+    if not isinstance(l, types.ListType):
+        return
+
+    def impl(l, allocated):
+        _raise_if_bulk_failed(_list_reserve(l, allocated))
+
+    return impl
+
+
+@intrinsic
+def _list_as_array(typingctx, l):
+    """Return a read-only 1D array viewing the items of the list *l*.
+
+    The array shares the meminfo of the list, which it keeps alive.
+    """
+    if not (isinstance(l, types.ListType) and
+            isinstance(l.item_type, (types.Number, types.Boolean))):
+        raise TypingError('expected a list of numbers or booleans')
+    arrty = types.Array(l.item_type, 1, 'C', readonly=True)
+    sig = arrty(l)
+
+    def codegen(context, builder, sig, args):
+        [tl] = sig.args
+        [l] = args
+        lstruct = cgutils.create_struct_proxy(tl)(context, builder, value=l)
+        ptr, n = _bulk_source_codegen(context, builder, tl, l)
+        ary = context.make_array(arrty)(context, builder)
+        itemsize = context.get_abi_sizeof(
+            context.get_data_type(arrty.dtype))
+        context.populate_array(
+            ary,
+            data=builder.bitcast(ptr, ary.data.type),
+            shape=[n],
+            strides=[context.get_constant(types.intp, itemsize)],
+            itemsize=context.get_constant(types.intp, itemsize),
+            meminfo=lstruct.meminfo,
+        )
+        # The reference to the list is now owned by the array
+        context.nrt.incref(builder, tl, l)
+        return ary._getvalue()
+
+    return sig, codegen
+
+
+@overload_method(types.ListType, 'as_array')
+def impl_as_array(l):
+    """list.as_array()
+
+    Return a read-only 1D array viewing the items of a list of numbers or
+    booleans without copying them. The list is made immutable, as resizing
+    it would move the items from under the view.
+    """
+    if not isinstance(l, types.ListType):
+        return
+    if not isinstance(l.item_type, (types.Number, types.Boolean)):
+        raise TypingError('as_array() requires a list of numbers or booleans, '
+                          'got {}'.format(l))
+
+    def impl(l):
+        l._make_immutable()
+        return _list_as_array(l)
+
+    return impl
+
+
 @overload_method(types.ListType, 'append')
 def impl_append(l, item):
     if not isinstance(l, types.ListType):
@@ -854,6 +1044,31 @@ def impl_setitem(l, index, item):
             raise TypingError("can only assign an iterable when using a slice "
                               "with assignment/setitem")
 
+        def impl_slice_bulk(l, index, item):
+            if not l._is_mutable():
+                raise ValueError("list is immutable")
+            slice_range = handle_slice(l, index)
+            # non-extended (simple) slices replace the items all at once
+            if slice_range.step == 1:
+                start = slice_range.start
+                stop = max(start, slice_range.stop)
+                status = _list_assign_slice(l, start, stop,
+                                            _contiguous(item))
+                _raise_if_bulk_failed(status)
+            # Extended slices
+            else:
+                if l is item:
+                    item = item.copy()
+                if len(slice_range) != len(item):
+                    raise ValueError("length mismatch for extended slice "
+                                     "and sequence")
+                # extended slice can only replace
+                for i, j in zip(slice_range, item):
+                    l[i] = j
+
+        if _is_bulk_source(_contiguous_type(item), itemty):
+            return impl_slice_bulk
+
         def impl_slice(l, index, item):
             if not l._is_mutable():
                 raise ValueError("list is immutable")
@@ -1057,6 +1272,27 @@ def impl_count(l, item):
     return impl
 
 
+def _contiguous_type(items):
+    """The type of _contiguous(items)"""
+    if isinstance(items, types.Array) and items.ndim == 1:
+        return items.copy(layout='C')
+    return items
+
+
+def _contiguous(items):
+    pass
+
+
+@overload(_contiguous)
+def impl_contiguous(items):
+    """Make a C-contiguous copy of a non-contiguous 1D array, return any other
+    *items* as is.
+    """
+    if isinstance(items, types.Array) and items.ndim == 1:
+        return lambda items: np.ascontiguousarray(items)
+    return lambda items: items
+
+
 @overload_method(types.ListType, 'extend')
 def impl_extend(l, iterable):
     if not isinstance(l, types.ListType):
@@ -1067,7 +1303,13 @@ def impl_extend(l, iterable):
     _check_for_none_typed(l, 'extend')
 
     def select_impl():
-        if isinstance(iterable, types.ListType):
+        if _is_bulk_source(_contiguous_type(iterable), l.item_type):
+            # a single copy of all the items, l.extend(l) included
+            def impl(l, iterable):
+                _raise_if_bulk_failed(_list_extend(l, _contiguous(iterable)))
+
+            return impl
+        elif isinstance(iterable, types.ListType):
             def impl(l, iterable):
                 if not l._is_mutable():
                     raise ValueError("list is immutable")
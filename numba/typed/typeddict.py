@@ -2,9 +2,12 @@
 Python wrapper that connects CPython interpreter to the numba dictobject.
 """
 from collections.abc import MutableMapping
+
+import numpy as np
+
 from numba.core.types import DictType
 from numba.core.imputils import numba_typeref_ctor
-from numba import njit, typeof
+from numba import njit, typeof, _dispatcher
 from numba.core import types, errors, config, cgutils
 from numba.core.extending import (
     overload,
@@ -19,8 +22,9 @@ from numba.core.typing import signature
 
 
 @njit
-def _make_dict(keyty, valty):
-    return dictobject._as_meminfo(dictobject.new_dict(keyty, valty))
+def _make_dict(keyty, valty, n_keys=0):
+    return dictobject._as_meminfo(dictobject.new_dict(keyty, valty,
+                                                      n_keys=n_keys))
 
 
 @njit
@@ -73,6 +77,26 @@ def _copy(d):
     return d.copy()
 
 
+@njit
+def _reserve(d, n_keys):
+    d.reserve(n_keys)
+
+
+@njit
+def _compact(d):
+    d.compact()
+
+
+@njit
+def _insert_many(d, keys, values):
+    d.insert_many(keys, values)
+
+
+@njit
+def _lookup_many(d, keys, default):
+    return d.lookup_many(keys, default)
+
+
 def _from_meminfo_ptr(ptr, dicttype):
     d = Dict(meminfo=ptr, dcttype=dicttype)
     return d
@@ -91,14 +115,15 @@ class Dict(MutableMapping):
             return object.__new__(cls)
 
     @classmethod
-    def empty(cls, key_type, value_type):
+    def empty(cls, key_type, value_type, n_keys=0):
         """Create a new empty Dict with *key_type* and *value_type*
         as the types for the keys and values of the dictionary respectively.
+        The dictionary holds *n_keys* keys before it is resized.
         """
         if config.DISABLE_JIT:
             return dict()
         else:
-            return cls(dcttype=DictType(key_type, value_type))
+            return cls(dcttype=DictType(key_type, value_type), n_keys=n_keys)
 
     def __init__(self, **kwargs):
         """
@@ -111,20 +136,23 @@ class Dict(MutableMapping):
             Used internally for the dictionary type.
         meminfo : MemInfo; keyword-only
             Used internally to pass the MemInfo object when boxing.
+        n_keys : int; keyword-only
+            Used internally for the number of keys to make room for.
         """
         if kwargs:
             self._dict_type, self._opaque = self._parse_arg(**kwargs)
         else:
             self._dict_type = None
 
-    def _parse_arg(self, dcttype, meminfo=None):
+    def _parse_arg(self, dcttype, meminfo=None, n_keys=0):
         if not isinstance(dcttype, DictType):
             raise TypeError('*dcttype* must be a DictType')
 
         if meminfo is not None:
             opaque = meminfo
         else:
-            opaque = _make_dict(dcttype.key_type, dcttype.value_type)
+            opaque = _make_dict(dcttype.key_type, dcttype.value_type,
+                                n_keys=n_keys)
         return dcttype, opaque
 
     @property
@@ -207,14 +235,50 @@ class Dict(MutableMapping):
     def copy(self):
         return _copy(self)
 
+    def reserve(self, n_keys):
+        """Make room for *n_keys* keys in total, such that they can be
+        inserted without resizing the dictionary.
+        """
+        if self._typed:
+            _reserve(self, n_keys)
+
+    def compact(self):
+        """Drop the space held by the deleted keys and shrink the dictionary
+        to fit its keys.
+        """
+        if self._typed:
+            _compact(self)
+
+    def insert_many(self, keys, values):
+        """Insert the 1D arrays of *keys* and *values* pairwise, as
+        ``d[k] = v`` does for each pair in turn.
+        """
+        if not self._typed:
+            if len(keys) == 0:
+                return
+            self._initialise_dict(keys[0], values[0])
+        _insert_many(self, keys, values)
+
+    def lookup_many(self, keys, default):
+        """Return an array of the values of the 1D array of *keys*, *default*
+        standing for the missing keys.
+        """
+        if not self._typed:
+            return np.full(len(keys), default)
+        return _lookup_many(self, keys, default)
+
+
+# Let the dispatcher read the type of typed dicts from _dict_type natively
+_dispatcher.typeof_register_type(Dict, '_dict_type')
+
 
 @overload_classmethod(types.DictType, 'empty')
-def typeddict_empty(cls, key_type, value_type):
+def typeddict_empty(cls, key_type, value_type, n_keys=0):
     if cls.instance_type is not DictType:
         return
 
-    def impl(cls, key_type, value_type):
-        return dictobject.new_dict(key_type, value_type)
+    def impl(cls, key_type, value_type, n_keys=0):
+        return dictobject.new_dict(key_type, value_type, n_keys=n_keys)
 
     return impl
 
@@ -14,7 +14,7 @@ from numba.core.types import ListType
 from numba.core.imputils import numba_typeref_ctor
 from numba.core.dispatcher import Dispatcher
 from numba.core import types, config, cgutils
-from numba import njit, typeof
+from numba import njit, typeof, _dispatcher
 from numba.core.extending import (
     overload,
     box,
@@ -63,6 +63,16 @@ def _allocated(l):
     return l._allocated()
 
 
+@njit
+def _reserve(l, allocated):
+    l.reserve(allocated)
+
+
+@njit
+def _as_array(l):
+    return l.as_array()
+
+
 @njit
 def _is_mutable(l):
     return l._is_mutable()
@@ -312,6 +322,22 @@ class List(MutableSequence, pt.Generic[T]):
         else:
             return _allocated(self)
 
+    def reserve(self, allocated: int) -> None:
+        """Make room for *allocated* items in total, such that appending up
+        to that many items does not reallocate the list.
+        """
+        if self._typed:
+            _reserve(self, allocated)
+
+    def as_array(self):
+        """Return a read-only NumPy array viewing the items of a list of
+        numbers or booleans without copying them, the array keeps the list
+        alive. The list is made immutable.
+        """
+        if not self._typed:
+            raise RuntimeError("invalid operation on untyped list")
+        return _as_array(self)
+
     def _is_mutable(self):
         return _is_mutable(self)
 
@@ -444,6 +470,10 @@ class List(MutableSequence, pt.Generic[T]):
         return "{prefix}({body})".format(prefix=prefix, body=body)
 
 
+# Let the dispatcher read the type of typed lists from _list_type natively
+_dispatcher.typeof_register_type(List, '_list_type')
+
+
 @overload_classmethod(ListType, 'empty_list')
 def typedlist_empty(cls, item_type, allocated=DEFAULT_ALLOCATED):
     if cls.instance_type is not ListType:
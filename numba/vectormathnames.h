@@ -0,0 +1,7 @@
+/* The math functions with vector-width variants, as pairs of the double
+   and float functions.  They must be mapped to the same names in
+   numba/cpython/mathimpl.py. */
+
+VECTOR_MATH_UNARY(erf, erff)
+VECTOR_MATH_UNARY(erfc, erfcf)
+VECTOR_MATH_UNARY(lgamma, lgammaf)
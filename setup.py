@@ -178,7 +178,10 @@ def get_ext_modules():
                                        "numba/_lapack.c",
                                        "numba/_npymath_exports.c",
                                        "numba/_random.c",
+                                       "numba/_vectormath.c",
+                                       "numba/_vectormath_kernels.h",
                                        "numba/mathnames.inc",
+                                       "numba/vectormathnames.h",
                                        ],
                               **np_compile_args)
 
@@ -275,7 +278,9 @@ def get_ext_modules():
                     'numba/np/ufunc/tbbpool.cpp',
                     'numba/np/ufunc/gufunc_scheduler.cpp',
                 ],
-                depends=['numba/np/ufunc/workqueue.h'],
+                depends=['numba/np/ufunc/workqueue.h',
+                         'numba/np/ufunc/affinity.h',
+                         'numba/np/ufunc/profiling.h'],
                 include_dirs=[os.path.join(tbb_root, 'include')],
                 extra_compile_args=cpp11flags,
                 libraries=['tbb'],  # TODO: if --debug or -g, use 'tbb_debug'
@@ -304,7 +309,9 @@ def get_ext_modules():
                 'numba/np/ufunc/omppool.cpp',
                 'numba/np/ufunc/gufunc_scheduler.cpp',
             ],
-            depends=['numba/np/ufunc/workqueue.h'],
+            depends=['numba/np/ufunc/workqueue.h',
+                     'numba/np/ufunc/affinity.h',
+                     'numba/np/ufunc/profiling.h'],
             extra_compile_args=ompcompileflags + cpp11flags,
             extra_link_args=omplinkflags,
         )
@@ -319,20 +326,31 @@ def get_ext_modules():
         name='numba.np.ufunc.workqueue',
         sources=['numba/np/ufunc/workqueue.c',
                  'numba/np/ufunc/gufunc_scheduler.cpp'],
-        depends=['numba/np/ufunc/workqueue.h'])
+        depends=['numba/np/ufunc/workqueue.h',
+                 'numba/np/ufunc/affinity.h',
+                 'numba/np/ufunc/profiling.h'])
     ext_np_ufunc_backends.append(ext_np_ufunc_workqueue_backend)
 
     ext_mviewbuf = Extension(name='numba.mviewbuf',
                              extra_link_args=install_name_tool_fixer,
                              sources=['numba/mviewbuf.c'])
 
+    # Compile out the NRT allocation statistics if forced by user with
+    # NUMBA_NRT_DISABLE_STATS=1
+    nrt_compile_args = dict(np_compile_args)
+    if os.getenv("NUMBA_NRT_DISABLE_STATS"):
+        print("NRT allocation statistics disabled")
+        nrt_compile_args['define_macros'] = (
+            list(nrt_compile_args.get('define_macros', [])) +
+            [('NRT_DISABLE_STATS', '1')])
+
     ext_nrt_python = Extension(name='numba.core.runtime._nrt_python',
                                sources=['numba/core/runtime/_nrt_pythonmod.c',
                                         'numba/core/runtime/nrt.cpp'],
                                depends=['numba/core/runtime/nrt.h',
                                         'numba/_pymodule.h',
                                         'numba/core/runtime/_nrt_python.c'],
-                               **np_compile_args)
+                               **nrt_compile_args)
 
     ext_jitclass_box = Extension(name='numba.experimental.jitclass._box',
                                  sources=['numba/experimental/jitclass/_box.c'],